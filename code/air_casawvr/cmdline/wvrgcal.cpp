@@ -860,6 +860,8 @@ static void defineOptions(boost::program_options::options_description &desc,
     ("offsets",
      value<std::string>(),
      "Name of the optional input table containing the temperature offsets, e.g. generated by remove_cloud")
+    ("tbtable",
+     "Interpolate the sky brightness in a precomputed table during the retrievals instead of evaluating the full radiative transfer model (faster when there are many retrievals, e.g. with --segsource)")
     ;
   p.add("ms", -1);
 }
@@ -1216,7 +1218,8 @@ int main(int argc,  char* argv[])
 	try {
 	   rlist=LibAIR2::doALMAAbsRet(inp,
 				       fb,
-				       problemAnts);
+				       problemAnts,
+				       vm.count("tbtable")>0);
 	}
 	catch(const std::runtime_error rE){
 	   rval = 1;
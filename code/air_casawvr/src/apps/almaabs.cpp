@@ -8,6 +8,8 @@
 #include "almaabs.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <stdio.h>            /*** for sprintf(...) ***/
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
@@ -20,6 +22,7 @@
 #include "segmentation.hpp"
 #include "../radiometermeasure.hpp"
 #include "../dtdltools.hpp"
+#include "../tbtable.hpp"
 
 #include "../model_make.hpp"
 #include "bnmin1/src/nestedsampler.hxx"
@@ -35,10 +38,12 @@ namespace LibAIR2 {
 
   ALMAAbsRet::ALMAAbsRet(const std::vector<double> &TObs,
 			 double el,
-			 const ALMAWVRCharacter &WVRChar):
+			 const ALMAWVRCharacter &WVRChar,
+			 boost::shared_ptr<const TbTable> table):
     i(new iALMAAbsRet(TObs,
 		      el,
-		      WVRChar)),
+		      WVRChar,
+		      table)),
     valid(true)
   {
     if( ! i->sample()){
@@ -320,7 +325,8 @@ namespace LibAIR2 {
 
   boost::ptr_list<ALMAResBase> doALMAAbsRet(ALMAAbsInpL &il,
 					    std::vector<std::pair<double, double> > &fb,
-					    AntSet& problemAnts)
+					    AntSet& problemAnts,
+					    bool tabulate)
   {
 
     problemAnts.clear();
@@ -336,28 +342,79 @@ namespace LibAIR2 {
 
     size_t count=0;
 
-    BOOST_FOREACH(const ALMAAbsInput &x, il)
+    const std::vector<ALMAAbsInput> iv(il.begin(), il.end());
+    const long ninp=static_cast<long>(iv.size());
+
+    // Check the inputs first so that warnings come out in order
+    std::vector<std::string> tobsErr(ninp);
+    for(long k=0; k<ninp; ++k)
     {
-      bool problematic = false;
-      std::vector<double>  TObs(4);
-      for(size_t i=0; i<4; ++i)
-        TObs[i]=x.TObs[i];
+      std::vector<double>  TObs(iv[k].TObs, iv[k].TObs+4);
       try {
 	checkTObs(TObs);
       }
       catch(const std::runtime_error rE){
+	tobsErr[k]=rE.what();
+      }
+    }
+
+    // One table for all retrievals, deep enough for the lowest elevation
+    boost::shared_ptr<const TbTable> table;
+    if (tabulate && ninp>0)
+    {
+      double maxAirmass=1.0;
+      for(long k=0; k<ninp; ++k)
+	maxAirmass=std::max(maxAirmass, 1.0/std::sin(iv[k].el));
+      // Water column prior (10 mm) plus room for the finite differences
+      table.reset(new TbTable(ALMAWVRCharacter(),
+			      10.0*maxAirmass+1.0));
+    }
+
+    // The retrievals are independent: do them in parallel
+    std::vector<ALMAResBase*> rv(ninp, (ALMAResBase*)NULL);
+    std::string err;
+#pragma omp parallel for schedule(dynamic)
+    for(long k=0; k<ninp; ++k)
+    {
+      try {
+	std::vector<double>  TObs(iv[k].TObs, iv[k].TObs+4);
+	ALMAWVRCharacter wvrchar;
+	ALMAAbsRet ar(TObs, 
+		      iv[k].el,  
+		      wvrchar,
+		      table);
+	ALMAResBase *ares=new ALMAResBase;
+	if(ar.g_Res(*ares)){
+	  rv[k]=ares;
+	}
+	else{
+	  delete ares;
+	}
+      }
+      catch(const std::exception &e){
+#pragma omp critical (doALMAAbsRet_err)
+	err=e.what();
+      }
+    }
+    if(!err.empty()){
+      for(long k=0; k<ninp; ++k)
+	delete rv[k];
+      throw std::runtime_error(err);
+    }
+
+    for(long k=0; k<ninp; ++k)
+    {
+      const ALMAAbsInput &x=iv[k];
+      bool problematic = false;
+      if (!tobsErr[k].empty()){
 	std::cout << std::endl << "WARNING: problem with Tobs of antenna " << x.antno
-		  << std::endl << "         LibAIR2::checkTObs: " << rE.what() << std::endl;
+		  << std::endl << "         LibAIR2::checkTObs: " << tobsErr[k] << std::endl;
 	std::cerr << std::endl << "WARNING: problem with Tobs of antenna " << x.antno
-		  << std::endl << "         LibAIR2::checkTObs: " << rE.what() << std::endl;
+		  << std::endl << "         LibAIR2::checkTObs: " << tobsErr[k] << std::endl;
 	problematic = true;
       }
-      ALMAWVRCharacter wvrchar;
-      ALMAAbsRet ar(TObs, 
-		    x.el,  
-		    wvrchar);
-      ALMAResBase *ares=new ALMAResBase;      
-      if(!ar.g_Res(*ares)){
+      if(rv[k]==NULL){
+	const double *TObs=x.TObs;
 	std::cout << "WARNING: Bayesian evidence was zero for antenna " << x.antno << std::endl
 		  << "         TObs was " << TObs[0] << " " << TObs[1] << " " << TObs[2] << " " <<TObs[3] 
 		  << " K, elevation " << x.el/M_PI*180. << " deg" << std::endl;
@@ -366,7 +423,7 @@ namespace LibAIR2 {
 		  << " K, elevation " << x.el/M_PI*180. << " deg" << std::endl;
       }
       else{
-	res.push_back(ares);
+	res.push_back(rv[k]);
 	newil.push_back(x);
 	if(fbFilled){
 	  newfb.push_back(fb[count++]);
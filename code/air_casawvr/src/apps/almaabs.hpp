@@ -17,6 +17,7 @@
 #include <iostream>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/array.hpp>
 #include <boost/ptr_container/ptr_list.hpp>
 
@@ -34,6 +35,7 @@ namespace LibAIR2 {
   class InterpArrayData;
   class dTdLCoeffsSingleInterpolated;
   class ALMARetOpts;
+  class TbTable;
 
   /**
    */
@@ -50,10 +52,14 @@ namespace LibAIR2 {
 
        \param WVRChar Characterisation of the WVR used to make this
        measurement
+
+       \param table If given, interpolate the sky brightness from this
+       table rather than computing the full model
      */
     ALMAAbsRet(const std::vector<double> &TObs,
 	       double el,
-	       const ALMAWVRCharacter &WVRChar);
+	       const ALMAWVRCharacter &WVRChar,
+	       boost::shared_ptr<const TbTable> table=boost::shared_ptr<const TbTable>());
 
     virtual ~ALMAAbsRet();
 
@@ -112,10 +118,18 @@ namespace LibAIR2 {
 
   /**  Carry out the retrieval of coefficients form a list of inputs;
        remove the inputs which have zero Bayesian evidence from the list
+
+       The retrievals are independent and are run in parallel; results
+       and messages are in the order of the inputs.
+
+       \param tabulate Tabulate the sky brightness once for all the
+       inputs (see TbTable) and interpolate in it during the
+       retrievals, instead of evaluating the full model each time
    */
   boost::ptr_list<ALMAResBase> doALMAAbsRet(ALMAAbsInpL &il, 
 					    std::vector<std::pair<double, double> > &fb,
-					    LibAIR2::AntSet &problemAnts);
+					    LibAIR2::AntSet &problemAnts,
+					    bool tabulate=false);
   
 
   /** \brief Calculate coefficients for phase correction from inputs
@@ -11,6 +11,7 @@
 #include "almaabs_i.hpp"
 
 #include "../model_make.hpp"
+#include "../tbtable.hpp"
 #include "../dtdltools.hpp"
 #include "bnmin1/src/nestedinitial.hxx"
 
@@ -20,12 +21,23 @@ namespace LibAIR2 {
   const double iALMAAbsRetLL::thermNoise=1.0;
   const size_t iALMAAbsRet::n_ss=200;
 
+  /// The model of the sky brightness, tabulated or full
+  static WVRAtmoQuantModel *mkRetModel(const ALMAWVRCharacter &WVRChar,
+				       boost::shared_ptr<const TbTable> table)
+  {
+    if (table)
+      return new TabulatedWaterModel(table, WVRChar);
+    return mkSingleLayerWater(WVRChar,
+			      PartTable,
+			      AirCont);
+  }
+
   iALMAAbsRetLL::iALMAAbsRetLL(const std::vector<double> &TObs,
 			       double el,
-			       const ALMAWVRCharacter &WVRChar):
-    cm(new CouplingModel(mkSingleLayerWater(WVRChar,
-					    PartTable,
-					    AirCont))),
+			       const ALMAWVRCharacter &WVRChar,
+			       boost::shared_ptr<const TbTable> table):
+    cm(new CouplingModel(mkRetModel(WVRChar,
+				    table))),
     m(cm),
     ll(new AbsNormMeasure(m))
   {
@@ -40,10 +52,12 @@ namespace LibAIR2 {
 
   iALMAAbsRet::iALMAAbsRet(const std::vector<double> &TObs,
 			   double el,
-			   const ALMAWVRCharacter &WVRChar):
+			   const ALMAWVRCharacter &WVRChar,
+			   boost::shared_ptr<const TbTable> table):
     ls(TObs, 
        el, 
-       WVRChar),
+       WVRChar,
+       table),
     pll(ls.ll),
     evidence()
   {
@@ -60,7 +74,9 @@ namespace LibAIR2 {
 		   n_ss,
 		   ss);
 
-    // Create the nested sampler
+    // Create the nested sampler. It and startSetDirect have their own
+    // generators, so each retrieval draws the same sequence whichever
+    // thread runs it
     ns.reset(new Minim::NestedS(pll));
     (*ns)["coupling"]->dofit=false;
     ns->reset(ss);
@@ -13,6 +13,7 @@
 #include <list>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "bnmin1/src/nestedsampler.hxx"
 #include "bnmin1/src/priors.hxx"
@@ -27,6 +28,9 @@
 
 namespace LibAIR2 {
 
+  // Forward declarations
+  class TbTable;
+
   /// Structures to represent likelihood of a measurement for an
   /// absolute retrieval from ALMA data
   struct iALMAAbsRetLL
@@ -44,9 +48,14 @@ namespace LibAIR2 {
     /// Representation of the measured values and errors
     AbsNormMeasure *ll;
 
+    /**
+       \param table If given, the sky brightness is interpolated from
+       this table instead of being computed by the full model
+     */
     iALMAAbsRetLL(const std::vector<double> &TObs,
 		  double el,
-		  const ALMAWVRCharacter &WVRChar);
+		  const ALMAWVRCharacter &WVRChar,
+		  boost::shared_ptr<const TbTable> table=boost::shared_ptr<const TbTable>());
 
   };
 
@@ -75,7 +84,8 @@ namespace LibAIR2 {
 
     iALMAAbsRet(const std::vector<double> &TObs,
 		double el,
-		const ALMAWVRCharacter &WVRChar);
+		const ALMAWVRCharacter &WVRChar,
+		boost::shared_ptr<const TbTable> table=boost::shared_ptr<const TbTable>());
 
     bool sample(void); // returns false if evidence is zero
 
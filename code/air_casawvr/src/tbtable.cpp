@@ -0,0 +1,271 @@
+/**
+   Maintained by ESO since 2013.
+
+   This file is part of LibAIR and is licensed under GNU Public
+   License Version 2
+
+   \file tbtable.cpp
+*/
+
+#include <cmath>
+#include <stdexcept>
+
+#include "tbtable.hpp"
+#include "model_make.hpp"
+#include "model_water.hpp"
+#include "singlelayerwater.hpp"
+#include "basicphys.hpp"
+
+namespace LibAIR2 {
+
+  /** Four-point Catmull-Rom stencil along one axis of the table.
+
+      At the edges the point outside the grid is replaced by linear
+      extrapolation of the two nearest ones, which is folded into the
+      weights so that only valid indices are used.
+   */
+  struct CRStencil {
+    size_t i[4];
+    double w[4];
+    double dw[4];
+
+    CRStencil(double x, double lo, double step, size_t N)
+    {
+      const double u=(x-lo)/step;
+      long j=static_cast<long>(std::floor(u));
+      if (j<0) j=0;
+      if (j>static_cast<long>(N)-2) j=static_cast<long>(N)-2;
+      const double t=u-j;
+      const double t2=t*t, t3=t2*t;
+
+      w[0]=0.5*(-t3+2*t2-t);
+      w[1]=0.5*(3*t3-5*t2+2);
+      w[2]=0.5*(-3*t3+4*t2+t);
+      w[3]=0.5*(t3-t2);
+      dw[0]=0.5*(-3*t2+4*t-1)/step;
+      dw[1]=0.5*(9*t2-10*t)/step;
+      dw[2]=0.5*(-9*t2+8*t+1)/step;
+      dw[3]=0.5*(3*t2-2*t)/step;
+
+      for(size_t k=0; k<4; ++k)
+      {
+	long jj=j-1+static_cast<long>(k);
+	i[k]=static_cast<size_t>(jj<0 ? 0 : (jj>static_cast<long>(N)-1 ? N-1 : jj));
+      }
+      if (j==0)
+      {
+	// f(-1) = 2 f(0) - f(1)
+	w[1]+=2*w[0]; w[2]-=w[0]; w[0]=0;
+	dw[1]+=2*dw[0]; dw[2]-=dw[0]; dw[0]=0;
+      }
+      if (j==static_cast<long>(N)-2)
+      {
+	// f(N) = 2 f(N-1) - f(N-2)
+	w[2]+=2*w[3]; w[1]-=w[3]; w[3]=0;
+	dw[2]+=2*dw[3]; dw[1]-=dw[3]; dw[3]=0;
+      }
+    }
+  };
+
+  static size_t gridSize(double lo, double hi, double step)
+  {
+    const size_t N=static_cast<size_t>(std::ceil((hi-lo)/step - 1e-9))+1;
+    return N<2 ? 2 : N;
+  }
+
+  TbTable::TbTable(const ALMAWVRCharacter &WVRChar,
+		   double nhi,
+		   double dn,
+		   double Tlo, double Thi, double dT,
+		   double Plo, double Phi, double dP):
+    nlo(0), dn(dn),
+    Tlo(Tlo), dT(dT),
+    Plo(Plo), dP(dP),
+    nn(gridSize(0, nhi, dn)),
+    nT(gridSize(Tlo, Thi, dT)),
+    nP(gridSize(Plo, Phi, dP)),
+    nch(4)
+  {
+    const long npoints=static_cast<long>(nn*nT*nP);
+    tb.resize(npoints*nch);
+    std::string err;
+
+#pragma omp parallel
+    {
+      // Each thread needs its own model since evaluation changes its
+      // state
+      boost::scoped_ptr<WaterModel<ISingleLayerWater> >
+	m(mkSingleLayerWater(WVRChar, PartTable, AirCont));
+      std::vector<Minim::DParamCtr> pars;
+      m->AddParams(pars);
+      double *pn=NULL, *pT=NULL, *pP=NULL;
+      for(size_t k=0; k<pars.size(); ++k)
+      {
+	if (pars[k].name=="n") pn=pars[k].p;
+	else if (pars[k].name=="T") pT=pars[k].p;
+	else if (pars[k].name=="P") pP=pars[k].p;
+      }
+      std::vector<double> res;
+
+#pragma omp for schedule(dynamic)
+      for(long k=0; k<npoints; ++k)
+      {
+	const size_t iP=k % nP;
+	const size_t iT=(k / nP) % nT;
+	const size_t in=k / (nP*nT);
+	*pn=nlo+in*dn;
+	*pT=Tlo+iT*dT;
+	*pP=Plo+iP*dP;
+	try {
+	  m->eval(res);
+	  for(size_t ch=0; ch<nch; ++ch)
+	    tb[k*nch+ch]=res[ch];
+	}
+	catch(const std::exception &e) {
+#pragma omp critical (TbTable_err)
+	  err=e.what();
+	}
+      }
+    }
+    if (!err.empty())
+      throw std::runtime_error("Could not tabulate sky brightness: "+err);
+  }
+
+  bool TbTable::covers(double n, double T, double P) const
+  {
+    return n>=nlo && n<=nlo+(nn-1)*dn &&
+      T>=Tlo && T<=Tlo+(nT-1)*dT &&
+      P>=Plo && P<=Plo+(nP-1)*dP;
+  }
+
+  void TbTable::eval(double n, double T, double P,
+		     std::vector<double> &res,
+		     std::vector<double> *dTdn) const
+  {
+    const CRStencil sn(n, nlo, dn, nn);
+    const CRStencil sT(T, Tlo, dT, nT);
+    const CRStencil sP(P, Plo, dP, nP);
+
+    res.assign(nch, 0.0);
+    if (dTdn)
+      dTdn->assign(nch, 0.0);
+    for(size_t a=0; a<4; ++a)
+    {
+      if (sn.w[a]==0 && sn.dw[a]==0) continue;
+      for(size_t b=0; b<4; ++b)
+      {
+	if (sT.w[b]==0) continue;
+	for(size_t c=0; c<4; ++c)
+	{
+	  if (sP.w[c]==0) continue;
+	  const double wTP=sT.w[b]*sP.w[c];
+	  const double *p=&tb[((sn.i[a]*nT + sT.i[b])*nP + sP.i[c])*nch];
+	  for(size_t ch=0; ch<nch; ++ch)
+	  {
+	    res[ch]+=sn.w[a]*wTP*p[ch];
+	    if (dTdn)
+	      (*dTdn)[ch]+=sn.dw[a]*wTP*p[ch];
+	  }
+	}
+      }
+    }
+  }
+
+  TabulatedWaterModel::TabulatedWaterModel(boost::shared_ptr<const TbTable> table,
+					   const ALMAWVRCharacter &WVRChar):
+    table(table),
+    WVRChar(WVRChar),
+    n(0), T(0), P(0)
+  {
+  }
+
+  TabulatedWaterModel::~TabulatedWaterModel()
+  {
+  }
+
+  void TabulatedWaterModel::evalFull(std::vector<double> &res,
+				     std::vector<double> *dTdc) const
+  {
+    if (!full)
+      full.reset(mkSingleLayerWater(WVRChar, PartTable, AirCont));
+    std::vector<Minim::DParamCtr> pars;
+    full->AddParams(pars);
+    for(size_t k=0; k<pars.size(); ++k)
+    {
+      if (pars[k].name=="n") *pars[k].p=n;
+      else if (pars[k].name=="T") *pars[k].p=T;
+      else if (pars[k].name=="P") *pars[k].p=P;
+    }
+    full->eval(res);
+    if (dTdc)
+      full->dTdc(*dTdc);
+  }
+
+  double TabulatedWaterModel::eval(size_t ch) const
+  {
+    std::vector<double> res;
+    eval(res);
+    return res[ch];
+  }
+
+  void TabulatedWaterModel::eval(std::vector<double> & res) const
+  {
+    if (table->covers(n, T, P))
+      table->eval(n, T, P, res);
+    else
+      evalFull(res, NULL);
+  }
+
+  double TabulatedWaterModel::dTdc (size_t ch) const
+  {
+    std::vector<double> res;
+    dTdc(res);
+    return res[ch];
+  }
+
+  void TabulatedWaterModel::dTdc (std::vector<double> &res) const
+  {
+    std::vector<double> tb;
+    if (table->covers(n, T, P))
+      table->eval(n, T, P, tb, &res);
+    else
+      evalFull(tb, &res);
+  }
+
+  double TabulatedWaterModel::dTdL_ND (size_t ch) const
+  {
+    return dTdc(ch) / SW_WaterToPath_Simplified(1.0,
+						T);
+  }
+
+  void TabulatedWaterModel::dTdL_ND (std::vector<double> & res) const
+  {
+    dTdc(res);
+    const double conv = 1.0 / SW_WaterToPath_Simplified(1.0,
+							T);
+    for (size_t i =0 ; i < res.size() ; ++i)
+      res[i] *= conv;
+  }
+
+  void TabulatedWaterModel::AddParams (std::vector< Minim::DParamCtr > &pars)
+  {
+    pars.push_back(Minim::DParamCtr ( &n ,
+				      "n",
+				      true     ,
+				      "Water column (mm)"
+				      ));
+
+    pars.push_back(Minim::DParamCtr ( &T ,
+				      "T",
+				      true     ,
+				      "Temperature (K)"
+				      ));
+
+    pars.push_back(Minim::DParamCtr ( &P ,
+				      "P",
+				      true     ,
+				      "Pressure (mBar)"
+				      ));
+  }
+
+}
@@ -0,0 +1,137 @@
+/**
+   Maintained by ESO since 2013.
+
+   This file is part of LibAIR and is licensed under GNU Public
+   License Version 2
+
+   \file tbtable.hpp
+
+   Tabulated sky brightness for the single layer water model
+*/
+#ifndef _LIBAIR_TBTABLE_HPP__
+#define _LIBAIR_TBTABLE_HPP__
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "model_iface.hpp"
+#include "radiometermeasure.hpp"
+
+namespace LibAIR2 {
+
+  // Forward declarations
+  class ISingleLayerWater;
+  template <class AM> class WaterModel;
+
+  /** \brief Brightness temperatures of the WVR channels of the
+      single layer water model, precomputed on a regular grid in
+      water column, temperature and pressure.
+
+      The full model does a line-by-line radiative transfer over the
+      radiometer frequency grid on every evaluation; the table does
+      it once per grid point (in parallel) and then interpolates with
+      separable cubic (Catmull-Rom) splines, which are continuous in
+      the first derivative so that dT/dc can be taken directly from
+      the interpolant.
+
+      The elevation is not a dimension of the table: the plane
+      parallel model (PPDipModel) only scales the water column by the
+      airmass, so the column range simply has to extend to the
+      largest line-of-sight column needed.
+   */
+  class TbTable
+  {
+    double nlo, dn, Tlo, dT, Plo, dP;
+    size_t nn, nT, nP, nch;
+
+    /// Brightness, index ((in*nT + iT)*nP + iP)*nch + ch
+    std::vector<double> tb;
+
+  public:
+
+    // ---------- Construction / Destruction --------------
+
+    /**
+       \param WVRChar Characterisation of the WVR, as used for the
+       full model
+
+       \param nhi Largest (line-of-sight) water column to tabulate
+       (mm)
+
+       The remaining parameters give the grid; the defaults cover the
+       priors used in the ALMA absolute retrievals.
+     */
+    TbTable(const ALMAWVRCharacter &WVRChar,
+	    double nhi,
+	    double dn=0.1,
+	    double Tlo=250, double Thi=295, double dT=5,
+	    double Plo=300, double Phi=550, double dP=25);
+
+    // ---------- Public interface   --------------
+
+    /// Number of channels tabulated
+    size_t nchannels(void) const {return nch;};
+
+    /// True if the point is within the tabulated range
+    bool covers(double n, double T, double P) const;
+
+    /** \brief Interpolated brightness of all channels, and optionally
+	their derivative with respect to the water column (K/mm)
+     */
+    void eval(double n, double T, double P,
+	      std::vector<double> &res,
+	      std::vector<double> *dTdn=NULL) const;
+
+  };
+
+  /** \brief Single layer water model evaluated from a TbTable
+
+      Has the same parameters (n, T, P) as
+      WaterModel<ISingleLayerWater> and can be used in its place. Points
+      outside the table are evaluated with the full model.
+   */
+  class TabulatedWaterModel:
+    public WVRAtmoQuantModel
+  {
+    boost::shared_ptr<const TbTable> table;
+    ALMAWVRCharacter WVRChar;
+
+    /// Full model, only created if needed
+    mutable boost::scoped_ptr<WaterModel<ISingleLayerWater> > full;
+
+    /// Evaluate with the full model, returning dT/dc if dTdc not null
+    void evalFull(std::vector<double> &res,
+		  std::vector<double> *dTdc) const;
+
+  public:
+
+    /// Water vapour column (mm pwv)
+    double n;
+
+    /// Water vapour temperature (K)
+    double T;
+
+    /// Water vapour pressure (mBar)
+    double P;
+
+    TabulatedWaterModel(boost::shared_ptr<const TbTable> table,
+			const ALMAWVRCharacter &WVRChar);
+
+    virtual ~TabulatedWaterModel();
+
+    // Inherited from WVRAtmoQuants
+    virtual double eval(size_t ch) const;
+    virtual void eval(std::vector<double> & res) const;
+    virtual double dTdc (size_t ch) const;
+    void dTdc (std::vector<double> &res) const;
+    virtual double dTdL_ND (size_t ch) const;
+    void dTdL_ND (std::vector<double> & res) const;
+    // Inherited from WVRAtmoModel
+    void AddParams (std::vector< Minim::DParamCtr > &pars);
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+//
+// CASA - Common Astronomy Software Applications
+// Copyright (C) 2026
+// Copyright by ESO (in the framework of the ALMA collaboration).
+//
+// This file is part of CASA.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// Checks that the tabulated single layer water model agrees with the
+// full radiative transfer model it replaces in the retrievals
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <casa/aips.h>
+#include <casa/Utilities/Assert.h>
+#include <casa/Exceptions/Error.h>
+
+#include "../src/tbtable.hpp"
+#include "../src/model_make.hpp"
+#include "../src/model_water.hpp"
+#include "../src/singlelayerwater.hpp"
+#include "../src/radiometermeasure.hpp"
+
+using namespace LibAIR2;
+
+// Tolerance of the interpolated brightness (K) and of dT/dc (relative)
+static const double TbTol=0.05;
+static const double dTdcTol=0.01;
+
+struct Models {
+  ALMAWVRCharacter WVRChar;
+  boost::shared_ptr<const TbTable> table;
+  boost::scoped_ptr<WaterModel<ISingleLayerWater> > full;
+  double *pn, *pT, *pP;
+
+  Models():
+    table(new TbTable(WVRChar, 11.0)),
+    full(mkSingleLayerWater(WVRChar, PartTable, AirCont)),
+    pn(NULL), pT(NULL), pP(NULL)
+  {
+    std::vector<Minim::DParamCtr> pars;
+    full->AddParams(pars);
+    for(size_t k=0; k<pars.size(); ++k)
+    {
+      if (pars[k].name=="n") pn=pars[k].p;
+      else if (pars[k].name=="T") pT=pars[k].p;
+      else if (pars[k].name=="P") pP=pars[k].p;
+    }
+    AlwaysAssertExit(pn && pT && pP);
+  }
+};
+
+// Compares the tabulated and full model at (n, T, P), returning the
+// largest brightness difference (K) and relative dT/dc difference
+static void compare(Models &m,
+		    double n, double T, double P,
+		    double &maxTb, double &maxdTdc)
+{
+  TabulatedWaterModel tab(m.table, m.WVRChar);
+  tab.n=n; tab.T=T; tab.P=P;
+  *m.pn=n; *m.pT=T; *m.pP=P;
+
+  std::vector<double> tbTab, tbFull, dTab, dFull;
+  tab.eval(tbTab);
+  tab.dTdc(dTab);
+  m.full->eval(tbFull);
+  m.full->dTdc(dFull);
+  AlwaysAssertExit(tbTab.size()==tbFull.size());
+  AlwaysAssertExit(dTab.size()==dFull.size());
+
+  maxTb=0; maxdTdc=0;
+  for(size_t ch=0; ch<tbFull.size(); ++ch)
+  {
+    maxTb=std::max(maxTb, std::fabs(tbTab[ch]-tbFull[ch]));
+    maxdTdc=std::max(maxdTdc,
+		     std::fabs(dTab[ch]-dFull[ch])/std::fabs(dFull[ch]));
+  }
+}
+
+// Off-grid points inside the table agree with the full model
+void t_TbTable_Interp(Models &m)
+{
+  const double pts[][3]={
+    {0.27, 252.5, 312.0},
+    {1.03, 268.1, 407.3},
+    {2.55, 273.7, 500.9},
+    {4.91, 281.2, 433.3},
+    {8.77, 291.4, 541.0}
+  };
+  for(size_t i=0; i<sizeof(pts)/sizeof(pts[0]); ++i)
+  {
+    AlwaysAssertExit(m.table->covers(pts[i][0], pts[i][1], pts[i][2]));
+    double maxTb, maxdTdc;
+    compare(m, pts[i][0], pts[i][1], pts[i][2], maxTb, maxdTdc);
+    std::cout << "n=" << pts[i][0]
+	      << " T=" << pts[i][1]
+	      << " P=" << pts[i][2]
+	      << " dTb=" << maxTb
+	      << " ddTdc=" << maxdTdc << std::endl;
+    AlwaysAssertExit(maxTb < TbTol);
+    AlwaysAssertExit(maxdTdc < dTdcTol);
+  }
+}
+
+// Points outside the table fall back to the full model exactly
+void t_TbTable_Outside(Models &m)
+{
+  AlwaysAssertExit(!m.table->covers(12.0, 270.0, 400.0));
+  double maxTb, maxdTdc;
+  compare(m, 12.0, 270.0, 400.0, maxTb, maxdTdc);
+  AlwaysAssertExit(maxTb == 0);
+  AlwaysAssertExit(maxdTdc == 0);
+}
+
+int main()
+{
+  try {
+    Models m;
+    std::cout << "t_TbTable_Interp" << std::endl;
+    t_TbTable_Interp(m);
+    std::cout << "t_TbTable_Outside" << std::endl;
+    t_TbTable_Outside(m);
+  }
+  catch (const casacore::AipsError &x) {
+    std::cerr << x.getMesg() << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}
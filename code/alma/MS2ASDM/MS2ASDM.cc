@@ -63,6 +63,10 @@
 #include <casa/iomanip.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <casa/OS/Directory.h>
 #include <alma/ASDM/ASDMAll.h>
 #include <alma/ASDMBinaries/SDMDataObjectWriter.h>
@@ -112,6 +116,7 @@ namespace casa {
     setSBDuration(); // set to default values
     setSubScanDuration(); 
     setDataAPCorrected();
+    setNumBDFWriters();
     setVerbosity();
   }
   
@@ -359,20 +364,286 @@ namespace casa {
     return true;
   }
 
+  // Converts the integrations of one subscan to BDF binary data and writes
+  // them to the subscan file on a thread of its own. The MS is read by the
+  // caller, which writes the header through sdmdow(), calls start(), hands
+  // over the integrations with add() and finally calls finish().
+  class MS2ASDM::BDFWriter {
+  public:
+    // one integration as read from the MS, rows in BDF baseline order
+    struct Integration {
+      uint64_t time; // midpoint in ns
+      uint64_t interval; // in ns
+      vector< Matrix<casacore::Complex> > data;
+      vector< Matrix<Bool> > flags;
+      vector< Bool > flagRow;
+      vector< Bool > autoCorr;
+    };
+
+    BDFWriter(const String& fileName, const string& uid, const vector< Bool >& skipCorr,
+	      const uInt numSpectralPoint, const uInt numStokesMS,
+	      const uInt flagsSize, const uInt crossSize, const uInt autoSize,
+	      const uInt verbosity) :
+      ofs_p(fileName.c_str()),
+      sdmdow_p(&ofs_p, uid), // use default title
+      skipCorr_p(skipCorr),
+      numSpectralPoint_p(numSpectralPoint),
+      numStokesMS_p(numStokesMS),
+      flagsSize_p(flagsSize),
+      crossSize_p(crossSize),
+      autoSize_p(autoSize),
+      verbosity_p(verbosity),
+      doneReading_p(false),
+      failed_p(false),
+      numIntegrations_p(0),
+      datasize_p(0),
+      numPadded_p(0)
+    {}
+
+    ~BDFWriter(){
+      { // drop what was not written yet if finish() was not called
+	std::lock_guard<std::mutex> lock(mutex_p);
+	queue_p.clear();
+      }
+      stop();
+    }
+
+    SDMDataObjectWriter& sdmdow(){ return sdmdow_p; }
+
+    void start(){
+      thread_p = std::thread(&BDFWriter::run, this);
+    }
+
+    // queue an integration, waiting while maxQueued integrations are queued;
+    // false if the writer failed
+    Bool add(std::unique_ptr<Integration>& integration){
+      std::unique_lock<std::mutex> lock(mutex_p);
+      changed_p.wait(lock, [this]() { return queue_p.size() < maxQueued || failed_p; });
+      if(failed_p){
+	return false;
+      }
+      queue_p.push_back(std::move(integration));
+      changed_p.notify_all();
+      return true;
+    }
+
+    // wait until all integrations are written and close the subscan file
+    // (return the number of integrations written, -1 on error)
+    Int finish(int& datasize, LogIO& os){
+      stop();
+      datasize = datasize_p;
+      for(uInt i=0; i<warnings_p.size(); i++){
+	os << LogIO::WARN << warnings_p[i] << LogIO::POST;
+      }
+      if(numPadded_p>0){
+	os << LogIO::WARN << "Encountered missing integrations for some baselines in MS."
+	   << " Filled " << numPadded_p << " integrations with flagged entries." << LogIO::POST; 
+      }
+      if(failed_p){
+	os << LogIO::SEVERE << "Error creating ASDM: " << error_p << LogIO::POST;
+	return -1;
+      }
+      try{
+	sdmdow_p.done();
+	ofs_p.close();
+      }
+      catch(asdmbinaries::SDMDataObjectWriterException x){
+	os << LogIO::SEVERE << "Error creating ASDM: " << x.getMessage()
+	   << LogIO::POST;      
+	return -1;
+      }
+      return numIntegrations_p;
+    }
+
+  private:
+    // the number of integrations read ahead of the writer
+    static const uInt maxQueued = 4;
+
+    void stop(){
+      {
+	std::lock_guard<std::mutex> lock(mutex_p);
+	doneReading_p = true;
+      }
+      changed_p.notify_all();
+      if(thread_p.joinable()){
+	thread_p.join();
+      }
+    }
+
+    void run(){
+      unsigned int integrationNum = 1;
+      while(true){
+	std::unique_ptr<Integration> integration;
+	{
+	  std::unique_lock<std::mutex> lock(mutex_p);
+	  changed_p.wait(lock, [this]() { return !queue_p.empty() || doneReading_p; });
+	  if(queue_p.empty()){
+	    return;
+	  }
+	  integration = std::move(queue_p.front());
+	  queue_p.pop_front();
+	}
+	changed_p.notify_all();
+	String error;
+	try{
+	  if(write(*integration, integrationNum)){
+	    integrationNum++;
+	  }
+	  continue;
+	}
+	catch(asdmbinaries::SDMDataObjectWriterException x){
+	  error = x.getMessage();
+	}
+	catch(asdmbinaries::SDMDataObjectException x){
+	  error = x.getMessage();
+	}
+	catch(AipsError y){
+	  error = y.getMesg();
+	}
+	catch(std::string z){
+	  error = z;
+	}
+	catch(std::exception& zz){
+	  error = zz.what();
+	}
+	catch(...){
+	  error = "unknown exception";
+	}
+	std::lock_guard<std::mutex> lock(mutex_p);
+	error_p = error;
+	failed_p = true;
+	queue_p.clear();
+	changed_p.notify_all();
+	return;
+      }
+    }
 
-  Int MS2ASDM::writeMainBinSubScanForOneDDIdFIdPair(const Int theDDId, const Int theFieldId, 
-						    const String& datacolumn, 
-						    const uInt theScan, const uInt theSubScan,
-						    const uInt startRow, const uInt endRow,
-						    const Tag eBlockId,
-						    int& datasize, asdm::EntityRef& dataOid, 
-						    vector< asdm::Tag >& stateIdV){
+    // convert and write one integration (return false if it was skipped)
+    Bool write(const Integration& integration, const unsigned int integrationNum){
+      vector< unsigned int > flags;
+      vector< int64_t > actualTimes; // only needed for data blanking
+      vector< int64_t > actualDurations; // only needed for data blanking
+      vector< float > zeroLags; // LAG_DATA, optional column, not used for the moment
+      vector< float > crossData;
+      // vector< short > crossData;
+      // vector< int > crossData; // standard case for ALMA
+      vector< float > autoData;	 
+      flags.reserve(flagsSize_p);
+      crossData.reserve(crossSize_p);
+      autoData.reserve(autoSize_p);
+
+      for(uInt ii=0; ii<integration.data.size(); ii++){
+	const Matrix<casacore::Complex>& dat = integration.data[ii];
+	const Matrix<Bool>& flagsm = integration.flags[ii];
+	Bool haveAuto = integration.autoCorr[ii];
+
+	if(haveAuto){
+	  for(uInt i=0; i<numSpectralPoint_p; i++){
+	    for(uInt j=0; j<numStokesMS_p; j++){
+	      if(!skipCorr_p[j]){
+		autoData.push_back( dat(j,i).real() );
+	      }
+	    }
+	  }
+	}
+	else{
+	  for(uInt i=0; i<numSpectralPoint_p; i++){
+	    for(uInt j=0; j<numStokesMS_p; j++){
+	      const casacore::Complex& x = dat(j,i);
+	      crossData.push_back( x.real() );
+	      crossData.push_back( x.imag() );
+	    }
+	  }
+	}
+
+	for(uInt i=0; i<numSpectralPoint_p; i++){
+	  for(uInt j=0; j<numStokesMS_p; j++){
+	    if(!(haveAuto && skipCorr_p[j])){
+	      flags.push_back( integration.flagRow[ii] ? 1 : flagsm(j,i) );
+	    }
+	  }
+	}
+      }// end loop over rows in this timestamp sorted by baseline
+
+      // fill with flagged entries in case there are missing baselines in the MS
+      if(flags.size()<flagsSize_p || crossData.size()<crossSize_p || autoData.size()<autoSize_p){
+	flags.resize(std::max((uInt)flags.size(), flagsSize_p), 1);
+	crossData.resize(std::max((uInt)crossData.size(), crossSize_p), 0.);
+	autoData.resize(std::max((uInt)autoData.size(), autoSize_p), 0.);
+	numPadded_p++;
+      }
+
+      if(verbosity_p>1){
+	ostringstream oss;
+	oss << "Sizes: " << endl
+	    << "   flags " << flags.size() << endl
+	    << "   crossData " << crossData.size() << endl
+	    << "   autoData " << autoData.size() << endl;
+	cout << oss.str();
+      }
+
+      try{
+	sdmdow_p.addIntegration(integrationNum,    // integration's index.
+				integration.time,     // midpoint
+				integration.interval, // time interval
+				flags,             // flags binary data 
+				actualTimes,       // actual times binary data      
+				actualDurations,   // actual durations binary data          
+				zeroLags,          // zero lags binary data                 
+				crossData,    // cross data (can be short or int)  
+				autoData);         // single dish data.  
+      }
+      catch(asdmbinaries::SDMDataObjectWriterException x){
+	warnings_p.push_back("Error writing ASDM:" + x.getMessage() + "\nWill try to continue ...");
+	return false;
+      }
+      // (Note: subintegrations are used only for channel averaging to gain time res. by sacrificing spec. res.)
+
+      datasize_p += flags.size() * sizeof(unsigned int)
+	+ crossData.size() * sizeof( float )
+	+ autoData.size() * sizeof( float );
+      numIntegrations_p++;
+      return true;
+    }
+
+    ofstream ofs_p;
+    SDMDataObjectWriter sdmdow_p;
+    vector< Bool > skipCorr_p; // for the POLARIZATION_ID of the subscan
+    uInt numSpectralPoint_p;
+    uInt numStokesMS_p;
+    uInt flagsSize_p;
+    uInt crossSize_p;
+    uInt autoSize_p;
+    uInt verbosity_p;
+
+    std::thread thread_p;
+    std::mutex mutex_p;
+    std::condition_variable changed_p;
+    std::deque< std::unique_ptr<Integration> > queue_p;
+    Bool doneReading_p;
+    Bool failed_p;
+    String error_p;
+
+    // results, only accessed by the writer thread until it is joined
+    Int numIntegrations_p;
+    int datasize_p;
+    uInt numPadded_p;
+    vector< string > warnings_p;
+  };
+
+
+  std::unique_ptr<MS2ASDM::BDFWriter> MS2ASDM::writeMainBinSubScanForOneDDIdFIdPair(const Int theDDId, const Int theFieldId, 
+										 const String& datacolumn, 
+										 const uInt theScan, const uInt theSubScan,
+										 const uInt startRow, const uInt endRow,
+										 const Tag eBlockId,
+										 asdm::EntityRef& dataOid, 
+										 vector< asdm::Tag >& stateIdV){
 
     LogIO os(LogOrigin("MS2ASDM", "writeMainBinForOneDDIdAndSubScan()"));
 
     // return values
-    Int numIntegrations = 0;
-    datasize = 0;
+    std::unique_ptr<BDFWriter> writer;
     dataOid = EntityRef();
     stateIdV.resize(0);
 
@@ -392,27 +663,27 @@ namespace casa {
       if(startRow>=nMainTabRows){
 	os << LogIO::SEVERE << "Internal error: startRow " << startRow << " exceeds end of MS."
 	   << LogIO::POST;
-	return -1;
+	return nullptr;
       }
 
       if(endRow>=nMainTabRows){
 	os << LogIO::SEVERE << "Internal error: endRow " << endRow << " exceeds end of MS."
 	   << LogIO::POST;
-	return -1;
+	return nullptr;
       }
 
       Int DDId = dataDescId()(startRow);
       if(DDId != theDDId){ // check Data Description Id
 	os << LogIO::SEVERE << "Internal error: input parameters to this routine are inconsistent.\n"
 	   << " DDId in start row should be as given in input parameters ==" << theDDId << LogIO::POST;
-	return -1;
+	return nullptr;
       }
       
       Int FId = fieldId()(startRow);
       if(FId != theFieldId){ // check Field Id
 	os << LogIO::SEVERE << "Internal error: input parameters to this routine are inconsistent.\n"
 	   << " FieldId in start row should be as given in input parameters ==" << theFieldId << LogIO::POST;
-	return -1;
+	return nullptr;
       }
 
       if(verbosity_p>1){
@@ -461,7 +732,7 @@ namespace casa {
 	cout << "  subscan end time is " << subScanEndTime << endl;
       }
       
-      // open disk file for subscan
+      // disk file for subscan
       String subscanFileName = asdmDir_p+"/ASDMBinary/"+String(getCurrentUidAsFileName());
       if(verbosity_p>1){
 	cout << "  subscan filename is " << subscanFileName << endl;
@@ -473,15 +744,8 @@ namespace casa {
 	os << LogIO::SEVERE << "Error creating ASDM:  UID \"" << getCurrentUid() 
 	   << "\" (intended for a BLOB) is not a valid Entity reference: " <<  x.getMessage()
 	   << LogIO::POST;      
-	return -1;
+	return nullptr;
       }
-	
-      // make sure that this file doesn't exist yet
-      ofstream ofs(subscanFileName.c_str());
-      
-      // set up SDMDataObjectWriter
-      
-      SDMDataObjectWriter sdmdow(&ofs, getCurrentUid()); // use default title
       
       uint64_t startTime = (uint64_t) floor(subScanStartTime);
       unsigned int execBlockNum = eBlockNum; // constant for all scans
@@ -740,8 +1004,13 @@ namespace casa {
       //                      relevant pass an empty AutoDataBinaryPart object. 
       
       
+      // set up the SDMDataObjectWriter of the subscan file
+      writer.reset(new BDFWriter(subscanFileName, getCurrentUid(), skipCorr_p[PolId],
+				 numSpectralPoint, numStokesMS, 
+				 bpFlagsSize, bpCrossSize, bpAutoSize, verbosity_p));
+      
       // Write the global header.
-      sdmdow.corrDataHeader(startTime,
+      writer->sdmdow().corrDataHeader(startTime,
 			    eBlockUID,
 			    execBlockNum,
 			    scanNum,
@@ -751,9 +1020,13 @@ namespace casa {
 			    spectralResolution, // the spectral resolution.
 			    dataStruct);        // the description of the structure of the binary data.
       
+      writer->start();
+
       //////////////////////////////////////////////////////
-      // write the integrations until timestamp exceeds limit
-      unsigned int integrationNum = 1;
+      // read the integrations until timestamp exceeds limit
+      // and hand them over to the writer
+      String dataColumn(datacolumn);
+      dataColumn.upcase();
       uInt mainTabRow=startRow; 
 
       while(mainTabRow <= endRow){
@@ -769,19 +1042,12 @@ namespace casa {
 	  continue;
 	}
 	
-	uint64_t timev = (uint64_t) floor((time()(mainTabRow))*1E9); // what units? nanoseconds
-	uint64_t intervalv = (uint64_t) floor(interval()(mainTabRow)*1E9);
-	vector< unsigned int > flags;
-	vector< int64_t > actualTimes;
-	vector< int64_t > actualDurations;
-	vector< float > zeroLags; // LAG_DATA, optional column, not used for the moment
-	vector< float > crossData;
-	// vector< short > crossData;
-	// vector< int > crossData; // standard case for ALMA
-	vector< float > autoData;	 
+	std::unique_ptr<BDFWriter::Integration> integration(new BDFWriter::Integration);
+	integration->time = (uint64_t) floor((time()(mainTabRow))*1E9); // what units? nanoseconds
+	integration->interval = (uint64_t) floor(interval()(mainTabRow)*1E9);
 	
 	////////////////////////////////////////////////////////
-	// fill data, time, and flag vectors for this timestamp
+	// read data and flags for this timestamp
 	Double theTStamp = time()(mainTabRow);
 	
 	// SORT the data by baseline and antenna resp.!!!!!!!!!!!!
@@ -856,180 +1122,26 @@ namespace casa {
 	  
 	  uInt iRow = rowsSorted[ii];
 
-	  DDId = dataDescId()(iRow);
-	  FId = fieldId()(iRow);
-	  
-	  Matrix<casacore::Complex> dat;
-	  Matrix<Bool> flagsm;
-	  String dataColumn(datacolumn);
-	  dataColumn.upcase();
 	  if(dataColumn == "MODEL"){
-	    dat.reference(modelData()(iRow));
+	    integration->data.push_back(modelData()(iRow));
 	  }
 	  else if(dataColumn == "CORRECTED"){
-	    dat.reference(correctedData()(iRow));
+	    integration->data.push_back(correctedData()(iRow));
 	  }
 	  else{
-	    dat.reference(data()(iRow));
+	    integration->data.push_back(data()(iRow));
 	  }
-	  flagsm.reference(flag()(iRow));
-	  
-	  //cout << " ii row a1 a2 " << ii << " " << iRow << " " << antenna1()(iRow) << " " << antenna2()(iRow) << endl;
-
-	  Bool haveAuto = (antenna1()(iRow) == antenna2()(iRow));
-
-	  if(haveAuto){
-	    Complex x;  
-	    float a;
-	    for(uInt i=0; i<numSpectralPoint; i++){
-	      for(uInt j=0; j<numStokesMS; j++){
-		if(skipCorr_p[PolId][j]){
-		  continue;
-		}
-		else{
-		  x = dat(j,i);
-		  a = x.real();
-		  autoData.push_back( a );
-		}
-	      }
-	    }
-	  }
-	  else{
-	    casacore::Complex x;
-	    float a,b;
-	    // int a,b;
-	    for(uInt i=0; i<numSpectralPoint; i++){
-	      for(uInt j=0; j<numStokesMS; j++){
-		x = dat(j,i);
-		a = x.real();
-		b = x.imag();
-		crossData.push_back( a );
-		crossData.push_back( b );
-	      }
-	    }
-	  }
-
-	  unsigned int ul;
-	  for(uInt i=0; i<numSpectralPoint; i++){
-	    for(uInt j=0; j<numStokesMS; j++){
-	      if(haveAuto && skipCorr_p[PolId][j]){
-		continue;
-	      }
-	      else{
-		if(flagRow()(iRow)){
-		  ul = 1;
-		}
-		else{
-		  ul = flagsm(j,i);
-		}
-		flags.push_back( ul );
-	      }
-	    }
-	  }
-	  // the following two lines only needed for data blanking
-	  //	    actualTimes.push_back((int64_t)floor(time()(iRow))*1000.);
-	  //	    actualDurations.push_back((int64_t)floor(interval()(iRow))*1000.);
-	}// end loop over rows in this timestamp sorted by baseline
-	
-
-	// fill with flagged entries in case there are missing baselines in the MS
-	uInt nToAdd1 = 0;
-	uInt nToAdd2 = 0;
-	uInt nToAdd3 = 0;
-	uInt nToAdd4 = 0;
-	uInt nToAdd5 = 0;
-	uInt nToAdd6 = 0;
-
-	if(flags.size()<bpFlagsSize){
-	  nToAdd1 = bpFlagsSize - flags.size();
-	  for(uInt i=0; i<nToAdd1; i++){
-	    flags.push_back(1);
-	  }
-	}	
-	if(actualTimes.size()<bpTimesSize){
-	  nToAdd2 = bpTimesSize-actualTimes.size();
-	  for(uInt i=0; i<nToAdd2; i++){
-	    actualTimes.push_back(0);
-	  }
-	}
-	if(actualDurations.size()<bpDurSize){
-	  nToAdd3 = bpDurSize-actualDurations.size();
-	  for(uInt i=0; i<nToAdd3; i++){
-	    actualDurations.push_back(0);
-	  }
-	}
-	if(zeroLags.size()<bpLagsSize){
-	  nToAdd4 = bpLagsSize-zeroLags.size();
-	  for(uInt i=0; i<nToAdd4; i++){
-	    zeroLags.push_back(0.);
-	  }
-	}
-	if(crossData.size()<bpCrossSize){
-	  nToAdd5 = bpCrossSize-crossData.size();
-	  for(uInt i=0; i<nToAdd5; i++){
-	    crossData.push_back(0.);
-	  }
-	}
-	if(autoData.size()<bpAutoSize){
-	  nToAdd6 = bpAutoSize-autoData.size();
-	  for(uInt i=0; i<nToAdd6; i++){
-	    autoData.push_back(0.);
-	  }
-	}
-
-	if(nToAdd1+nToAdd2+nToAdd3+nToAdd4+nToAdd5+nToAdd6>0){
-	  os << LogIO::WARN << "Encountered missing integrations for some baselines in MS."
-	     << " Will fill with flagged entries (" << nToAdd1 << ", " << nToAdd2 << ", " << nToAdd3 
-	     << ", "<< nToAdd4 << ", "<< nToAdd5 << ", "<< nToAdd6 << ")" << LogIO::POST; 
-	}
-	
-	// finally write the integration
-	  
-	if(verbosity_p>1){
-	  cout << "Sizes: " << endl;
-	  cout << "   flags " << flags.size() << endl;
-	  cout << "   actualTimes " << actualTimes.size() << endl;
-	  cout << "   actualDurations " << actualDurations.size() << endl;
-	  cout << "   zeroLags " << zeroLags.size() << endl;
-	  cout << "   crossData " << crossData.size() << endl;
-	  cout << "   autoData " << autoData.size() << endl;
+	  integration->flags.push_back(flag()(iRow));
+	  integration->flagRow.push_back(flagRow()(iRow));
+	  integration->autoCorr.push_back(antenna1()(iRow) == antenna2()(iRow));
 	}
 
-	try{
-
-	  sdmdow.addIntegration(integrationNum,    // integration's index.
-				timev,             // midpoint
-				intervalv,         // time interval
-				flags,             // flags binary data 
-				actualTimes,       // actual times binary data      
-				actualDurations,   // actual durations binary data          
-				zeroLags,          // zero lags binary data                 
-				crossData,    // cross data (can be short or int)  
-				autoData);         // single dish data.  
-
-	  integrationNum++;
-	  datasize += flags.size() * sizeof(unsigned int)
-	    + actualTimes.size() * sizeof( int64_t )
-	    + actualDurations.size() * sizeof( int64_t )
-	    + zeroLags.size() * sizeof( float )
-	    + crossData.size() * sizeof( float )
-	    + autoData.size() * sizeof( float );
-	  numIntegrations++;
-
-	}
-	catch(asdmbinaries::SDMDataObjectWriterException x){
-	  os << LogIO::WARN << "Error writing ASDM:" << x.getMessage() << endl
-	     << "Will try to continue ..."
-	     << LogIO::POST; 
+	if(!writer->add(integration)){
+	  break; // the writer failed, finish() reports why
 	}
-	// (Note: subintegrations are used only for channel averaging to gain time res. by sacrificing spec. res.)
 	
       } // end while 
       
-      sdmdow.done();
-      
-      ofs.close();
-      
       // end write subscan
       
       incrementUid();
@@ -1038,30 +1150,30 @@ namespace casa {
     catch(asdmbinaries::SDMDataObjectWriterException x){
       os << LogIO::SEVERE << "Error creating ASDM: " << x.getMessage()
 	 << LogIO::POST;      
-      return -1;
+      return nullptr;
     }
     catch(asdmbinaries::SDMDataObjectException x){
       os << LogIO::SEVERE << "Error creating ASDM: " << x.getMessage()
 	 << LogIO::POST;      
-      return -1;
+      return nullptr;
     }
     catch(AipsError y){
       os << LogIO::SEVERE << "Error creating ASDM: " << y.getMesg()
 	 << LogIO::POST;      
-      return -1;
+      return nullptr;
     }      
     catch(std::string z){
       os << LogIO::SEVERE << "Error creating ASDM: " << z
 	 << LogIO::POST;      
-      return -1;
+      return nullptr;
     }      
     catch(std::exception zz){
       os << LogIO::SEVERE << "Error creating ASDM: " << zz.what()
 	 << LogIO::POST;      
-      return -1;
+      return nullptr;
     }      
     
-    return numIntegrations;
+    return writer;
 
   } // end writeMainBinForOneDDIdAndSubScan
 
@@ -3729,6 +3841,75 @@ namespace casa {
     asdm::SubscanTable& tSST = ASDM_p->getSubscan();
     asdm::SubscanRow* tSSR = 0;
     
+    // A subscan whose binary data is still being written. Its Main and
+    // Subscan table rows need the number of integrations written.
+    struct PendingSubscan {
+      std::unique_ptr<BDFWriter> writer;
+      uInt startRow;
+      ArrayTime mainTime;
+      Tag configDescriptionId;
+      Tag fieldIdTag;
+      int numAntenna;
+      Interval interval;
+      EntityRef dataOid;
+      vector< Tag > stateIdV;
+      Tag execBlockId;
+      int scanNumber;
+      int subscanNumber;
+      ArrayTime subScanStartArrayTime;
+      ArrayTime subScanEndArrayTime;
+      string fieldName;
+      SubscanIntentMod::SubscanIntent subscanIntent;
+    };
+    std::deque<PendingSubscan> pending;
+
+    // A completed scan's Scan table row waits until the Main and Subscan
+    // rows of all its subscans are written, so that the rows of the three
+    // tables are added in the same order as when subscans were written one
+    // at a time. Each entry holds the number of subscans started before the
+    // scan row was made.
+    std::deque< std::pair< uInt, asdm::ScanRow* > > pendingScans;
+    uInt numSubscansStarted = 0;
+    uInt numSubscansFinished = 0;
+    auto addCompletedScans = [&]() {
+      while(!pendingScans.empty() && pendingScans.front().first <= numSubscansFinished){
+	tST.add(pendingScans.front().second);
+	pendingScans.pop_front();
+      }
+    };
+
+    // wait for the binary data of a subscan and write its Main and Subscan table rows
+    auto finishSubscan = [&](PendingSubscan& subscan) {
+      int dataSize;
+      int numIntegration = subscan.writer->finish(dataSize, os);
+      subscan.writer.reset();
+      if(numIntegration<0){ // error!
+	os << LogIO::SEVERE << "Error writing Subscan starting at main table row " 
+	   << subscan.startRow << LogIO::POST;
+	return false;
+      }
+
+      vector< int > numberSubintegration(numIntegration, 0); // no subintegrations for the moment, no channel averaging (???)
+      TimeSamplingMod::TimeSampling timeSampling = TimeSamplingMod::INTEGRATION;
+
+      // write corresponding Main table row
+      tR = tT.newRow(subscan.mainTime, subscan.configDescriptionId, subscan.fieldIdTag, subscan.numAntenna, 
+		     timeSampling, subscan.interval, numIntegration, subscan.scanNumber, subscan.subscanNumber, 
+		     dataSize, subscan.dataOid, subscan.stateIdV, subscan.execBlockId);
+      tT.add(tR);
+	  
+      // write corresponding Subscan table row
+      tSSR = tSST.newRow(subscan.execBlockId, subscan.scanNumber, subscan.subscanNumber, 
+			 subscan.subScanStartArrayTime, subscan.subScanEndArrayTime, 
+			 subscan.fieldName, subscan.subscanIntent, numIntegration, numberSubintegration //// , flagRow
+			 );
+      tSST.add(tSSR);
+
+      numSubscansFinished++;
+      addCompletedScans();
+      return true;
+    };
+    
     
     // Scheme
     // loop over main table
@@ -3906,7 +4087,6 @@ namespace casa {
 	    ArrayTime subScanEndArrayTime = ASDMArrayTime(timestampEndSecs(endRow)); 
 	    string fieldName = field().name()(fieldId()(startRow)).c_str(); 
 	    SubscanIntentMod::SubscanIntent subscanIntent = SubscanIntentMod::ON_SOURCE;
-	    vector< int > numberSubintegration;
 	    ////bool flagRow = false;
 
 	    // parameters for the corresponding new Main table row
@@ -3925,49 +4105,47 @@ namespace casa {
 	      return false;
 	    }
 
-	    Tag fieldIdTag = asdmFieldId_p(theFId);
-	    int numAntenna = CDR->getNumAntenna();
-	    TimeSamplingMod::TimeSampling timeSampling = TimeSamplingMod::INTEGRATION;
-	    Interval interval = ASDMInterval(intervalQuant()(startRow).getValue("s")); // data sampling interval
-	    int numIntegration; // to be set by the following method call
-	    int dataSize; // to be set by the following method call
-	    EntityRef dataOid; // to be set by the following method call
-	    vector< Tag > stateIdV; // "
+	    PendingSubscan subscan;
+	    subscan.startRow = startRow;
+	    subscan.mainTime = mainTime;
+	    subscan.configDescriptionId = configDescriptionId;
+	    subscan.fieldIdTag = asdmFieldId_p(theFId);
+	    subscan.numAntenna = CDR->getNumAntenna();
+	    subscan.interval = ASDMInterval(intervalQuant()(startRow).getValue("s")); // data sampling interval
+	    subscan.execBlockId = execBlockId;
+	    subscan.scanNumber = scanNumber;
+	    subscan.subscanNumber = subscanNumber;
+	    subscan.subScanStartArrayTime = subScanStartArrayTime;
+	    subscan.subScanEndArrayTime = subScanEndArrayTime;
+	    subscan.fieldName = fieldName;
+	    subscan.subscanIntent = subscanIntent;
+
+	    // at most numBDFWriters_p subscans are written at the same time
+	    if(pending.size() >= numBDFWriters_p){
+	      if(!finishSubscan(pending.front())){
+		return false;
+	      }
+	      pending.pop_front();
+	    }
 	  
 	    // Note: for WVR data, a special case would have to be made here or inside
             //       writeMainBinSubScanForOneDDIdFIdPair() which does not call corrDataHeader
             //       and addIntegration but instead only SDMDataObjectWriter::wvrData()
 
-	    numIntegration = writeMainBinSubScanForOneDDIdFIdPair(theDDId, theFId, 
+	    subscan.writer = writeMainBinSubScanForOneDDIdFIdPair(theDDId, theFId, 
 								  datacolumn, 
 								  scanNumber, subscanNumber,
 								  startRow, endRow,
 								  execBlockId,
-								  dataSize, dataOid, stateIdV);
-	    if(numIntegration<0){ // error!
+								  subscan.dataOid, subscan.stateIdV);
+	    if(!subscan.writer){ // error!
 	      os << LogIO::SEVERE << "Error writing Subscan starting at main table row " 
 		 << startRow << LogIO::POST;
 	      return false;
 	    }
-
-	    for(uInt i=0; i<(uInt)numIntegration; i++){
-	      numberSubintegration.push_back(0); // no subintegrations for the moment, no channel averaging (???)
-	    }
-	  
-	    // end write subscan
-	  
-	    // write corresponding Main table row
-	    tR = tT.newRow(mainTime, configDescriptionId, fieldIdTag, numAntenna, timeSampling, interval, numIntegration, 
-			   scanNumber, subscanNumber, dataSize, dataOid, stateIdV, execBlockId);
-	    tT.add(tR);
-	  
-	    // write corresponding Subscan table row
-	    
-	    tSSR = tSST.newRow(execBlockId, scanNumber, subscanNumber, subScanStartArrayTime, subScanEndArrayTime, 
-			       fieldName, subscanIntent, numIntegration, numberSubintegration //// , flagRow
-			       );
-	    
-	    tSST.add(tSSR);
+	    // the Main and Subscan table rows are written when the binary data is complete
+	    pending.push_back(std::move(subscan));
+	    numSubscansStarted++;
 	    
 	    subscanNumber++;
 	    numSubScan++;
@@ -3993,12 +4171,22 @@ namespace casa {
 		       scanCalDataType, scanCalibrationOnLine ////, scanFlagRow
 		       );
       
-      tST.add(tSR);
+      // added once its subscans are complete
+      pendingScans.push_back(std::make_pair(numSubscansStarted, tSR));
+      addCompletedScans();
       
       scanNumber++;
       
     }//  end for
 
+    // complete the subscans still being written
+    while(!pending.empty()){
+      if(!finishSubscan(pending.front())){
+	return false;
+      }
+      pending.pop_front();
+    }
+
     EntityId theUid(getCurrentUid());
     Entity ent = tT.getEntity();
     ent.setEntityId(theUid);
@@ -28,6 +28,7 @@
 #include <casa/Arrays/Array.h>
 #include <casa/Arrays/Vector.h>
 #include <map>
+#include <memory>
 #include <vector>
 #include <casa/OS/Directory.h>
 
@@ -114,6 +115,14 @@ namespace casa { //# NAMESPACE CASA - BEGIN
   // get maximum duration of a Scheduling casacore::Block in seconds
   casacore::Double getSBDuration(){ return schedBlockDuration_p; }
 
+  // set the maximum number of subscans whose binary data is written at the same time,
+  //   each by a thread of its own
+  void setNumBDFWriters(const casacore::uInt numWriters = 4){
+    numBDFWriters_p = numWriters>0 ? numWriters : 1; }
+
+  // get the maximum number of subscans whose binary data is written at the same time
+  casacore::uInt getNumBDFWriters(){ return numBDFWriters_p; }
+
   void setDataAPCorrected(const casacore::Bool isCorrected = true){
     dataIsAPCorrected_p = isCorrected; }
 
@@ -199,6 +208,9 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 		 );
 
  private:
+  // writes the binary data of one subscan on a thread of its own
+  class BDFWriter;
+
   // *** Private member functions ***
 
   casacore::Bool incrementUid(); // returns true if successful
@@ -255,14 +267,16 @@ namespace casa { //# NAMESPACE CASA - BEGIN
   casacore::Bool writeMainAndScanAndSubScan(const casacore::String& datacolumn);
 
   // write the Main binary data for one DataDescId/FieldId pair and one SubScan
-  // (return number of integrations written and set the last three parameters in the list)
-  casacore::Int writeMainBinSubScanForOneDDIdFIdPair(const casacore::Int theDDId, const casacore::Int theFieldId, 
-					   const casacore::String& datacolumn, 
-					   const casacore::uInt theScan, const casacore::uInt theSubScan,
-					   const casacore::uInt startRow, const casacore::uInt endRow,
-					   const asdm::Tag eBlockId,
-					   int& datasize, asdm::EntityRef& dataOid, 
-					   vector< asdm::Tag >& stateId);
+  // (the MS is read by the calling thread and the integrations are converted and written
+  //  by the returned writer, whose finish() returns the number of integrations written;
+  //  return null on error and set the last two parameters in the list)
+  std::unique_ptr<BDFWriter> writeMainBinSubScanForOneDDIdFIdPair(const casacore::Int theDDId, const casacore::Int theFieldId, 
+								  const casacore::String& datacolumn, 
+								  const casacore::uInt theScan, const casacore::uInt theSubScan,
+								  const casacore::uInt startRow, const casacore::uInt endRow,
+								  const asdm::Tag eBlockId,
+								  asdm::EntityRef& dataOid, 
+								  vector< asdm::Tag >& stateId);
 
   casacore::Bool writePointingModel(); // write dummy pointing models
 
@@ -302,6 +316,8 @@ namespace casa { //# NAMESPACE CASA - BEGIN
                             // AtmPhaseCorrectionMod::AP_CORRECTED, false if it is
                             // AtmPhaseCorrectionMod::AP_UNCORRECTED
 
+  casacore::uInt numBDFWriters_p; // maximum number of subscans whose binary data is written at the same time
+
   string asdmUID_p; // ASDM UID == container ID of all tables
 
   casacore::String asdmDir_p; // ASDM output directory name
@@ -93,6 +93,7 @@ int main(int argc, char *argv[]) {
   double subscanduration = 24.*3600.; // default is one day
   double schedblockduration = 2700.; // default is 45 minutes
   bool apcorrected = true;
+  unsigned int bdfwriters = 4; // subscans written in parallel
 
   boost::filesystem::path msPath;
 
@@ -114,6 +115,7 @@ int main(int argc, char *argv[]) {
     ("subscanduration,s", po::value<double>(), "specifies the maximum duration of a subscan in the output ASDM (seconds). Default: 86400")
     ("schedblockduration,s", po::value<double>(), "specifies the maximum duration of a scheduling block in the output ASDM (seconds). Default: 2700")
     ("logfile,l", po::value<string>(), "specifies the log filename. If the option is not used then the logged informations are written to the standard error stream.")
+    ("bdfwriters,w", po::value<unsigned int>(), "specifies the maximum number of subscans whose binary data is written in parallel. Default: 4")
     ("apuncorrected,u", "the data given by datacolumn should be regarded as not having an atmospheric phase correction. Default: data is AP corrected.")
     ("verbose,v", "logs numerous informations as the filler is working.")
     ("revision,r", "logs information about the revision of this application.");
@@ -176,6 +178,10 @@ int main(int argc, char *argv[]) {
     schedblockduration = vm["schedblockduration"].as< double >();
   }
 
+  if (vm.count("bdfwriters")) {
+    bdfwriters = vm["bdfwriters"].as< unsigned int >();
+  }
+
   if (vm.count("ms-directory")) {
     msfile = String(vm["ms-directory"].as< string >());
   }
@@ -205,6 +211,7 @@ int main(int argc, char *argv[]) {
       itsMS = new MeasurementSet(msfile);
       m2a = new MS2ASDM(*itsMS);
       info("Using ASDM version " + m2a->showversion());
+      m2a->setNumBDFWriters(bdfwriters);
       if (!m2a->writeASDM(asdmfile, datacolumn, archiveid, rangeid, verbose,
 			  subscanduration, schedblockduration, apcorrected)) {
 	delete m2a;
@@ -59,23 +59,36 @@ namespace casa {
     itsDataManName (dataManName),
     itsBDF         (0),
     itsOpenBDF     (-1),
+    itsMaxCacheBlocks (theirDefaultCacheBlocks),
+    itsCacheClock  (0),
+    itsBlock       (0),
     itsNBl(0)
   {}
 
   AsdmStMan::AsdmStMan (const String& dataManName,
-			const Record&)
+			const Record& spec)
   : DataManager    (),
     itsDataManName (dataManName),
     itsBDF         (0),
     itsOpenBDF     (-1),
+    itsMaxCacheBlocks (theirDefaultCacheBlocks),
+    itsCacheClock  (0),
+    itsBlock       (0),
     itsNBl(0)
-  {}
+  {
+    if (spec.isDefined ("MAXCACHEBLOCKS")) {
+      setMaxCacheBlocks (spec.asuInt ("MAXCACHEBLOCKS"));
+    }
+  }
 
   AsdmStMan::AsdmStMan (const AsdmStMan& that)
   : DataManager    (),
     itsDataManName (that.itsDataManName),
     itsBDF         (0),
     itsOpenBDF     (-1),
+    itsMaxCacheBlocks (that.itsMaxCacheBlocks),
+    itsCacheClock  (0),
+    itsBlock       (0),
     itsNBl(0)
   {}
 
@@ -217,6 +230,7 @@ namespace casa {
   void AsdmStMan::deleteManager()
   {
     closeBDF();
+    clearCache();
     // Remove index file.
     DOos::remove (fileName()+"asdmindex", false, false);
   }
@@ -254,6 +268,7 @@ namespace casa {
     itsSpec.define ("version", itsVersion);
     itsSpec.define ("bigEndian", asBigEndian);
     itsSpec.define ("BDFs", Vector<String>(itsBDFNames));
+    itsSpec.define ("MAXCACHEBLOCKS", itsMaxCacheBlocks);
     // Set to nothing read yet.
     itsStartRow   = -1;
     itsEndRow     = -1;
@@ -325,7 +340,7 @@ namespace casa {
   void CASA_ATTR_VECTORIZE AsdmStMan::getShort (const AsdmIndex& ix, Complex* buf, uInt bl, uInt spw)
   {
     // Get pointer to the data in the block.
-    Short* data = (reinterpret_cast<Short*>(&itsData[0]));
+    const Short* data = reinterpret_cast<const Short*>(itsBlock);
     data = data + 2 * ix.blockOffset + 2 * bl * ix.stepBl ;  // Michel Caillat - 21  Nov 2012
 
     //cout << "getShort works at this adress : " << (unsigned long long int) data << endl;
@@ -355,7 +370,7 @@ namespace casa {
   void AsdmStMan::getInt (const AsdmIndex& ix, Complex* buf, uInt bl, uInt spw)
   {
     // Get pointer to the data in the block.
-    Int* data = (reinterpret_cast<Int*>(&(itsData[0])));
+    const Int* data = reinterpret_cast<const Int*>(itsBlock);
     data = data + 2 * ix.blockOffset + 2 * bl * ix.stepBl;   // 21 Nov 2012 - Michel Caillat
     if (itsDoSwap) {
       Int real,imag;
@@ -382,7 +397,7 @@ namespace casa {
   void AsdmStMan::getFloat (const AsdmIndex& ix, Complex* buf, uInt bl, uInt spw)
   {
     // Get pointer to the data in the block.
-    Float* data = (reinterpret_cast<Float*>(&(itsData[0])));
+    const Float* data = reinterpret_cast<const Float*>(itsBlock);
     data = data + 2 * ix.blockOffset + 2 * bl * ix.stepBl;   // 21 Nov 2012 Michel Caillat
     if (itsDoSwap) {
       Float real,imag;
@@ -409,7 +424,7 @@ namespace casa {
   void AsdmStMan::getAuto (const AsdmIndex& ix, Complex* buf, uInt bl)
   {
     // Get pointer to the data in the block.
-    Float* data = (reinterpret_cast<Float*>(&(itsData[0])));
+    const Float* data = reinterpret_cast<const Float*>(itsBlock);
     data = data + ix.blockOffset + bl * ix.stepBl;   // 21 Nov 2012 . Michel Caillat
 
     // The autocorr can have 1, 2, 3 or 4 npol.
@@ -477,7 +492,7 @@ namespace casa {
   void AsdmStMan::getAuto (const AsdmIndex& ix, Float* buf, uInt bl)
   {
     // Get pointer to the data in the block.
-    Float* data = (reinterpret_cast<Float*>(&(itsData[0])));
+    const Float* data = reinterpret_cast<const Float*>(itsBlock);
     data = data + ix.blockOffset + bl * ix.stepBl; 
 
     // This can only apply to the FLOAT_DATA column, and in that
@@ -502,6 +517,126 @@ namespace casa {
     }
   }
 
+  void AsdmStMan::setMaxCacheBlocks (uInt nblocks)
+  {
+    itsMaxCacheBlocks = std::max (nblocks, uInt(1));
+    while (itsCache.size() > itsMaxCacheBlocks) {
+      evictBlock();
+    }
+    itsSpec.define ("MAXCACHEBLOCKS", itsMaxCacheBlocks);
+  }
+
+  void AsdmStMan::clearCache()
+  {
+    itsCache.clear();
+    itsBlock = 0;
+  }
+
+  void AsdmStMan::evictBlock()
+  {
+    // Remove the least recently used block.
+    uInt oldest = 0;
+    for (uInt i=1; i<itsCache.size(); ++i) {
+      if (itsCache[i].lastUse < itsCache[oldest].lastUse) {
+        oldest = i;
+      }
+    }
+    itsCache.erase (itsCache.begin() + oldest);
+  }
+
+  Int AsdmStMan::isCached (const AsdmIndex& ix) const
+  {
+    for (uInt i=0; i<itsCache.size(); ++i) {
+      const AsdmBlock& blk = itsCache[i];
+      if (blk.fileNr == ix.fileNr  &&  blk.fileOffset == ix.fileOffset  &&
+          blk.data.size() >= ix.dataSize()) {
+        return i+1;
+      }
+    }
+    return 0;
+  }
+
+  void AsdmStMan::openBDF (uInt fileNr)
+  {
+    if (Int(fileNr) != itsOpenBDF) {
+      closeBDF();
+      itsFD  = FiledesIO::open (itsBDFNames[fileNr].c_str(), false);
+      itsBDF = new FiledesIO (itsFD, itsBDFNames[fileNr]);
+      itsOpenBDF = fileNr;
+    }
+  }
+
+  const char* AsdmStMan::getBlock (uInt indexEntry)
+  {
+    const AsdmIndex& ix = itsIndex[indexEntry];
+    // Several index entries (one per spw) can share a data block.
+    Int cached = isCached (ix);
+    if (cached) {
+      AsdmBlock& blk = itsCache[cached-1];
+      blk.lastUse = ++itsCacheClock;
+      return &(blk.data[0]);
+    }
+    // Not cached, so read it.  The blocks of the following index entries
+    // in the same BDF are read along with it (in a single read) as long as
+    // they are close enough to make it a sequential read and fit in the
+    // cache. Blocks are mostly accessed in row order, so they are likely
+    // to be needed next.
+    Int64 start = ix.fileOffset;
+    Int64 end   = start + ix.dataSize();
+    vector<uInt> entries(1, indexEntry);
+    for (uInt j=indexEntry+1; j<itsIndex.size(); ++j) {
+      const AsdmIndex& nx = itsIndex[j];
+      if (nx.fileNr != ix.fileNr  ||  nx.fileOffset < start) {
+        break;
+      }
+      Int64 nend = nx.fileOffset + nx.dataSize();
+      if (nx.fileOffset > end + theirMaxReadAheadGap  ||
+          nend - start > theirMaxReadAheadBytes) {
+        break;
+      }
+      // Only one entry per distinct block is needed.
+      Bool known = false;
+      for (uInt k=0; k<entries.size(); ++k) {
+        if (itsIndex[entries[k]].fileOffset == nx.fileOffset) {
+          known = true;
+          if (nx.dataSize() > itsIndex[entries[k]].dataSize()) {
+            entries[k] = j;
+          }
+          break;
+        }
+      }
+      if (!known) {
+        if (entries.size() >= itsMaxCacheBlocks) {
+          break;
+        }
+        entries.push_back (j);
+      }
+      end = std::max (end, nend);
+    }
+    vector<char> span(end - start);
+    openBDF (ix.fileNr);
+    itsBDF->seek (start);
+    itsBDF->read (span.size(), &(span[0]));
+    // Store the blocks, the requested one last so it is the most recent.
+    for (uInt k=entries.size(); k>0; --k) {
+      const AsdmIndex& bx = itsIndex[entries[k-1]];
+      if (k > 1  &&  isCached (bx)) {
+        continue;
+      }
+      if (itsCache.size() >= itsMaxCacheBlocks) {
+        evictBlock();
+      }
+      itsCache.push_back (AsdmBlock());
+      AsdmBlock& blk = itsCache.back();
+      blk.fileNr     = bx.fileNr;
+      blk.fileOffset = bx.fileOffset;
+      blk.lastUse    = ++itsCacheClock;
+      const char* src = &(span[0]) + (bx.fileOffset - start);
+      blk.data.assign (src, src + bx.dataSize());
+    }
+    return &(itsCache.back().data[0]);
+  }
+
   IPosition AsdmStMan::getShape (uInt rownr)
   {
     // Here determine the shape from the rownr.
@@ -524,30 +659,9 @@ namespace casa {
       if (ix.nBl != itsNBl)
 	setTransposeBLNum(ix.nBl);
   
-    // Open the BDF if needed.
-    if (Int(ix.fileNr) != itsOpenBDF) {
-      closeBDF();
-      itsFD  = FiledesIO::open (itsBDFNames[ix.fileNr].c_str(), false);
-      itsBDF = new FiledesIO (itsFD, itsBDFNames[ix.fileNr]);
-      itsOpenBDF = ix.fileNr;
-      itsFileOffset = ix.fileOffset;
-      itsData.resize(0);
-    }
-  
-    // Or we did not have open a new BDF but are aiming at a new position in the same BDF
-    else if ( itsFileOffset != ix.fileOffset ) {
-      itsFileOffset = ix.fileOffset;
-      itsData.resize(0);
-    }
+    // Get the data block (from the cache or the BDF).
+    itsBlock = getBlock (itsIndexEntry);
 
-    // Read data block if not done yet, i.e. if and only if we are in a new BDF or in the same
-    // one but at a new position (fileOffset).
-    //
-    if (itsData.empty()) {
-      itsData.resize (ix.dataSize());
-      itsBDF->seek (ix.fileOffset);
-      itsBDF->read (itsData.size(), &(itsData[0]));
-    }
     // Determine the spw and baseline from the row.
     // The rows are stored in order of spw,baseline.
     uInt spw = ix.iSpw ; // 19 Feb 2014 : Michel Caillat changed this assignement;
@@ -588,30 +702,9 @@ namespace casa {
       throw DataManError ("AsdmStMan: illegal data type for FLOAT_DATA column");
     }
   
-    // Open the BDF if needed.
-    if (Int(ix.fileNr) != itsOpenBDF) {
-      closeBDF();
-      itsFD  = FiledesIO::open (itsBDFNames[ix.fileNr].c_str(), false);
-      itsBDF = new FiledesIO (itsFD, itsBDFNames[ix.fileNr]);
-      itsOpenBDF = ix.fileNr;
-      itsFileOffset = ix.fileOffset;
-      itsData.resize(0);
-    }
-  
-    // Or we did not have open a new BDF but are aiming at a new position in the same BDF
-    else if ( itsFileOffset != ix.fileOffset ) {
-      itsFileOffset = ix.fileOffset;
-      itsData.resize(0);
-    }
+    // Get the data block (from the cache or the BDF).
+    itsBlock = getBlock (itsIndexEntry);
 
-    // Read data block if not done yet, i.e. if and only if we are in a new BDF or in the same
-    // one but at a new position (fileOffset).
-    //
-    if (itsData.empty()) {
-      itsData.resize (ix.dataSize());
-      itsBDF->seek (ix.fileOffset);
-      itsBDF->read (itsData.size(), &(itsData[0]));
-    }
     // Determine the spw and baseline from the row.
     // The rows are stored in order of spw,baseline.
     // getAuto appears to not depend on spw.  R.Garwood.
@@ -630,6 +723,8 @@ namespace casa {
   {
     if(bDFNames.size() == itsBDFNames.size()){
       itsBDFNames = bDFNames;
+      closeBDF();
+      clearCache();
       return true;
     }
     else{
@@ -195,6 +195,17 @@ public:
   // data manager
   void writeIndex();
 
+  // Set the maximum number of BDF data blocks kept in memory (at least 1).
+  // It can also be given as field MAXCACHEBLOCKS in the specification record.
+  void setMaxCacheBlocks (casacore::uInt nblocks);
+
+  casacore::uInt getMaxCacheBlocks() const
+    { return itsMaxCacheBlocks; }
+
+  // Get the number of BDF data blocks currently in memory.
+  casacore::uInt nCachedBlocks() const
+    { return itsCache.size(); }
+
 private:
   // Copy constructor cannot be used.
   AsdmStMan (const AsdmStMan& that);
@@ -270,6 +281,23 @@ private:
   // Close the currently open BDF file.
   void closeBDF();
 
+  // Open the given BDF file (if not already open).
+  void openBDF (casacore::uInt fileNr);
+
+  // Get the data block of the given index entry, reading it (and the blocks
+  // following it in the same BDF) if not in the cache.
+  const char* getBlock (casacore::uInt indexEntry);
+
+  // Return 1 + the cache entry holding the data block of the index entry,
+  // or 0 if not cached.
+  casacore::Int isCached (const AsdmIndex& ix) const;
+
+  // Remove the least recently used block from the cache.
+  void evictBlock();
+
+  // Remove all blocks from the cache.
+  void clearCache();
+
   // Return the entry number in the index containing the row.
   casacore::uInt searchIndex (casacore::Int64 rownr);
 
@@ -290,6 +318,23 @@ private:
   // set transposeBLNum_v
   void setTransposeBLNum(casacore::uInt nBl);
 
+  // A data block read from a BDF.
+  struct AsdmBlock {
+    casacore::uInt   fileNr;
+    casacore::Int64  fileOffset;
+    casacore::Int64  lastUse;       //# cache clock at last access
+    vector<char>     data;
+  };
+
+  //# Default number of cached data blocks. A time slot mostly has a cross-
+  //# and an auto-correlation block, so 4 holds the current and next time
+  //# slot. A cross block can be tens of MBytes, hence no more than that.
+  static const casacore::uInt  theirDefaultCacheBlocks = 4;
+  //# Maximum size of a single read done to read ahead.
+  static const casacore::Int64 theirMaxReadAheadBytes = 64*1024*1024;
+  //# Maximum gap between blocks that are read in a single read.
+  static const casacore::Int64 theirMaxReadAheadGap = 64*1024;
+
   //# Declare member variables.
   // Name of data manager.
   casacore::String itsDataManName;
@@ -299,7 +344,6 @@ private:
   casacore::FiledesIO*             itsBDF;
   int                    itsFD;
   int                    itsOpenBDF;
-  casacore::Int64                  itsFileOffset;
   casacore::Bool   itsDoSwap;       //# true = byte-swapping is needed
   casacore::Record itsSpec;         //# casacore::Data manager properties
   casacore::uInt   itsVersion;      //# Version of AsdmStMan casacore::MeasurementSet
@@ -307,7 +351,11 @@ private:
   casacore::Int64  itsStartRow;     //# First row of data block
   casacore::Int64  itsEndRow;       //# First row of next data block
   casacore::uInt   itsIndexEntry;   //# Index entry number of current data block
-  vector<char>      itsData;
+  //# Cache of data blocks, least recently used one is replaced.
+  vector<AsdmBlock> itsCache;
+  casacore::uInt    itsMaxCacheBlocks;
+  casacore::Int64   itsCacheClock;
+  const char*       itsBlock;       //# Data block of the current row
   vector<AsdmIndex> itsIndex;
   vector<casacore::Int64>     itsIndexRows;
 
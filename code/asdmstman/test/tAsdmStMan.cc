@@ -291,6 +291,42 @@ void readTable (uInt ntime, uInt nant,
   }
 }
 
+// Read the data with a small block cache in an order jumping between the
+// BDFs and check they match the data read in row order.
+void checkCache (uInt maxBlocks)
+{
+  Table tab("tAsdmStMan_tmp.data");
+  ROArrayColumn<Complex> dataCol(tab, "DATA");
+  uInt nrow = tab.nrow();
+  vector<Array<Complex> > expData(nrow);
+  for (uInt i=0; i<nrow; ++i) {
+    expData[i] = dataCol(i);
+  }
+  AsdmStMan* sm = dynamic_cast<AsdmStMan*>
+    (RODataManAccessor(tab, "DATA", true).operator->());
+  AlwaysAssertExit (sm != 0);
+  sm->setMaxCacheBlocks (maxBlocks);
+  AlwaysAssertExit (sm->getMaxCacheBlocks() == std::max(maxBlocks, uInt(1)));
+  AlwaysAssertExit (sm->nCachedBlocks() <= sm->getMaxCacheBlocks());
+  // Alternate between the first and last rows (different BDFs), so
+  // blocks are evicted and read again.
+  for (uInt i=0; i<nrow; ++i) {
+    uInt rownr = (i%2 == 0  ?  i/2 : nrow-1-i/2);
+    AlwaysAssertExit (allEQ (dataCol(rownr), expData[rownr]));
+    AlwaysAssertExit (sm->nCachedBlocks() >= 1);
+    AlwaysAssertExit (sm->nCachedBlocks() <= sm->getMaxCacheBlocks());
+  }
+  // Reading a cached row again does not change the cache.
+  AlwaysAssertExit (allEQ (dataCol(nrow/2), expData[nrow/2]));
+  uInt ncached = sm->nCachedBlocks();
+  AlwaysAssertExit (allEQ (dataCol(nrow/2), expData[nrow/2]));
+  AlwaysAssertExit (sm->nCachedBlocks() == ncached);
+  // Shrinking the cache evicts blocks.
+  sm->setMaxCacheBlocks (1);
+  AlwaysAssertExit (sm->nCachedBlocks() == 1);
+  AlwaysAssertExit (allEQ (dataCol(0), expData[0]));
+}
+
 int main (int argc, char* argv[])
 {
   try {
@@ -309,6 +345,10 @@ int main (int argc, char* argv[])
     readTable   (5, 4, 2, 8, 4, 2, 8, 1);
     createTable (5, 4, 6, 8, 4, 2, 1, 2);
     readTable   (5, 4, 6, 8, 4, 2, 1, 2);
+    checkCache (0);
+    checkCache (1);
+    checkCache (2);
+    checkCache (16);
   } catch (AipsError& x) {
     cout << "Caught an exception: " << x.getMesg() << endl;
     return 1;
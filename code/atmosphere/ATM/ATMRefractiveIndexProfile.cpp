@@ -26,7 +26,11 @@
 #include "ATMRefractiveIndexProfile.h"
 
 #include <iostream>
+#include <list>
+#include <map>
 #include <math.h>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -282,6 +286,168 @@ bool RefractiveIndexProfile::setBasicAtmosphericParameters(const Length &altitud
   return updated;
 }
 
+namespace {
+
+  // Layer quantities the refractivities depend on, in the order they
+  // are stored (per layer) in the layer state vector
+  enum { LS_T, LS_P, LS_WV, LS_O3, LS_CO, LS_N2O, LS_NO2, LS_SO2, LS_NUM };
+
+  // Refractivities of all the layers at one frequency, one vector per
+  // contribution held by RefractiveIndexProfile
+  struct ChannelRefractivity
+  {
+    enum { H2OLines, H2OCont, O2Lines, DryCont, O3Lines, COLines, N2OLines, NO2Lines, SO2Lines, NumContrib };
+    vector<complex<double> > N[NumContrib];
+  };
+
+  // Computed refractivities for one layer state, by frequency (Hz)
+  struct RefractivityCacheEntry
+  {
+    vector<double> layerState;
+    map<double, ChannelRefractivity> chan;
+  };
+
+  // Bound on the memory held by the cache. One channel of a 40 layer
+  // profile is 9 x 40 complex values, so this keeps some 5000 channels.
+  const size_t maxRefractivityCacheBytes = 32 * 1024 * 1024;
+
+  void mkChannelRefractivity(RefractiveIndex &atm,
+                             const vector<double> &layerState,
+                             double nu, // GHz
+                             ChannelRefractivity &chan)
+  {
+    unsigned int numLayer = layerState.size() / LS_NUM;
+    for(unsigned int k = 0; k < ChannelRefractivity::NumContrib; k++) {
+      chan.N[k].resize(numLayer);
+    }
+
+    for(unsigned int j = 0; j < numLayer; j++) {
+      const double *ls = &layerState[j * LS_NUM];
+      double wv = ls[LS_WV] * 1000.0; // se multiplica por 10**3 por cuestión de unidades en las rutinas fortran.
+      double wvt = wv * ls[LS_T] / 217.0; // v_layerWaterVapor_[j] está en kg/m**3
+
+      chan.N[ChannelRefractivity::O2Lines][j] = atm.getRefractivity_o2(ls[LS_T], ls[LS_P], wvt, nu);
+      chan.N[ChannelRefractivity::H2OCont][j] = atm.getSpecificRefractivity_cnth2o(ls[LS_T], ls[LS_P], wvt, nu);
+      chan.N[ChannelRefractivity::DryCont][j] = atm.getSpecificRefractivity_cntdry(ls[LS_T], ls[LS_P], wvt, nu);
+
+      chan.N[ChannelRefractivity::H2OLines][j] = (ls[LS_WV] > 0) ?
+        atm.getRefractivity_h2o(ls[LS_T], ls[LS_P], wvt, nu) : 0.0;
+
+      chan.N[ChannelRefractivity::O3Lines][j] = (ls[LS_O3] > 0) ?
+        atm.getRefractivity_o3(ls[LS_T], ls[LS_P], nu, ls[LS_O3] * 1E-6 * 1e6) : 0.0;
+
+      // m^2 * m^-3 = m^-1
+      chan.N[ChannelRefractivity::COLines][j] = (ls[LS_CO] > 0) ?
+        atm.getSpecificRefractivity_co(ls[LS_T], ls[LS_P], nu) * (ls[LS_CO] * 1E-6) * 1e6 : 0.0;
+      chan.N[ChannelRefractivity::N2OLines][j] = (ls[LS_N2O] > 0) ?
+        atm.getSpecificRefractivity_n2o(ls[LS_T], ls[LS_P], nu) * (ls[LS_N2O] * 1E-6) * 1e6 : 0.0;
+      chan.N[ChannelRefractivity::NO2Lines][j] = (ls[LS_NO2] > 0) ?
+        atm.getSpecificRefractivity_no2(ls[LS_T], ls[LS_P], nu) * (ls[LS_NO2] * 1E-6) * 1e6 : 0.0;
+      chan.N[ChannelRefractivity::SO2Lines][j] = (ls[LS_SO2] > 0) ?
+        atm.getSpecificRefractivity_so2(ls[LS_T], ls[LS_P], nu) * (ls[LS_SO2] * 1E-6) * 1e6 : 0.0;
+    }
+  }
+
+}
+
+/** Refractivities computed for recent layer states, shared by all the
+ *  RefractiveIndexProfile objects alive at the same time (e.g. one
+ *  SkyStatus per antenna or scan) and by spectral windows added later.
+ *  The least recently used layer states are evicted beyond
+ *  maxRefractivityCacheBytes and the cache is freed with the last
+ *  profile holding it.
+ */
+class RefractivityCache
+{
+public:
+  RefractivityCache() : bytes_(0) {}
+
+  /// The cache shared by the live profiles, created if there is none
+  static std::shared_ptr<RefractivityCache> acquire()
+  {
+    static std::mutex liveMutex;
+    static std::weak_ptr<RefractivityCache> live;
+    std::lock_guard<std::mutex> lock(liveMutex);
+    std::shared_ptr<RefractivityCache> cache = live.lock();
+    if(!cache) {
+      cache = std::make_shared<RefractivityCache>();
+      live = cache;
+    }
+    return cache;
+  }
+
+  /// Fill the channels found in the cache, flagging them in found
+  void lookup(const vector<double> &layerState,
+              const vector<double> &freq,
+              vector<ChannelRefractivity> &chan,
+              vector<char> &found)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(list<RefractivityCacheEntry>::iterator it = entries_.begin();
+        it != entries_.end(); ++it) {
+      if(it->layerState != layerState) continue;
+      for(unsigned int i = 0; i < freq.size(); i++) {
+        map<double, ChannelRefractivity>::const_iterator c = it->chan.find(freq[i]);
+        if(c != it->chan.end()) {
+          chan[i] = c->second;
+          found[i] = 1;
+        }
+      }
+      entries_.splice(entries_.begin(), entries_, it);
+      break;
+    }
+  }
+
+  /// Add the channels that were not found, evicting least recently
+  /// used layer states beyond the size bound
+  void store(const vector<double> &layerState,
+             const vector<double> &freq,
+             const vector<ChannelRefractivity> &chan,
+             const vector<char> &found)
+  {
+    const size_t chanBytes = ChannelRefractivity::NumContrib
+      * (layerState.size() / LS_NUM) * sizeof(complex<double>);
+    size_t nnew = 0;
+    for(unsigned int i = 0; i < found.size(); i++) {
+      if(!found[i]) nnew++;
+    }
+    if(nnew == 0 || nnew * chanBytes > maxRefractivityCacheBytes) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(entries_.empty() || entries_.front().layerState != layerState) {
+      entries_.push_front(RefractivityCacheEntry());
+      entries_.front().layerState = layerState;
+    }
+    RefractivityCacheEntry &entry = entries_.front();
+    while(bytes_ + nnew * chanBytes > maxRefractivityCacheBytes
+          && entries_.size() > 1) {
+      bytes_ -= entryBytes(entries_.back());
+      entries_.pop_back();
+    }
+    if(bytes_ + nnew * chanBytes > maxRefractivityCacheBytes) {
+      bytes_ -= entryBytes(entry);
+      entry.chan.clear();
+    }
+    for(unsigned int i = 0; i < found.size(); i++) {
+      if(found[i]) continue;
+      if(entry.chan.insert(make_pair(freq[i], chan[i])).second) {
+        bytes_ += chanBytes;
+      }
+    }
+  }
+
+private:
+  static size_t entryBytes(const RefractivityCacheEntry &entry)
+  {
+    return entry.chan.size() * ChannelRefractivity::NumContrib
+      * (entry.layerState.size() / LS_NUM) * sizeof(complex<double>);
+  }
+
+  std::mutex mutex_;
+  list<RefractivityCacheEntry> entries_;
+  size_t bytes_;
+};
+
 void RefractiveIndexProfile::mkRefractiveIndexProfile()
 {
 
@@ -291,19 +457,6 @@ void RefractiveIndexProfile::mkRefractiveIndexProfile()
   //    static const double o2_mixing_ratio=0.2092;
   //    static const double mmol_h2o=18.005059688;  //   20*0.0020439+19*(0.0003750+2*0.000298444)+18*(1-0.0020439-0.0003750-2*0.000298444)
 
-  // static bool first = true;   // [-Wunused_but_set_variable]
-
-  double abun_O3, abun_CO, abun_N2O, abun_NO2, abun_SO2;
-  double wvt, wv;
-  // double t; // [-Wunused_but_set_variable]
-  double nu;
-  // double nu2, nu_pi; // [-Wunused_but_set_variable]
-  // double width;
-  // unsigned int npoints;
-  RefractiveIndex atm;
-  //    double sumAbsO3Lines1, sumAbsCOLines1, sumAbsN2OLines1, sumAbsNO2Lines1, sumAbsSO2Lines1; 
-
-
   //TODO we will have to put numLayer_ and v_chanFreq_.size() const
   //we do not want to resize! ==> pas de setter pour SpectralGrid
 
@@ -323,19 +476,6 @@ void RefractiveIndexProfile::mkRefractiveIndexProfile()
     rmRefractiveIndexProfile(); // delete all the layer profiles for all the frequencies
   }
 
-  vector<complex<double> >* v_N_H2OLinesPtr;
-  vector<complex<double> >* v_N_H2OContPtr;
-  vector<complex<double> >* v_N_O2LinesPtr;
-  vector<complex<double> >* v_N_DryContPtr;
-  vector<complex<double> >* v_N_O3LinesPtr;
-  vector<complex<double> >* v_N_COLinesPtr;
-  vector<complex<double> >* v_N_N2OLinesPtr;
-  vector<complex<double> >* v_N_NO2LinesPtr;
-  vector<complex<double> >* v_N_SO2LinesPtr;
-
-  // cout << "v_chanFreq_.size()=" << v_chanFreq_.size() << endl;
-  // cout << "numLayer_=" << numLayer_ << endl;
-  // cout << "v_chanFreq_[0]=" << v_chanFreq_[0] << endl;
   // check if new spectral windows have been added
   unsigned int ncmin;
   /*  cout << "vv_N_H2OLinesPtr_.size()="<<vv_N_H2OLinesPtr_.size()<<endl; */
@@ -344,161 +484,63 @@ void RefractiveIndexProfile::mkRefractiveIndexProfile()
 
   //    cout << "ncmin=" << ncmin << endl;
 
-  for(unsigned int nc = ncmin; nc < v_chanFreq_.size(); nc++) {
-
-    v_N_H2OLinesPtr = new vector<complex<double> > ;
-    v_N_H2OContPtr = new vector<complex<double> > ;
-    v_N_O2LinesPtr = new vector<complex<double> > ;
-    v_N_DryContPtr = new vector<complex<double> > ;
-    v_N_O3LinesPtr = new vector<complex<double> > ;
-    v_N_COLinesPtr = new vector<complex<double> > ;
-    v_N_N2OLinesPtr = new vector<complex<double> > ;
-    v_N_NO2LinesPtr = new vector<complex<double> > ;
-    v_N_SO2LinesPtr = new vector<complex<double> > ;
-    v_N_H2OLinesPtr->reserve(numLayer_);
-    v_N_H2OContPtr->reserve(numLayer_);
-    v_N_O2LinesPtr->reserve(numLayer_);
-    v_N_DryContPtr->reserve(numLayer_);
-    v_N_O3LinesPtr->reserve(numLayer_);
-    v_N_COLinesPtr->reserve(numLayer_);
-    v_N_N2OLinesPtr->reserve(numLayer_);
-    v_N_NO2LinesPtr->reserve(numLayer_);
-    v_N_SO2LinesPtr->reserve(numLayer_);
-
-    nu = 1.0E-9 * v_chanFreq_[nc]; // ATM uses GHz units
-
-    // cout << "freq. points =" << v_chanFreq_.size() << endl;
-
-    /*       TO BE IMPLEMENTED IN NEXT RELEASE
-
-    if (v_chanFreq_.size()>1){
-      if(nc==0){
-	width = fabs(v_chanFreq_[nc+1]-v_chanFreq_[nc])*1e-9;       // width en GHz para ATM
-	npoints=(unsigned int)round(width*100);                     // One point every 10 MHz
-      }else{
-	if(nc==v_chanFreq_.size()-1){
-	  width = fabs(v_chanFreq_[nc]-v_chanFreq_[nc-1])*1e-9;     // width en GHz para ATM
-	  npoints=(unsigned int)round(width*100);                   // One point every 10 MHz 
-	}else{
-	  width = fabs((v_chanFreq_[nc+1]-v_chanFreq_[nc-1])/2.0)*1e-9;    // width en GHz para ATM
-	  npoints=(unsigned int)round(width*100);                          // One point every 10 MHz
-	}
-      }
-    }else{
-      width = 0.001;      // default width = 1 MHz = 0.001 GHz
-      npoints=1;
+  // The refractivities only depend on the layer state and on the
+  // frequency: take what we can from the cache and compute the rest in
+  // parallel across channels.
+  vector<double> layerState(numLayer_ * LS_NUM);
+  for(unsigned int j = 0; j < numLayer_; j++) {
+    double *ls = &layerState[j * LS_NUM];
+    ls[LS_T] = v_layerTemperature_[j];
+    ls[LS_P] = v_layerPressure_[j];
+    ls[LS_WV] = v_layerWaterVapor_[j];
+    ls[LS_O3] = v_layerO3_[j];
+    ls[LS_CO] = v_layerCO_[j];
+    ls[LS_N2O] = v_layerN2O_[j];
+    ls[LS_NO2] = v_layerNO2_[j];
+    ls[LS_SO2] = v_layerSO2_[j];
+  }
+
+  vector<double> freq;
+  if(v_chanFreq_.size() > ncmin) freq.assign(v_chanFreq_.begin() + ncmin, v_chanFreq_.end());
+  vector<ChannelRefractivity> v_chan(freq.size());
+  vector<char> v_found(freq.size(), 0);
+  if(!refractivityCache_) refractivityCache_ = RefractivityCache::acquire();
+  refractivityCache_->lookup(layerState, freq, v_chan, v_found);
+
+  int nfreq = freq.size();
+#pragma omp parallel
+  {
+    RefractiveIndex atm;
+#pragma omp for schedule(dynamic)
+    for(int i = 0; i < nfreq; i++) {
+      if(v_found[i]) continue;
+      mkChannelRefractivity(atm, layerState, 1.0E-9 * freq[i], v_chan[i]); // ATM uses GHz units
     }
+  }
 
-    if(npoints==0){npoints=1;}
-
-    */
-
-
-
-    // cout << "nc =" << nc << " nu=" << nu << " width=" << width << " GHz    npoints=" << npoints << endl;
-
-    // nu2 = nu * nu;      // [-Wunused_but_set_variable]
-    // nu_pi = nu / M_PI;    // [-Wunused_but_set_variable] 
-
-    for(unsigned int j = 0; j < numLayer_; j++) {
-
-      wv = v_layerWaterVapor_[j] * 1000.0; // se multiplica por 10**3 por cuestión de unidades en las rutinas fortran.
-      wvt = wv * v_layerTemperature_[j] / 217.0; // v_layerWaterVapor_[j] está en kg/m**3
-      // t = v_layerTemperature_[j] / 300.0;    // [-Wunused_but_set_variable] 
-
-
-      // cout <<"ATMRefractiveIndexProfile: " << v_layerTemperature_[j] << " K " << v_layerPressure_[j] << " mb "  << nu << " GHz " << endl;
-      // cout <<"ATMRefractiveIndexProfile: O2" <<  atm.getRefractivity_o2(v_layerTemperature_[j],v_layerPressure_[j],wvt,nu) << endl;
-      // cout << "ATMRefractiveIndexProfile: O2" << atm.getRefractivity_o2(v_layerTemperature_[j],v_layerPressure_[j],wvt,nu,width,npoints) << endl;
-      // cout << "ATMRefractiveIndexProfile: H2O" << atm.getRefractivity_h2o(v_layerTemperature_[j],v_layerPressure_[j],wvt,nu) << endl;
-      // cout << "ATMRefractiveIndexProfile: H2O" << atm.getRefractivity_h2o(v_layerTemperature_[j],v_layerPressure_[j],wvt,nu,width,npoints) << endl;
-      // cout <<"ATMRefractiveIndexProfile: O3" <<  atm.getRefractivity_o3(v_layerTemperature_[j],v_layerPressure_[j],nu,v_layerO3_[j]) << endl;
-      // cout << "ATMRefractiveIndexProfile: O3" << atm.getRefractivity_o3(v_layerTemperature_[j],v_layerPressure_[j],nu,width,npoints,v_layerO3_[j]) << endl;      
-      // cout <<"ATMRefractiveIndexProfile: CO" <<  atm.getSpecificRefractivity_co(v_layerTemperature_[j],v_layerPressure_[j],nu) << endl;
-      // cout << "ATMRefractiveIndexProfile: CO" << atm.getSpecificRefractivity_co(v_layerTemperature_[j],v_layerPressure_[j],nu,width,npoints) << endl;
-
-      v_N_O2LinesPtr->push_back(atm.getRefractivity_o2(v_layerTemperature_[j],
-                                                       v_layerPressure_[j],
-                                                       wvt,
-                                                       nu));     // ,width,npoints)); TO BE IMPLEMENTED IN NEXT RELEASE
-
-      complex<double> cont_h2o =
-        atm.getSpecificRefractivity_cnth2o(v_layerTemperature_[j],
-                                           v_layerPressure_[j],
-                                           wvt,
-                                           nu);                   // ,width,npoints); TO BE IMPLEMENTED IN NEXT RELEASE
-      complex<double> cont_dry =
-          atm.getSpecificRefractivity_cntdry(v_layerTemperature_[j],
-                                             v_layerPressure_[j],
-                                             wvt,
-                                             nu);                  // ,width,npoints); TO BE IMPLEMENTED IN NEXT RELEASE
-
-      v_N_H2OContPtr->push_back(cont_h2o);
-      v_N_DryContPtr->push_back(cont_dry);
-
-      if(v_layerWaterVapor_[j] > 0) {
-
-        v_N_H2OLinesPtr->push_back(atm.getRefractivity_h2o(v_layerTemperature_[j],
-                                                           v_layerPressure_[j],
-                                                           wvt,
-                                                           nu)); // ,width,npoints)); TO BE IMPLEMENTED IN NEXT RELEASE
-      } else {
-        v_N_H2OLinesPtr->push_back(0.0);
-      }
-
-      //	if(v_layerO3_[j]<0.0||j==10){cout << "v_layerO3_[" << j << "]=" << v_layerO3_[j] << endl;}
-
-      if(v_layerO3_[j] > 0) {
-
-        abun_O3 = v_layerO3_[j] * 1E-6;
-        v_N_O3LinesPtr->push_back(atm.getRefractivity_o3(v_layerTemperature_[j],
-                                                         v_layerPressure_[j],
-                                                         nu,      // width,npoints, TO BE IMPLEMENTED IN NEXT RELEASE
-                                                         abun_O3 * 1e6));
-      } else {
-        v_N_O3LinesPtr->push_back(0.0);
-      }
-
-      if(v_layerCO_[j] > 0) {
-        abun_CO = v_layerCO_[j] * 1E-6; // in cm^-3
-        v_N_COLinesPtr->push_back(atm.getSpecificRefractivity_co(v_layerTemperature_[j],
-								 v_layerPressure_[j],
-								 nu)            // ,width,npoints) TO BE IMPLEMENTED IN NEXT RELEASE
-				  * abun_CO * 1e6); // m^2 * m^-3 = m^-1
-        } else {
-        v_N_COLinesPtr->push_back(0.0);
-      }
+  refractivityCache_->store(layerState, freq, v_chan, v_found);
 
-      if(v_layerN2O_[j] > 0) {
-        abun_N2O = v_layerN2O_[j] * 1E-6;
-        v_N_N2OLinesPtr->push_back(atm.getSpecificRefractivity_n2o(v_layerTemperature_[j],
-								   v_layerPressure_[j],
-								   nu)             // ,width,npoints) TO BE IMPLEMENTED IN NEXT RELEASE
-				   * abun_N2O * 1e6); // m^2 * m^-3 = m^-1
-        } else {
-        v_N_N2OLinesPtr->push_back(0.0);
-      }
-
-      if(v_layerNO2_[j] > 0) {
-        abun_NO2 = v_layerNO2_[j] * 1E-6;
-        v_N_NO2LinesPtr->push_back(atm.getSpecificRefractivity_no2(v_layerTemperature_[j],
-								   v_layerPressure_[j],
-								   nu)             // ,width,npoints) TO BE IMPLEMENTED IN NEXT RELEASE
-				   * abun_NO2 * 1e6); // m^2 * m^-3 = m^-1
-      } else {
-        v_N_NO2LinesPtr->push_back(0.0);
-      }
+  for(unsigned int nc = ncmin; nc < v_chanFreq_.size(); nc++) {
 
-      if(v_layerSO2_[j] > 0) {
-        abun_SO2 = v_layerSO2_[j] * 1E-6;
-        v_N_SO2LinesPtr->push_back(atm.getSpecificRefractivity_so2(v_layerTemperature_[j],
-								   v_layerPressure_[j],
-								   nu)            // ,width,npoints) TO BE IMPLEMENTED IN NEXT RELEASE
-				   * abun_SO2 * 1e6); // m^2 * m^-3 = m^-1
-      } else {
-        v_N_SO2LinesPtr->push_back(0.0);
-      }
-    }
+    ChannelRefractivity &chan = v_chan[nc - ncmin];
+    vector<complex<double> >* v_N_H2OLinesPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_H2OContPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_O2LinesPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_DryContPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_O3LinesPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_COLinesPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_N2OLinesPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_NO2LinesPtr = new vector<complex<double> > ;
+    vector<complex<double> >* v_N_SO2LinesPtr = new vector<complex<double> > ;
+    v_N_H2OLinesPtr->swap(chan.N[ChannelRefractivity::H2OLines]);
+    v_N_H2OContPtr->swap(chan.N[ChannelRefractivity::H2OCont]);
+    v_N_O2LinesPtr->swap(chan.N[ChannelRefractivity::O2Lines]);
+    v_N_DryContPtr->swap(chan.N[ChannelRefractivity::DryCont]);
+    v_N_O3LinesPtr->swap(chan.N[ChannelRefractivity::O3Lines]);
+    v_N_COLinesPtr->swap(chan.N[ChannelRefractivity::COLines]);
+    v_N_N2OLinesPtr->swap(chan.N[ChannelRefractivity::N2OLines]);
+    v_N_NO2LinesPtr->swap(chan.N[ChannelRefractivity::NO2Lines]);
+    v_N_SO2LinesPtr->swap(chan.N[ChannelRefractivity::SO2Lines]);
 
     // if(vv_N_H2OLinesPtr_.size() == 0) first = true;  // [-Wunused_but_set_variable]
 
@@ -38,9 +38,12 @@
 #include "ATMRefractiveIndex.h"
 
 #include <complex>
+#include <memory>
 
 ATM_NAMESPACE_BEGIN
 
+class RefractivityCache;
+
 /**  \brief Profile of the absorption and Phase coefficient(s) at given frequency(ies) for an
  *   atmospheric profile (P/T/gas densities).
  *
@@ -869,6 +872,8 @@ protected:
 
   /* vecteur de vecteurs ???? */
 
+  std::shared_ptr<RefractivityCache> refractivityCache_; //!< refractivities of recent layer states, shared with the other live profiles
+
   /**
    * Method to build the profile of the absorption coefficients,
    */
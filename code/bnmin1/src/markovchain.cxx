@@ -15,7 +15,9 @@ namespace Minim {
 
   ChainBase::ChainBase(const v_t &ic,
 		       fx_t fLkl,
-		       fx_t fPr):
+		       fx_t fPr,
+		       unsigned seed):
+    igen(seed),
     fLkl(fLkl),
     fPr(fPr),
     ngen(igen,
@@ -117,10 +119,12 @@ namespace Minim {
   ILklChain::ILklChain(const v_t &ic,
 		       fx_t fLkl,
 		       fx_t fPr,
-		       fa_t fAccept):
+		       fa_t fAccept,
+		       unsigned seed):
     ChainBase(ic,
 	      fLkl,
-	      fPr),
+	      fPr,
+	      seed),
     fAccept(fAccept)
   {
     L=c.l;
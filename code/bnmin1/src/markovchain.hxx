@@ -95,9 +95,14 @@ namespace Minim {
 
     // ---------- Construction / Destruction --------------
     
+    /**
+       \param seed Seed for the random number generator of this
+       chain (5489 is the default seed of the generator)
+     */
     ChainBase(const v_t &ic,
 	      fx_t fLkl,
-	      fx_t fPr);
+	      fx_t fPr,
+	      unsigned seed=5489u);
 
     virtual ~ChainBase();
 
@@ -234,7 +239,8 @@ namespace Minim {
     ILklChain(const v_t &ic,
 	      fx_t fLkl,
 	      fx_t fPr,
-	      fa_t fAccept);
+	      fa_t fAccept,
+	      unsigned seed=5489u);
 
     // ---------- Public interface --------------------------
 
@@ -30,15 +30,16 @@ namespace Minim {
 
   NestedS::NestedS(PriorNLikelihood & ml,
 		   const std::list<MCPoint> & start,
-		   unsigned /*seed*/) throw (NestedSmallStart):
+		   unsigned seed) throw (NestedSmallStart):
     ModelDesc(ml),
     Zseq(1,0.0),
     Xseq(1,1.0),
     ml(ml),
     //ps(new CSPMetro(ml, sigmas, seed)),
     //ps(new CSPAdaptive(ml, *this, sigmas)),
-    ps(new CSRMSSS(ml, *this, g_ss())),
+    ps(new CSRMSSS(ml, *this, g_ss(), seed)),
     initials(new InitialWorst()),
+    seed(seed),
     mon(NULL),
     n_psample(100)
   {
@@ -55,13 +56,14 @@ namespace Minim {
   }
 
   NestedS::NestedS(PriorNLikelihood & ml,
-		   unsigned /*seed*/):
+		   unsigned seed):
     ModelDesc(ml),
     Zseq(1,0.0),
     Xseq(1,1.0),
     ml(ml),
     ps(NULL),
     initials(new InitialWorst()),
+    seed(seed),
     mon(NULL),
     n_psample(100)
   {
@@ -88,7 +90,8 @@ namespace Minim {
 
     ps.reset(new CSRMSSS(ml, 
 			 *this, 
-			 g_ss()));
+			 g_ss(),
+			 seed));
     Zseq=boost::assign::list_of(0.0).convert_to_container<std::vector<double> >( );
     Xseq=boost::assign::list_of(1.0).convert_to_container<std::vector<double> >( );
     llPoint(ml,
@@ -72,6 +72,9 @@ namespace Minim {
 
     /// The strategy for picking the inital point
     boost::scoped_ptr<NestedInitial> initials;
+
+    /// Seed for the random number generator of the prior sampler
+    const unsigned seed;
     
   public:
 
@@ -97,19 +100,22 @@ namespace Minim {
        functions will be re-calculated so it does not need be supplied
        in the MCPoint structure
        
-       \param seed Seed for the random number generator
+       \param seed Seed for the random number generator of the
+       Markov chains. The default is that of a default-constructed
+       boost::mt19937, which the chains used before the seed was
+       passed to them
 
     */
     NestedS(PriorNLikelihood & ml,
 	    const std::list<MCPoint> & start,
-	    unsigned seed=43) throw (NestedSmallStart);
+	    unsigned seed=5489) throw (NestedSmallStart);
 
     /**
        A constructor without a starting set, which allows for the
        to-fit parameters to be adjusted before initialisation
      */
     NestedS(PriorNLikelihood & ml,
-	    unsigned seed=43) ;
+	    unsigned seed=5489) ;
 
 
     ~NestedS();
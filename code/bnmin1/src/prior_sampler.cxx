@@ -188,16 +188,20 @@ namespace Minim
 
   CSRMSSS::CSRMSSS(PriorNLikelihood &ml,
 		   ModelDesc &md,
-		   const std::set<MCPoint> &ss):
+		   const std::set<MCPoint> &ss,
+		   unsigned seed):
     CPriorSampler(ml,md),
-    ss(ss)
+    ss(ss),
+    seed(seed)
   {
   }
 
   CSRMSSS::CSRMSSS(PriorNLikelihood &ml,
-		   NestedS &s):
+		   NestedS &s,
+		   unsigned seed):
     CPriorSampler(ml,s),
-    ss(s.g_ss())
+    ss(s.g_ss()),
+    seed(seed)
   {
   }
 
@@ -222,7 +226,8 @@ namespace Minim
     c.reset(new ILklChain(ic,
 			  flkl,
 			  fprior,
-			  constrPriorL));
+			  constrPriorL,
+			  seed));
 
     nprop=0;
   }
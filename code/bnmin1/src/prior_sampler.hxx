@@ -153,20 +153,25 @@ namespace Minim
 
     size_t nprop;
 
+    /// Seed for the random number generator of the chain
+    const unsigned seed;
+
 
   public:
 
     // -------------- Construction/Destruction ---------------------
 
     /**
-
+       \param seed Seed for the random number generator of the chain
      */
     CSRMSSS(PriorNLikelihood &ml,
 	    ModelDesc &md,
-	    const std::set<MCPoint> &ss);
+	    const std::set<MCPoint> &ss,
+	    unsigned seed=5489u);
 
     CSRMSSS(PriorNLikelihood &ml,
-	    NestedS &s);
+	    NestedS &s,
+	    unsigned seed=5489u);
 
 
     ~CSRMSSS();
@@ -475,6 +475,28 @@ void t_NestedSampling()
 	  
 }
 
+// Nested sampling of the gaussian likelihood with the given seed
+double nestedGaussEvidence(unsigned seed)
+{
+  using namespace Minim;
+  pdesc d=mkDesc(1.0, false);
+  NestedS s(*d.obs, seed);
+  std::list<MCPoint> ss;
+  startSetDirect(*d.obs, 20, ss);
+  s.reset(ss);
+  return s.sample(500);
+}
+
+void t_NestedSampling_Seed()
+{
+  // Every sampler has its own generator: the same seed gives the same
+  // result, whatever other samplers ran in between
+  const double first=nestedGaussEvidence(1);
+  const double other=nestedGaussEvidence(2);
+  AlwaysAssertExit(nestedGaussEvidence(1) == first);
+  AlwaysAssertExit(other != first);
+}
+
 void MetroPropose_raccept()
 {
   
@@ -748,6 +770,8 @@ int main()
   t_NestedSampling_Gauss();
   std::cout << "t_NestedSampling" << std::endl;
   t_NestedSampling();
+  std::cout << "t_NestedSampling_Seed" << std::endl;
+  t_NestedSampling_Seed();
 
   std::cout << "MetroPropose_raccept" << std::endl;
   MetroPropose_raccept();
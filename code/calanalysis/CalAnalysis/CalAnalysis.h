@@ -41,6 +41,7 @@ Modification history:
 
 #include <iostream>
 #include <sstream>
+#include <vector>
 using namespace std;
 
 #include <casa/Exceptions/Error.h>
@@ -698,9 +699,16 @@ casacore::Vector<CalAnalysis::OUTPUT<T> >& CalAnalysis::stats(
   poOutput->resize( uiNumGroup, false );
 
 
-  // Send each group to CalStats<T>() and perform the desired operation
+  // Send each group to CalStats<T>() and perform the desired operation.  The
+  // groups were all read by getGroup() and are independent, so they are
+  // processed in parallel; each writes only its own output element.  LogIO is
+  // not thread safe, so the warnings of each group are collected and posted
+  // in group order after the loop.
 
-  for ( casacore::uInt g=0; g<uiNumGroup; g++ ) {
+  std::vector<std::vector<casacore::String> > oWarningGroup( uiNumGroup );
+
+#pragma omp parallel for schedule(dynamic)
+  for ( casacore::Int g=0; g<(casacore::Int) uiNumGroup; g++ ) {
 
     poOutput->operator[](g).uiField = oFieldGroup[g];
     poOutput->operator[](g).uiAntenna1 = oAntenna1Group[g];
@@ -723,35 +731,58 @@ casacore::Vector<CalAnalysis::OUTPUT<T> >& CalAnalysis::stats(
 	case (casacore::uInt) AMPLITUDE:
 	  poCS = (CalStats*) new CalStatsAmp( oCParamGroup[g],
               oParamErrGroup[g], oFlagGroup[g], oInputNew.oFeed, oFreqGroup[g],
-              oTimeUniqueGroup[g], oInputNew.eAxisIterUserID, oInputNew.bNorm );
+              oTimeUniqueGroup[g], oInputNew.eAxisIterUserID, oInputNew.bNorm,
+              &oWarningGroup[g] );
           break;
 	case (casacore::uInt) PHASE:
 	  poCS = (CalStats*) new CalStatsPhase( oCParamGroup[g],
               oParamErrGroup[g], oFlagGroup[g], oInputNew.oFeed, oFreqGroup[g],
               oTimeUniqueGroup[g], oInputNew.eAxisIterUserID, oInputNew.bUnwrap,
-              oInputNew.dJumpMax );
+              oInputNew.dJumpMax, &oWarningGroup[g] );
           break;
         default:
           throw( casacore::AipsError( "Invalid parameter (REAL, AMPLITUDE, or PHASE)" ) );
       }
 
-      poOutput->operator[](g).oOut = poCS->stats<T>( oArg );
+      poOutput->operator[](g).oOut = poCS->stats<T>( oArg, &oWarningGroup[g] );
 
       delete poCS;
 
     }
 
     catch ( casacore::AipsError oAE ) {
-      casacore::LogIO log( casacore::LogOrigin( "CalAnalysis", "stats<T>()", WHERE ) );
-      log << casacore::LogIO::WARN << oAE.getMesg()
-          << ", iteration (field,antenna1,antenna2) = (" << oFieldGroup[g]
-          << "," << oAntenna1Group[g] << "," << oAntenna2Group[g]
-          << "), continuing ..." << casacore::LogIO::POST;
+      delete poCS;
+      oWarningGroup[g].push_back( oAE.getMesg() + ", continuing ..." );
+      poOutput->operator[](g).oOut = CalStats::OUT<T>();
+    }
+
+    // Nothing may leave the parallel region (it would terminate the
+    // process), so any other failure is also reported as a warning
+    catch ( std::exception& oE ) {
+      delete poCS;
+      oWarningGroup[g].push_back( casacore::String( oE.what() ) + ", continuing ..." );
+      poOutput->operator[](g).oOut = CalStats::OUT<T>();
+    }
+
+    catch ( ... ) {
+      delete poCS;
+      oWarningGroup[g].push_back( "Unknown error, continuing ..." );
       poOutput->operator[](g).oOut = CalStats::OUT<T>();
     }
 
   }
 
+  casacore::LogIO log( casacore::LogOrigin( "CalAnalysis", "stats<T>()", WHERE ) );
+
+  for ( casacore::uInt g=0; g<uiNumGroup; g++ ) {
+    for ( size_t w=0; w<oWarningGroup[g].size(); w++ ) {
+      log << casacore::LogIO::WARN << oWarningGroup[g][w]
+          << ", iteration (field,antenna1,antenna2) = (" << oFieldGroup[g]
+          << "," << oAntenna1Group[g] << "," << oAntenna2Group[g] << ")"
+          << casacore::LogIO::POST;
+    }
+  }
+
 
   // Return the reference to the casacore::Vector<CalAnalysis::OUTPUT<T> > instance
 
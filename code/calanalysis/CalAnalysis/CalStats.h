@@ -38,6 +38,9 @@ Modification history:
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+#include <sstream>
+#include <vector>
+
 #include <casa/BasicSL/String.h>
 
 #include <casa/aips.h>
@@ -52,6 +55,7 @@ Modification history:
 #include <casa/Arrays/ArrayIter.h>
 #include <casa/Arrays/ArrayMath.h>
 #include <casa/Arrays/ArrayLogical.h>
+#include <casa/Arrays/ArrayIO.h>
 
 #include <calanalysis/CalAnalysis/CalStatsFitter.h>
 
@@ -320,8 +324,10 @@ class CalStats {
     // calculating statistics, CalStatsFitter::FIT calculates fits, and
     // CalStatsHist::HIST calculates histogram statistics).  Member function
     // stats() is the main user interface and statsWrap() is the supporting
-    // wrapper.
-    template <typename T> casacore::Matrix<OUT<T> >& stats( const ARG<T>& oArg );
+    // wrapper.  Fit failures are appended to poWarning if it is not NULL
+    // (for callers running in parallel), otherwise they are logged.
+    template <typename T> casacore::Matrix<OUT<T> >& stats( const ARG<T>& oArg,
+        std::vector<casacore::String>* poWarning = NULL );
     template <typename T> T& statsWrap( const casacore::Vector<casacore::Double>& oAbs,
         const casacore::Vector<casacore::Double>& oValue, const casacore::Vector<casacore::Double>& oValueErr,
         casacore::Vector<casacore::Bool>& oFlag, const ARG<T>& oArg );
@@ -451,8 +457,10 @@ are CalStats::NONE (no statistics, just the input data), CalStatsFitter::FIT
 
 Inputs:
 -------
-oArg - This reference to a CalStats::ARG<T> instance contains the extra input
-       parameters.
+oArg      - This reference to a CalStats::ARG<T> instance contains the extra
+            input parameters.
+poWarning - This pointer to a std::vector<String> instance, if not NULL,
+            receives the fit failure warnings instead of the logger.
 
 Outputs:
 --------
@@ -466,13 +474,16 @@ Modification history:
               getData() and calcFit() member functions.
 2012 Jan 25 - Nick Elias, NRAO
               Logging capability added.
+2026 Oct 19 - Warnings can be returned to the caller (poWarning) so that
+              they are not logged from worker threads.
 
 */
 
 // -----------------------------------------------------------------------------
 
 template <typename T>
-casacore::Matrix<CalStats::OUT<T> >& CalStats::stats( const CalStats::ARG<T>& oArg ) {
+casacore::Matrix<CalStats::OUT<T> >& CalStats::stats( const CalStats::ARG<T>& oArg,
+    std::vector<casacore::String>* poWarning ) {
 
   // Initialize the CalStats::OUT<T> array and its iterator
 
@@ -513,9 +524,15 @@ casacore::Matrix<CalStats::OUT<T> >& CalStats::stats( const CalStats::ARG<T>& oA
     }
 
     catch ( casacore::AipsError oAE ) {
-      casacore::LogIO log( casacore::LogOrigin( "CalStats", "stats<T>()", WHERE ) );
-      log << casacore::LogIO::WARN << oAE.getMesg() << ", iteration: "
-          << oPos.asVector() << ", continuing ..." << casacore::LogIO::POST;
+      std::ostringstream oMessage;
+      oMessage << oAE.getMesg() << ", iteration: " << oPos.asVector()
+          << ", continuing ...";
+      if ( poWarning != NULL ) {
+        poWarning->push_back( oMessage.str() );
+      } else {
+        casacore::LogIO log( casacore::LogOrigin( "CalStats", "stats<T>()", WHERE ) );
+        log << casacore::LogIO::WARN << oMessage.str() << casacore::LogIO::POST;
+      }
       oOut.oT = T();
     }
 
@@ -49,6 +49,18 @@ namespace casa {
 const uInt CalStatsPhase::NUM_ITER_UNWRAP = 50;
 const Double CalStatsPhase::NEW_RANGE_FACTOR = 5.0;
 
+// Post a warning, or append it to the caller's list when one is supplied so
+// that it can be posted later from a single thread
+static void postWarning( const LogOrigin& oOrigin, const String& oMessage,
+    std::vector<String>* poWarning ) {
+  if ( poWarning != NULL ) {
+    poWarning->push_back( oMessage );
+  } else {
+    LogIO log( oOrigin );
+    log << LogIO::WARN << oMessage << LogIO::POST;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Start of CalStatsReal class
 // -----------------------------------------------------------------------------
@@ -286,6 +298,8 @@ eAxisIterUserID - This reference to a CalStats::AXIS enum contains either the
                   FREQUENCY or TIME iteration axes (user defined).
 bNorm           - This reference to a Bool variable contains the normalization
                   flag (true = normalize, false = don't normalize).
+poWarning       - This pointer to a std::vector<String> instance, if not NULL,
+                  collects the normalization warnings instead of logging them.
 
 Outputs:
 --------
@@ -314,7 +328,7 @@ CalStatsAmp::CalStatsAmp( const Cube<DComplex>& oValue,
     const Cube<Double>& oValueErr, const Cube<Bool>& oFlag,
     const Vector<String>& oFeed, const Vector<Double>& oFrequency,
     const Vector<Double>& oTime, const CalStats::AXIS& eAxisIterUserID,
-    const Bool& bNorm ) : CalStats() {
+    const Bool& bNorm, std::vector<String>* poWarning ) : CalStats() {
 
   // Calculate the amplitudes and their errors
 
@@ -357,7 +371,7 @@ CalStatsAmp::CalStatsAmp( const Cube<DComplex>& oValue,
     Vector<Double> oAmpV( oAmpIter.array().copy().reform(oShape) );
     Vector<Double> oAmpErrV( oAmpErrIter.array().copy().reform(oShape) );
 
-    norm( oAmpV, oAmpErrV, oFlagV );
+    norm( oAmpV, oAmpErrV, oFlagV, poWarning );
 
     oFlagIter.array() = oFlagV;
     oAmpIter.array() = oAmpV;
@@ -472,6 +486,8 @@ oAmp    - This reference to a Vector<Double> instance contains the unnormalized
 oAmpErr - This reference to a Vector<Double> instance contains the unnormalized
           amplitude errors.
 oFlag   - This reference to a Vector<Bool> instance contains the flags.
+poWarning - This pointer to a std::vector<String> instance, if not NULL,
+            collects the warnings instead of logging them.
 
 Outputs:
 --------
@@ -496,7 +512,7 @@ Modification history:
 // -----------------------------------------------------------------------------
 
 void CalStatsAmp::norm( Vector<Double>& oAmp, Vector<Double>& oAmpErr,
-    Vector<Bool>& oFlag ) {
+    Vector<Bool>& oFlag, std::vector<String>* poWarning ) {
 
   // Eliminate the flagged amplitudes and their errors
 
@@ -512,10 +528,8 @@ void CalStatsAmp::norm( Vector<Double>& oAmp, Vector<Double>& oAmpErr,
   uInt uiNumAbsC = oAmpC.nelements();
 
   if ( uiNumAbsC <= 1 ) {
-    LogIO log( LogOrigin( "CalStatsAmp", "norm", WHERE ) );
-    log << LogIO::WARN
-        << "Abscissa has a dimension <= 1, no normalization"
-        << LogIO::POST;
+    postWarning( LogOrigin( "CalStatsAmp", "norm", WHERE ),
+        "Abscissa has a dimension <= 1, no normalization", poWarning );
     return;
   }
 
@@ -664,6 +678,8 @@ dJumpMax        - This reference to a Double variable contains the maximum
                   CalStats::FREQUENCY axis), this parameter selects the type of
                   unwrapping (dJumpMax==0.0 --> group-delay unwrapping, dJumpMax
                   != 0.0 --> simple unwrapping).
+poWarning       - This pointer to a std::vector<String> instance, if not NULL,
+                  collects the unwrapping warnings instead of logging them.
 
 Outputs:
 --------
@@ -693,7 +709,8 @@ CalStatsPhase::CalStatsPhase( const Cube<DComplex>& oValue,
     const Cube<Double>& oValueErr, const Cube<Bool>& oFlag,
     const Vector<String>& oFeed, const Vector<Double>& oFrequency,
     const Vector<Double>& oTime, const CalStats::AXIS& eAxisIterUserID,
-    const Bool& bUnwrap, const Double& dJumpMax ) : CalStats() {
+    const Bool& bUnwrap, const Double& dJumpMax,
+    std::vector<String>* poWarning ) : CalStats() {
 
   // Calculate the phases and the initial phase error cube (set to 0.0)
 
@@ -740,7 +757,7 @@ CalStatsPhase::CalStatsPhase( const Cube<DComplex>& oValue,
 
     if ( eAxisIterUserID == CalStats::TIME ) {
       if ( dJumpMax == 0.0 ) {
-        unwrapGD( oPhaseV, oFrequency, oFlagV );
+        unwrapGD( oPhaseV, oFrequency, oFlagV, poWarning );
       } else {
         unwrapSimple( oPhaseV, dJumpMax, oFlagV );
       }
@@ -1042,6 +1059,8 @@ oPhase     - This reference to a Vector<Double> instance contains the wrapped
 oFrequency - This reference to a Vector<Double> instance is the frequency
              abscissa.
 oFlag      - This reference to a Vector<Bool> instance contains the flags.
+poWarning  - This pointer to a std::vector<String> instance, if not NULL,
+             collects the warnings instead of logging them.
 
 Outputs:
 --------
@@ -1065,7 +1084,8 @@ Modification history:
 // -----------------------------------------------------------------------------
 
 void CalStatsPhase::unwrapGD( Vector<Double>& oPhase,
-    const Vector<Double>& oFrequency, const Vector<Bool>& oFlag ) {
+    const Vector<Double>& oFrequency, const Vector<Bool>& oFlag,
+    std::vector<String>* poWarning ) {
 
   // Eliminate the flagged phases and frequencies
 
@@ -1081,10 +1101,9 @@ void CalStatsPhase::unwrapGD( Vector<Double>& oPhase,
   uInt uiNumFrequencyC = oFrequencyC.nelements();
 
   if ( uiNumFrequencyC <= 1 ) {
-    LogIO log( LogOrigin( "CalStatsPhase", "unwrap", WHERE ) );
-    log << LogIO::WARN
-        << "Frequency axis has a dimension <= 1, no unwrapping performed"
-        << LogIO::POST;
+    postWarning( LogOrigin( "CalStatsPhase", "unwrap", WHERE ),
+        "Frequency axis has a dimension <= 1, no unwrapping performed",
+        poWarning );
     return;
   }
 
@@ -1109,8 +1128,7 @@ void CalStatsPhase::unwrapGD( Vector<Double>& oPhase,
   }
 
   if ( fD >= uiNumFrequencyC-1 ) {
-    LogIO log( LogOrigin( "CalStatsPhase", "unwrap", WHERE ) );
-    log << "Something is very wrong with the frequencies" << LogIO::EXCEPTION;
+    throw( AipsError( "Something is very wrong with the frequencies" ) );
   }
 
   Double dFreqDeltaC = oFreqDeltaC[fD];
@@ -1179,11 +1197,9 @@ void CalStatsPhase::unwrapGD( Vector<Double>& oPhase,
 
     dGroupDelay = mean( oTime );
   
-    LogIO log( LogOrigin( "CalStatsPhase", "unwrap", WHERE ) );
-    log << LogIO::WARN
-        << "Number of iterations exceeded for group delay calculation\n"
-        << "Using the mean time from the last iteration"
-        << LogIO::POST;
+    postWarning( LogOrigin( "CalStatsPhase", "unwrap", WHERE ),
+        "Number of iterations exceeded for group delay calculation\n"
+        "Using the mean time from the last iteration", poWarning );
 
   }
 
@@ -43,6 +43,7 @@ Modification history:
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <vector>
 
 #include <casa/Arrays/ArrayMath.h>
 #include <casa/Arrays/MaskedArray.h>
@@ -145,14 +146,15 @@ class CalStatsAmp : public CalStats {
     CalStatsAmp( const casacore::Cube<casacore::DComplex>& oValue, const casacore::Cube<casacore::Double>& oValueErr,
         const casacore::Cube<casacore::Bool>& oFlag, const casacore::Vector<casacore::String>& oFeed,
         const casacore::Vector<casacore::Double>& oFrequency, const casacore::Vector<casacore::Double>& oTime,
-        const CalStats::AXIS& eAxisIterUserID, const casacore::Bool& bNorm );
+        const CalStats::AXIS& eAxisIterUserID, const casacore::Bool& bNorm,
+        std::vector<casacore::String>* poWarning = NULL );
 
     // Destructor
     ~CalStatsAmp( void );
 
     // Normalize member function
     static void norm( casacore::Vector<casacore::Double>& oAmp, casacore::Vector<casacore::Double>& oAmpErr,
-        casacore::Vector<casacore::Bool>& oFlag );
+        casacore::Vector<casacore::Bool>& oFlag, std::vector<casacore::String>* poWarning = NULL );
 
 };
 
@@ -226,14 +228,15 @@ class CalStatsPhase : public CalStats {
         const casacore::Cube<casacore::Bool>& oFlag, const casacore::Vector<casacore::String>& oFeed,
         const casacore::Vector<casacore::Double>& oFrequency, const casacore::Vector<casacore::Double>& oTime,
         const CalStats::AXIS& eAxisIterUserID, const casacore::Bool& bUnwrap,
-        const casacore::Double& dJumpMax );
+        const casacore::Double& dJumpMax, std::vector<casacore::String>* poWarning = NULL );
 
     // Destructor
     ~CalStatsPhase( void );
 
     // Group-delay unwrapping member function
     static void unwrapGD( casacore::Vector<casacore::Double>& oPhase,
-        const casacore::Vector<casacore::Double>& oFrequency, const casacore::Vector<casacore::Bool>& oFlag );
+        const casacore::Vector<casacore::Double>& oFrequency, const casacore::Vector<casacore::Bool>& oFlag,
+        std::vector<casacore::String>* poWarning = NULL );
 
     // Simple phase unwrapping member function
     static void unwrapSimple( casacore::Vector<casacore::Double>& oPhase, const casacore::Double& dJumpMax,
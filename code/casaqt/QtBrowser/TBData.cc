@@ -1010,6 +1010,14 @@ TBData* TBArrayData::firstItem() {
     else return NULL;
 }
 
+void TBArrayData::setUnloadedShape(const IPosition& s) {
+    if(loaded) release();
+    shape.resize(s.size());
+    for(unsigned int i = 0; i < s.size(); i++)
+        shape[i] = s[i];
+    oneDim = shape.size() == 1;
+}
+
 
 ///////////////////////////////////
 // TBARRAYDATASTRING DEFINITIONS //
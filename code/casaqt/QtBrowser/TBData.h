@@ -1007,6 +1007,10 @@ public:
     
     // Returns the first item in the array, or NULL if there is no data loaded.
     TBData* firstItem();
+    
+    // Sets the shape of the array and releases any loaded data, so that the
+    // array can be displayed before its data is loaded.
+    void setUnloadedShape(const casacore::IPosition& s);
 
     
     // dataAt() must be implemented by any subclass.  Returns a TBData copy
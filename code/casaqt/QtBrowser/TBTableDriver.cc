@@ -43,8 +43,11 @@
 #include <tables/Tables/TableColumn.h>
 #include <casa/Containers/RecordField.h>
 #include <casa/Arrays/Vector.h>
+#include <casa/Arrays/Slicer.h>
 #include <casa/Exceptions/Error.h>
+#include <casa/OS/Path.h>
 
+#include <algorithm>
 #include <sstream>
 
 using namespace casacore;
@@ -105,31 +108,85 @@ Result TBTableDriver::query(String type, String query) {
 }
 */
 
+namespace {
+
+// Appends the cells of rows [start, end) of the given scalar column, read in
+// one call, to column col of rows.
+template <class T, class D>
+void readScalarCells(const Table& table, unsigned int col, int start,
+                     int end, vector<vector<TBData*>*>& rows) {
+    ROScalarColumn<T> column(table, table.tableDesc().columnDesc(col).name());
+    Vector<T> v = column.getColumnRange(Slicer(IPosition(1, start),
+                                               IPosition(1, end - start)));
+    for(int i = 0; i < end - start; i++)
+        rows.at(i)->at(col) = new D(v[i]);
+}
+
+// Appends the cells of rows [start, end) of the given array column to column
+// col of rows.  Unless full is true only the shapes of arrays with more than
+// one dimension are read; their values are read by
+// TBTableDriverDirect::loadArray() when they are needed.
+template <class T, class D>
+void readArrayCells(const Table& table, unsigned int col, int start, int end,
+                    bool full, vector<vector<TBData*>*>& rows) {
+    ROArrayColumn<T> column(table, table.tableDesc().columnDesc(col).name());
+    for(int i = start; i < end; i++) {
+        D* val;
+        if(!column.isDefined(i)) {
+            val = new D(Array<T>(), full);
+        } else if(full || column.ndim(i) == 1) {
+            val = new D(column(i), full);
+        } else {
+            val = new D();
+            val->setUnloadedShape(column.shape(i));
+        }
+        rows.at(i - start)->at(col) = val;
+    }
+}
+
+}
+
 /////////////////////////////////////
 // TBTABLEDRIVERDIRECT DEFINITIONS //
 /////////////////////////////////////
 
+// Static Members //
+
+QMutex TBTableDriverDirect::prefetchMutex;
+std::multimap<String, TBTableDriverDirect*>
+TBTableDriverDirect::prefetchDrivers;
+
 // Constructors/Destructors //
 
 TBTableDriverDirect::TBTableDriverDirect(TableParams* tp, TBTable* t) :
-                                    TBTableDriver(tp, t) {
+                                    TBTableDriver(tp, t), pageRows(0),
+                                    pageTotalRows(0), dataStart(-1),
+                                    prefetchThread(NULL) {
+    if(!taql) prefetchKey = Path(location).absoluteName();
+    waitForPrefetch();
     if(taql) m_table = Table(tableCommand(location));
     else m_table = Table(location);
 }
 
-TBTableDriverDirect::~TBTableDriverDirect() { }
+TBTableDriverDirect::~TBTableDriverDirect() {
+    waitForPrefetch();
+    clearPages();
+}
 
 // Public Methods //
 
 bool TBTableDriverDirect::canRead() {
+    waitForPrefetch();
     return m_table.hasLock(FileLocker::Read);
 }
 
 bool TBTableDriverDirect::canWrite() {
+    waitForPrefetch();
     return m_table.hasLock(FileLocker::Write);
 }
 
 bool TBTableDriverDirect::tryWriteLock() {
+    waitForPrefetch();
     if(!m_table.lock(FileLocker::Write, 1)) return false;
     try {
         m_table.reopenRW();
@@ -141,6 +198,7 @@ bool TBTableDriverDirect::tryWriteLock() {
 }
 
 bool TBTableDriverDirect::releaseWriteLock() {
+    waitForPrefetch();
     if(!m_table.hasLock(FileLocker::Write)) return true; // nothing to release
     m_table.unlock(); // release write lock
     return m_table.lock(FileLocker::Read); // re-acquire read lock
@@ -149,13 +207,10 @@ bool TBTableDriverDirect::releaseWriteLock() {
 Result TBTableDriverDirect::loadRows(int start, int num, bool full,
                                      vector<String>* f, bool parsedata,
                                      ProgressHelper* pp) {
+    waitForPrefetch();
     try {
     int steps = 1 + fields.size();
-    if(parsedata && pp != NULL) {
-        int n = taql ? num : totalRowsOf(location);
-        if(num < n) n = num;
-        steps += n / 10;
-    }
+    if(parsedata && pp != NULL) steps += m_table.tableDesc().ncolumn();
     if(pp != NULL) {
         pp->reset("Loading rows...");
         pp->setSteps(steps);
@@ -233,7 +288,6 @@ Result TBTableDriverDirect::loadRows(int start, int num, bool full,
     ROTableRow row(table);
     Vector<String> colNames = row.columnNames();
     TableDesc tdesc = table.tableDesc();
-    void** fieldPtrs = (void**) new unsigned int*[colNames.nelements()];
 
     bool updateFields = colNames.nelements() != fields.size();
     if(updateFields) {
@@ -252,69 +306,15 @@ Result TBTableDriverDirect::loadRows(int start, int num, bool full,
         DataType t = row.record().type(row.record().fieldNumber(colNames(i)));
         String type = TBConstants::typeName(t);
 
-        bool valid = true;
-        if(t == TpString)
-            fieldPtrs[i] = new RORecordFieldPtr<String>(row.record(),
-                                                        colNames(i));
-        else if(t == TpInt)
-            fieldPtrs[i] = new RORecordFieldPtr<Int>(row.record(),
-                                                     colNames(i));
-        else if(t == TpFloat)
-            fieldPtrs[i] = new RORecordFieldPtr<Float>(row.record(),
-                                                       colNames(i));
-        else if(t == TpDouble)
-            fieldPtrs[i] = new RORecordFieldPtr<Double>(row.record(),
-                                                        colNames(i));
-        else if(t == TpBool)
-            fieldPtrs[i] = new RORecordFieldPtr<Bool>(row.record(),
-                                                      colNames(i));
-        else if(t == TpUChar)
-            fieldPtrs[i] = new RORecordFieldPtr<uChar>(row.record(),
-                                                       colNames(i));
-        else if(t == TpShort)
-            fieldPtrs[i] = new RORecordFieldPtr<Short>(row.record(),
-                                                       colNames(i));
-        else if(t == TpUInt)
-            fieldPtrs[i] = new RORecordFieldPtr<uInt>(row.record(),
-                                                      colNames(i));
-        else if(t == TpComplex)
-            fieldPtrs[i] = new RORecordFieldPtr<Complex>(row.record(),
-                                                         colNames(i));
-        else if(t == TpDComplex)
-            fieldPtrs[i] = new RORecordFieldPtr<DComplex>(row.record(),
-                                                          colNames(i));
-        else if(t == TpArrayDouble)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<Double> >(row.record(),
-                                                                colNames(i));
-        else if(t == TpArrayBool)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<Bool> >(row.record(),
-                                                              colNames(i));
-        else if(t == TpArrayUChar)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<uChar> >(row.record(),
-                                                               colNames(i));
-        else if(t == TpArrayShort)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<Short> >(row.record(),
-                                                               colNames(i));
-        else if(t == TpArrayInt)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<Int> >(row.record(),
-                                                             colNames(i));
-        else if(t == TpArrayUInt)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<uInt> >(row.record(),
-                                                              colNames(i));
-        else if(t == TpArrayFloat)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<Float> >(row.record(),
-                                                               colNames(i));
-        else if(t == TpArrayComplex)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<Complex> >(row.record(),
-                                                                 colNames(i));
-        else if(t == TpArrayDComplex)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<DComplex> >(row.record(),
-                                                                  colNames(i));
-        else if(t == TpArrayString)
-            fieldPtrs[i] = new RORecordFieldPtr<Array<String> >(row.record(),
-                                                                colNames(i));
-        else {valid = false;
-	}
+        bool valid = t == TpString || t == TpInt || t == TpFloat ||
+                     t == TpDouble || t == TpBool || t == TpUChar ||
+                     t == TpShort || t == TpUInt || t == TpComplex ||
+                     t == TpDComplex || t == TpArrayDouble ||
+                     t == TpArrayBool || t == TpArrayUChar ||
+                     t == TpArrayShort || t == TpArrayInt ||
+                     t == TpArrayUInt || t == TpArrayFloat ||
+                     t == TpArrayComplex || t == TpArrayDComplex ||
+                     t == TpArrayString;
                 
         if(updateFields && t == TpDouble) { // Check if it's a date.
           String comment = cdesc.comment(); // Wouldn't it be better to look
@@ -388,123 +388,43 @@ Result TBTableDriverDirect::loadRows(int start, int num, bool full,
     // Update data
     loadedRows = 0;
     
-    for(unsigned int i = 0; i < data.size(); i++) {
-        vector<TBData*>* dr = data.at(i);
-        for(unsigned int j = 0; j < data.at(i)->size(); j++) {
-            delete dr->at(j);
-        }
-        delete dr;
+    // Only whole pages of all columns are kept for paging.
+    bool page = parsedata && !full && num > 0 && (f == NULL || f->size() == 0);
+    bool samePages = page && num == pageRows && totalRows == pageTotalRows;
+    if(!samePages) {
+        clearPages();
+        pageRows = num;
+        pageTotalRows = totalRows;
+    }
+    
+    // Keep the displayed page as a neighbour of the new one.
+    if(samePages && dataStart >= 0 && dataStart != start &&
+       pages.find(dataStart) == pages.end()) {
+        pages[dataStart] = data;
+    } else {
+        clearRows(data);
     }
     data.clear();
+    dataStart = -1;
     
     if(parsedata) {
-        for(int i = start; i < end; i++) {
-            row.get(i);
-
-            vector<TBData*>* r2 = new vector<TBData*>();
-            for(unsigned int j = 0; j < colNames.nelements(); j++) {
-                DataType t = row.record().type(j);
-
-                TBData* val = NULL;
-                if(t == TpString) {
-                    val = new TBDataString(**((RORecordFieldPtr<String>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpFloat) {
-                    val = new TBDataFloat(**((RORecordFieldPtr<Float>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpInt) {
-                    val = new TBDataInt(**((RORecordFieldPtr<Int>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpDouble) {
-                    String comment = tdesc.columnDesc(j).comment();
-                    double v = **((RORecordFieldPtr<Double>*)fieldPtrs[j]);
-                    if(TBConstants::equalsIgnoreCase(comment,
-                                                     TBConstants::COMMENT_DATE) ||
-                       TBConstants::equalsIgnoreCase(comment,
-                                                     TBConstants::COMMENT_TIMP) ||
-                       TBConstants::equalsIgnoreCase(comment,
-                                                     TBConstants::COMMENT_TIMP2)) {
-                        val = new TBDataDate(v);
-                    } else {
-                        val = new TBDataDouble(v);
-                    }
-                } else if(t == TpBool) {
-                    val = new TBDataBool(**((RORecordFieldPtr<Bool>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpChar) {
-                    val = new TBDataChar(**((RORecordFieldPtr<Char>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpUChar) {
-                    val = new TBDataUChar(**((RORecordFieldPtr<uChar>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpShort) {
-                    val = new TBDataShort(**((RORecordFieldPtr<Short>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpUInt) {
-                    val = new TBDataUInt(**((RORecordFieldPtr<uInt>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpComplex) {
-                    val = new TBDataComplex(**((RORecordFieldPtr<Complex>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpDComplex) {
-                    val = new TBDataDComplex(**((RORecordFieldPtr<DComplex>*)
-                                           fieldPtrs[j]));
-                } else if(t == TpArrayDouble) {
-                    val = new TBArrayDataDouble(
-                              **((RORecordFieldPtr<Array<Double> >*)
-                                 fieldPtrs[j]), full);
-                } else if(t == TpArrayBool) {
-                    val = new TBArrayDataBool(
-                              **((RORecordFieldPtr<Array<Bool> >*)
-                                 fieldPtrs[j]), full);
-                } else if(t == TpArrayUChar) {
-                    val = new TBArrayDataUChar(
-                              **((RORecordFieldPtr<Array<uChar> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayChar) {
-                    val = new TBArrayDataChar(
-                              **((RORecordFieldPtr<Array<Char> >*)
-                                 fieldPtrs[j]));
-                } else if(t == TpArrayShort) {
-                    val = new TBArrayDataShort(
-                              **((RORecordFieldPtr<Array<Short> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayInt) {
-                    val = new TBArrayDataInt(
-                              **((RORecordFieldPtr<Array<Int> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayUInt) {
-                    val = new TBArrayDataUInt(
-                              **((RORecordFieldPtr<Array<uInt> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayFloat) {
-                    val = new TBArrayDataFloat(
-                              **((RORecordFieldPtr<Array<Float> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayComplex) {
-                    val = new TBArrayDataComplex(
-                              **((RORecordFieldPtr<Array<Complex> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayDComplex) {
-                    val = new TBArrayDataDComplex(
-                              **((RORecordFieldPtr<Array<DComplex> >*)
-                                      fieldPtrs[j]), full);
-                } else if(t == TpArrayString) {
-                    val = new TBArrayDataString(
-                              **((RORecordFieldPtr<Array<String> >*)
-                                      fieldPtrs[j]), full);
-                }
-                
-                r2->push_back(val);
-            }
-            data.push_back(r2);
-            loadedRows++;
-
-            if(pp != NULL && ((i - start) % 10) == 0) pp->step();
+        std::map<int, vector<vector<TBData*>*> >::iterator it =
+            pages.find(start);
+        if(page && it != pages.end() &&
+           (int)it->second.size() == end - start) {
+            data = it->second;
+            pages.erase(it);
+        } else {
+            readRows(table, start, end, full, data, pp);
+        }
+        loadedRows = data.size();
+        
+        if(page) {
+            dataStart = start;
+            startPrefetch(start, num);
         }
     }
 
-    delete [] fieldPtrs;
     if(pp != NULL) pp->done();
     return Result("", true);
 
@@ -518,6 +438,7 @@ Result TBTableDriverDirect::loadRows(int start, int num, bool full,
 void TBTableDriverDirect::loadArray(TBArrayData* d, unsigned int r,
                                     unsigned int c) {
     //checkTaqlTable();
+    waitForPrefetch();
     
     Table table = m_table;
 
@@ -570,6 +491,7 @@ vector<int> TBTableDriverDirect::dimensionsOf(unsigned int col) {
     String type = fields.at(col)->getType();
     if(!TBConstants::typeIsArray(type)) return d;
     
+    waitForPrefetch();
     Table table = m_table;
     
     ColumnDesc acd = table.tableDesc().columnDesc(col);
@@ -623,6 +545,10 @@ Result TBTableDriverDirect::editData(unsigned int row, unsigned int col,
                                      TBData* newVal, vector<int>* d) {
     if(taql) return Result("Cannot edit TaQL tables.", false);
     
+    // pages loaded in advance may hold the old value
+    waitForPrefetch();
+    clearPages();
+    
     Table table = m_table;
     table.reopenRW();
     TableColumn column(table, col);
@@ -736,13 +662,18 @@ Result TBTableDriverDirect::editData(unsigned int row, unsigned int col,
 }
 
 int TBTableDriverDirect::totalRowsOf(String location) {
+    waitForPrefetch();
     if(location == m_table.tableName()) return m_table.nrow();
-    else return Table(location).nrow();
+    waitForPrefetch(Path(location).absoluteName());
+    return Table(location).nrow();
 }
 
 Result TBTableDriverDirect::insertRows(int n) {
     if(taql) return Result("Cannot edit TaQL tables.", false);
     
+    waitForPrefetch();
+    clearPages();
+    
     try {
         Table table = m_table;
         if(!table.canAddRow())
@@ -760,6 +691,9 @@ Result TBTableDriverDirect::insertRows(int n) {
 Result TBTableDriverDirect::deleteRows(vector<int> r) {
     if(taql) return Result("Cannot edit TaQL tables.", false);
     
+    waitForPrefetch();
+    clearPages();
+    
     try {
         Table table = m_table;
         if(!table.canRemoveRow())
@@ -869,6 +803,187 @@ vector<TBKeyword*>* TBTableDriverDirect::getKeywords(RecordInterface& kws) {
     return v;
 }
 
+// Private Methods //
+
+void TBTableDriverDirect::readRows(Table& table, int start, int end,
+                                   bool full, vector<vector<TBData*>*>& rows,
+                                   ProgressHelper* pp) {
+    const TableDesc& tdesc = table.tableDesc();
+    unsigned int ncols = tdesc.ncolumn();
+    rows.reserve(rows.size() + std::max(end - start, 0));
+    vector<vector<TBData*>*> r;
+    for(int i = start; i < end; i++)
+        r.push_back(new vector<TBData*>(ncols, (TBData*)NULL));
+    
+    // Read column by column so that each column is read in as few calls as
+    // possible instead of once per row.
+    try {
+        for(unsigned int j = 0; j < ncols && start < end; j++) {
+            const ColumnDesc& cdesc = tdesc.columnDesc(j);
+            DataType t = cdesc.dataType();
+            if(cdesc.isScalar()) {
+                if(t == TpString)
+                    readScalarCells<String, TBDataString>(table, j, start,
+                                                          end, r);
+                else if(t == TpFloat)
+                    readScalarCells<Float, TBDataFloat>(table, j, start,
+                                                        end, r);
+                else if(t == TpInt)
+                    readScalarCells<Int, TBDataInt>(table, j, start, end, r);
+                else if(t == TpDouble) {
+                    String c = cdesc.comment();
+                    if(TBConstants::equalsIgnoreCase(c,
+                                                 TBConstants::COMMENT_DATE) ||
+                       TBConstants::equalsIgnoreCase(c,
+                                                 TBConstants::COMMENT_TIMP) ||
+                       TBConstants::equalsIgnoreCase(c,
+                                                 TBConstants::COMMENT_TIMP2))
+                        readScalarCells<Double, TBDataDate>(table, j, start,
+                                                            end, r);
+                    else
+                        readScalarCells<Double, TBDataDouble>(table, j, start,
+                                                              end, r);
+                } else if(t == TpBool)
+                    readScalarCells<Bool, TBDataBool>(table, j, start, end, r);
+                else if(t == TpUChar)
+                    readScalarCells<uChar, TBDataUChar>(table, j, start,
+                                                        end, r);
+                else if(t == TpShort)
+                    readScalarCells<Short, TBDataShort>(table, j, start,
+                                                        end, r);
+                else if(t == TpUInt)
+                    readScalarCells<uInt, TBDataUInt>(table, j, start, end, r);
+                else if(t == TpComplex)
+                    readScalarCells<Complex, TBDataComplex>(table, j, start,
+                                                            end, r);
+                else if(t == TpDComplex)
+                    readScalarCells<DComplex, TBDataDComplex>(table, j, start,
+                                                              end, r);
+            } else if(cdesc.isArray()) {
+                if(t == TpDouble)
+                    readArrayCells<Double, TBArrayDataDouble>(table, j, start,
+                                                              end, full, r);
+                else if(t == TpBool)
+                    readArrayCells<Bool, TBArrayDataBool>(table, j, start,
+                                                          end, full, r);
+                else if(t == TpUChar)
+                    readArrayCells<uChar, TBArrayDataUChar>(table, j, start,
+                                                            end, full, r);
+                else if(t == TpShort)
+                    readArrayCells<Short, TBArrayDataShort>(table, j, start,
+                                                            end, full, r);
+                else if(t == TpInt)
+                    readArrayCells<Int, TBArrayDataInt>(table, j, start,
+                                                        end, full, r);
+                else if(t == TpUInt)
+                    readArrayCells<uInt, TBArrayDataUInt>(table, j, start,
+                                                          end, full, r);
+                else if(t == TpFloat)
+                    readArrayCells<Float, TBArrayDataFloat>(table, j, start,
+                                                            end, full, r);
+                else if(t == TpComplex)
+                    readArrayCells<Complex, TBArrayDataComplex>(table, j,
+                                                   start, end, full, r);
+                else if(t == TpDComplex)
+                    readArrayCells<DComplex, TBArrayDataDComplex>(table, j,
+                                                   start, end, full, r);
+                else if(t == TpString)
+                    readArrayCells<String, TBArrayDataString>(table, j, start,
+                                                              end, full, r);
+            }
+            
+            if(pp != NULL) pp->step();
+        }
+    } catch(...) {
+        clearRows(r);
+        throw;
+    }
+    rows.insert(rows.end(), r.begin(), r.end());
+}
+
+void TBTableDriverDirect::startPrefetch(int start, int num) {
+    // Keep only the pages next to the displayed one.
+    std::map<int, vector<vector<TBData*>*> >::iterator it = pages.begin();
+    while(it != pages.end()) {
+        if(it->first != start - num && it->first != start + num) {
+            clearRows(it->second);
+            pages.erase(it++);
+        } else it++;
+    }
+    
+    vector<int> starts;
+    if(start + num < totalRows && pages.find(start + num) == pages.end())
+        starts.push_back(start + num);
+    if(start - num >= 0 && pages.find(start - num) == pages.end())
+        starts.push_back(start - num);
+    if(starts.empty()) return;
+    
+    QMutexLocker locker(&prefetchMutex);
+    prefetchThread = new TBPrefetchThread(this, starts, num);
+    prefetchDrivers.insert(std::make_pair(prefetchKey, this));
+    prefetchThread->start();
+}
+
+void TBTableDriverDirect::waitForPrefetch() {
+    waitForPrefetch(prefetchKey);
+}
+
+void TBTableDriverDirect::waitForPrefetch(const String& key) {
+    QMutexLocker locker(&prefetchMutex);
+    std::multimap<String, TBTableDriverDirect*>::iterator it =
+        prefetchDrivers.begin();
+    while(it != prefetchDrivers.end()) {
+        if(key.empty() || it->first.empty() || it->first == key) {
+            TBTableDriverDirect* d = it->second;
+            d->prefetchThread->wait();
+            delete d->prefetchThread;
+            d->prefetchThread = NULL;
+            prefetchDrivers.erase(it++);
+        } else it++;
+    }
+}
+
+void TBTableDriverDirect::clearPages() {
+    std::map<int, vector<vector<TBData*>*> >::iterator it;
+    for(it = pages.begin(); it != pages.end(); it++)
+        clearRows(it->second);
+    pages.clear();
+}
+
+void TBTableDriverDirect::clearRows(vector<vector<TBData*>*>& rows) {
+    for(unsigned int i = 0; i < rows.size(); i++) {
+        vector<TBData*>* dr = rows.at(i);
+        for(unsigned int j = 0; j < dr->size(); j++)
+            delete dr->at(j);
+        delete dr;
+    }
+    rows.clear();
+}
+
+//////////////////////////////////
+// TBPREFETCHTHREAD DEFINITIONS //
+//////////////////////////////////
+
+TBPrefetchThread::TBPrefetchThread(TBTableDriverDirect* d, vector<int> s,
+                                   int n) : driver(d), starts(s), num(n) { }
+
+TBPrefetchThread::~TBPrefetchThread() { }
+
+void TBPrefetchThread::run() {
+    for(unsigned int i = 0; i < starts.size(); i++) {
+        int start = starts.at(i);
+        vector<vector<TBData*>*> rows;
+        try {
+            int end = std::min(start + num, driver->totalRows);
+            driver->readRows(driver->m_table, start, end, false, rows);
+        } catch(...) {
+            // The page is read again when it is displayed.
+            continue;
+        }
+        driver->pages[start] = rows;
+    }
+}
+
 /*
 //////////////////////////////////
 // TBTABLEDRIVERXML DEFINITIONS //
@@ -33,6 +33,10 @@
 #include <casa/BasicSL/String.h>
 #include <tables/Tables/Table.h>
 
+#include <QMutex>
+#include <QThread>
+
+#include <map>
 #include <vector>
 
 namespace casacore{
@@ -53,6 +57,7 @@ class DriverParams;
 class ProgressHelper;
 class TBData;
 class TBArrayData;
+class TBTableDriverDirect;
 
 // <summary>
 // Driver for interacting with the table on disk.
@@ -246,8 +251,99 @@ public:
     static std::vector<TBKeyword*>* getKeywords(casacore::RecordInterface& kws);
     
 private:
+    friend class TBPrefetchThread;
+
     // Reference to table on disk.
     casacore::Table m_table;
+    
+    // Pages of rows next to the displayed one, keyed by their first row.
+    // They are loaded in advance by prefetchThread so that paging through
+    // the table does not wait for the disk.
+    std::map<int, std::vector<std::vector<TBData*>*> > pages;
+    
+    // Number of rows per page and of the table when the pages were loaded.
+    int pageRows, pageTotalRows;
+    
+    // First row of the displayed page if it can be kept as a neighbouring
+    // page, -1 otherwise.
+    int dataStart;
+    
+    // Thread loading pages in advance, or NULL.
+    TBPrefetchThread* prefetchThread;
+    
+    // Absolute name of the table read by prefetchThread, or empty for TaQL
+    // tables.
+    casacore::String prefetchKey;
+    
+    // Drivers whose prefetch thread may still be running, keyed by their
+    // prefetchKey, and the mutex guarding them.  Other drivers opened on the
+    // same table (for example for exporting or plotting) share its
+    // casacore::PlainTable through the table cache, so they must wait for
+    // these threads too.
+    static QMutex prefetchMutex;
+    static std::multimap<casacore::String, TBTableDriverDirect*> prefetchDrivers;
+    
+    
+    // Reads rows [start, end) of the given table into rows.  Array cells
+    // with more than one dimension only get their shapes unless full is
+    // true; see TBTable::loadArray().
+    void readRows(casacore::Table& table, int start, int end, bool full,
+                  std::vector<std::vector<TBData*>*>& rows,
+                  ProgressHelper* pp = NULL);
+    
+    // Starts loading the pages before and after the given one in the
+    // background and drops the pages further away.
+    void startPrefetch(int start, int num);
+    
+    // Waits until the prefetch threads of all drivers reading this table,
+    // if any, have finished.  Must be called before accessing the table since
+    // casacore tables are not thread-safe.
+    void waitForPrefetch();
+    
+    // Waits until the prefetch threads of all drivers reading the table with
+    // the given absolute name have finished.  An empty name, or a driver on a
+    // TaQL table, matches every table.
+    static void waitForPrefetch(const casacore::String& key);
+    
+    // Deletes all pages loaded in advance.
+    void clearPages();
+    
+    // Deletes the given rows.
+    static void clearRows(std::vector<std::vector<TBData*>*>& rows);
+};
+
+// <summary>
+// Thread that loads pages of a table in advance.
+// </summary>
+//
+// <synopsis>
+// TBPrefetchThread is a subclass of QThread that reads pages of rows for a
+// TBTableDriverDirect into its page cache while the user looks at the
+// displayed page.  The driver waits for the thread before it accesses the
+// table itself.
+// </synopsis>
+class TBPrefetchThread : public QThread {
+public:
+    // Constructor that takes the driver and the first rows of the pages to
+    // load, with num rows each.
+    TBPrefetchThread(TBTableDriverDirect* driver, std::vector<int> starts,
+                     int num);
+    
+    ~TBPrefetchThread();
+    
+    // Overrides QThread::run() which defines the task to be completed by the
+    // thread.
+    void run();
+    
+private:
+    // Driver to load pages for.
+    TBTableDriverDirect* driver;
+    
+    // First rows of the pages to load.
+    std::vector<int> starts;
+    
+    // Rows per page.
+    int num;
 };
 
 // NOTE: the TBTableDriverXML has been disabled.  If it is to be used in the
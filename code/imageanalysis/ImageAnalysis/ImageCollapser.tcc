@@ -29,7 +29,6 @@
 
 #include <casa/Arrays/ArrayLogical.h>
 #include <casa/BasicSL/STLIO.h>
-#include <casacore/scimath/Mathematics/ClassicalStatistics.h>
 #include <casacore/scimath/Mathematics/NumericTraits.h>
 #include <images/Images/ImageStatistics.h>
 #include <images/Images/ImageUtilities.h>
@@ -39,7 +38,9 @@
 #include <lattices/Lattices/LatticeUtilities.h>
 #include <lattices/LatticeMath/LatticeMathUtil.h>
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace casa {
 
@@ -428,50 +429,143 @@ template<class T> void ImageCollapser<T>::_invert() {
 template<class T> void ImageCollapser<T>::_doMedian(
     SPCIIT image, casacore::TempImage<T>& outImage
 ) const {
-    IPosition cursorShape(image->ndim(), 1);
-    for (uInt i = 0; i < cursorShape.size(); ++i) {
-        for (uInt j = 0; j < _axes.size(); ++j) {
-            if (_axes[j] == i) {
-                cursorShape[i] = image->shape()[i];
-                break;
+    // The image is read in chunks that span the full collapse axes and whole
+    // tiles along the other axes, so each tile is read only once. The medians
+    // of the output pixels in a chunk are found in parallel by in-place
+    // selection on per-thread scratch buffers.
+    const auto& shape = image->shape();
+    const auto ndim = shape.size();
+    auto tileShape = image->niceCursorShape();
+    Vector<Bool> isCollapse(ndim, False);
+    for (uInt j = 0; j < _axes.size(); ++j) {
+        isCollapse[_axes[j]] = True;
+    }
+    IPosition chunkShape(ndim, 1);
+    for (uInt i = 0; i < ndim; ++i) {
+        chunkShape[i] = isCollapse[i] ? shape[i] : tileShape[i];
+    }
+    // keep the chunk to a reasonable size by shrinking the non-collapse
+    // axes, longest first
+    static const Int64 maxChunkPixels = 1 << 26;
+    while (chunkShape.product() > maxChunkPixels) {
+        Int longest = -1;
+        for (uInt i = 0; i < ndim; ++i) {
+            if (
+                ! isCollapse[i] && chunkShape[i] > 1
+                && (longest < 0 || chunkShape[i] > chunkShape[longest])
+            ) {
+                longest = i;
             }
         }
+        if (longest < 0) {
+            break;
+        }
+        chunkShape[longest] = (chunkShape[longest] + 1)/2;
     }
-    LatticeStepper stepper(image->shape(), cursorShape);
+    LatticeStepper stepper(shape, chunkShape, LatticeStepper::RESIZE);
     std::unique_ptr<Array<Bool>> outMask;
-    // accumtype being the same precision as the input data type is ok here,
-    // since we are only computing the median and not actually accumulating
-    ClassicalStatistics<
-        T, typename Array<T>::const_iterator, Array<Bool>::const_iterator
-    > stats;
     auto hasMaskedPixels = ! ImageMask::isAllMaskTrue(*image);
     for (stepper.reset(); !stepper.atEnd(); stepper++) {
         Slicer slicer(
             stepper.position(), stepper.endPosition(), casacore::Slicer::endIsLast
         );
         auto data = image->getSlice(slicer);
-        Bool isMasked = False;
         Array<Bool> maskSlice;
         if (hasMaskedPixels) {
             maskSlice = image->getMaskSlice(slicer);
-            isMasked = ! allTrue(maskSlice);
         }
-        if (isMasked) {
-            if (! anyTrue(maskSlice)) {
-                if (! outMask) {
-                    outMask.reset(new Array<Bool>(outImage.shape(), true));
+        const auto dataShape = data.shape();
+        auto outShape = dataShape;
+        IPosition collapseShape(ndim, 1);
+        for (uInt i = 0; i < ndim; ++i) {
+            if (isCollapse[i]) {
+                outShape[i] = 1;
+                collapseShape[i] = dataShape[i];
+            }
+        }
+        // offsets into the chunk of the pixels collapsed onto an output
+        // pixel, and of the output pixels themselves
+        const auto nCollapse = collapseShape.product();
+        const auto nOut = outShape.product();
+        std::vector<size_t> collapseOffsets(nCollapse);
+        for (Int64 k = 0; k < nCollapse; ++k) {
+            collapseOffsets[k] = toOffsetInArray(
+                toIPositionInArray(k, collapseShape), dataShape
+            );
+        }
+        std::vector<size_t> outOffsets(nOut);
+        for (Int64 k = 0; k < nOut; ++k) {
+            outOffsets[k] = toOffsetInArray(
+                toIPositionInArray(k, outShape), dataShape
+            );
+        }
+        Bool deleteData, deleteMask;
+        const T* dptr = data.getStorage(deleteData);
+        const Bool* mptr = hasMaskedPixels
+            ? maskSlice.getStorage(deleteMask) : nullptr;
+        Array<T> outData(outShape);
+        Array<Bool> outGood(outShape, True);
+        T* optr = outData.data();
+        Bool* gptr = outGood.data();
+        // casacore's ordering, as used by ClassicalStatistics; the std
+        // algorithms do not find casacore's complex operator< through ADL
+        const auto lessThan = [](const T& a, const T& b) { return a < b; };
+#pragma omp parallel default(shared)
+        {
+            std::vector<T> values;
+            values.reserve(nCollapse);
+#pragma omp for schedule(dynamic, 64)
+            for (Int64 k = 0; k < nOut; ++k) {
+                const auto base = outOffsets[k];
+                values.clear();
+                if (mptr) {
+                    for (Int64 m = 0; m < nCollapse; ++m) {
+                        const auto idx = base + collapseOffsets[m];
+                        if (mptr[idx]) {
+                            values.push_back(dptr[idx]);
+                        }
+                    }
+                }
+                else {
+                    for (Int64 m = 0; m < nCollapse; ++m) {
+                        values.push_back(dptr[base + collapseOffsets[m]]);
+                    }
+                }
+                const auto n = values.size();
+                if (n == 0) {
+                    gptr[k] = False;
+                    optr[k] = T(0);
+                    continue;
                 }
-                (*outMask)(stepper.position()) = false;
-                outImage.putAt(T(0), stepper.position());
+                // same definition as ClassicalStatistics::getMedian(): the
+                // mean of the two middle values if the number is even
+                auto mid = values.begin() + n/2;
+                std::nth_element(values.begin(), mid, values.end(), lessThan);
+                T median = *mid;
+                if (n % 2 == 0) {
+                    median = (
+                        *std::max_element(values.begin(), mid, lessThan) + median
+                    )/T(2);
+                }
+                optr[k] = median;
             }
-            else if (! allTrue(maskSlice)) {
-                stats.setData(data.begin(), maskSlice.begin(), data.size());
-                outImage.putAt(stats.getMedian(), stepper.position());
+        }
+        data.freeStorage(dptr, deleteData);
+        if (mptr) {
+            maskSlice.freeStorage(mptr, deleteMask);
+        }
+        auto outPos = stepper.position();
+        for (uInt i = 0; i < ndim; ++i) {
+            if (isCollapse[i]) {
+                outPos[i] = 0;
             }
         }
-        else {
-            stats.setData(data.begin(), data.size());
-            outImage.putAt(stats.getMedian(), stepper.position());
+        outImage.putSlice(outData, outPos);
+        if (! allTrue(outGood)) {
+            if (! outMask) {
+                outMask.reset(new Array<Bool>(outImage.shape(), true));
+            }
+            (*outMask)(outPos, outPos + outShape - 1) = outGood;
         }
     }
     if (outMask) {
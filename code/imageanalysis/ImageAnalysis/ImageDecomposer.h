@@ -407,6 +407,25 @@ private:
 // as individual any components that are distinct above any such level.
   void deblendRegions(const casacore::Vector<T>& contours, casacore::Int minRange=1, casacore::Int naxis=2);
 
+// Makes a decomposer whose component map is allowed up to mapMaxMemoryInMB
+// of memory before it is put on disk.
+  ImageDecomposer(const casacore::ImageInterface<T>& image,
+                  casacore::Double mapMaxMemoryInMB);
+
+// Makes a decomposer for region <src>region</src> (one-based) of
+// thresholdMap over its bounding box, and deblends and fits (or estimates)
+// its components.  Touches no state of this decomposer, so it may be
+// called for several regions at once if <src>inMemory</src> is true, which
+// keeps the subimage and the subcomponentmap in memory whatever their size.
+// Otherwise they go to disk beyond the usual limits.  The caller owns the
+// returned object.
+  ImageDecomposer<T>* decomposeRegion(const ImageDecomposer<T>& thresholdMap,
+                                      casacore::uInt region,
+                                      const casacore::IPosition& blc,
+                                      const casacore::IPosition& trc,
+                                      const casacore::Vector<T>& contours,
+                                      casacore::Bool inMemory) const;
+
 // Retrieves the target image's value at the given location.
 // <group>
   T getImageVal(casacore::IPosition coord) const;
@@ -43,11 +43,21 @@
 #include <images/Images/TempImage.h>
 #include <images/Images/SubImage.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace casa {
 
 template <class T>
 ImageDecomposer<T>::ImageDecomposer(const casacore::ImageInterface<T>& image)
+ : ImageDecomposer<T>(image, 1)
+{}
+
+template <class T>
+ImageDecomposer<T>::ImageDecomposer(const casacore::ImageInterface<T>& image,
+                                    casacore::Double mapMaxMemoryInMB)
  : itsImagePtr(image.cloneII()),
    itsMapPtr(0),
    itsShape(itsImagePtr->shape()),
@@ -65,7 +75,8 @@ ImageDecomposer<T>::ImageDecomposer(const casacore::ImageInterface<T>& image)
    itsMaxIter(256),
    itsConvCriteria(0.001)
 {
-  itsMapPtr = new casacore::TempLattice<casacore::Int>(casacore::TiledShape(itsShape), 1); 
+  itsMapPtr = new casacore::TempLattice<casacore::Int>(casacore::TiledShape(itsShape),
+                                                       mapMaxMemoryInMB); 
   if (!itsMapPtr) {
      delete itsImagePtr;
      throw(casacore::AipsError("Failed to create internal TempLattice"));
@@ -85,7 +96,11 @@ ImageDecomposer<T>::ImageDecomposer(const ImageDecomposer<T>& other)
    itsNRegions(0),
    itsNComponents(0)
 {
-  itsMapPtr = new casacore::TempLattice<casacore::Int>(casacore::TiledShape(itsShape), 1);  
+// Keep the copy in memory if the original is (see decomposeRegion()).
+  const casacore::Double mapMaxMemoryInMB = other.itsMapPtr->isPaged() ? 1
+    : itsShape.product()*sizeof(casacore::Int)/(1024.*1024.) + 1;
+  itsMapPtr = new casacore::TempLattice<casacore::Int>(casacore::TiledShape(itsShape),
+                                                       mapMaxMemoryInMB);  
   if (!itsMapPtr) {
      delete itsImagePtr;
      throw(casacore::AipsError("Failed to create internal TempLattice"));
@@ -1767,81 +1782,165 @@ void ImageDecomposer<T>::decomposeImage()
   // (subcomponentmap) and perform the fitting.  Regions are treated as
   // independent entities by the fitter - even if one region contains a 
   // very high-sigma component that may extend into another region, this
-  // is not taken into account by the other region
-
-    for (casacore::uInt r=0; r<nRegions; r++) {
-
-      // Make a decomposer for this region
-
-      casacore::Slicer sl(blc[r], trc[r]-blc[r], casacore::Slicer::endIsLength);
-      casacore::SubImage<T> subIm(*itsImagePtr, sl);
-      ImageDecomposer<T> subpmap(subIm);
-      subpmap.copyOptions(*this);
+  // is not taken into account by the other region.
+
+  // Since the regions are independent they are decomposed in parallel, in
+  // batches of a few regions per thread so that only a limited number of
+  // subcomponentmaps exist at once.  A region decomposed in parallel is held
+  // in memory, so regions whose bounding box is larger than
+  // maxParallelRegionMB are decomposed one at a time afterwards, with their
+  // temporary images paged to disk as before.  Each batch is added back into
+  // the main component map in region order, so the component list does not
+  // depend on the number of threads.
+
+    const casacore::Double maxParallelRegionMB = 64;
+    casacore::Vector<casacore::Bool> inMemory(nRegions);
+    for (casacore::uInt r = 0; r < nRegions; r++) {
+      const casacore::Double nMB = (trc[r]-blc[r]).product()
+        *(sizeof(T)+sizeof(casacore::Int))/(1024.*1024.);
+      inMemory(r) = nMB <= maxParallelRegionMB;
+    }
 
-      // Flag pixels outside the target region (this makes sure that other
-      // regions that happen to overlap part of the target region's bounding
-      // rectangle are not counted twice, and that only the target region 
-      // pixels are used in fitting.)
-      {
-        casacore::IPosition pos(subpmap.itsDim,0); decrement(pos);
-        while (increment(pos,subpmap.shape())) {     
-          if (thresholdMap.getCell(blc[r] + pos) != casacore::Int(r+1)) {
-            subpmap.setCell(pos, MASKED);
-	  }
+#ifdef _OPENMP
+    const casacore::uInt batchSize = 4*omp_get_max_threads();
+#else
+    const casacore::uInt batchSize = 1;
+#endif
+    casacore::PtrBlock<ImageDecomposer<T>*> subpmaps(batchSize,
+                                   static_cast<ImageDecomposer<T>*>(0));
+    for (casacore::uInt r0=0; r0<nRegions; r0+=batchSize) {
+      const casacore::Int nBatch = casacore::min(batchSize, nRegions-r0);
+      casacore::String err;
+#pragma omp parallel for schedule(dynamic)
+      for (casacore::Int b=0; b<nBatch; b++) {
+        const casacore::uInt r = r0 + b;
+        if (!inMemory(r)) continue;
+        try {
+          subpmaps[b] = decomposeRegion(thresholdMap, r+1, blc[r], trc[r],
+                                        mainContours, true);
+        }
+        catch (const std::exception& x) {
+#pragma omp critical (ImageDecomposer_decomposeImage_err)
+          err = x.what();
         }
       }
-    
-      casacore::Vector<T> subContours(itsNContour);
-      casacore::Vector<T> *contourPtr;
- 
-    // Generate contours for this region or use global 
-    // ones for entire image
-
-      if (varyContours)  {
-        subContours = subpmap.autoContour(itsNContour, itsThresholdVal); 
-        contourPtr = &subContours;
-      } else {
-        contourPtr = &mainContours;
+      for (casacore::Int b=0; b<nBatch && err.empty(); b++) {
+        const casacore::uInt r = r0 + b;
+        if (inMemory(r)) continue;
+        try {
+          subpmaps[b] = decomposeRegion(thresholdMap, r+1, blc[r], trc[r],
+                                        mainContours, false);
+        }
+        catch (const std::exception& x) {
+          err = x.what();
+        }
       }
 
-      if (showProcess)  {    
-        cout << "-----------------------------------------" << endl;
-        cout << "Subimage " << r << endl;
-        cout << "Contour Map:" << endl;
-        subpmap.displayContourMap(*contourPtr);
+  // Add these regions back into the main component map
+
+      for (casacore::Int b=0; b<nBatch; b++) {
+        if (err.empty()) synthesize(*subpmaps[b], blc[r0+b]);
+        delete subpmaps[b];
+        subpmaps[b] = 0;
       }
+      if (!err.empty()) throw(casacore::AipsError(err));
+    }
+  }
+  return;
+}
 
-  // Deblend components in this region
 
-      subpmap.deblendRegions(*contourPtr, itsMinRange, itsNAxis);   
-      if (showProcess) {
-        cout << "Component Map:" << endl;
-        subpmap.display();
-      }
 
-      if (itsFitIt) {
-        // Fit gaussians to region
-          subpmap.fitComponents();  
-      }
-      else {
-        // Just estimate
-        subpmap.itsNComponents = subpmap.itsNRegions;     
-        subpmap.itsList.resize();
-        subpmap.itsList = subpmap.estimateComponents();
-      }
+template <class T>
+ImageDecomposer<T>* ImageDecomposer<T>::decomposeRegion(
+                                     const ImageDecomposer<T>& thresholdMap,
+                                     casacore::uInt region,
+                                     const casacore::IPosition& blc,
+                                     const casacore::IPosition& trc,
+                                     const casacore::Vector<T>& contours,
+                                     casacore::Bool inMemory) const
+{
+  const casacore::Bool showProcess = false;
+
+// Copy the pixels and the threshold map of the bounding box.  The target
+// image and the threshold map are shared by all regions and lattice access
+// is not thread safe, so this is the only step done one region at a time.
+// When decomposed in parallel, the subimage and the subcomponentmap are
+// then given enough memory to be held in memory whatever their size, since
+// disk-based temporary lattices are tables, which several threads may not
+// create and use at once.
 
-      if (showProcess) {
-        cout << "Object " << r+1 << " subcomponents: " << endl;
-        subpmap.printComponents(); 
-        cout << endl;
+  casacore::Slicer sl(blc, trc-blc, casacore::Slicer::endIsLength);
+  casacore::Array<T> subPixels;
+  casacore::Array<casacore::Int> subLabels;
+  casacore::CoordinateSystem subCsys;
+#pragma omp critical (ImageDecomposer_decomposeRegion_read)
+  {
+    casacore::SubImage<T> subIm(*itsImagePtr, sl);
+    subPixels = subIm.get();
+    subCsys = subIm.coordinates();
+    subLabels = thresholdMap.itsMapPtr->getSlice(sl);
+  }
+  const casacore::Double nMB = subPixels.nelements()/(1024.*1024.) + 1;
+  casacore::TempImage<T> subIm(casacore::TiledShape(subPixels.shape()), subCsys,
+                               inMemory ? nMB*sizeof(T) : -1);
+  subIm.put(subPixels);
+
+  ImageDecomposer<T>* subpmap = new ImageDecomposer<T>(subIm,
+                                   inMemory ? nMB*sizeof(casacore::Int) : 1);
+  try {
+    subpmap->copyOptions(*this);
+
+    // Flag pixels outside the target region (this makes sure that other
+    // regions that happen to overlap part of the target region's bounding
+    // rectangle are not counted twice, and that only the target region 
+    // pixels are used in fitting.)
+    {
+      casacore::IPosition pos(subpmap->itsDim,0); decrement(pos);
+      while (increment(pos,subpmap->shape())) {     
+        if (subLabels(pos) != casacore::Int(region)) {
+          subpmap->setCell(pos, MASKED);
+        }
       }
+    }
 
-  // Add this region back into the main component map
+    if (showProcess)  {    
+      cout << "-----------------------------------------" << endl;
+      cout << "Subimage " << region-1 << endl;
+      cout << "Contour Map:" << endl;
+      subpmap->displayContourMap(contours);
+    }
 
-      synthesize(subpmap, blc[r]);     
+  // Deblend components in this region
+
+    subpmap->deblendRegions(contours, itsMinRange, itsNAxis);   
+    if (showProcess) {
+      cout << "Component Map:" << endl;
+      subpmap->display();
+    }
+
+    if (itsFitIt) {
+      // Fit gaussians to region
+      subpmap->fitComponents();  
+    }
+    else {
+      // Just estimate
+      subpmap->itsNComponents = subpmap->itsNRegions;     
+      subpmap->itsList.resize();
+      subpmap->itsList = subpmap->estimateComponents();
+    }
+
+    if (showProcess) {
+      cout << "Object " << region << " subcomponents: " << endl;
+      subpmap->printComponents(); 
+      cout << endl;
     }
   }
-  return;
+  catch (...) {
+    delete subpmap;
+    throw;
+  }
+  return subpmap;
 }
 
 
@@ -35,6 +35,7 @@
 namespace casacore{
 
 template <class T> class MaskedLattice;
+class LatticeProgress;
 }
 
 namespace casa {
@@ -331,6 +332,14 @@ private:
    SPCIIT _image = SPCIIT(nullptr);
    ImageMomentsProgressMonitor* _progressMonitor = nullptr;
 
+   // Compute the moments of all profiles along the moment axis with the given
+   // calculators (one per thread) and write them to the output lattices.
+   void _computeMoments(
+       vector<SHARED_PTR<casacore::MaskedLattice<T> > >& outPt,
+       vector<SHARED_PTR<MomentCalcBase<T> > >& calculators,
+       casacore::LatticeProgress* progress
+   ) const;
+
    // casacore::Smooth an image
    SPIIT _smoothImage();
 
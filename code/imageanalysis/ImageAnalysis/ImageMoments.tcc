@@ -36,6 +36,11 @@
 #include <imageanalysis/ImageAnalysis/MomentClip.h>
 #include <imageanalysis/ImageAnalysis/MomentWindow.h>
 #include <imageanalysis/ImageAnalysis/SepImageConvolver.h>
+#include <lattices/Lattices/LatticeStepper.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace casa {
 
@@ -392,23 +397,30 @@ vector<SHARED_PTR<casacore::MaskedLattice<T> > > ImageMoments<T>::createMoments(
         stdDeviation_p = noise;
     }
 
-    // Create appropriate MomentCalculator object
+    // Create appropriate MomentCalculator objects, one per thread since
+    // they keep per-profile state
     os_p << casacore::LogIO::NORMAL << "Begin computation of moments" << casacore::LogIO::POST;
-    shared_ptr<MomentCalcBase<T> > momentCalculator;
-    if (clipMethod || smoothClipMethod) {
-        momentCalculator.reset(
-            new MomentClip<T>(smoothedImage, *this, os_p, outPt.size())
-        );
-    }
-    else if (windowMethod) {
-        momentCalculator.reset(
-            new MomentWindow<T>(smoothedImage, *this, os_p, outPt.size())
-        );
-    }
-    else if (fitMethod) {
-        momentCalculator.reset(
-            new MomentFit<T>(*this, os_p, outPt.size())
-        );
+    casacore::uInt nThreads = 1;
+#ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+#endif
+    vector<shared_ptr<MomentCalcBase<T> > > momentCalculators(nThreads);
+    for (auto& momentCalculator: momentCalculators) {
+        if (clipMethod || smoothClipMethod) {
+            momentCalculator.reset(
+                new MomentClip<T>(smoothedImage, *this, os_p, outPt.size())
+            );
+        }
+        else if (windowMethod) {
+            momentCalculator.reset(
+                new MomentWindow<T>(smoothedImage, *this, os_p, outPt.size())
+            );
+        }
+        else if (fitMethod) {
+            momentCalculator.reset(
+                new MomentFit<T>(*this, os_p, outPt.size())
+            );
+        }
     }
     // Iterate optimally through the image, compute the moments, fill the output lattices
     unique_ptr<ImageMomentsProgress> pProgressMeter;
@@ -418,20 +430,15 @@ vector<SHARED_PTR<casacore::MaskedLattice<T> > > ImageMoments<T>::createMoments(
             pProgressMeter->setProgressMonitor(_progressMonitor);
         }
     }
-    casacore::uInt n = outPt.size();
-    casacore::PtrBlock<casacore::MaskedLattice<T>* > ptrBlock(n);
-    for (casacore::uInt i=0; i<n; ++i) {
-        ptrBlock[i] = outPt[i].get();
-    }
-    casacore::LatticeApply<T>::lineMultiApply(
-        ptrBlock, *_image, *momentCalculator,
-        momentAxis_p, pProgressMeter.get()
-    );
+    _computeMoments(outPt, momentCalculators, pProgressMeter.get());
     if (windowMethod || fitMethod) {
-        if (momentCalculator->nFailedFits() != 0) {
+        casacore::uInt nFailed = 0;
+        for (const auto& momentCalculator: momentCalculators) {
+            nFailed += momentCalculator->nFailedFits();
+        }
+        if (nFailed != 0) {
             os_p << casacore::LogIO::NORMAL << "There were "
-                <<  momentCalculator->nFailedFits()
-                << " failed fits" << casacore::LogIO::POST;
+                <<  nFailed << " failed fits" << casacore::LogIO::POST;
         }
     }
     for (auto& p: outPt) {
@@ -440,6 +447,154 @@ vector<SHARED_PTR<casacore::MaskedLattice<T> > > ImageMoments<T>::createMoments(
     return outPt;
 }
 
+template <class T> void ImageMoments<T>::_computeMoments(
+    vector<SHARED_PTR<casacore::MaskedLattice<T> > >& outPt,
+    vector<SHARED_PTR<MomentCalcBase<T> > >& calculators,
+    casacore::LatticeProgress* progress
+) const {
+    // The image is read in blocks that span the moment axis and whole tiles
+    // along the other axes, so each tile is read once.  The profiles of a
+    // block are processed in parallel, each thread with its own moment
+    // calculator, and the block of moments is then written to the outputs.
+    const auto& shape = _image->shape();
+    const auto ndim = shape.size();
+    const casacore::Int64 nChan = shape[momentAxis_p];
+    const auto nOut = outPt.size();
+    const casacore::Int nThreads = calculators.size();
+    auto blockShape = _image->niceCursorShape();
+    blockShape[momentAxis_p] = nChan;
+    static const casacore::Int64 maxBlockPixels = 1 << 24;
+    while (blockShape.product() > maxBlockPixels) {
+        casacore::Int longest = -1;
+        for (casacore::uInt i=0; i<ndim; ++i) {
+            if (
+                casacore::Int(i) != momentAxis_p && blockShape[i] > 1
+                && (longest < 0 || blockShape[i] > blockShape[longest])
+            ) {
+                longest = i;
+            }
+        }
+        if (longest < 0) {
+            break;
+        }
+        blockShape[longest] = (blockShape[longest] + 1)/2;
+    }
+    const auto hasMask = _image->isMasked();
+    // calculators that can't handle a null mask get an all good one
+    const auto needMask = hasMask || ! calculators[0]->canHandleNullMask();
+    casacore::IPosition momentAxis(1, momentAxis_p);
+    casacore::LatticeStepper stepper(
+        shape, blockShape, casacore::LatticeStepper::RESIZE
+    );
+    if (progress) {
+        progress->init(casacore::Double(shape.product()/nChan));
+    }
+    casacore::Double nDone = 0;
+    for (stepper.reset(); ! stepper.atEnd(); stepper++) {
+        const auto blc = stepper.position();
+        casacore::Slicer slicer(
+            blc, stepper.endPosition(), casacore::Slicer::endIsLast
+        );
+        auto data = _image->getSlice(slicer);
+        casacore::Array<casacore::Bool> mask;
+        if (hasMask) {
+            mask = _image->getMaskSlice(slicer);
+        }
+        const auto dataShape = data.shape();
+        auto planeShape = dataShape;
+        planeShape[momentAxis_p] = 1;
+        const auto nProfiles = planeShape.product();
+        casacore::Int64 chanStep = 1;
+        for (casacore::Int i=0; i<momentAxis_p; ++i) {
+            chanStep *= dataShape[i];
+        }
+        vector<casacore::Array<T> > outData(nOut);
+        vector<casacore::Array<casacore::Bool> > outMask(nOut);
+        vector<T*> pOutData(nOut);
+        vector<casacore::Bool*> pOutMask(nOut);
+        for (casacore::uInt m=0; m<nOut; ++m) {
+            outData[m].resize(planeShape);
+            outMask[m].resize(planeShape);
+            pOutData[m] = outData[m].data();
+            pOutMask[m] = outMask[m].data();
+        }
+        casacore::Bool deleteData, deleteMask;
+        const T* pData = data.getStorage(deleteData);
+        const casacore::Bool* pMask = hasMask
+            ? mask.getStorage(deleteMask) : nullptr;
+        casacore::String err;
+#pragma omp parallel default(shared) num_threads(nThreads)
+        {
+            casacore::Int thread = 0;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            auto& calc = *calculators[thread];
+            casacore::Vector<T> profile(nChan);
+            casacore::Vector<casacore::Bool> profileMask(needMask ? nChan : 0, true);
+            casacore::Vector<T> moments(nOut);
+            casacore::Vector<casacore::Bool> momentsMask(nOut);
+#pragma omp for schedule(dynamic)
+            for (casacore::Int64 k=0; k<nProfiles; ++k) {
+                auto pos = casacore::toIPositionInArray(k, planeShape);
+                const auto base = casacore::toOffsetInArray(pos, dataShape);
+                for (casacore::Int64 c=0; c<nChan; ++c) {
+                    profile[c] = pData[base + c*chanStep];
+                }
+                if (pMask) {
+                    for (casacore::Int64 c=0; c<nChan; ++c) {
+                        profileMask[c] = pMask[base + c*chanStep];
+                    }
+                }
+                pos += blc;
+                try {
+                    calc.multiProcess(
+                        moments, momentsMask, profile, profileMask, pos
+                    );
+                }
+                catch (const casacore::AipsError& x) {
+#pragma omp critical (ImageMoments_computeMoments)
+                    err = x.getMesg();
+                    moments = 0;
+                    momentsMask = false;
+                }
+                for (casacore::uInt m=0; m<nOut; ++m) {
+                    pOutData[m][k] = moments[m];
+                    pOutMask[m][k] = momentsMask[m];
+                }
+            }
+        }
+        data.freeStorage(pData, deleteData);
+        if (pMask) {
+            mask.freeStorage(pMask, deleteMask);
+        }
+        ThrowIf(! err.empty(), err);
+        auto outPos = blc;
+        outPos[momentAxis_p] = 0;
+        for (casacore::uInt m=0; m<nOut; ++m) {
+            auto& lattice = *outPt[m];
+            // the moment axis may have been removed from the output
+            auto latticePos = lattice.ndim() < ndim
+                ? outPos.removeAxes(momentAxis) : outPos;
+            auto latticeShape = lattice.ndim() < ndim
+                ? planeShape.removeAxes(momentAxis) : planeShape;
+            lattice.putSlice(outData[m].reform(latticeShape), latticePos);
+            if (lattice.isMasked() && lattice.isMaskWritable()) {
+                lattice.pixelMask().putSlice(
+                    outMask[m].reform(latticeShape), latticePos
+                );
+            }
+        }
+        if (progress) {
+            nDone += nProfiles;
+            progress->nstepsDone(nDone);
+        }
+    }
+    if (progress) {
+        progress->done();
+    }
+}
+
 template <class T> SPIIT ImageMoments<T>::_smoothImage() {
     // casacore::Smooth image.   casacore::Input masked pixels are zerod before smoothing.
     // The output smoothed image is masked as well to reflect
@@ -97,6 +97,9 @@ template <class T> void MomentClip<T>::multiProcess(
     if (_ancilliaryLattice && (doInclude_p || doExclude_p)) {
         casacore::Array<T> ancilliarySlice;
         casacore::IPosition stride(_ancilliaryLattice->ndim(),1);
+        // Profiles may be processed in parallel, lattice access is not
+        // thread safe
+#pragma omp critical (MomentCalc_ancilliaryLattice)
         _ancilliaryLattice->getSlice(
             ancilliarySlice, inPos, sliceShape_p, stride, true
         );
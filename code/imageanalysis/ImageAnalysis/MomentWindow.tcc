@@ -151,6 +151,8 @@ void MomentWindow<T>::multiProcess(casacore::Vector<T>& moments,
    if (_ancilliaryLattice) {
       casacore::Array<T> ancilliarySlice;
       casacore::IPosition stride(_ancilliaryLattice->ndim(),1);
+      // Profiles may be processed in parallel, lattice access is not thread safe
+#pragma omp critical (MomentCalc_ancilliaryLattice)
       _ancilliaryLattice->getSlice(ancilliarySlice, inPos,
                                sliceShape_p, stride, true);
       ancilliarySliceRef_p.reference(ancilliarySlice);
@@ -165,8 +167,8 @@ void MomentWindow<T>::multiProcess(casacore::Vector<T>& moments,
 
 // Make abcissa and labels
    
-   static casacore::Vector<casacore::Int> window(2);  
-   static casacore::Int nPts = 0;
+   casacore::Vector<casacore::Int> window(2);
+   casacore::Int nPts = 0;
       
    abcissa_p.resize(pProfileSelect_p->size());
    indgen(abcissa_p);
@@ -30,11 +30,11 @@
 #include <measures/Measures/MDirection.h>
 #include <tables/Tables/PlainTable.h>
 
-#include <imageanalysis/ImageAnalysis/ImageCollapser.h>
-#include <imageanalysis/ImageAnalysis/ImageMetaData.h>
-#include <imageanalysis/ImageAnalysis/ImagePadder.h>
-#include <imageanalysis/ImageAnalysis/ImageRotator.h>
+#include <images/Images/ImageUtilities.h>
+#include <images/Images/TempImage.h>
 #include <imageanalysis/ImageAnalysis/SubImageFactory.h>
+#include <lattices/Lattices/LatticeStepper.h>
+#include <scimath/Mathematics/Interpolate2D.h>
 
 #include <iomanip>
 
@@ -265,72 +265,224 @@ SPIIF PVGenerator::generate() const {
         // check already done when setting the points if _width == 1
         _checkWidthSanity(paInRad, halfwidth, start, end, subImage, xAxis, yAxis);
     }
-    _moveRefPixel(subImage, subCoords, start, end, paInRad, xAxis, yAxis);
-    auto rotated = _doRotate(
-        subImage, start, end, 
-        xAxis, yAxis, halfwidth, paInRad
-    ); 
-    // done with this pointer
-    subImage.reset();
-    Vector<Double> origStartPixel(subShape.size(), 0);
-    origStartPixel[xAxis] = start[0];
-    origStartPixel[yAxis] = start[1];
-    Vector<Double> origEndPixel(subShape.size(), 0);
-    origEndPixel[xAxis] = end[0];
-    origEndPixel[yAxis] = end[1];
-    auto startWorld = subCoords.toWorld(origStartPixel);
-    auto endWorld = subCoords.toWorld(origEndPixel);
-    const auto& rotCoords = rotated->coordinates();
-    auto rotPixStart = rotCoords.toPixel(startWorld);
-    auto rotPixEnd = rotCoords.toPixel(endWorld);
-    Double xdiff = fabs(end[0] - start[0]);
-    Double ydiff = fabs(end[1] - start[1]);
-    _checkRotatedImageSanity(
-        rotated, rotPixStart, rotPixEnd,
-        xAxis, yAxis, xdiff, ydiff
-    );
     Int collapsedAxis;
-    auto collapsed = _doCollapse(
-        collapsedAxis, rotated, xAxis, yAxis, rotPixStart, rotPixEnd, halfwidth
+    auto collapsed = _doSample(
+        collapsedAxis, subImage, start, end, xAxis, yAxis, halfwidth, paInRad
     );
     return _dropDegen(collapsed, collapsedAxis);
 }
 
-SPIIF PVGenerator::_doCollapse(
-    Int& collapsedAxis, SPCIIF rotated, Int xAxis, Int yAxis, const Vector<Double>& rotPixStart,
-    const Vector<Double>& rotPixEnd, Double halfwidth
+SPIIF PVGenerator::_doSample(
+    Int& collapsedAxis, SPCIIF subImage, const vector<Double>& start,
+    const vector<Double>& end, Int xAxis, Int yAxis, Double halfwidth,
+    Double paInRad
 ) const {
-    IPosition blc(rotated->ndim(), 0);
-    auto trc = rotated->shape() - 1;
-    blc[xAxis] = (Int)(rotPixStart[xAxis] + 0.5);
-    blc[yAxis] = (Int)(rotPixStart[yAxis] + 0.5 - halfwidth);
-    trc[xAxis] = (Int)(rotPixEnd[xAxis] + 0.5);
-    trc[yAxis] = (Int)(rotPixEnd[yAxis] + 0.5 + halfwidth);
-    auto lcbox = (Record)LCBox(blc, trc, rotated->shape()).toRecord("");
-    IPosition axes(1, yAxis);
-    ImageCollapser<Float> collapser(
-        "mean", rotated, &lcbox, "", axes, false, "", false
+    // The image is sampled directly at unit pixel spacing along the slice,
+    // and at unit spacing perpendicular to it out to the half width. Samples
+    // on pixel centres take the pixel values, the others use the same cubic
+    // interpolation the image rotator uses where possible. The path is
+    // processed in segments so only the part of the image around each segment
+    // is read, and the planes (channels etc.) of a segment are sampled in
+    // parallel.
+    static const Int segmentLength = 64;
+    static const Int64 maxChunkPixels = 1 << 24;
+    const auto& shape = subImage->shape();
+    const auto ndim = shape.size();
+    Double dx = end[0] - start[0];
+    Double dy = end[1] - start[1];
+    Double length = sqrt(dx*dx + dy*dy);
+    Int nSamples = (Int)(length + 0.5) + 1;
+    // unit vectors along and perpendicular to the slice
+    Double ux = dx/length;
+    Double uy = dy/length;
+    Double vx = -uy;
+    Double vy = ux;
+    Int hw = (Int)halfwidth;
+    auto outShape = shape;
+    outShape[xAxis] = nSamples;
+    outShape[yAxis] = 1;
+    Array<Float> outData(outShape, 0.0f);
+    Array<Bool> outMask(outShape, false);
+    auto hasMask = subImage->isMasked();
+    for (Int seg0 = 0; seg0 < nSamples; seg0 += segmentLength) {
+        Int seg1 = min(seg0 + segmentLength, nSamples) - 1;
+        // bounding box of this segment, with a margin for the interpolation
+        // kernel
+        Double xmin = min(start[0] + seg0*ux, start[0] + seg1*ux) - hw*fabs(vx);
+        Double xmax = max(start[0] + seg0*ux, start[0] + seg1*ux) + hw*fabs(vx);
+        Double ymin = min(start[1] + seg0*uy, start[1] + seg1*uy) - hw*fabs(vy);
+        Double ymax = max(start[1] + seg0*uy, start[1] + seg1*uy) + hw*fabs(vy);
+        IPosition boxBlc(ndim, 0);
+        auto boxTrc = shape - 1;
+        boxBlc[xAxis] = max((Int64)floor(xmin) - 2, (Int64)0);
+        boxBlc[yAxis] = max((Int64)floor(ymin) - 2, (Int64)0);
+        boxTrc[xAxis] = min((Int64)ceil(xmax) + 2, (Int64)shape[xAxis] - 1);
+        boxTrc[yAxis] = min((Int64)ceil(ymax) + 2, (Int64)shape[yAxis] - 1);
+        if (boxBlc[xAxis] > boxTrc[xAxis] || boxBlc[yAxis] > boxTrc[yAxis]) {
+            continue;
+        }
+        auto boxShape = boxTrc - boxBlc + 1;
+        // read as many planes of the box at once as fit in the chunk size
+        auto chunkShape = boxShape;
+        while (chunkShape.product() > maxChunkPixels) {
+            Int longest = -1;
+            for (uInt i=0; i<ndim; ++i) {
+                if (
+                    (Int)i != xAxis && (Int)i != yAxis && chunkShape[i] > 1
+                    && (longest < 0 || chunkShape[i] > chunkShape[longest])
+                ) {
+                    longest = i;
+                }
+            }
+            if (longest < 0) {
+                break;
+            }
+            chunkShape[longest] = (chunkShape[longest] + 1)/2;
+        }
+        LatticeStepper stepper(boxShape, chunkShape, LatticeStepper::RESIZE);
+        for (stepper.reset(); ! stepper.atEnd(); stepper++) {
+            auto chunkBlc = boxBlc + stepper.position();
+            Slicer slicer(
+                chunkBlc, boxBlc + stepper.endPosition(), Slicer::endIsLast
+            );
+            auto data = subImage->getSlice(slicer);
+            Array<Bool> mask;
+            if (hasMask) {
+                mask = subImage->getMaskSlice(slicer);
+            }
+            const auto dataShape = data.shape();
+            auto planeShape = dataShape;
+            planeShape[xAxis] = 1;
+            planeShape[yAxis] = 1;
+            const auto nPlanes = planeShape.product();
+            const Int64 nx = dataShape[xAxis];
+            const Int64 ny = dataShape[yAxis];
+            IPosition unitx(ndim, 0);
+            unitx[xAxis] = 1;
+            IPosition unity(ndim, 0);
+            unity[yAxis] = 1;
+            const auto xStep = toOffsetInArray(unitx, dataShape);
+            const auto yStep = toOffsetInArray(unity, dataShape);
+            Bool deleteData, deleteMask;
+            const Float* pData = data.getStorage(deleteData);
+            const Bool* pMask = hasMask ? mask.getStorage(deleteMask) : nullptr;
+#pragma omp parallel default(shared)
+            {
+                // Interpolate2D is cheap to make, so each thread has its own
+                Interpolate2D cubic(Interpolate2D::CUBIC);
+                Interpolate2D linear(Interpolate2D::LINEAR);
+                Interpolate2D nearest(Interpolate2D::NEAREST);
+                Matrix<Float> plane(nx, ny);
+                Matrix<Bool> planeMask;
+                if (pMask) {
+                    planeMask.resize(nx, ny);
+                }
+                const Matrix<Bool>* maskPtr = pMask ? &planeMask : nullptr;
+                Vector<Double> where(2);
+                Float value;
+                // Value of the plane at (x, y). Integer positions, such as
+                // all samples of a slice along a pixel row, take the pixel
+                // itself. Elsewhere cubic interpolation is used, falling
+                // back to linear and then nearest where the cubic kernel
+                // runs off the box or into the mask.
+                auto sample = [&](Double x, Double y) -> Bool {
+                    auto i = (Int64)round(x);
+                    auto j = (Int64)round(y);
+                    if (fabs(x - i) < 1e-6 && fabs(y - j) < 1e-6) {
+                        if (
+                            i < 0 || j < 0 || i >= nx || j >= ny
+                            || (pMask && ! planeMask(i, j))
+                        ) {
+                            return false;
+                        }
+                        value = plane(i, j);
+                        return true;
+                    }
+                    where[0] = x;
+                    where[1] = y;
+                    return cubic.interp(value, where, plane, maskPtr)
+                        || linear.interp(value, where, plane, maskPtr)
+                        || nearest.interp(value, where, plane, maskPtr);
+                };
+#pragma omp for schedule(dynamic)
+                for (Int64 p=0; p<nPlanes; ++p) {
+                    auto pos = toIPositionInArray(p, planeShape);
+                    const auto base = toOffsetInArray(pos, dataShape);
+                    for (Int64 j=0; j<ny; ++j) {
+                        for (Int64 i=0; i<nx; ++i) {
+                            auto off = base + i*xStep + j*yStep;
+                            plane(i, j) = pData[off];
+                            if (pMask) {
+                                planeMask(i, j) = pMask[off];
+                            }
+                        }
+                    }
+                    auto outPos = pos + chunkBlc;
+                    for (Int k=seg0; k<=seg1; ++k) {
+                        Double sum = 0;
+                        Int n = 0;
+                        for (Int w=-hw; w<=hw; ++w) {
+                            if (
+                                sample(
+                                    start[0] + k*ux + w*vx - boxBlc[xAxis],
+                                    start[1] + k*uy + w*vy - boxBlc[yAxis]
+                                )
+                            ) {
+                                sum += value;
+                                ++n;
+                            }
+                        }
+                        outPos[xAxis] = k;
+                        outPos[yAxis] = 0;
+                        if (n > 0) {
+                            outData(outPos) = sum/n;
+                            outMask(outPos) = true;
+                        }
+                    }
+                }
+            }
+            data.freeStorage(pData, deleteData);
+            if (pMask) {
+                mask.freeStorage(pMask, deleteMask);
+            }
+        }
+    }
+    // The direction coordinate of the sampled image is the one rotated to
+    // align its x axis with the slice, with pixel (0, 0) at the start point.
+    // It is kept as the secondary coordinate system.
+    auto coords = subImage->coordinates();
+    const auto& dc = coords.directionCoordinate();
+    std::unique_ptr<DirectionCoordinate> rotCoord(
+        dynamic_cast<DirectionCoordinate *>(
+            dc.rotate(Quantity(paInRad, "rad"))
+        )
     );
-    SPIIF collapsed = collapser.collapse();
-    auto newRefPix = rotated->coordinates().referencePixel();
-    newRefPix[xAxis] = rotPixStart[xAxis] - blc[xAxis];
-    newRefPix[yAxis] = rotPixStart[yAxis] - blc[yAxis];
+    Vector<Double> worldStart, startPixRot;
+    dc.toWorld(worldStart, Vector<Double>(start));
+    rotCoord->toPixel(startPixRot, worldStart);
+    rotCoord->setReferencePixel(rotCoord->referencePixel() - startPixRot);
+    coords.replaceCoordinate(*rotCoord, coords.directionCoordinateNumber());
+    SPIIF collapsed(new TempImage<Float>(outShape, coords));
+    collapsed->put(outData);
+    if (! allTrue(outMask)) {
+        dynamic_cast<TempImage<Float> *>(collapsed.get())->attachMask(
+            ArrayLattice<Bool>(outMask)
+        );
+    }
+    ImageUtilities::copyMiscellaneous(*collapsed, *subImage, true);
     auto collCoords = collapsed->coordinates();
+    const auto& collDC = collCoords.directionCoordinate();
+    collapsedAxis = collCoords.directionAxesNumbers()[1];
 
     // to determine the pixel increment of the angular offset axis, get the
     // distance between the end points
-    ImageMetaData md(collapsed);
-    Vector<Int> dirShape = md.directionShape();
-    AlwaysAssert(dirShape[1] == 1, AipsError);
-    const auto& dc = collCoords.directionCoordinate();
-    collapsedAxis = collCoords.directionAxesNumbers()[1];
     Vector<Double> pixStart(2, 0);
-    auto collapsedStart = dc.toWorld(pixStart);
+    auto collapsedStart = collDC.toWorld(pixStart);
     Vector<Double> pixEnd(2, 0);
-    pixEnd[0] = dirShape[0];
-    MVDirection collapsedEnd = dc.toWorld(pixEnd);
+    pixEnd[0] = nSamples;
+    MVDirection collapsedEnd = collDC.toWorld(pixEnd);
     auto separation = collapsedEnd.separation(
-        collapsedStart, dc.worldAxisUnits()[0]
+        collapsedStart, collDC.worldAxisUnits()[0]
     );
     // The new coordinate must have the same number of axes as the coordinate
     // it replaces, so 2 for the linear coordinate, we will remove the degenerate
@@ -338,11 +490,11 @@ SPIIF PVGenerator::_doCollapse(
     Vector<String> axisName(2, "Offset");
     Vector<String> axisUnit(2, _unit);
     Vector<Double> crval(2, 0);
-    Vector<Double> cdelt(2, separation.getValue(axisUnit[0])/dirShape[0]);
+    Vector<Double> cdelt(2, separation.getValue(axisUnit[0])/nSamples);
     Matrix<Double> xform(2, 2, 1);
     xform(0, 1) = 0;
     xform(1, 0) = 0;
-    Vector<Double> crpix(2, (dirShape[0] - 1)/2);
+    Vector<Double> crpix(2, (nSamples - 1)/2);
     LinearCoordinate lc(
         axisName, axisUnit, crval,
         cdelt, xform, crpix
@@ -383,144 +535,6 @@ SPIIF PVGenerator::_dropDegen(SPIIF collapsed, Int collapsedAxis) const {
     return _prepareOutputImage(*cDropped, 0, newMask.get());
 }
 
-SPCIIF PVGenerator::_doRotate(
-    SPIIF subImage, const vector<Double>& start, const vector<Double>& end,
-    Int xAxis, Int yAxis, Double halfwidth, Double paInRad
-) const {
-    Vector<Double> worldStart, worldEnd;
-    const auto& dc1 = subImage->coordinates().directionCoordinate();
-    dc1.toWorld(worldStart, Vector<Double>(start));
-    dc1.toWorld(worldEnd, Vector<Double>(end));
-    std::unique_ptr<DirectionCoordinate> rotCoord(
-        dynamic_cast<DirectionCoordinate *>(
-            dc1.rotate(Quantity(paInRad, "rad"))
-        )
-    );
-    Vector<Double> startPixRot, endPixRot;
-    rotCoord->toPixel(startPixRot, worldStart);
-    rotCoord->toPixel(endPixRot, worldEnd);
-    AlwaysAssert(abs(startPixRot[1] - endPixRot[1]) < 1e-6, AipsError);
-    Double xdiff = fabs(end[0] - start[0]);
-    Double ydiff = fabs(end[1] - start[1]);
-    AlwaysAssert(
-        abs(
-            (endPixRot[0] - startPixRot[0])
-            - sqrt(xdiff*xdiff + ydiff*ydiff)
-        ) < 1e-6, AipsError
-    );
-    Double padNumber = max(0.0, 1 - startPixRot[0]);
-    padNumber = max(padNumber, -(startPixRot[1] - halfwidth - 1));
-    auto imageToRotate = subImage;
-    Int nPixels = 0;
-    if (padNumber > 0) {
-        nPixels = (Int)padNumber + 1;
-        *_getLog() << LogIO::NORMAL
-            << "Some pixels will fall outside the rotated image, so "
-            << "padding before rotating with " << nPixels << " pixels."
-            << LogIO::POST;
-        ImagePadder padder(subImage);
-        padder.setPaddingPixels(nPixels);
-        auto padded = padder.pad(true);
-        imageToRotate = padded;
-    }
-    IPosition blc(subImage->ndim(), 0);
-    auto subShape = subImage->shape();
-    auto trc = subShape - 1;
-    // ensure we have enough real estate after the rotation
-    blc[xAxis] = (Int)min(min(start[0], end[0]) - 1 - halfwidth, 0.0);
-    blc[yAxis] = (Int)min(min(start[1], end[1]) - 1 - halfwidth, 0.0);
-    trc[xAxis] = (Int)max(
-        max(start[0], end[0]) + 1 + halfwidth,
-        blc[xAxis] + (Double)subShape[xAxis] - 1
-    ) + nPixels;
-    trc[yAxis] = (Int)max(
-        max(start[1], end[1]) + 1 + halfwidth,
-        (Double)subShape[yAxis] - 1
-    ) + nPixels;
-    Record lcbox = LCBox(blc, trc, imageToRotate->shape()).toRecord("");
-    SPIIF rotated;
-    if (paInRad == 0) {
-        *_getLog() << LogIO::NORMAL << "Slice is along x-axis, no rotation necessary.";
-        return SubImageFactory<Float>::createSubImageRW(
-            *imageToRotate, lcbox, "", 0, AxesSpecifier(), true
-        );
-    }
-    else {
-        auto outShape = subShape;
-        outShape[xAxis] = (Int)(endPixRot[0] + nPixels + 6);
-        outShape[yAxis] = (Int)(startPixRot[1] + halfwidth) + nPixels + 6;
-        ImageRotator rotator(imageToRotate, &lcbox, "", "", false);
-        rotator.setAngle(Quantity(paInRad, "rad"));
-        rotator.setShape(outShape);
-        return rotator.rotate();
-    }
-}
-
-void PVGenerator::_checkRotatedImageSanity(
-    SPCIIF rotated, const Vector<Double>& rotPixStart, const Vector<Double>& rotPixEnd,
-    Int xAxis, Int yAxis, Double xdiff, Double ydiff
-) const {
-    // sanity checks, can be removed when this is well tested and used without issue
-    // The rotated start and end pixels should lie in the image
-    auto rotShape = rotated->shape();
-    for (uInt i=0; i<2 ;i++) {
-        Int64 shape = i == 0 ? rotShape[xAxis] : rotShape[yAxis];
-        AlwaysAssert(
-            rotPixStart[i] > 0 && rotPixEnd[i] > 0
-            && rotPixStart[i] < shape - 1 && rotPixEnd[i] < shape - 1,
-            AipsError
-        );
-    }
-
-    // We've rotated to make the slice coincident with the x axis, therefore, the y axis
-    // values of the endpoints should be equal
-    AlwaysAssert(abs(rotPixStart[yAxis] - rotPixEnd[yAxis]) < 1e-6, AipsError);
-    // the difference in the x axis coordinate of rotated endpoints should simply be
-    // the distance between those points before rotation
-    AlwaysAssert(
-        abs(
-            (rotPixEnd[xAxis] - rotPixStart[xAxis])
-            - sqrt(xdiff*xdiff + ydiff*ydiff)
-        ) < 1e-6, AipsError
-    );
-    // CAS-6043, because it's possible for the above conditions to be true but the y values to still be
-    // just a little different and on either side of the 0.5 pixel mark
-    //rotPixEnd[yAxis] = rotPixStart[yAxis];
-    // We have rotated so the position of the starting pixel x is smaller than
-    // the ending pixel x.
-    AlwaysAssert(rotPixStart[xAxis] < rotPixEnd[xAxis], AipsError);
-}
-
-void PVGenerator::_moveRefPixel(
-    SPIIF subImage, CoordinateSystem& subCoords, const vector<Double>& start,
-    const vector<Double>& end, Double paInRad, Int xAxis, Int yAxis
-) const {
-    // rotation occurs about the reference pixel, so move the reference pixel to be
-    // on the segment, near the midpoint so that the y value is an integer.
-    vector<Double> midpoint(end.size());
-    // THESE CAN EASILLY BE CHANGED TO ONE PASS WITH C++11 AND LAMBDA FUNCTIONS
-    std::transform( end.begin( ), end.end( ), start.begin( ), midpoint.begin( ), std::plus<double>( ) );
-    std::transform( midpoint.begin( ), midpoint.end( ), midpoint.begin( ), std::bind2nd(std::divides<double>(),2.0) );
-    Double targety = int(midpoint[1]);
-    Double targetx = (near(targety, midpoint[1], 1e-8))
-        ? midpoint[0]
-        : (
-            start[0]*(end[1] - targety) + end[0]*(targety - start[1])
-        )/(end[1] - start[1]);
-    Vector<Double> newRefPix = subCoords.referencePixel();
-    newRefPix[xAxis] = targetx;
-    newRefPix[yAxis] = targety;
-    Vector<Double> newRefVal;
-    subCoords.toWorld(newRefVal, newRefPix);
-    subCoords.setReferencePixel(newRefPix);
-    subCoords.setReferenceValue(newRefVal);
-    subImage->setCoordinateInfo(subCoords);
-    // rotate the image through this angle, in the opposite direction.
-    *_getLog() << LogIO::NORMAL << "Rotating image by " << (paInRad*180/C::pi)
-        << " degrees about direction coordinate pixel (" << targetx << ", " << targety
-        << ") to align specified slice with the x axis" << LogIO::POST;
-}
-
 void PVGenerator::_checkWidthSanity(
     Double paInRad, Double halfwidth, const vector<Double>& start,
     const vector<Double>& end, SPCIIF subImage, Int xAxis, Int yAxis
@@ -130,7 +130,7 @@ public:
     // should occur. Must be odd and >= 1. 1 => just use the pixels coincident with the slice
     // (no averaging). 3 => Average three pixels, one pixel on either side of the slice and the
     // pixel lying on the slice.
-    // Note this average is done after the image has been rotated.
+    // The image is interpolated at unit pixel spacing along and across the slice.
     void setWidth(casacore::uInt width);
     // This will set the width by rounding <src>q</src> up so that the width is an odd number of pixels.
     void setWidth(const casacore::Quantity& q);
@@ -166,20 +166,13 @@ private:
     // disallow default constructor
     PVGenerator();
 
-    void _checkRotatedImageSanity(
-        SPCIIF rotated, const Vector<Double>& rotPixStart,
-        const Vector<Double>& rotPixEnd, Int xAxis, Int yAxis,
-        Double xdiff, Double ydiff
-    ) const;
-
-    SPIIF _doCollapse(
-        Int& collapsedAxis, SPCIIF rotated, Int xAxis, Int yAxis, const Vector<Double>& rotPixStart,
-        const Vector<Double>& rotPixEnd, Double halfwidth
-    ) const;
-
-    SPCIIF _doRotate(
-        SPIIF subImage, const vector<Double>& start, const vector<Double>& end,
-        Int xAxis, Int yAxis, Double halfwidth, Double paInRad
+    // Sample the image along the slice, averaging over the width, and give
+    // the result the offset coordinate. collapsedAxis is set to the
+    // degenerate axis perpendicular to the slice.
+    SPIIF _doSample(
+        Int& collapsedAxis, SPCIIF subImage, const vector<Double>& start,
+        const vector<Double>& end, Int xAxis, Int yAxis, Double halfwidth,
+        Double paInRad
     ) const;
 
     SPIIF _dropDegen(SPIIF collapsed, Int collapsedAxis) const;
@@ -193,11 +186,6 @@ private:
 
     casacore::Quantity _increment() const;
 
-    void _moveRefPixel(
-        SPIIF subImage, CoordinateSystem& subCoords, const vector<Double>& start,
-        const vector<Double>& end, Double paInRad, Int xAxis, Int yAxis
-    ) const;
-    
     static casacore::String _pairToString(const std::pair<casacore::Double, casacore::Double>& p);
 
 };
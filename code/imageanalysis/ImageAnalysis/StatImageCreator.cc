@@ -6,6 +6,8 @@
 #include <imageanalysis/Annotations/AnnCircle.h>
 #include <casacore/lattices/LEL/LatticeExpr.h>
 
+#include <atomic>
+
 namespace casa {
 
 const Double StatImageCreator::PHI = 1.482602218505602;
@@ -175,9 +177,6 @@ void StatImageCreator::_computeStat(
     }
     auto imshape = subImage->shape();
     auto ndim = imshape.size();
-    IPosition chunkShape(ndim, 1);
-    chunkShape[_dirAxes[0]] = xChunkSize;
-    chunkShape[_dirAxes[1]] = yChunkSize;
     auto xsize = imshape[_dirAxes[0]];
     auto ysize = imshape[_dirAxes[1]];
     IPosition planeShape(imshape.size(), 1);
@@ -186,25 +185,17 @@ void StatImageCreator::_computeStat(
     RO_MaskedLatticeIterator<Float> lattIter (
         *subImage, planeShape, True
     );
-    // Vector rather than IPosition because blc values can be negative
-    Vector<Int> blc(ndim, 0);
-    blc[_dirAxes[0]] = xstart - xBlcOff;
-    blc[_dirAxes[1]] = ystart - yBlcOff;
     String algName;
-    auto alg = _getStatsAlgorithm(algName);
+    _getStatsAlgorithm(algName);
     std::set<StatisticsData::STATS> statToCompute;
     statToCompute.insert(_statType);
-    alg->setStatsToCalculate(statToCompute);
     auto ngrid = nxpts*nypts;
     auto nPts = ngrid;
-    IPosition loopAxes;
     for (uInt i=0; i<ndim; ++i) {
         if (i != _dirAxes[0] && i != _dirAxes[1]) {
-            loopAxes.append(IPosition(1, i));
             nPts *= imshape[i];
         }
     }
-    auto hasLoopAxes = loopAxes.size() > 0;
     ProgressMeter pm(0, nPts, "Processing stats at grid points");
     auto doCircle = _ylen.getValue() <= 0;
     *_getLog() << LogOrigin(getClass(), __func__) << LogIO::NORMAL
@@ -226,119 +217,314 @@ void StatImageCreator::_computeStat(
     *_getLog() << ") to choose pixels for computing " << _statName
         << " using the " << algName << " algorithm around each of "
         << ngrid << " grid points in " << (nPts/ngrid) << " planes." << LogIO::POST;
-    IPosition planeBlc(ndim, 0);
-    auto& xPlaneBlc = planeBlc[_dirAxes[0]];
-    auto& yPlaneBlc = planeBlc[_dirAxes[1]];
-    auto imageChunkShape = chunkShape;
-    // pixels at the TRC are included in the statistics
-    auto planeTrc = planeBlc + chunkShape - 1;
-    auto& xPlaneTrc = planeTrc[_dirAxes[0]];
-    auto& yPlaneTrc = planeTrc[_dirAxes[1]];
+    // Statistics that only need the number of points, the sum and the sum of
+    // squares are computed from running (prefix) sums along the rows of the
+    // plane, so the cost per grid point is proportional to the number of rows
+    // in the region rather than to its area. Other statistics are computed
+    // from the pixels of each region.
+    auto useSums = _getAlgConf().algorithm == StatisticsData::CLASSICAL
+        && (
+            _statType == StatisticsData::MEAN
+            || _statType == StatisticsData::NPTS
+            || _statType == StatisticsData::RMS
+            || _statType == StatisticsData::STDDEV
+            || _statType == StatisticsData::SUM
+            || _statType == StatisticsData::SUMSQ
+            || _statType == StatisticsData::VARIANCE
+        );
+    // the x ranges, relative to the region blc, of the pixels in each row
+    // of the region
+    std::vector<std::vector<std::pair<Int, Int>>> spans(yChunkSize);
+    if (useSums) {
+        IPosition regPos(ndim, 0);
+        for (uInt r=0; r<yChunkSize; ++r) {
+            regPos[_dirAxes[1]] = r;
+            Int first = -1;
+            for (uInt x=0; x<=xChunkSize; ++x) {
+                Bool good = x < xChunkSize;
+                if (good && regionMask) {
+                    regPos[_dirAxes[0]] = x;
+                    good = (*regionMask)(regPos);
+                }
+                if (good && first < 0) {
+                    first = x;
+                }
+                else if (! good && first >= 0) {
+                    spans[r].push_back(std::make_pair(first, (Int)x - 1));
+                    first = -1;
+                }
+            }
+        }
+    }
+    IPosition outShape(ndim, 1);
+    outShape[_dirAxes[0]] = nxpts;
+    outShape[_dirAxes[1]] = nypts;
+    // memory steps along the direction axes in the plane and output arrays
+    Int64 xStep = 1;
+    Int64 yStep = 1;
+    Int64 xOutStep = 1;
+    Int64 yOutStep = 1;
+    for (uInt i=0; i<_dirAxes[0]; ++i) {
+        xStep *= planeShape[i];
+        xOutStep *= outShape[i];
+    }
+    for (uInt i=0; i<_dirAxes[1]; ++i) {
+        yStep *= planeShape[i];
+        yOutStep *= outShape[i];
+    }
+    const auto ximshape = (Int)xsize;
+    const auto yimshape = (Int)ysize;
     uInt nCount = 0;
-    auto ximshape = imshape[_dirAxes[0]];
-    auto yimshape = imshape[_dirAxes[1]];
     for (lattIter.atStart(); ! lattIter.atEnd(); ++lattIter) {
-        auto plane = lattIter.cursor();
-        auto lattMask = lattIter.getMask();
-        auto outPos = lattIter.position();
-        auto& xOutPos = outPos[_dirAxes[0]];
-        auto& yOutPos = outPos[_dirAxes[1]];
-        Int yblc = ystart - yBlcOff;
-        for (uInt yCount=0; yCount<nypts; ++yCount, yblc+=_grid.second) {
-            yOutPos = yCount;
-            yPlaneBlc = max(0, yblc);
-            yPlaneTrc = min(
-                yblc + (Int)yChunkSize - 1, (Int)yimshape - 1
-            );
+        const auto& plane = lattIter.cursor();
+        const auto lattMask = lattIter.getMask();
+        Array<Float> outPlane(outShape, 0.0f);
+        Array<Bool> outMask(outShape, True);
+        Bool deletePlane, deleteMask;
+        const Float* pPlane = plane.getStorage(deletePlane);
+        const Bool* pMask = lattMask.getStorage(deleteMask);
+        Float* pOut = outPlane.data();
+        Bool* pOutMask = outMask.data();
+        // The running sums are of the pixel values less the mean of the
+        // plane, so that the variance of a window does not come from the
+        // difference of two large, nearly equal sums when the mean is
+        // large compared with the spread
+        Double shift = 0;
+        if (useSums) {
+            Double n = 0;
+            for (Int y=0; y<yimshape; ++y) {
+                for (Int x=0; x<ximshape; ++x) {
+                    auto off = x*xStep + y*yStep;
+                    if (pMask[off]) {
+                        shift += pPlane[off];
+                        ++n;
+                    }
+                }
+            }
+            if (n > 0) {
+                shift /= n;
+            }
+        }
+        String err;
+        // set once err is, so that threads can stop without reading err
+        std::atomic<Bool> failed(False);
+        // rows of grid points are shared among threads, each with its own
+        // statistics algorithm and row sums
+#pragma omp parallel default(shared)
+        {
+            SHARED_PTR<StatisticsAlgorithm<
+                Double, Array<Float>::const_iterator, Array<Bool>::const_iterator>
+            > myAlg;
+            String myAlgName;
+            // running sums, one row of the plane per region row, indexed by
+            // plane row modulo the region height
+            std::vector<Int> sumRow;
+            std::vector<Double> npts, sum, sumsq;
+            if (useSums) {
+                sumRow.assign(yChunkSize, -1);
+                npts.resize(yChunkSize*(xsize + 1));
+                sum.resize(yChunkSize*(xsize + 1));
+                sumsq.resize(yChunkSize*(xsize + 1));
+            }
+            else {
+                try {
+                    myAlg = _getStatsAlgorithm(myAlgName);
+                    myAlg->setStatsToCalculate(statToCompute);
+                }
+                catch (const AipsError& x) {
+#pragma omp critical (StatImageCreator_computeStat)
+                    {
+                        err = x.getMesg();
+                        failed = True;
+                    }
+                }
+            }
+            IPosition planeBlc(ndim, 0);
+            auto& xPlaneBlc = planeBlc[_dirAxes[0]];
+            auto& yPlaneBlc = planeBlc[_dirAxes[1]];
+            // pixels at the TRC are included in the statistics
+            auto planeTrc = planeBlc;
+            auto& xPlaneTrc = planeTrc[_dirAxes[0]];
+            auto& yPlaneTrc = planeTrc[_dirAxes[1]];
             IPosition regMaskStart(ndim, 0);
             auto& xRegMaskStart = regMaskStart[_dirAxes[0]];
             auto& yRegMaskStart = regMaskStart[_dirAxes[1]];
             auto regMaskLength = regMaskStart;
             auto& xRegMaskLength = regMaskLength[_dirAxes[0]];
             auto& yRegMaskLength = regMaskLength[_dirAxes[1]];
-            Bool yDoMaskSlice = False;
-            if (regionMask) {
-                regMaskLength = regionMask->shape();
-                if (yblc < 0) {
-                    yRegMaskStart = -yblc;
-                    yRegMaskLength += yblc;
-                    yDoMaskSlice = True;
+#pragma omp for schedule(static)
+            for (Int yCount=0; yCount<(Int)nypts; ++yCount) {
+                if (failed) {
+                    continue;
                 }
-                else if (yblc + yChunkSize > yimshape) {
-                    yRegMaskLength = yimshape - yblc;
-                    yDoMaskSlice = True;
-                }
-            }
-            Int xblc = xstart - xBlcOff;
-            for (uInt xCount=0; xCount<nxpts; ++xCount, xblc+=_grid.first) {
-                xOutPos = xCount;
-                xPlaneBlc = max(0, xblc);
-                xPlaneTrc = min(
-                    xblc + (Int)xChunkSize - 1, (Int)ximshape - 1
+                Int yblc = ystart - (Int)yBlcOff + yCount*(Int)_grid.second;
+                yPlaneBlc = max(0, yblc);
+                yPlaneTrc = min(
+                    yblc + (Int)yChunkSize - 1, yimshape - 1
                 );
-                SHARED_PTR<Array<Bool>> subRegionMask;
-                if (regionMask) {
-                    auto doMaskSlice = yDoMaskSlice;
-                    xRegMaskStart = 0;
-                    if (xblc < 0) {
-                        xRegMaskStart = -xblc;
-                        xRegMaskLength = regionMask->shape()[_dirAxes[0]] + xblc;
-                        doMaskSlice = True;
+                if (useSums) {
+                    for (Int y=yPlaneBlc; y<=yPlaneTrc; ++y) {
+                        auto slot = y % yChunkSize;
+                        if (sumRow[slot] == y) {
+                            continue;
+                        }
+                        sumRow[slot] = y;
+                        auto *pn = &npts[slot*(xsize + 1)];
+                        auto *ps = &sum[slot*(xsize + 1)];
+                        auto *ps2 = &sumsq[slot*(xsize + 1)];
+                        pn[0] = 0;
+                        ps[0] = 0;
+                        ps2[0] = 0;
+                        for (Int x=0; x<ximshape; ++x) {
+                            auto off = x*xStep + y*yStep;
+                            Double v = pMask[off] ? pPlane[off] - shift : 0;
+                            pn[x + 1] = pn[x] + (pMask[off] ? 1 : 0);
+                            ps[x + 1] = ps[x] + v;
+                            ps2[x + 1] = ps2[x] + v*v;
+                        }
                     }
-                    else if (xblc + xChunkSize > ximshape) {
-                        regMaskLength[_dirAxes[0]] = ximshape - xblc;
-                        doMaskSlice = True;
-                    }
-                    else {
-                        xRegMaskLength = xChunkSize;
-                    }
-                    if (doMaskSlice) {
-                        Slicer sl(regMaskStart, regMaskLength);
-                        subRegionMask.reset(new Array<Bool>(regMaskCopy(sl)));
+                }
+                else if (regionMask) {
+                    regMaskLength = regionMask->shape();
+                    yRegMaskStart = 0;
+                }
+                Bool yDoMaskSlice = False;
+                if (! useSums && regionMask) {
+                    if (yblc < 0) {
+                        yRegMaskStart = -yblc;
+                        yRegMaskLength += yblc;
+                        yDoMaskSlice = True;
                     }
-                    else {
-                        subRegionMask.reset(new Array<Bool>(regMaskCopy));
+                    else if (yblc + yChunkSize > (uInt)yimshape) {
+                        yRegMaskLength = yimshape - yblc;
+                        yDoMaskSlice = True;
                     }
                 }
-                auto maskChunk = lattMask(planeBlc, planeTrc).copy();
-                if (subRegionMask) {
-                    maskChunk = maskChunk && *subRegionMask;
-                }
-                Float res = 0;
-                if (anyTrue(maskChunk)) {
-                    auto chunk = plane(planeBlc, planeTrc);
-                    if (allTrue(maskChunk)) {
-                        alg->setData(chunk.begin(), chunk.size());
+                Int xblc = xstart - xBlcOff;
+                for (uInt xCount=0; xCount<nxpts; ++xCount, xblc+=_grid.first) {
+                    auto outOff = xCount*xOutStep + yCount*yOutStep;
+                    Float res = 0;
+                    Bool good = True;
+                    if (useSums) {
+                        Double n = 0;
+                        Double s = 0;
+                        Double s2 = 0;
+                        for (Int y=yPlaneBlc; y<=yPlaneTrc; ++y) {
+                            auto slot = y % yChunkSize;
+                            const auto *pn = &npts[slot*(xsize + 1)];
+                            const auto *ps = &sum[slot*(xsize + 1)];
+                            const auto *ps2 = &sumsq[slot*(xsize + 1)];
+                            for (const auto& span: spans[y - yblc]) {
+                                auto x0 = max(xblc + span.first, 0);
+                                auto x1 = min(xblc + span.second, ximshape - 1);
+                                if (x0 <= x1) {
+                                    n += pn[x1 + 1] - pn[x0];
+                                    s += ps[x1 + 1] - ps[x0];
+                                    s2 += ps2[x1 + 1] - ps2[x0];
+                                }
+                            }
+                        }
+                        good = n > 0;
+                        if (good) {
+                            // s and s2 are the sums of the shifted values
+                            Double var = n > 1 ? max(s2 - s*s/n, 0.0)/(n - 1) : 0;
+                            Double sumsq = s2 + 2*shift*s + n*shift*shift;
+                            switch (_statType) {
+                            case StatisticsData::MEAN:
+                                res = shift + s/n;
+                                break;
+                            case StatisticsData::NPTS:
+                                res = n;
+                                break;
+                            case StatisticsData::RMS:
+                                res = sqrt(sumsq/n);
+                                break;
+                            case StatisticsData::STDDEV:
+                                res = sqrt(var);
+                                break;
+                            case StatisticsData::SUM:
+                                res = s + n*shift;
+                                break;
+                            case StatisticsData::SUMSQ:
+                                res = sumsq;
+                                break;
+                            default:
+                                res = var;
+                                break;
+                            }
+                        }
                     }
                     else {
-                        alg->setData(chunk.begin(), maskChunk.begin(), chunk.size());
+                        xPlaneBlc = max(0, xblc);
+                        xPlaneTrc = min(
+                            xblc + (Int)xChunkSize - 1, ximshape - 1
+                        );
+                        SHARED_PTR<Array<Bool>> subRegionMask;
+                        if (regionMask) {
+                            auto doMaskSlice = yDoMaskSlice;
+                            xRegMaskStart = 0;
+                            if (xblc < 0) {
+                                xRegMaskStart = -xblc;
+                                xRegMaskLength = regionMask->shape()[_dirAxes[0]] + xblc;
+                                doMaskSlice = True;
+                            }
+                            else if (xblc + xChunkSize > (uInt)ximshape) {
+                                xRegMaskLength = ximshape - xblc;
+                                doMaskSlice = True;
+                            }
+                            else {
+                                xRegMaskLength = xChunkSize;
+                            }
+                            if (doMaskSlice) {
+                                Slicer sl(regMaskStart, regMaskLength);
+                                subRegionMask.reset(new Array<Bool>(regMaskCopy(sl)));
+                            }
+                            else {
+                                subRegionMask.reset(new Array<Bool>(regMaskCopy));
+                            }
+                        }
+                        auto maskChunk = lattMask(planeBlc, planeTrc).copy();
+                        if (subRegionMask) {
+                            maskChunk = maskChunk && *subRegionMask;
+                        }
+                        good = anyTrue(maskChunk);
+                        if (good) {
+                            auto chunk = plane(planeBlc, planeTrc);
+                            try {
+                                if (allTrue(maskChunk)) {
+                                    myAlg->setData(chunk.begin(), chunk.size());
+                                }
+                                else {
+                                    myAlg->setData(
+                                        chunk.begin(), maskChunk.begin(), chunk.size()
+                                    );
+                                }
+                                res = myAlg->getStatistic(_statType);
+                            }
+                            catch (const AipsError& x) {
+#pragma omp critical (StatImageCreator_computeStat)
+                                {
+                                    err = x.getMesg();
+                                    failed = True;
+                                }
+                            }
+                        }
                     }
-                    res = alg->getStatistic(_statType);
-                }
-                else {
-                    writeTo.pixelMask().putAt(False, outPos);
+                    pOut[outOff] = res;
+                    pOutMask[outOff] = good;
                 }
-                writeTo.putAt(res, outPos);
             }
-            nCount += nxpts;
-            pm.update(nCount);
         }
-        if (hasLoopAxes) {
-            Bool done = False;
-            uInt idx = 0;
-            while (! done) {
-                auto targetAxis = loopAxes[idx];
-                ++blc[targetAxis];
-                if (blc[targetAxis] == imshape[targetAxis]) {
-                    blc[targetAxis] = 0;
-                    ++idx;
-                    done = idx == loopAxes.size();
-                }
-                else {
-                    done = True;
-                }
-            }
+        plane.freeStorage(pPlane, deletePlane);
+        lattMask.freeStorage(pMask, deleteMask);
+        ThrowIf(! err.empty(), err);
+        auto outPos = lattIter.position();
+        writeTo.putSlice(outPlane, outPos);
+        if (writeTo.hasPixelMask()) {
+            writeTo.pixelMask().putSlice(outMask, outPos);
         }
+        nCount += ngrid;
+        pm.update(nCount);
     }
 }
 
@@ -39,6 +39,7 @@
 #include <measures/Measures/Stokes.h>
 
 #include <tables/Tables.h>
+#include <tables/Tables/RefRows.h>
 #include <tables/Tables/TableInfo.h>
 
 #include <ms/MeasurementSets.h> 
@@ -46,6 +47,14 @@
 #include <mirlib/maxdimc.h>
 #include <mirlib/miriad.h>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 using namespace casa;
 
 // helper functions
@@ -106,6 +115,7 @@ Importmiriad::Importmiriad(String& infile, Int debug,
   infile_p = infile;
   debug_p = debug;
   msc_p = 0;
+  reading_p = false;
   nArray_p = 0;
   nfield = 0;           //  # mosaiced fields (using offsets?)
   npoint = 0;           //  # pointings (using independant RA/DEC?)
@@ -447,6 +457,8 @@ void Importmiriad::setupMeasurementSet(const String& MSFileName, Bool useTSM)
                          stringToVector(MS::columnName(MS::DATA)));
     td.defineHypercolumn("TiledFlag",3,
                          stringToVector(MS::columnName(MS::FLAG)));
+    td.defineHypercolumn("TiledFlagCategory",4,
+                         stringToVector(MS::columnName(MS::FLAG_CATEGORY)));
     td.defineHypercolumn("TiledUVW",2,
                          stringToVector(MS::columnName(MS::UVW)));
   }
@@ -488,6 +500,11 @@ void Importmiriad::setupMeasurementSet(const String& MSFileName, Bool useTSM)
   MeasurementSet ms(newtab);
 #else
   //  NEW CODE TO ACCOMODATE VARYING SHAPED COLUMNS 
+  // Columns which change every row are not worth the Incr StMan
+  newtab.bindColumn(MS::columnName(MS::ANTENNA1),aipsStMan);
+  newtab.bindColumn(MS::columnName(MS::ANTENNA2),aipsStMan);
+  newtab.bindColumn(MS::columnName(MS::WEIGHT),aipsStMan);
+  newtab.bindColumn(MS::columnName(MS::SIGMA),aipsStMan);
   if (useTSM) {
     Int tileSize=nChan/10+1;
 
@@ -500,16 +517,21 @@ void Importmiriad::setupMeasurementSet(const String& MSFileName, Bool useTSM)
     //TiledShapeStMan tiledStMan2("TiledWeight",
     //                             IPosition(3,nCorr,tileSize,
     //                                       16384/nCorr/tileSize));
+    TiledShapeStMan tiledStMan1c("TiledFlagCategory",
+                                 IPosition(4,nCorr,tileSize,3,
+                                           16384/nCorr/tileSize/3+1));
     TiledColumnStMan tiledStMan3("TiledUVW",
                                  IPosition(2,3,1024));
 
     // Bind the DATA and FLAG columns to the tiled stman
     newtab.bindColumn(MS::columnName(MS::DATA),tiledStMan1);
     newtab.bindColumn(MS::columnName(MS::FLAG),tiledStMan1f);
+    newtab.bindColumn(MS::columnName(MS::FLAG_CATEGORY),tiledStMan1c);
     newtab.bindColumn(MS::columnName(MS::UVW),tiledStMan3);
   } else {
     newtab.bindColumn(MS::columnName(MS::DATA),aipsStMan);
     newtab.bindColumn(MS::columnName(MS::FLAG),aipsStMan);
+    newtab.bindColumn(MS::columnName(MS::FLAG_CATEGORY),aipsStMan);
     newtab.bindColumn(MS::columnName(MS::UVW),aipsStMan);
   }   
   TableLock lock(TableLock::AutoLocking);
@@ -632,28 +654,31 @@ void Importmiriad::fillObsTables()
 // Loop over the visibility data and fill the main table of the MeasurementSet 
 // as you find corr/wcorr's
 //
-void Importmiriad::fillMSMainTable()
+// The dataset is read, and its variables tracked, on the calling thread.
+// The records, with the tracked values they need, are handed in batches to
+// a writer thread which converts each batch in parallel and appends it to
+// the main table in one block. The ANTENNA and SYSCAL rows that Tracking
+// derives from the tracked variables are queued with the batch and added
+// by the writer too, so only the writer touches the MS while reading.
+//
+void Importmiriad::fillMSMainTable(Bool threaded)
 {
   if (Debug(1)) os_p << LogIO::DEBUG1 << "Importmiriad::fillMSMainTable" << LogIO::POST;
 
   MSColumns& msc(*msc_p);           // Get access to the MS columns, new way
   Int nCorr = (array_p=="CARMA" ? 1 : npol_p); // # stokes (1 for CARMA for now)
-  Int nChan = MAXCHAN;              // max # channels to be written
-  if (Debug(1)) os_p << LogIO::DEBUG1 << "nCorr = "<<nCorr<<", nChan = "<< nChan <<LogIO::POST;
+  if (Debug(1)) os_p << LogIO::DEBUG1 << "nCorr = "<<nCorr<<", nChan = "<< MAXCHAN <<LogIO::POST;
   Int nCat  = 3;                    // # initial flagging categories (fixed at 3)
   Int iscan = 0;
   Int ifield_old = 0;
+  const uInt batchSize = 4096;      // # records handed to the writer at a time
+  const uInt maxQueued = 2;         // # batches read ahead of the writer
 
-  Matrix<Complex> vis(nCorr,nChan);
-  Vector<Float>   sigma(nCorr);
   Vector<String>  cat(nCat);
   cat(0)="FLAG_CMD";
   cat(1)="ORIGINAL";
   cat(2)="USER";
   msc.flagCategory().rwKeywordSet().define("CATEGORY",cat);
-  Cube<Bool> flagCat(nCorr,nChan,nCat,false);  
-  Matrix<Bool> flag = flagCat.xyPlane(0); // references flagCat's storage
-  Vector<Float> w1(nCorr), w2(nCorr);
 
   uvrewind_c(uv_handle_p);
   
@@ -661,12 +686,77 @@ void Importmiriad::fillMSMainTable()
   nAnt_p[0]=0;
 
   receptorAngle_p.resize(1);
-  Int group, row=-1;
-  Double interval;
-  Bool lastRowFlag = false;
+  Int group;
+
+  std::mutex queueMutex;
+  std::condition_variable queueChanged;
+  std::deque<std::unique_ptr<VisBatch> > queue;
+  Bool doneReading = false;
+  Bool first = true;
+  std::exception_ptr writeError;
+
+  // add the queued subtable rows and the records of a batch
+  auto write = [&](const VisBatch& batch) {
+    for (auto& update : batch.subtableUpdates) update();
+    writeBatch(batch, first);
+    first = false;
+  };
+  std::thread writer;
+  if (threaded) writer = std::thread([&]() {
+    while (true) {
+      std::unique_ptr<VisBatch> batch;
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait(lock, [&]() { return !queue.empty() || doneReading; });
+        if (queue.empty()) return;
+        batch = std::move(queue.front());
+        queue.pop_front();
+      }
+      queueChanged.notify_all();
+      try {
+        write(*batch);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        writeError = std::current_exception();
+        queue.clear();
+        queueChanged.notify_all();
+        return;
+      }
+    }
+  });
+  // hand a batch to the writer, waiting while it is maxQueued batches behind;
+  // false if the writer failed. Without a writer thread it is written here.
+  auto handOver = [&](std::unique_ptr<VisBatch>& batch) {
+    batch->subtableUpdates.swap(subtableUpdates_p);
+    if (!threaded) {
+      write(*batch);
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueChanged.wait(lock, [&]() { return queue.size() < maxQueued || writeError; });
+    if (writeError) return false;
+    queue.push_back(std::move(batch));
+    queueChanged.notify_all();
+    return true;
+  };
+  auto stopWriter = [&]() {
+    reading_p = false;
+    subtableUpdates_p.clear();         // only left over if writing failed
+    if (!threaded) return;
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      doneReading = true;
+    }
+    queueChanged.notify_all();
+    writer.join();
+  };
 
   //os_p << "Found  " << win[0].nspect << " spectral window" << (win[0].nspect>1 ? "s":"") << LogIO::POST;
 
+  std::unique_ptr<VisBatch> batch(new VisBatch);
+  uInt nRow = 0;
+  reading_p = true;
+  try {
   time_p=0;
   for (group=0; ; group++) {        // loop forever until end-of-file
     int nread, nwread;
@@ -725,141 +815,79 @@ void Importmiriad::fillMSMainTable()
     // in case there are multiple arrays???
     // TODO: code should just assuming single array
     
-    Vector<Double> uvw(3);
-    uvw(0) = -preamble[0] * 1e-9; // convert to seconds
-    uvw(1) = -preamble[1] * 1e-9; // MIRIAD uses nanosec
-    uvw(2) = -preamble[2] * 1e-9; // note - sign (CASA vs. MIRIAD convention)
-    uvw   *= C::c;                // Finally convert to meters for CASA
+    VisRecord rec;
+    rec.uvw[0] = -preamble[0] * 1e-9 * C::c; // MIRIAD uses nanosec, CASA meter
+    rec.uvw[1] = -preamble[1] * 1e-9 * C::c; // note - sign (CASA vs. MIRIAD convention)
+    rec.uvw[2] = -preamble[2] * 1e-9 * C::c;
 
     if (group==0 && Debug(1)) {
         os_p << LogIO::DEBUG1 << "### First record: " << LogIO::POST;
         os_p << LogIO::DEBUG1 << "### Preamble: " << preamble[0] << " " <<
                                 preamble[1] << " " <<
                                 preamble[2] << " nanosec.(MIRIAD convention)" << LogIO::POST;
-        os_p << LogIO::DEBUG1 << "### uvw: " << uvw(0) << " " <<
-                               uvw(1) << " " <<
-                               uvw(2) << " meter. (CASA convention)" << LogIO::POST;
+        os_p << LogIO::DEBUG1 << "### uvw: " << rec.uvw[0] << " " <<
+                               rec.uvw[1] << " " <<
+                               rec.uvw[2] << " meter. (CASA convention)" << LogIO::POST;
     }
 
-
-    // first construct the data (vis & flag) in a single long array
-    // containing all spectral windows
-    // In the (optional) loop over all spectral windows, subsets of
-    // these arrays will be written out
-
+    if (group==0) ifield_old = ifield;
+    if (ifield_old != ifield) 
+      iscan++;
+    ifield_old = ifield;
+
+    rec.time = time;           // CARMA did begin of scan.., now middle (2009)
+    rec.ant1 = ant1;
+    rec.ant2 = ant2;
+    rec.field = ifield;
+    rec.scan = iscan;
+    rec.array = nArray_p-1;
+    rec.freqSet = freqSet_p;
+    rec.ddid = ddid_p;
+    rec.inttime = inttime_p;
+    rec.jyperk = jyperk_p;
+    rec.tsys1 = (Qtsys_p ? systemp[ant1] : 0);
+    rec.tsys2 = (Qtsys_p ? systemp[ant2] : 0);
+
+    // keep the channels the selected windows need (IFs go to separate rows
+    // in the MS, pol's do not!)
+    rec.nchan = nread;
+    rec.nspw = 0;
+    for (Int sno=0; sno < win[freqSet_p].nspect; sno++) {
+      if (not keep[sno]) continue;
+      rec.nchan = max(rec.nchan, win[freqSet_p].ischan[sno]-1+win[freqSet_p].nschan[sno]);
+      rec.nspw++;
+    }
+    rec.nchan = min(rec.nchan, Int(MAXCHAN));
+    if (Qtsys_p && (rec.tsys1 == 0 || rec.tsys2 == 0))
+      zero_tsys += rec.nspw;
+
+    // the data (vis & flag) of all correlations go, in read order, into a
+    // single long array containing all spectral windows; the writer picks
+    // out the subsets of every spectral window
+    rec.offset = batch->flags.size();
     for (Int i=0; i<nCorr; i++) {
-      Int count = 0;                // index into data[] array
       if (i>0) uvread_c(uv_handle_p, preamble, data, flags, MAXCHAN, &nread);
-      //if (group==0) {
-      //        os_p << "pol="<< pol<<", nread="<<nread<<LogIO::POST;
-      //  os_p << "data(500)="<< data[1000] <<", "<< data[1001] <<LogIO::POST;
-      //}
-      for (Int chan=0; chan<nChan; chan++) {
-
-        // miriad uses bl=ant1-ant2, FITS/AIPS/CASA use bl=ant2-ant1
-        // apart from using -(UVW)'s, the visib need to be conjugated as well
-        Bool  visFlag =  (flags[count/2] == 0) ? false : true;
-        Float visReal = +data[count]; count++; 
-        Float visImag = -data[count]; count++;
-        Float wt = 1.0;
-        if (!visFlag) wt = -wt;
-        
-        // check flags array !! need separate counter (count/2)
-        Int pol = corrIndex_p(i);
-        flag(pol,chan) = (wt<=0); 
-        vis(pol,chan) = Complex(visReal,visImag);
-      } // chan
-      //if (group==0) os_p << "vis = "<<vis(pol,500)<<LogIO::POST;
+      batch->data.insert(batch->data.end(), data, data + 2*rec.nchan);
+      batch->flags.insert(batch->flags.end(), flags, flags + rec.nchan);
     } // pol
-
-    Int ispw=-1;
-    for (Int sno=0; sno < win[freqSet_p].nspect; sno++) {
-      if (not keep[sno]) continue;    
-      // IFs go to separate rows in the MS, pol's do not!
-      ms_p.addRow(); 
-      row++; ispw++;
-
-      // first fill in values for all the unused columns
-      if (row==0) {
-        ifield_old = ifield;
-        msc.feed1().put(row,0);
-        msc.feed2().put(row,0);
-        msc.flagRow().put(row,false);
-        lastRowFlag = false;
-        msc.scanNumber().put(row,iscan);
-        msc.processorId().put(row,-1);
-        msc.observationId().put(row,0);
-        msc.stateId().put(row,-1);
-      }
-      
-      Matrix<Complex> tvis(nCorr,win[freqSet_p].nschan[sno]);
-      Cube<Bool> tflagCat(nCorr,win[freqSet_p].nschan[sno],nCat,false);  
-      Matrix<Bool> tflag = tflagCat.xyPlane(0); // references flagCat's storage
-      
-      Int woffset = win[freqSet_p].ischan[sno]-1;
-      Int wsize   = win[freqSet_p].nschan[sno];
-      for (Int j=0; j<nCorr; j++) {
-        for (Int i=0; i< wsize; i++) {
-          tvis(j,i) = vis(j,i+woffset);
-          tflag(j,i) = flag(j,i+woffset);
-        }
-      }
-
-      //if (group==0) os_p<<"tvis="<<tvis(0,500)<<", "<<tvis(1,500)<<LogIO::POST;
-      msc.data().put(row,tvis);
-      msc.flag().put(row,tflag);
-      msc.flagCategory().put(row,tflagCat);
-
-      Bool rowFlag = allEQ(flag,true);
-      if (rowFlag != lastRowFlag) {
-        msc.flagRow().put(row,rowFlag);
-        lastRowFlag = rowFlag;
-      }
-
-      msc.antenna1().put(row,ant1);
-      msc.antenna2().put(row,ant2);
-      msc.time().put(row,time);           // CARMA did begin of scan.., now middle (2009)
-      msc.timeCentroid().put(row,time);   // do we really need this ? flagging/blanking ?
-
-      interval = inttime_p;
-      msc.exposure().put(row,interval);
-      msc.interval().put(row,interval);
-      Float chnbw = win[freqSet_p].sdf[sno]*1e9;
-      Float factor = interval * abs(chnbw)/jyperk_p/jyperk_p;
-      // sigma=sqrt(Tx1*Tx2)/sqrt(chnbw*intTime)*JyPerK;
-      if (Qtsys_p) {    
-        w2 = 1.0; 
-        if( systemp[ant1] == 0 || systemp[ant2] == 0) {
-          zero_tsys++;
-          w1 = 0.0;
-        } else {
-          w1 = factor/(systemp[ant1]*systemp[ant2]);  // see uvio::uvinfo_variance()
-          w2 = sqrt(systemp[ant1]*systemp[ant2])/sqrt(factor);
-        }
-        // os_p << w1 << " " << w2 << " " << jyperk_p << " "<< chnbw<< " "<< interval<< LogIO::POST;
-        msc.weight().put(row,w1);
-        msc.sigma().put(row,w2);        
-      } else {
-          w1=factor/50/50;  // Use nominal 50K systemp to keep values similar
-          w2=50/sqrt(factor);
-          msc.weight().put(row,w1);
-          msc.sigma().put(row,w2);
-      }
-      msc.uvw().put(row,uvw);
-      msc.arrayId().put(row,nArray_p-1);
-      // calc index into table
-      msc.dataDescId().put(row,ddid_p+ispw);
-      msc.fieldId().put(row,ifield);
-
-
-      if (ifield_old != ifield) 
-        iscan++;
-      ifield_old = ifield;
-      msc.scanNumber().put(row,iscan);
-
-    }  // sno
+    batch->records.push_back(rec);
+    nRow += rec.nspw;
     fcount[ifield]++;
+
+    if (batch->records.size() == batchSize) {
+      if (! handOver(batch)) break;
+      batch.reset(new VisBatch);
+    }
   } // for(grou) : loop over all visibilities
+  if (batch && ! batch->records.empty())
+    handOver(batch);
+  } catch (...) {
+    stopWriter();
+    throw;
+  }
+  stopWriter();
+  if (writeError) std::rethrow_exception(writeError);
+
   show();
   if (ms_p.nrow()==0) {
     os_p<<LogIO::SEVERE<<"No data selected, table is empty!" <<LogIO::POST;
@@ -875,11 +903,161 @@ void Importmiriad::fillMSMainTable()
        << LogIO::POST;
   }
   if (Debug(1))
-    os_p << LogIO::DEBUG1 << "nAnt_p contains: " << nAnt_p.nelements() << LogIO::POST;
+    os_p << LogIO::DEBUG1 << "nAnt_p contains: " << nAnt_p.nelements() 
+         << ", wrote " << nRow << " rows" << LogIO::POST;
 
 
 } // fillMSMainTable()
-
+
+// ==============================================================================================
+//
+// Convert a batch of visibility records and append them to the main table.
+// Runs on the writer thread of fillMSMainTable: it may only use the
+// records and the variables which do not change while reading (the
+// spectral window selection, the frequency setups up to the ones of the
+// batch, the correlation order and the flags of the filler).
+//
+void Importmiriad::writeBatch(const VisBatch& batch, Bool first)
+{
+  MSColumns& msc(*msc_p);
+  Int nCorr = (array_p=="CARMA" ? 1 : npol_p); // # stokes (1 for CARMA for now)
+  Int nCat  = 3;                    // # initial flagging categories (fixed at 3)
+  Int nRecord = batch.records.size();
+
+  // MS row of every record, relative to the batch
+  std::vector<uInt> firstRow(nRecord+1, 0);
+  for (Int r=0; r<nRecord; r++)
+    firstRow[r+1] = firstRow[r] + batch.records[r].nspw;
+  uInt nRow = firstRow[nRecord];
+  if (nRow == 0) return;
+
+  Vector<Int>     ant1(nRow), ant2(nRow), fieldId(nRow), scan(nRow), arrayId(nRow), ddId(nRow);
+  Vector<Double>  time(nRow), interval(nRow);
+  Vector<Bool>    flagRow(nRow);
+  Matrix<Double>  uvw(3,nRow);
+  Matrix<Float>   weight(nCorr,nRow), sigma(nCorr,nRow);
+  std::vector<Matrix<Complex> > vis(nRow);
+  std::vector<Cube<Bool> >      flagCat(nRow);
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for (Int r=0; r<nRecord; r++) {
+    const VisRecord& rec = batch.records[r];
+    const WINDOW& w = win[rec.freqSet];
+    const float* recData  = &batch.data[2*rec.offset];
+    const int*   recFlags = &batch.flags[rec.offset];
+
+    Bool rowFlag = true;
+    for (Int k=0; k<nCorr*rec.nchan && rowFlag; k++)
+      rowFlag = (recFlags[k] == 0);
+
+    uInt row = firstRow[r];
+    Int ispw = -1;
+    for (Int sno=0; sno < w.nspect; sno++) {
+      if (not keep[sno]) continue;    
+      ispw++;
+
+      Int woffset = w.ischan[sno]-1;
+      Int wsize   = w.nschan[sno];
+      Matrix<Complex>& tvis = vis[row];
+      Cube<Bool>& tflagCat = flagCat[row];
+      tvis.resize(nCorr,wsize);
+      tflagCat.resize(nCorr,wsize,nCat);
+      tflagCat = false;
+      for (Int i=0; i<nCorr; i++) {
+        Int pol = corrIndex_p(i);
+        const float* d = recData + 2*(i*rec.nchan + woffset);
+        const int*   f = recFlags + i*rec.nchan + woffset;
+        for (Int chan=0; chan<wsize; chan++) {
+          // miriad uses bl=ant1-ant2, FITS/AIPS/CASA use bl=ant2-ant1
+          // apart from using -(UVW)'s, the visib need to be conjugated as well
+          tvis(pol,chan) = Complex(d[2*chan], -d[2*chan+1]);
+          tflagCat(pol,chan,0) = (f[chan] == 0);
+        }
+      }
+
+      flagRow(row) = rowFlag;
+      ant1(row) = rec.ant1;
+      ant2(row) = rec.ant2;
+      time(row) = rec.time;
+      interval(row) = rec.inttime;
+      for (Int k=0; k<3; k++) uvw(k,row) = rec.uvw[k];
+      arrayId(row) = rec.array;
+      ddId(row) = rec.ddid+ispw;       // calc index into table
+      fieldId(row) = rec.field;
+      scan(row) = rec.scan;
+
+      Float chnbw = w.sdf[sno]*1e9;
+      Float factor = rec.inttime * abs(chnbw)/rec.jyperk/rec.jyperk;
+      // sigma=sqrt(Tx1*Tx2)/sqrt(chnbw*intTime)*JyPerK;
+      Float w1, w2;
+      if (Qtsys_p) {    
+        w2 = 1.0; 
+        if( rec.tsys1 == 0 || rec.tsys2 == 0) {
+          w1 = 0.0;
+        } else {
+          w1 = factor/(rec.tsys1*rec.tsys2);  // see uvio::uvinfo_variance()
+          w2 = sqrt(rec.tsys1*rec.tsys2)/sqrt(factor);
+        }
+      } else {
+        w1=factor/50/50;  // Use nominal 50K systemp to keep values similar
+        w2=50/sqrt(factor);
+      }
+      for (Int k=0; k<nCorr; k++) {
+        weight(k,row) = w1;
+        sigma(k,row) = w2;
+      }
+      row++;
+    }  // sno
+  }
+
+  uInt row0 = ms_p.nrow();
+  ms_p.addRow(nRow);
+
+  // first fill in values for all the unused columns
+  if (first) {
+    msc.feed1().put(row0,0);
+    msc.feed2().put(row0,0);
+    msc.processorId().put(row0,-1);
+    msc.observationId().put(row0,0);
+    msc.stateId().put(row0,-1);
+  }
+
+  RefRows rows(row0, row0+nRow-1);
+  msc.antenna1().putColumnCells(rows,ant1);
+  msc.antenna2().putColumnCells(rows,ant2);
+  msc.time().putColumnCells(rows,time);
+  msc.timeCentroid().putColumnCells(rows,time);   // do we really need this ? flagging/blanking ?
+  msc.exposure().putColumnCells(rows,interval);
+  msc.interval().putColumnCells(rows,interval);
+  msc.flagRow().putColumnCells(rows,flagRow);
+  msc.uvw().putColumnCells(rows,uvw);
+  msc.weight().putColumnCells(rows,weight);
+  msc.sigma().putColumnCells(rows,sigma);
+  msc.arrayId().putColumnCells(rows,arrayId);
+  msc.dataDescId().putColumnCells(rows,ddId);
+  msc.fieldId().putColumnCells(rows,fieldId);
+  msc.scanNumber().putColumnCells(rows,scan);
+  // the shape of DATA and FLAG changes with the spectral window
+  for (uInt i=0; i<nRow; i++) {
+    msc.data().put(row0+i,vis[i]);
+    msc.flag().put(row0+i,flagCat[i].xyPlane(0));
+    msc.flagCategory().put(row0+i,flagCat[i]);
+  }
+} // writeBatch()
+
+// ==============================================================================================
+//
+// Add rows to a subtable now, or, while fillMSMainTable is reading, queue
+// them to be added by its writer with the next batch of records
+//
+void Importmiriad::addSubtableRows(const std::function<void()>& update)
+{
+  if (reading_p)
+    subtableUpdates_p.push_back(update);
+  else
+    update();
+}
+
 void Importmiriad::fillAntennaTable()
 {
   if (Debug(1)) os_p << LogIO::DEBUG1 << "Importmiriad::fillAntennaTable" << LogIO::POST;
@@ -964,32 +1142,28 @@ void Importmiriad::fillAntennaTable()
   } else
     os_p << "Ant configuration not supported yet" << LogIO::POST;
 
-  MSAntennaColumns& ant(msc_p->antenna());
+  // While fillMSMainTable is reading, the rows are added by its writer
+  // (see Tracking), so work out here everything they need from the
+  // tracked variables, and pass it on by value
+  Bool firstArray = (nArray_p == 0);
+  String arrnam = array_p;
+  std::vector<Double> arrayXYZ(arrayXYZ_p.begin(), arrayXYZ_p.end());
+  std::vector<Double> dishDiameter(nAnt), position(3*nAnt);
   Vector<Double> antXYZ(3);
 
-  // add antenna info to table
-  if (nArray_p == 0) {                   // check if needed
-    ant.setPositionRef(MPosition::ITRF);
-    //ant.setPositionRef(MPosition::WGS84);
-  }
-  Int row=ms_p.antenna().nrow()-1;
-
-  if (Debug(2)) os_p << LogIO::DEBUG2 << "Importmiriad::fillAntennaTable row=" << row+1 
-       << " array " << nArray_p+1 << LogIO::POST;
+  if (Debug(2)) os_p << LogIO::DEBUG2 << "Importmiriad::fillAntennaTable array " << nArray_p+1 << LogIO::POST;
 
   for (Int i=0; i<nAnt; i++) {
 
-    ms_p.antenna().addRow(); 
-    row++;
     if (array_p=="OVRO" || array_p=="BIMA" || array_p=="HATCREEK" || array_p=="CARMA") {
       if (i<6)
-        ant.dishDiameter().put(row,10.4);  // OVRO
+        dishDiameter[i] = 10.4;            // OVRO
       else if (i<15)
-        ant.dishDiameter().put(row,6.1);   // BIMA or HATCREEK
+        dishDiameter[i] = 6.1;             // BIMA or HATCREEK
       else
-        ant.dishDiameter().put(row,3.5);   // SZA
+        dishDiameter[i] = 3.5;             // SZA
     } else {
-      ant.dishDiameter().put(row,diameter); // others
+      dishDiameter[i] = diameter;          // others
     }
     antXYZ(0) = antpos[i];              //# these are now in nano-sec
     antXYZ(1) = antpos[i+nAnt];
@@ -997,27 +1171,6 @@ void Importmiriad::fillAntennaTable()
     antXYZ *= 1e-9 * C::c;             //# and now in meters
     if (Debug(2)) os_p << LogIO::DEBUG2 << "Ant " << i+1 << ":" << antXYZ << " (m)." << LogIO::POST;
 
-    String mount;                           // really should consult
-    switch (mount_p) {                      // the "mount" uv-variable
-      case  0: mount="ALT-AZ";      break;
-      case  1: mount="EQUATORIAL";  break;
-      case  2: mount="X-Y";         break;
-      case  3: mount="ORBITING";    break;
-      case  4: mount="BIZARRE";     break;
-      // case  5: mount="SPACE-HALCA"; break;
-      default: mount="UNKNOWN";     break;
-    }
-    ant.mount().put(row,mount);
-    ant.flagRow().put(row,false);
-    String antName = "C";
-    if (array_p=="ATCA") antName="CA0";
-    antName += String::toString(i+1);
-    ant.name().put(row,antName);
-    ant.station().put(row,"ANT" + String::toString(i+1));  // unknown PADs, so for now ANT#
-    ant.type().put(row,"GROUND-BASED");
-
-    Vector<Double> offsets(3);
-    offsets=0.0;
     // store absolute positions, with all offsets 0
 
 #if 1
@@ -1032,35 +1185,74 @@ void Importmiriad::fillAntennaTable()
 // This doesn't work because miriad calculated the relative positions with
 // respect to the first antenna with non zero coordinates, 
 // not the array reference position. This makes it impossible to invert exactly
-    ant.position().put(row,arrayXYZ_p+antXYZ);
+    for (Int k=0; k<3; k++) position[3*i+k] = arrayXYZ_p(k) + antXYZ(k);
 #else
     //test
-    ant.position().put(row,arrayXYZ_p);
+    for (Int k=0; k<3; k++) position[3*i+k] = arrayXYZ_p(k);
 #endif
-    ant.offset().put(row,offsets);
 
     // store the angle for use in the feed table
 //    receptorAngle_p[array](2*i+0)=polangleA(i)*C::degree;
 //    receptorAngle_p[array](2*i+1)=polangleB(i)*C::degree;
   }
-  // ant.position().rwKeywordSet().define("MEASURE_REFERENCE","ITRF");
+
+  String mount;                           // really should consult
+  switch (mount_p) {                      // the "mount" uv-variable
+    case  0: mount="ALT-AZ";      break;
+    case  1: mount="EQUATORIAL";  break;
+    case  2: mount="X-Y";         break;
+    case  3: mount="ORBITING";    break;
+    case  4: mount="BIZARRE";     break;
+    // case  5: mount="SPACE-HALCA"; break;
+    default: mount="UNKNOWN";     break;
+  }
+
+  addSubtableRows([this, nAnt, firstArray, arrnam, arrayXYZ,
+                               dishDiameter, position, mount]() {
+    MSAntennaColumns& ant(msc_p->antenna());
+
+    // add antenna info to table
+    if (firstArray) {                      // check if needed
+      ant.setPositionRef(MPosition::ITRF);
+      //ant.setPositionRef(MPosition::WGS84);
+    }
+    Int row=ms_p.antenna().nrow();
+    ms_p.antenna().addRow(nAnt);
+
+    Vector<Double> offsets(3), pos(3);
+    offsets=0.0;
+    for (Int i=0; i<nAnt; i++, row++) {
+      ant.dishDiameter().put(row,dishDiameter[i]);
+      ant.mount().put(row,mount);
+      ant.flagRow().put(row,false);
+      String antName = "C";
+      if (arrnam=="ATCA") antName="CA0";
+      antName += String::toString(i+1);
+      ant.name().put(row,antName);
+      ant.station().put(row,"ANT" + String::toString(i+1));  // unknown PADs, so for now ANT#
+      ant.type().put(row,"GROUND-BASED");
+      for (Int k=0; k<3; k++) pos(k) = position[3*i+k];
+      ant.position().put(row,pos);
+      ant.offset().put(row,offsets);
+    }
+    // ant.position().rwKeywordSet().define("MEASURE_REFERENCE","ITRF");
+
+    if (!firstArray) return;
+
+    // now do some things which only need to happen the first time around
+
+    // store these items in non-standard keywords for now
+    // 
+    ant.name().rwKeywordSet().define("ARRAY_NAME",arrnam);
+    ant.position().rwKeywordSet().define("ARRAY_POSITION",
+                                         Vector<Double>(arrayXYZ));
+  });
 
   nArray_p++;
   nAnt_p.resize(nArray_p);
   nAnt_p[nArray_p-1] = 0;
   if (Debug(3) && nArray_p > 1)
     os_p << LogIO::DEBUG2  << nAnt_p[nArray_p-2] << LogIO::POST;
-  
-  if (nArray_p > 1) return;
-
-  // now do some things which only need to happen the first time around
-
-  // store these items in non-standard keywords for now
-  // 
-  String arrnam = array_p;
-  ant.name().rwKeywordSet().define("ARRAY_NAME",arrnam);
-  ant.position().rwKeywordSet().define("ARRAY_POSITION",arrayXYZ_p);
-
 
   // fill the array table entry
   // this assumes there is one AN table for each (sub)array index encountered.
@@ -1082,28 +1274,37 @@ void Importmiriad::fillSyscalTable()
 {
   //if (Debug(1)) os_p << "Importmiriad::fillSyscalTable" << LogIO::POST;
 
-  MSSysCalColumns&     msSys(msc_p->sysCal());
-  Vector<Float> Systemp(1);    // should we set both receptors same?
-  Int row = ms_p.sysCal().nrow();
+  // While fillMSMainTable is reading, the rows are added by its writer
+  // (see Tracking), with the system temperatures of this record
+  Int nspect = win[freqSet_p].nspect;
+  Int nants = nants_p;
+  Double time = time_p;
+  std::vector<Float> tsys(systemp, systemp + nants*nspect);
 
   //  if (Debug(1)) 
   //   for (Int i=0; i<nants_p; i++)
   //     os_p  << "SYSTEMP: " << i << ": " << systemp[i] << LogIO::POST;
 
-  for (Int j=0; j<win[freqSet_p].nspect; j++) {
-    for (Int i=0; i<nants_p; i++) {
-      ms_p.sysCal().addRow(); 
-      msSys.antennaId().put(row,i);   //  i, or i+nants_offset_p ????
-      msSys.feedId().put(row,0);
-      msSys.spectralWindowId().put(row,j);    // all of them for now .....
-      msSys.time().put(row,time_p);
-      msSys.interval().put(row,-1.0);
-    
-      Systemp(0) = systemp[i+j*nants_p];
-      msSys.tsys().put(row,Systemp);
-      row++; 
+  addSubtableRows([this, nspect, nants, time, tsys]() {
+    MSSysCalColumns&     msSys(msc_p->sysCal());
+    Vector<Float> Systemp(1);    // should we set both receptors same?
+    Int row = ms_p.sysCal().nrow();
+    ms_p.sysCal().addRow(nants*nspect);
+
+    for (Int j=0; j<nspect; j++) {
+      for (Int i=0; i<nants; i++) {
+        msSys.antennaId().put(row,i);   //  i, or i+nants_offset_p ????
+        msSys.feedId().put(row,0);
+        msSys.spectralWindowId().put(row,j);    // all of them for now .....
+        msSys.time().put(row,time);
+        msSys.interval().put(row,-1.0);
+
+        Systemp(0) = tsys[i+j*nants];
+        msSys.tsys().put(row,Systemp);
+        row++; 
+      }
     }
-  }
+  });
  
 
 
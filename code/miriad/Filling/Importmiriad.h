@@ -47,6 +47,9 @@
 #include <mirlib/maxdimc.h>
 #include <mirlib/miriad.h>
 
+#include <functional>
+#include <vector>
+
 #include <casa/namespace.h>
 namespace casa { //# NAMESPACE CASA - BEGIN
 
@@ -189,8 +192,10 @@ public:
   // DATA, FLAG and WEIGHT_SPECTRUM
   void setupMeasurementSet(const casacore::String& MSFileName, casacore::Bool useTSM=true);
 
-  // Fill the main table by reading in all the visibilities
-  void fillMSMainTable();
+  // Fill the main table by reading in all the visibilities. The records
+  // are converted and written by a separate thread, unless threaded is
+  // false, in which case they are written as they are read
+  void fillMSMainTable(casacore::Bool threaded=true);
 
   // Make an Antenna casacore::Table (can be called incrementally now)
   void fillAntennaTable();
@@ -226,10 +231,39 @@ public:
   void close();
 
 private:
+  // One visibility record (all correlations) as read by fillMSMainTable,
+  // with the values of the tracked variables needed to convert it
+  struct VisRecord {
+    casacore::Double time, uvw[3];
+    casacore::Int    ant1, ant2, field, scan, array, freqSet, ddid;
+    casacore::Float  inttime, jyperk, tsys1, tsys2;
+    casacore::Int    nchan;        // # channels kept per correlation
+    casacore::Int    nspw;         // # MS rows (selected windows)
+    size_t           offset;       // of the first channel in VisBatch::flags
+  };
+
+  // A batch of records handed from the reading to the writing thread;
+  // data and flags are in MIRIAD format, correlation after correlation
+  struct VisBatch {
+    std::vector<VisRecord> records;
+    std::vector<float>     data;
+    std::vector<int>       flags;
+    // ANTENNA and SYSCAL rows, added before the records
+    std::vector<std::function<void()> > subtableUpdates;
+  };
+
+  // Convert a batch of records and append them to the main table
+  void writeBatch(const VisBatch& batch, casacore::Bool first);
+
+  // Add subtable rows, or queue them for the writer while reading
+  void addSubtableRows(const std::function<void()>& update);
+
   casacore::String                 infile_p;     // filename
   casacore::Int                    uv_handle_p;  // miriad handle 
   casacore::MeasurementSet         ms_p;         // the casacore::MS itself
   casacore::MSColumns             *msc_p;        // handy pointer to the columns in an casacore::MS  
+  std::vector<std::function<void()> > subtableUpdates_p; // subtable rows queued by Tracking for the writer
+  casacore::Bool                   reading_p;    // fillMSMainTable is reading the dataset
   casacore::Int                    debug_p;      // debug level
   casacore::String                 array_p, 
                          project_p, 
@@ -0,0 +1,223 @@
+//# Importmiriad_GTest.cc: Compares threaded and serial MIRIAD import
+//# Copyright (C) 2026
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify
+//# it under the terms of the GNU General Public License as published by
+//# the Free Software Foundation; either version 2 of the License, or
+//# (at your option) any later version.
+//#
+//# This program is distributed in the hope that it will be useful,
+//# but WITHOUT ANY WARRANTY; without even the implied warranty of
+//# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//# GNU General Public License for more details.
+//#
+//# You should have received a copy of the GNU General Public License
+//# along with this program; if not, write to the Free Software
+//# Foundation, Inc., 675 Masve, Cambridge, MA 02139, USA.
+//#
+
+#include <miriad/Filling/Importmiriad.h>
+
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/Containers/Block.h>
+#include <ms/MeasurementSets/MeasurementSet.h>
+#include <ms/MeasurementSets/MSColumns.h>
+#include <tables/Tables/ArrayColumn.h>
+#include <tables/Tables/ScalarColumn.h>
+
+#include <cstdlib>
+#include <gtest/gtest.h>
+
+using namespace casacore;
+using namespace casa;
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+
+const int nAnt = 3;
+const int nSpect = 2;
+const int nSChan = 8;
+const int nTimes = 2000;        // 6000 records, more than one batch
+const int tsysInterval = 10;    // # integrations between SYSCAL updates
+
+// Write a small ATCA-like dataset: 3 antennas, 2 windows of 8 channels,
+// one polarization, with system temperatures changing every few
+// integrations so that SYSCAL rows are added while reading
+void writeDataset(const String& name)
+{
+  int tno;
+  uvopen_c(&tno, name.chars(), "new");
+  uvset_c(tno, "preamble", "uvw/time/baseline", 0, 0.0, 0.0, 0.0);
+
+  int nants = nAnt, npol = 1, pol = -5, nspect = nSpect, nwide = 0;
+  int nschan[nSpect] = {nSChan, nSChan}, ischan[nSpect] = {1, 1+nSChan};
+  double sfreq[nSpect] = {5.0, 5.5}, sdf[nSpect] = {0.001, -0.001};
+  double restfreq[nSpect] = {0.0, 0.0};
+  double antpos[3*nAnt] = {0, 100, 250, 0, -50, 20, 0, 5, -5};
+  double ra = 1.0, dec = -0.5;
+  float inttime = 10, jyperk = 12, epoch = 2000, dra = 0, ddec = 0;
+
+  uvputvr_c(tno, H_BYTE, "telescop", "ATCA", 4);
+  uvputvr_c(tno, H_BYTE, "source", "TESTSRC", 7);
+  uvputvr_c(tno, H_INT, "nants", (char *)&nants, 1);
+  uvputvr_c(tno, H_DBLE, "antpos", (char *)antpos, 3*nAnt);
+  uvputvr_c(tno, H_INT, "npol", (char *)&npol, 1);
+  uvputvr_c(tno, H_INT, "pol", (char *)&pol, 1);
+  uvputvr_c(tno, H_INT, "nspect", (char *)&nspect, 1);
+  uvputvr_c(tno, H_INT, "nwide", (char *)&nwide, 1);
+  uvputvr_c(tno, H_INT, "nschan", (char *)nschan, nSpect);
+  uvputvr_c(tno, H_INT, "ischan", (char *)ischan, nSpect);
+  uvputvr_c(tno, H_DBLE, "sfreq", (char *)sfreq, nSpect);
+  uvputvr_c(tno, H_DBLE, "sdf", (char *)sdf, nSpect);
+  uvputvr_c(tno, H_DBLE, "restfreq", (char *)restfreq, nSpect);
+  uvputvr_c(tno, H_DBLE, "ra", (char *)&ra, 1);
+  uvputvr_c(tno, H_DBLE, "dec", (char *)&dec, 1);
+  uvputvr_c(tno, H_REAL, "dra", (char *)&dra, 1);
+  uvputvr_c(tno, H_REAL, "ddec", (char *)&ddec, 1);
+  uvputvr_c(tno, H_REAL, "inttime", (char *)&inttime, 1);
+  uvputvr_c(tno, H_REAL, "jyperk", (char *)&jyperk, 1);
+  uvputvr_c(tno, H_REAL, "epoch", (char *)&epoch, 1);
+
+  const int nchan = nSpect*nSChan;
+  double preamble[5];
+  float vis[2*nchan], systemp[nAnt*nSpect];
+  int flags[nchan];
+  for (int t = 0; t < nTimes; t++) {
+    if (t % tsysInterval == 0) {
+      for (int i = 0; i < nAnt*nSpect; i++) systemp[i] = 30 + t/tsysInterval + i;
+      uvputvr_c(tno, H_REAL, "systemp", (char *)systemp, nAnt*nSpect);
+    }
+    for (int a1 = 1; a1 <= nAnt; a1++) {
+      for (int a2 = a1+1; a2 <= nAnt; a2++) {
+        preamble[0] = 10.0*a1 + 0.01*t;
+        preamble[1] = -5.0*a2 + 0.02*t;
+        preamble[2] = 0.5*(a2-a1);
+        preamble[3] = 2455000.5 + t*inttime/86400.0;
+        preamble[4] = 256*a1 + a2;
+        for (int ch = 0; ch < nchan; ch++) {
+          vis[2*ch]   = a1 + 0.1*ch + 0.001*t;
+          vis[2*ch+1] = a2 - 0.2*ch;
+          flags[ch]   = ((t + ch) % 7 != 0);
+        }
+        uvwrite_c(tno, preamble, vis, flags, nchan);
+      }
+    }
+  }
+  uvclose_c(tno);
+}
+
+void importDataset(String uvname, const String& msname, Bool threaded)
+{
+  Importmiriad bf(uvname, 0, true);
+  Block<Int> spws(1, -1), wides(1, -1);
+  bf.checkInput(spws, wides);
+  bf.setupMeasurementSet(msname);
+  bf.fillAntennaTable();
+  bf.fillMSMainTable(threaded);
+  bf.fillSyscalTable();
+  bf.fillSpectralWindowTable("TOPO");
+  bf.fillFieldTable();
+  bf.fillSourceTable();
+  bf.fillFeedTable();
+  bf.fixEpochReferences();
+  bf.fillObsTables();
+  bf.close();
+}
+
+}
+
+TEST( ImportmiriadTest , ThreadedMatchesSerial ) {
+
+  char tmpdir[] = "/tmp/tImportmiriadXXXXXX";
+  ASSERT_TRUE(mkdtemp(tmpdir) != NULL);
+  String dir(tmpdir);
+
+  writeDataset(dir + "/test.uv");
+  importDataset(dir + "/test.uv", dir + "/serial.ms", false);
+  importDataset(dir + "/test.uv", dir + "/threaded.ms", true);
+
+  {
+    MeasurementSet serial(dir + "/serial.ms");
+    MeasurementSet threaded(dir + "/threaded.ms");
+    ROMSColumns s(serial), t(threaded);
+
+    // one row per baseline and window
+    ASSERT_EQ(uInt(nTimes*3*nSpect), serial.nrow());
+    ASSERT_EQ(serial.nrow(), threaded.nrow());
+    EXPECT_TRUE(allEQ(s.time().getColumn(), t.time().getColumn()));
+    EXPECT_TRUE(allEQ(s.antenna1().getColumn(), t.antenna1().getColumn()));
+    EXPECT_TRUE(allEQ(s.antenna2().getColumn(), t.antenna2().getColumn()));
+    EXPECT_TRUE(allEQ(s.dataDescId().getColumn(), t.dataDescId().getColumn()));
+    EXPECT_TRUE(allEQ(s.fieldId().getColumn(), t.fieldId().getColumn()));
+    EXPECT_TRUE(allEQ(s.scanNumber().getColumn(), t.scanNumber().getColumn()));
+    EXPECT_TRUE(allEQ(s.uvw().getColumn(), t.uvw().getColumn()));
+    EXPECT_TRUE(allEQ(s.weight().getColumn(), t.weight().getColumn()));
+    EXPECT_TRUE(allEQ(s.sigma().getColumn(), t.sigma().getColumn()));
+    EXPECT_TRUE(allEQ(s.flagRow().getColumn(), t.flagRow().getColumn()));
+    for (uInt row = 0; row < serial.nrow(); row++) {
+      ASSERT_TRUE(allEQ(s.data()(row), t.data()(row))) << "DATA row " << row;
+      ASSERT_TRUE(allEQ(s.flag()(row), t.flag()(row))) << "FLAG row " << row;
+    }
+
+    // and a few rows against what writeDataset put in: rows come in
+    // (time, baseline, window) order, the visibilities are conjugated, a
+    // MIRIAD flag of 0 means bad and the weight follows uvinfo_variance()
+    const int times[] = {0, 17, nTimes-1};
+    const double sdf[nSpect] = {0.001, -0.001};
+    const float inttime = 10, jyperk = 12;
+    for (int t : times) {
+      float tsys[nAnt];
+      for (int a = 0; a < nAnt; a++) tsys[a] = 30 + t/tsysInterval + a;
+      for (int b = 0; b < 3; b++) {
+        for (int sno = 0; sno < nSpect; sno++) {
+          uInt row = (t*3 + b)*nSpect + sno;
+          int a1 = s.antenna1()(row), a2 = s.antenna2()(row);
+          ASSERT_EQ(sno, s.dataDescId()(row)) << "row " << row;
+          Matrix<Complex> data = s.data()(row);
+          Matrix<Bool> flag = s.flag()(row);
+          ASSERT_EQ(IPosition(2, 1, nSChan), data.shape()) << "row " << row;
+          for (int chan = 0; chan < nSChan; chan++) {
+            int ch = sno*nSChan + chan;
+            Complex expected(a1+1 + 0.1*ch + 0.001*t, -(a2+1 - 0.2*ch));
+            EXPECT_NEAR(expected.real(), data(0,chan).real(), 1e-4)
+              << "DATA row " << row << " chan " << chan;
+            EXPECT_NEAR(expected.imag(), data(0,chan).imag(), 1e-4)
+              << "DATA row " << row << " chan " << chan;
+            EXPECT_EQ((t + ch) % 7 == 0, flag(0,chan))
+              << "FLAG row " << row << " chan " << chan;
+          }
+          Float expected = inttime*fabs(sdf[sno]*1e9)/jyperk/jyperk/
+                           (tsys[a1]*tsys[a2]);
+          EXPECT_NEAR(expected, s.weight()(row)(IPosition(1,0)),
+                      1e-5*expected) << "WEIGHT row " << row;
+        }
+      }
+    }
+
+    // the ANTENNA and SYSCAL rows added while reading
+    ASSERT_EQ(uInt(nAnt), threaded.antenna().nrow());
+    ASSERT_EQ(serial.antenna().nrow(), threaded.antenna().nrow());
+    EXPECT_TRUE(allEQ(s.antenna().position().getColumn(),
+                      t.antenna().position().getColumn()));
+    EXPECT_TRUE(allEQ(s.antenna().name().getColumn(),
+                      t.antenna().name().getColumn()));
+
+    EXPECT_GT(threaded.sysCal().nrow(), uInt(nAnt*nSpect));
+    ASSERT_EQ(serial.sysCal().nrow(), threaded.sysCal().nrow());
+    EXPECT_TRUE(allEQ(s.sysCal().time().getColumn(),
+                      t.sysCal().time().getColumn()));
+    EXPECT_TRUE(allEQ(s.sysCal().antennaId().getColumn(),
+                      t.sysCal().antennaId().getColumn()));
+    EXPECT_TRUE(allEQ(s.sysCal().spectralWindowId().getColumn(),
+                      t.sysCal().spectralWindowId().getColumn()));
+    EXPECT_TRUE(allEQ(s.sysCal().tsys().getColumn(),
+                      t.sysCal().tsys().getColumn()));
+  }
+
+  system((std::string("rm -rf ") + tmpdir).c_str());
+}
@@ -322,68 +322,95 @@ void StatWtTVI::_clearCache() {
 }
 
 void StatWtTVI::_gatherAndComputeWeights() const {
-    // Drive NEXT LOWER layer's ViImpl to gather data into allvis:
+    // Drive NEXT LOWER layer's ViImpl to gather statistics:
     //  Assumes all sub-chunks in the current chunk are to be used
     //   for the variance calculation
-    //  Essentially, we are sorting the incoming data into
-    //   allvis, to enable a convenient variance calculation
+    //  Rather than copying the data of each (baseline, spw, chan bin)
+    //   into its own container, each sub-chunk is reduced to per
+    //   (row, chan bin) variance accumulators in parallel, which are
+    //   then merged (in row order) into per (baseline, spw, chan bin)
+    //   accumulators
     ViImplementation2* vii = getVii();
     VisBuffer2* vb = vii->getVisBuffer();
     _newRowIDs.resize(vii->nRowsInChunk());
-    // baseline to visibility, flag maps
-    std::map<BaselineChanBin, Cube<Complex>> data;
-    std::map<BaselineChanBin, Cube<Bool>> flags;
-    IPosition blc, trc;
+    std::map<BaselineChanBin, uInt> groupIndex;
+    std::vector<BaselineChanBin> groups;
+    std::vector<VarianceAccumulator> groupStats;
+    // total number of points, flagged or not, in each group
+    std::vector<uInt64> groupNPts;
+    std::vector<uInt> rowBinGroup;
+    std::vector<Int> rowBinRow;
+    std::vector<ChanBin> rowBinBin;
+    std::vector<VarianceAccumulator> rowBinStats;
     for (vii->origin();vii->more();vii->next()) {
-        const auto rowIDs = vb->rowIds();
-        const auto ant1 = vb->antenna1();
-        const auto ant2 = vb->antenna2();
+        const auto& ant1 = vb->antenna1();
+        const auto& ant2 = vb->antenna2();
         // [nC,nF,nR)
-        const auto dataCube = vb->visCubeCorrected();
-        IPosition dataCubeBLC(3, 0);
-        auto dataCubeTRC = dataCube.shape() - 1;
-        dataCubeTRC[2] = 0;
-        const auto flagCube = vb->flagCube();
+        const auto& dataCube = vb->visCubeCorrected();
+        const auto& flagCube = vb->flagCube();
         const auto nrows = vb->nRows();
-        const auto npol = dataCube.nrow();
-        //const auto nchan = dataCube.ncolumn();
-        const auto spws = vb->spectralWindows();
-        blc = dataCubeBLC;
-        trc = dataCubeTRC;
+        const Int npol = dataCube.nrow();
+        const Int nchan = dataCube.ncolumn();
+        const auto& spws = vb->spectralWindows();
+        rowBinGroup.clear();
+        rowBinRow.clear();
+        rowBinBin.clear();
         for (Int i=0; i<nrows; ++i) {
-            dataCubeBLC[2] = i;
-            dataCubeTRC[2] = i;
             BaselineChanBin blcb;
             blcb.baseline = _baseline(ant1[i], ant2[i]);
             auto spw = spws[i];
-            auto bins = _chanBins.find(spw)->second;
+            const auto& bins = _chanBins.find(spw)->second;
             blcb.spw = spw;
             auto citer = bins.begin();
             auto cend = bins.end();
             for (; citer!=cend; ++citer) {
-                dataCubeBLC[1] = citer->start;
-                dataCubeTRC[1] = citer->end;
-                blcb.chanBin.start = citer->start;
-                blcb.chanBin.end = citer->end;
-                if (data.find(blcb) == data.end()) {
-                    data[blcb] = dataCube(dataCubeBLC, dataCubeTRC);
-                    flags[blcb] = flagCube(dataCubeBLC, dataCubeTRC);
+                blcb.chanBin = *citer;
+                auto giter = groupIndex.find(blcb);
+                uInt g = 0;
+                if (giter == groupIndex.end()) {
+                    g = groups.size();
+                    groupIndex[blcb] = g;
+                    groups.push_back(blcb);
+                    groupStats.push_back(VarianceAccumulator());
+                    groupNPts.push_back(0);
                 }
                 else {
-                    const auto nplane = data[blcb].nplane();
-                    blc[2] = nplane;
-                    trc[2] = nplane;
-                    auto nchan = citer->end - citer->start + 1;
-                    data[blcb].resize(npol, nchan, nplane+1, True);
-                    flags[blcb].resize(npol, nchan, nplane+1, True);
-                    data[blcb](blc, trc) = dataCube(dataCubeBLC, dataCubeTRC);
-                    flags[blcb](blc, trc) = flagCube(dataCubeBLC, dataCubeTRC);
+                    g = giter->second;
                 }
+                rowBinGroup.push_back(g);
+                rowBinRow.push_back(i);
+                rowBinBin.push_back(*citer);
             }
         }
+        const Int nRowBins = rowBinGroup.size();
+        rowBinStats.assign(nRowBins, VarianceAccumulator());
+        Bool delData, delFlags;
+        const Complex* dataPtr = dataCube.getStorage(delData);
+        const Bool* flagPtr = flagCube.getStorage(delFlags);
+#pragma omp parallel for schedule(dynamic, 16)
+        for (Int k=0; k<nRowBins; ++k) {
+            auto& stats = rowBinStats[k];
+            const auto& bin = rowBinBin[k];
+            const auto offset = ((size_t)rowBinRow[k]*nchan + bin.start)*npol;
+            const auto n = (size_t)(bin.end - bin.start + 1)*npol;
+            const auto* d = dataPtr + offset;
+            const auto* f = flagPtr + offset;
+            for (size_t j=0; j<n; ++j) {
+                if (! f[j]) {
+                    stats.add(d[j]);
+                }
+            }
+        }
+        dataCube.freeStorage(dataPtr, delData);
+        flagCube.freeStorage(flagPtr, delFlags);
+        for (Int k=0; k<nRowBins; ++k) {
+            const auto g = rowBinGroup[k];
+            groupStats[g].merge(rowBinStats[k]);
+            groupNPts[g] += (uInt64)(rowBinBin[k].end - rowBinBin[k].start + 1)*npol;
+        }
     }
-    // data has been gathered, now compute weights
-    _computeWeights(data, flags);
+    // statistics have been gathered, now compute weights
+    _computeWeights(groups, groupStats, groupNPts);
 }
 
 void StatWtTVI::writeBackChanges(VisBuffer2 * vb) {
@@ -406,45 +433,25 @@ StatWtTVI::Baseline StatWtTVI::_baseline(uInt ant1, uInt ant2) {
 }
 
 void StatWtTVI::_computeWeights(
-    const map<BaselineChanBin, Cube<Complex>>& data,
-    const map<BaselineChanBin, Cube<Bool>>& flags
+    const std::vector<BaselineChanBin>& groups,
+    const std::vector<VarianceAccumulator>& stats,
+    const std::vector<uInt64>& npts
 ) const {
-    ClassicalStatistics<Double, Array<Float>::const_iterator, Array<Bool>::const_iterator> csReal, csImag;
-    std::set<StatisticsData::STATS> stats;
-    stats.insert(StatisticsData::VARIANCE);
-    csReal.setStatsToCalculate(stats);
-    csImag.setStatsToCalculate(stats);
-    auto diter = data.begin();
-    auto dend = data.end();
-    auto fiter = flags.begin();
-    for (; diter!=dend; ++diter, ++fiter) {
-        auto blcb = diter->first;
-        auto dataForBLCB = diter->second;
-        const auto npts = dataForBLCB.size();
-        if (npts == 1) {
+    const auto ngroups = groups.size();
+    for (size_t i=0; i<ngroups; ++i) {
+        const auto& blcb = groups[i];
+        if (npts[i] == 1) {
             // one data point, trivial
             _weights[blcb] = 0;
         }
+        else if (stats[i].npts == 0) {
+            // all data flagged, trivial
+            _weights[blcb] = 0;
+        }
         else {
-            auto flagsForBLCB = fiter->second;
-            if (allTrue(flagsForBLCB)) {
-                // all data flagged, trivial
-                _weights[blcb] = 0;
-            }
-            else {
-                // some data not flagged
-                const auto realPart = real(dataForBLCB);
-                const auto imagPart = imag(dataForBLCB);
-                const auto mask = ! flagsForBLCB;
-                const auto riter = realPart.begin();
-                const auto iiter = imagPart.begin();
-                const auto miter = mask.begin();
-                csReal.setData(riter, miter, npts);
-                csImag.setData(iiter, miter, npts);
-                auto varSum = csReal.getStatistic(StatisticsData::VARIANCE)
-                    + csImag.getStatistic(StatisticsData::VARIANCE);
-                _weights[blcb] = varSum == 0 ? 0 : 2/varSum;
-            }
+            // some data not flagged
+            auto varSum = stats[i].varianceSum();
+            _weights[blcb] = varSum == 0 ? 0 : 2/varSum;
         }
     }
 }
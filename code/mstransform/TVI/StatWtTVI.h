@@ -107,6 +107,54 @@ private:
         };
     };
 
+    // Running variance of the real and imaginary parts of a set of
+    // visibilities (Welford), which can be merged with another one
+    // (Chan et al.) so that subsets can be reduced independently
+    struct VarianceAccumulator {
+        casacore::uInt64 npts = 0;
+        casacore::Double meanReal = 0;
+        casacore::Double meanImag = 0;
+        casacore::Double nvarReal = 0;
+        casacore::Double nvarImag = 0;
+
+        void add(const casacore::Complex& v) {
+            ++npts;
+            const casacore::Double re = v.real();
+            const casacore::Double im = v.imag();
+            const casacore::Double dRe = re - meanReal;
+            const casacore::Double dIm = im - meanImag;
+            meanReal += dRe/npts;
+            meanImag += dIm/npts;
+            nvarReal += dRe*(re - meanReal);
+            nvarImag += dIm*(im - meanImag);
+        }
+
+        void merge(const VarianceAccumulator& other) {
+            if (other.npts == 0) {
+                return;
+            }
+            if (npts == 0) {
+                *this = other;
+                return;
+            }
+            const casacore::Double n = npts + other.npts;
+            const casacore::Double f = (casacore::Double)npts*other.npts/n;
+            const casacore::Double dRe = other.meanReal - meanReal;
+            const casacore::Double dIm = other.meanImag - meanImag;
+            nvarReal += other.nvarReal + dRe*dRe*f;
+            nvarImag += other.nvarImag + dIm*dIm*f;
+            meanReal += dRe*other.npts/n;
+            meanImag += dIm*other.npts/n;
+            npts += other.npts;
+        }
+
+        // sum of the (sample) variances of the real and imaginary parts,
+        // 0 if there are fewer than two points
+        casacore::Double varianceSum() const {
+            return npts > 1 ? (nvarReal + nvarImag)/(npts - 1) : 0;
+        }
+    };
+
     mutable casacore::Bool _weightsComputed = false;
     mutable casacore::Bool _wtSpExists = true;
     mutable casacore::Cube<casacore::Float> _newWtSp;
@@ -122,9 +170,12 @@ private:
 
     void _gatherAndComputeWeights() const;
 
+    // npts are the total numbers of points, including flagged ones,
+    // of each group
     void _computeWeights(
-        const map<BaselineChanBin, casacore::Cube<casacore::Complex>>& data,
-        const map<BaselineChanBin, casacore::Cube<casacore::Bool>>& flags
+        const std::vector<BaselineChanBin>& groups,
+        const std::vector<VarianceAccumulator>& stats,
+        const std::vector<casacore::uInt64>& npts
     ) const;
 
     casacore::Bool _parseConfiguration(const casacore::Record &configuration);
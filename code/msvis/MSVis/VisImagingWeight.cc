@@ -33,6 +33,18 @@
 #include <casa/Arrays/ArrayMath.h>
 #include <casa/Arrays/Matrix.h>
 #include <casa/Arrays/Vector.h>
+#include <casa/Arrays/ArrayIO.h>
+#include <casa/IO/AipsIO.h>
+#include <casa/OS/Directory.h>
+#include <casa/OS/File.h>
+#include <casa/Utilities/Regex.h>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 
@@ -58,7 +70,8 @@ namespace casa { //# NAMESPACE CASA - BEGIN
   VisImagingWeight::VisImagingWeight(ROVisibilityIterator& vi, const String& rmode, const Quantity& noise,
                                      const Double robust, const Int nx, const Int ny,
                                      const Quantity& cellx, const Quantity& celly,
-                                     const Int uBox, const Int vBox, const Bool multiField) : multiFieldMap_p(-1), doFilter_p(false), robust_p(robust), rmode_p(rmode), noise_p(noise) {
+                                     const Int uBox, const Int vBox, const Bool multiField,
+                                     const String& densityCache) : multiFieldMap_p(-1), doFilter_p(false), robust_p(robust), rmode_p(rmode), noise_p(noise) {
 
       LogIO os(LogOrigin("VisSetUtil", "VisImagingWeight()", WHERE));
 
@@ -89,8 +102,21 @@ namespace casa { //# NAMESPACE CASA - BEGIN
       gwt_p[0].set(0.0);
 
       Int fields=0;
+      // Key of the density cache: the selected data of each MS and the fields
+      String cacheKey;
+      std::set<String> chanKeys;
+      Int lastMsId=-1, lastSpw=-1;
       for (vi.originChunks();vi.moreChunks();vi.nextChunk()) {
           for (vi.origin();vi.more();vi++) {
+              if(!densityCache.empty() && vb->msId()!=lastMsId){
+                  lastMsId=vb->msId();
+                  lastSpw=-1;
+                  cacheKey+=String::toString(lastMsId)+String(":")+msDensityKey(vi.ms())+String("|");
+              }
+              if(!densityCache.empty() && vb->spectralWindow()!=lastSpw){
+                  lastSpw=vb->spectralWindow();
+                  chanKeys.insert(chanDensityKey(lastMsId, lastSpw, vb->channel()));
+              }
               if(vb->newFieldId()){
                   mapid=String::toString(vb->msId())+String("_")+String::toString(vb->fieldId());
                   if(multiField){
@@ -107,11 +133,22 @@ namespace casa { //# NAMESPACE CASA - BEGIN
           }
       }
 
-      Float u, v;
       Vector<Double> sumwt(fields+1,0.0);
       f2_p.resize(fields+1);
       d2_p.resize(fields+1);
       Int fid=0;
+
+      // The density only depends on the selected data and the uv grid, so
+      // it can be reused from a previous run
+      if (!densityCache.empty()) {
+	for (std::set<String>::const_iterator it=chanKeys.begin(); it!=chanKeys.end(); ++it)
+	  cacheKey+=*it;
+	cacheKey=densityKey(cacheKey, cellx, celly, uBox, vBox, multiField, doWtSp);
+      }
+      if (!densityCache.empty() && loadDensity(densityCache, cacheKey, sumwt)) {
+	os << LogIO::NORMAL << "Using imaging weight density from " << densityCache << LogIO::POST;
+      }
+      else {
       for (vi.originChunks();vi.moreChunks();vi.nextChunk()) {
           for (vi.origin();vi.more();vi++) {
               if(vb->newFieldId())
@@ -132,42 +169,14 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 		// WS UNavailable
 		wtm.reference(vb->weight().reform(IPosition(2,1,nRow))); // use vb.weight() (corr-collapsed, w/ 1 channel)
 
-	      // Use this to mod the channel indexing below
-	      Int nChanWt=wtm.shape()(0);
-
-              for (Int row=0; row<nRow; row++) {
-                  for (Int chn=0; chn<nChan; chn++) {
-                      if(!vb->flag()(chn,row)) {
-			  Float currwt=wtm(chn%nChanWt,row);  // the weight for this chan,row
-                          Float f=vb->frequency()(chn)/C::c;
-                          u=vb->uvw()(row)(0)*f;
-                          v=vb->uvw()(row)(1)*f;
-                          Int ucell=Int(uscale_p*u+uorigin_p);
-                          Int vcell=Int(vscale_p*v+vorigin_p);
-			 
-                          if(((ucell-uBox)>0)&&((ucell+uBox)<nx)&&((vcell-vBox)>0)&&((vcell+vBox)<ny)) {
-                              for (Int iv=-vBox;iv<=vBox;iv++) {
-                                  for (Int iu=-uBox;iu<=uBox;iu++) {
-				      gwt_p[fid](ucell+iu,vcell+iv)+=currwt;
-                                      sumwt[fid]+=currwt;
-                                  }
-                              }
-                          }
-                          ucell=Int(-uscale_p*u+uorigin_p);
-                          vcell=Int(-vscale_p*v+vorigin_p);
-                          if(((ucell-uBox)>0)&&((ucell+uBox)<nx)&&((vcell-vBox)>0)&&((vcell+vBox)<ny)) {
-                              for (Int iv=-vBox;iv<=vBox;iv++) {
-                                  for (Int iu=-uBox;iu<=uBox;iu++) {
-                                      gwt_p[fid](ucell+iu,vcell+iv)+=currwt;
-                                      sumwt[fid]+=currwt;
-                                  }
-                              }
-                          }
-                      }
-                  }
-              }
+	      Matrix<Double> freq(nChan, 1);
+	      freq.column(0)=vb->frequency();
+	      addDensity(gwt_p[fid], sumwt[fid], vb->flag(), vb->uvwMat(), freq, wtm, uBox, vBox);
           }
       }
+      if (!densityCache.empty())
+	saveDensity(densityCache, cacheKey, sumwt);
+      }
 
       // We use the approximation that all statistical weights are equal to
       // calculate the average summed weights (over visibilities, not bins!)
@@ -274,7 +283,8 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 				     const String& rmode, const Quantity& noise,
                                      const Double robust, const Int nx, const Int ny,
                                      const Quantity& cellx, const Quantity& celly,
-                                     const Int uBox, const Int vBox, const Bool multiField) : multiFieldMap_p(-1), doFilter_p(false), robust_p(robust), rmode_p(rmode), noise_p(noise) {
+                                     const Int uBox, const Int vBox, const Bool multiField,
+                                     const String& densityCache) : multiFieldMap_p(-1), doFilter_p(false), robust_p(robust), rmode_p(rmode), noise_p(noise) {
 
       LogIO os(LogOrigin("VisSetUtil", "VisImagingWeight()", WHERE));
 
@@ -306,8 +316,21 @@ namespace casa { //# NAMESPACE CASA - BEGIN
       Bool doWtSp=visIter.weightSpectrumExists();
 
       Int fields=0;
+      // Key of the density cache: the selected data of each MS and the fields
+      String cacheKey;
+      std::set<String> chanKeys;
+      Int lastMsId=-1, lastSpw=-1;
       for (visIter.originChunks();visIter.moreChunks();visIter.nextChunk()) {
           for (visIter.origin();visIter.more();visIter.next()) {
+              if(!densityCache.empty() && vb->msId()!=lastMsId){
+                  lastMsId=vb->msId();
+                  lastSpw=-1;
+                  cacheKey+=String::toString(lastMsId)+String(":")+msDensityKey(visIter.ms())+String("|");
+              }
+              if(!densityCache.empty() && vb->spectralWindows()(0)!=lastSpw){
+                  lastSpw=vb->spectralWindows()(0);
+                  chanKeys.insert(chanDensityKey(lastMsId, lastSpw, vb->getChannelNumbers(0)));
+              }
               if(vb->isNewFieldId()){
                   mapid=String::toString(vb->msId())+String("_")+String::toString(vb->fieldId()[0]);
                   if(multiField){
@@ -324,11 +347,22 @@ namespace casa { //# NAMESPACE CASA - BEGIN
           }
       }
 
-      Float u, v;
       Vector<Double> sumwt(fields+1,0.0);
       f2_p.resize(fields+1);
       d2_p.resize(fields+1);
       Int fid=0;
+
+      // The density only depends on the selected data and the uv grid, so
+      // it can be reused from a previous run
+      if (!densityCache.empty()) {
+	for (std::set<String>::const_iterator it=chanKeys.begin(); it!=chanKeys.end(); ++it)
+	  cacheKey+=*it;
+	cacheKey=densityKey(cacheKey, cellx, celly, uBox, vBox, multiField, doWtSp);
+      }
+      if (!densityCache.empty() && loadDensity(densityCache, cacheKey, sumwt)) {
+	os << LogIO::NORMAL << "Using imaging weight density from " << densityCache << LogIO::POST;
+      }
+      else {
       for (visIter.originChunks();visIter.moreChunks();visIter.nextChunk()) {
           for (visIter.origin();visIter.more();visIter.next()) {
               if(vb->isNewFieldId())
@@ -350,46 +384,18 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 	      }
 	      unPolChanWeight(wtm,wtc);   // Collapse on corr axis
 
-	      // Used for mod of chn index below
-	      Int nChanWt=wtm.shape()(0);
-
 	      //Oww !!! temporary implementation of old vb.flag just to see if things work
 	      Matrix<Bool> flag;
 	      cube2Matrix(vb->flagCube(), flag);
-              for (Int row=0; row<nRow; row++) {
-                  for (Int chn=0; chn<nChan; chn++) {
-                	  
-		    Float currwt=wtm(chn%nChanWt,row);  // the weight for this chan,row
-			
-                      if(!flag(chn,row)) {
-                          Float f=vb->getFrequency(row, chn)/C::c;
-                          u=vb->uvw()(0,row)*f;
-                          v=vb->uvw()(1,row)*f;
-                          Int ucell=Int(uscale_p*u+uorigin_p);
-                          Int vcell=Int(vscale_p*v+vorigin_p);
-                          if(((ucell-uBox)>0)&&((ucell+uBox)<nx)&&((vcell-vBox)>0)&&((vcell+vBox)<ny)) {
-                              for (Int iv=-vBox;iv<=vBox;iv++) {
-                                  for (Int iu=-uBox;iu<=uBox;iu++) {
-				      gwt_p[fid](ucell+iu,vcell+iv)+=currwt;
-                                      sumwt[fid]+=currwt;
-                                  }
-                              }
-                          }
-                          ucell=Int(-uscale_p*u+uorigin_p);
-                          vcell=Int(-vscale_p*v+vorigin_p);
-                          if(((ucell-uBox)>0)&&((ucell+uBox)<nx)&&((vcell-vBox)>0)&&((vcell+vBox)<ny)) {
-                              for (Int iv=-vBox;iv<=vBox;iv++) {
-                                  for (Int iu=-uBox;iu<=uBox;iu++) {
-                                      gwt_p[fid](ucell+iu,vcell+iv)+=currwt;
-                                      sumwt[fid]+=currwt;
-                                  }
-                              }
-                          }
-                      }
-                  }
-              }
+	      Matrix<Double> freq(nChan, nRow);
+	      for (Int row=0; row<nRow; row++)
+		freq.column(row)=vb->getFrequencies(row);
+	      addDensity(gwt_p[fid], sumwt[fid], flag, vb->uvw(), freq, wtm, uBox, vBox);
           }
       }
+      if (!densityCache.empty())
+	saveDensity(densityCache, cacheKey, sumwt);
+      }
 
       // We use the approximation that all statistical weights are equal to
       // calculate the average summed weights (over visibilities, not bins!)
@@ -727,6 +733,230 @@ void VisImagingWeight::weightNatural(Matrix<Float>& imagingWeight, const Matrix<
     
     
   }
+  void VisImagingWeight::addDensity(Matrix<Float>& grid, Double& sumwt,
+				    const Matrix<Bool>& flag, const Matrix<Double>& uvw,
+				    const Matrix<Double>& freq, const Matrix<Float>& wtm,
+				    const Int uBox, const Int vBox) const
+  {
+    Int nRow=flag.shape()(1);
+    Int nChan=flag.shape()(0);
+    Int nChanWt=wtm.shape()(0);
+    Bool freqPerRow=(freq.shape()(1) > 1);
+    Int nSamp=nRow*nChan;
+
+    // First find the cells of (u,v) and (-u,-v) for every sample (in
+    // parallel); ucell=-1 marks a point whose box is not on the grid
+    std::vector<Int> cells(4*nSamp, -1);
+    std::vector<Float> wts(nSamp, 0.0);
+    Double sumPointWt=0.0;
+#pragma omp parallel for reduction(+:sumPointWt) if(nSamp > 4096)
+    for (Int row=0; row<nRow; row++) {
+      for (Int chn=0; chn<nChan; chn++) {
+	if(flag(chn,row)) continue;
+	Int k=row*nChan+chn;
+	Float currwt=wtm(chn%nChanWt,row);  // the weight for this chan,row
+	wts[k]=currwt;
+	Float f=freq(chn, freqPerRow ? row : 0)/C::c;
+	Float u=uvw(0,row)*f;
+	Float v=uvw(1,row)*f;
+	for (Int p=0; p<2; p++) {
+	  Int ucell= p==0 ? Int(uscale_p*u+uorigin_p) : Int(-uscale_p*u+uorigin_p);
+	  Int vcell= p==0 ? Int(vscale_p*v+vorigin_p) : Int(-vscale_p*v+vorigin_p);
+	  if(((ucell-uBox)>0)&&((ucell+uBox)<nx_p)&&((vcell-vBox)>0)&&((vcell+vBox)<ny_p)) {
+	    cells[4*k+2*p]=ucell;
+	    cells[4*k+2*p+1]=vcell;
+	    sumPointWt+=currwt;
+	  }
+	}
+      }
+    }
+    sumwt+=sumPointWt*(2*uBox+1)*(2*vBox+1);
+
+    // Then grid them, each thread owning a band of v rows of the grid.
+    // Every cell receives its contributions in sample order, so the
+    // result does not depend on the number of threads.
+    Int nBand=1;
+#ifdef _OPENMP
+    if (nSamp > 4096)
+      nBand=min(omp_get_max_threads(), ny_p);
+#endif
+    // Add point q (sample q/2, (u,v) or (-u,-v) for q%2) to rows [v0,v1)
+    auto gridPoint=[&](Int q, Int v0, Int v1) {
+      Int ucell=cells[2*q];
+      Int vcell=cells[2*q+1];
+      Int ivlo=max(-vBox, v0-vcell);
+      Int ivhi=min(vBox, v1-1-vcell);
+      for (Int iv=ivlo;iv<=ivhi;iv++) {
+	for (Int iu=-uBox;iu<=uBox;iu++) {
+	  grid(ucell+iu,vcell+iv)+=wts[q/2];
+	}
+      }
+    };
+    if (nBand == 1) {
+      for (Int q=0; q<2*nSamp; q++)
+	if (cells[2*q] >= 0)
+	  gridPoint(q, 0, ny_p);
+      return;
+    }
+
+    // Hand each band only the points whose box touches it.  Thread c lists
+    // the points of its slice of samples per band (a box can straddle
+    // bands), and the lists are laid out band by band in slice order, which
+    // keeps the points of every band in sample order.
+    std::vector<Int> bandOf(ny_p);
+    for (Int band=0; band<nBand; band++)
+      for (Int v=(band*ny_p)/nBand; v<((band+1)*ny_p)/nBand; v++)
+	bandOf[v]=band;
+    std::vector<Int> nPoints(nBand*nBand, 0);
+#pragma omp parallel for schedule(static)
+    for (Int c=0; c<nBand; c++) {
+      Int q1=Int((Int64(c+1)*2*nSamp)/nBand);
+      for (Int q=Int((Int64(c)*2*nSamp)/nBand); q<q1; q++) {
+	if (cells[2*q] < 0) continue;
+	for (Int band=bandOf[cells[2*q+1]-vBox]; band<=bandOf[cells[2*q+1]+vBox]; band++)
+	  nPoints[c*nBand+band]++;
+      }
+    }
+    std::vector<Int> next(nBand*nBand);
+    std::vector<Int> bandStart(nBand+1);
+    Int nTotal=0;
+    for (Int band=0; band<nBand; band++) {
+      bandStart[band]=nTotal;
+      for (Int c=0; c<nBand; c++) {
+	next[c*nBand+band]=nTotal;
+	nTotal+=nPoints[c*nBand+band];
+      }
+    }
+    bandStart[nBand]=nTotal;
+    std::vector<Int> points(nTotal);
+#pragma omp parallel for schedule(static)
+    for (Int c=0; c<nBand; c++) {
+      Int q1=Int((Int64(c+1)*2*nSamp)/nBand);
+      for (Int q=Int((Int64(c)*2*nSamp)/nBand); q<q1; q++) {
+	if (cells[2*q] < 0) continue;
+	for (Int band=bandOf[cells[2*q+1]-vBox]; band<=bandOf[cells[2*q+1]+vBox]; band++)
+	  points[next[c*nBand+band]++]=q;
+      }
+    }
+#pragma omp parallel for schedule(static)
+    for (Int band=0; band<nBand; band++) {
+      Int v0=(band*ny_p)/nBand;
+      Int v1=((band+1)*ny_p)/nBand;
+      for (Int i=bandStart[band]; i<bandStart[band+1]; i++)
+	gridPoint(points[i], v0, v1);
+    }
+  }
+
+  String VisImagingWeight::densityKey(const String& msKeys, const Quantity& cellx,
+				      const Quantity& celly, const Int uBox, const Int vBox,
+				      const Bool multiField, const Bool doWtSp) const
+  {
+    std::ostringstream oss;
+    oss.precision(17);
+    oss << msKeys << nx_p << "x" << ny_p << ":" << cellx.get("rad").getValue()
+	<< "x" << celly.get("rad").getValue() << ":" << uBox << "x" << vBox
+	<< ":" << multiField << ":" << doWtSp;
+    for (uInt k=0; k < multiFieldMap_p.ndefined(); ++k)
+      oss << ":" << multiFieldMap_p.getKey(k) << "=" << multiFieldMap_p.getVal(k);
+    return oss.str();
+  }
+
+  String VisImagingWeight::msDensityKey(const MeasurementSet& ms)
+  {
+    // The tables holding the selected rows, with the newest change of their
+    // data files (so that e.g. flagging invalidates a cached density), and
+    // a hash of the selected row numbers
+    std::ostringstream oss;
+    Block<String> parts=ms.getPartNames(true);
+    for (uInt i=0; i < parts.nelements(); ++i) {
+      uInt mtime=0;
+      if (File(parts[i]).isDirectory()) {
+	Directory dir(parts[i]);
+	Vector<String> files=dir.find(Regex("table\\.f[0-9]+.*"), false, false);
+	for (uInt k=0; k < files.nelements(); ++k)
+	  mtime=max(mtime, File(parts[i]+"/"+files[k]).modifyTime());
+      }
+      oss << parts[i] << "@" << mtime << ";";
+    }
+    Vector<uInt> rows=ms.rowNumbers();
+    uInt64 hash=14695981039346656037ULL;
+    for (uInt k=0; k < rows.nelements(); ++k)
+      hash=(hash^rows[k])*1099511628211ULL;
+    oss << ms.nrow() << "#" << hash;
+    return oss.str();
+  }
+
+  String VisImagingWeight::chanDensityKey(const Int msId, const Int spw,
+					  const Vector<Int>& chans)
+  {
+    // The selected channels of a spectral window of an MS, so that another
+    // channel selection on the same rows does not match
+    uInt64 hash=14695981039346656037ULL;
+    for (uInt k=0; k < chans.nelements(); ++k)
+      hash=(hash^uInt64(chans[k]))*1099511628211ULL;
+    std::ostringstream oss;
+    oss << msId << "_" << spw << ":" << chans.nelements() << "#" << hash << "|";
+    return oss.str();
+  }
+
+  Bool VisImagingWeight::loadDensity(const String& cacheName, const String& key,
+				     Vector<Double>& sumwt)
+  {
+    if (!File(cacheName).exists())
+      return false;
+    Block<Matrix<Float> > grids(gwt_p.nelements());
+    Vector<Double> cachedSumwt;
+    try {
+      AipsIO aio(cacheName);
+      aio.getstart("VisImagingWeightDensity");
+      String cachedKey;
+      uInt nGrid;
+      aio >> cachedKey >> nGrid;
+      if (cachedKey != key || nGrid != gwt_p.nelements())
+	return false;
+      for (uInt k=0; k < nGrid; ++k) {
+	Array<Float> arr;
+	aio >> arr;
+	if (arr.shape() != IPosition(2, nx_p, ny_p))
+	  return false;
+	grids[k].reference(arr);
+      }
+      aio >> cachedSumwt;
+      aio.getend();
+    }
+    catch (AipsError& x) {
+      LogIO os(LogOrigin("VisImagingWeight", "loadDensity()", WHERE));
+      os << LogIO::WARN << "Could not read imaging weight density from "
+	 << cacheName << ": " << x.getMesg() << LogIO::POST;
+      return false;
+    }
+    if (cachedSumwt.nelements() != sumwt.nelements())
+      return false;
+    for (uInt k=0; k < gwt_p.nelements(); ++k)
+      gwt_p[k].reference(grids[k]);
+    sumwt=cachedSumwt;
+    return true;
+  }
+
+  void VisImagingWeight::saveDensity(const String& cacheName, const String& key,
+				     const Vector<Double>& sumwt) const
+  {
+    try {
+      AipsIO aio(cacheName, ByteIO::New);
+      aio.putstart("VisImagingWeightDensity", 1);
+      aio << key << uInt(gwt_p.nelements());
+      for (uInt k=0; k < gwt_p.nelements(); ++k)
+	aio << gwt_p[k];
+      aio << sumwt;
+      aio.putend();
+    }
+    catch (AipsError& x) {
+      LogIO os(LogOrigin("VisImagingWeight", "saveDensity()", WHERE));
+      os << LogIO::WARN << "Could not save imaging weight density to "
+	 << cacheName << ": " << x.getMesg() << LogIO::POST;
+    }
+  }
+
   void VisImagingWeight::cube2Matrix(const Cube<Bool>& fcube, Matrix<Bool>& fMat)
   {
 	  fMat.resize(fcube.shape()[1], fcube.shape()[2]);
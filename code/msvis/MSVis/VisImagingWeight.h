@@ -79,10 +79,14 @@ class ROVisibilityIterator;
      //Constructor to calculate uniform weight schemes; include Brigg's and super/uniform
      //If multiField=true, the weight density calcution is done on a per field basis, 
      //else it is all fields combined
+     // If densityCache is given, the weight density is read from that file when
+     // it was saved there for the same selected data, uv grid and fields, and
+     // is saved there otherwise.
      VisImagingWeight(ROVisibilityIterator& vi, const casacore::String& rmode, const casacore::Quantity& noise,
                                const casacore::Double robust, const casacore::Int nx, const casacore::Int ny,
                                const casacore::Quantity& cellx, const casacore::Quantity& celly,
-		      const casacore::Int uBox, const casacore::Int vBox, const casacore::Bool multiField=false);
+		      const casacore::Int uBox, const casacore::Int vBox, const casacore::Bool multiField=false,
+		      const casacore::String& densityCache=casacore::String(""));
      //Constructor for uniform style weighting when the weight density is calculated 
      //elsewhere
      VisImagingWeight(ROVisibilityIterator& vi, casacore::Block<casacore::Matrix<casacore::Float> >& grids, const casacore::String& rmode, const casacore::Quantity& noise,
@@ -94,7 +98,8 @@ class ROVisibilityIterator;
      VisImagingWeight(vi::VisibilityIterator2& vi, const casacore::String& rmode, const casacore::Quantity& noise,
                                const casacore::Double robust, const casacore::Int nx, const casacore::Int ny,
                                const casacore::Quantity& cellx, const casacore::Quantity& celly,
-		      const casacore::Int uBox, const casacore::Int vBox, const casacore::Bool multiField=false);
+		      const casacore::Int uBox, const casacore::Int vBox, const casacore::Bool multiField=false,
+		      const casacore::String& densityCache=casacore::String(""));
 
      virtual ~VisImagingWeight();
 
@@ -153,6 +158,28 @@ class ROVisibilityIterator;
 
     private:
      void cube2Matrix(const casacore::Cube<casacore::Bool>& fcube, casacore::Matrix<casacore::Bool>& fMat);
+     // Add the uniform weight density of one buffer to grid, and the weight
+     // added to sumwt. freq is [nchan,1] or [nchan,nrow]
+     void addDensity(casacore::Matrix<casacore::Float>& grid, casacore::Double& sumwt,
+                     const casacore::Matrix<casacore::Bool>& flag, const casacore::Matrix<casacore::Double>& uvw,
+                     const casacore::Matrix<casacore::Double>& freq, const casacore::Matrix<casacore::Float>& wtm,
+                     const casacore::Int uBox, const casacore::Int vBox) const;
+     // Description of the selected data of an MS for the density cache
+     static casacore::String msDensityKey(const casacore::MeasurementSet& ms);
+     // Key of the channels selected in spectral window spw of MS msId
+     static casacore::String chanDensityKey(const casacore::Int msId, const casacore::Int spw,
+                                            const casacore::Vector<casacore::Int>& chans);
+     // Key of the density cache: msKeys (from msDensityKey and
+     // chanDensityKey), the uv grid and the field map
+     casacore::String densityKey(const casacore::String& msKeys, const casacore::Quantity& cellx,
+                                 const casacore::Quantity& celly, const casacore::Int uBox,
+                                 const casacore::Int vBox, const casacore::Bool multiField,
+                                 const casacore::Bool doWtSp) const;
+     // Read/write the density grids and summed weights from/to the cache file
+     casacore::Bool loadDensity(const casacore::String& cacheName, const casacore::String& key,
+                                casacore::Vector<casacore::Double>& sumwt);
+     void saveDensity(const casacore::String& cacheName, const casacore::String& key,
+                      const casacore::Vector<casacore::Double>& sumwt) const;
      casacore::SimpleOrderedMap <casacore::String, casacore::Int> multiFieldMap_p;
      casacore::Block<casacore::Matrix<casacore::Float> > gwt_p;
      casacore::String wgtType_p;
@@ -0,0 +1,617 @@
+// -*- mode: c++ -*-
+//# Copyright (C) 1996,1997,1998,1999,2000,2002,2003,2015
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This library is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU Library General Public License as published by
+//# the Free Software Foundation; either version 2 of the License, or (at your
+//# option) any later version.
+//#
+//# This library is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+//# License for more details.
+//#
+//# You should have received a copy of the GNU Library General Public License
+//# along with this library; if not, write to the Free Software Foundation,
+//# Inc., 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//
+// Classical statistics over the datasets of a Vi2DataProvider, computed from
+// mergeable partial accumulators.
+//
+#ifndef MSVIS_STATISTICS_VI2_CLASSICAL_STATISTICS_H_
+#define MSVIS_STATISTICS_VI2_CLASSICAL_STATISTICS_H_
+
+#include <casacore/casa/aips.h>
+#include <casacore/casa/BasicMath/Math.h>
+#include <casacore/casa/Exceptions/Error.h>
+#include <casacore/casa/System/AipsrcValue.h>
+#include <casacore/casa/Utilities/CountedPtr.h>
+#include <casacore/scimath/Mathematics/StatisticsTypes.h>
+#include <msvis/MSVis/statistics/Vi2DataProvider.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace casa {
+
+// Replacement for casacore::ClassicalStatistics for use with a
+// Vi2DataProvider, with the same interface as far as it is used by
+// ms::statistics2 (getStatistics(), getMedianAndQuantiles() and
+// getMedianAbsDevMed()).
+//
+// casacore::ClassicalStatistics iterates over the data provider, and thereby
+// reads the MS, once for the moments and again several times for each of the
+// median, the quantiles and the median absolute deviation, all on one
+// thread. This class instead
+//
+// - accumulates the moments, and the extrema with their positions, of each
+//   sub-chunk in fixed size blocks of values, in parallel, into partial
+//   accumulators that are merged in block order (so that the results do not
+//   depend on the number of threads),
+// - keeps the valid values of the dataset in memory during that pass if there
+//   are no more than maxValuesInMemory of them, in which case the median,
+//   quantiles and median absolute deviation need no further passes (the
+//   default limit, 16M values or 128 MB, can be changed with the
+//   ms.statistics2.maxvaluesinmemory aipsrc variable), and
+// - otherwise finds the values of the requested ranks exactly by histogram
+//   refinement: every pass counts the values (in parallel, with one histogram
+//   per thread) in the bins of an order preserving integer key of the values,
+//   and narrows the range of each rank to a single bin, until the values in
+//   the range fit in memory.
+//
+// Only one pass over the data is needed for the moments, median and quantiles
+// of a dataset which fits in memory; for larger datasets every additional
+// statistic takes two or three passes.
+//
+// As in casacore::ClassicalStatistics, only unmasked values with positive
+// weights are part of the sample, the quantiles are not weighted, and the
+// "dataset" of the extrema positions is the sub-chunk in the dataset.
+template <class AccumType, class DataIterator, class MaskIterator,
+          class WeightsIterator>
+class Vi2ClassicalStatistics {
+
+public:
+	typedef Vi2DataProvider<DataIterator,MaskIterator,WeightsIterator>
+	DataProvider;
+
+	Vi2ClassicalStatistics(
+		casacore::uInt64 maxValuesInMemory = defaultMaxValuesInMemory())
+		: dp(nullptr)
+		, maxValuesInMemory(std::max(maxValuesInMemory, (casacore::uInt64)2))
+		, haveMoments(false)
+		, valuesInMemory(false)
+		, haveMedian(false)
+		, medianValue(0) {}
+
+	// The maxValuesInMemory given by the ms.statistics2.maxvaluesinmemory
+	// aipsrc variable, if it is positive, or 16M values otherwise.
+	static casacore::uInt64 defaultMaxValuesInMemory() {
+		casacore::Int n;
+		casacore::AipsrcValue<casacore::Int>::find(
+			n, "ms.statistics2.maxvaluesinmemory", 1 << 24);
+		return n > 0 ? (casacore::uInt64)n : (casacore::uInt64)1 << 24;
+	}
+
+	// Set the data provider, positioned at the dataset for which statistics
+	// will be computed, clearing any previous results.
+	void setDataProvider(DataProvider *dataProvider) {
+		dp = dataProvider;
+		haveMoments = false;
+		haveMedian = false;
+		valuesInMemory = false;
+		values.clear();
+		values.shrink_to_fit();
+	}
+
+	casacore::StatsData<AccumType> getStatistics() {
+		computeMoments();
+		casacore::StatsData<AccumType> stats =
+			casacore::initializeStatsData<AccumType>();
+		stats.masked = dp->hasMask();
+		stats.weighted = dp->hasWeights();
+		stats.npts = moments.npts;
+		if (moments.npts > 0) {
+			stats.max = casacore::CountedPtr<AccumType>(
+				new AccumType(moments.max));
+			stats.maxpos = moments.maxpos;
+			stats.min = casacore::CountedPtr<AccumType>(
+				new AccumType(moments.min));
+			stats.minpos = moments.minpos;
+		}
+		const casacore::Double variance =
+			moments.npts > 1
+			? moments.nvariance / (moments.sumweights - 1)
+			: 0;
+		stats.mean = moments.mean;
+		stats.nvariance = moments.nvariance;
+		stats.sum = moments.sum;
+		stats.sumsq = moments.sumsq;
+		stats.sumweights = moments.sumweights;
+		stats.variance = variance;
+		stats.stddev = std::sqrt(variance);
+		stats.rms = moments.sumweights > 0
+			? std::sqrt(moments.sumsq / moments.sumweights)
+			: 0;
+		return stats;
+	}
+
+	// Get the median and the values of the given quantiles (in (0,1)).
+	AccumType getMedianAndQuantiles(
+		std::map<casacore::Double,AccumType> &quantileToValue,
+		const std::set<casacore::Double> &quantiles) {
+
+		computeMoments();
+		const casacore::uInt64 n = moments.npts;
+		if (n == 0)
+			throw casacore::AipsError("No valid data found");
+		std::vector<casacore::uInt64> ranks = medianRanks(n);
+		const size_t nMedianRanks = ranks.size();
+		for (auto &&q : quantiles) {
+			if (q <= 0 || q >= 1)
+				throw casacore::AipsError(
+					"Quantile values must be between 0 and 1 (exclusive)");
+			ranks.push_back(quantileRank(q, n));
+		}
+		std::vector<casacore::Double> v = valuesAtRanks(ranks, nullptr);
+		medianValue = (AccumType)(nMedianRanks == 2 ? (v[0] + v[1]) / 2 : v[0]);
+		haveMedian = true;
+		size_t i = nMedianRanks;
+		for (auto &&q : quantiles)
+			quantileToValue[q] = (AccumType)v[i++];
+		return (AccumType)medianValue;
+	}
+
+	// Get the median of the absolute deviations from the median.
+	AccumType getMedianAbsDevMed() {
+		if (!haveMedian) {
+			std::map<casacore::Double,AccumType> none;
+			getMedianAndQuantiles(none, std::set<casacore::Double>());
+		}
+		const std::vector<casacore::uInt64> ranks = medianRanks(moments.npts);
+		std::vector<casacore::Double> v = valuesAtRanks(ranks, &medianValue);
+		return (AccumType)(ranks.size() == 2 ? (v[0] + v[1]) / 2 : v[0]);
+	}
+
+private:
+
+	// Weighted moments and extrema of a sample, which can be merged with those
+	// of another sample.
+	struct Moments {
+		casacore::uInt64 npts = 0;
+		casacore::Double sumweights = 0;
+		casacore::Double sum = 0;
+		casacore::Double sumsq = 0;
+		casacore::Double mean = 0;
+		casacore::Double nvariance = 0;
+		casacore::Double min = 0;
+		casacore::Double max = 0;
+		std::pair<casacore::Int64,casacore::Int64> minpos{-1, -1};
+		std::pair<casacore::Int64,casacore::Int64> maxpos{-1, -1};
+
+		void add(casacore::Double datum, casacore::Double weight,
+		         casacore::Int64 dataset, casacore::Int64 index) {
+			if (npts == 0 || datum < min) {
+				min = datum;
+				minpos = std::make_pair(dataset, index);
+			}
+			if (npts == 0 || datum > max) {
+				max = datum;
+				maxpos = std::make_pair(dataset, index);
+			}
+			++npts;
+			sumweights += weight;
+			sum += weight * datum;
+			sumsq += weight * datum * datum;
+			const casacore::Double prevMean = mean;
+			mean += weight * (datum - prevMean) / sumweights;
+			nvariance += weight * (datum - prevMean) * (datum - mean);
+		}
+
+		void merge(const Moments &other) {
+			if (other.npts == 0)
+				return;
+			if (npts == 0) {
+				*this = other;
+				return;
+			}
+			if (other.min < min || (other.min == min && other.minpos < minpos)) {
+				min = other.min;
+				minpos = other.minpos;
+			}
+			if (other.max > max || (other.max == max && other.maxpos < maxpos)) {
+				max = other.max;
+				maxpos = other.maxpos;
+			}
+			const casacore::Double w = sumweights + other.sumweights;
+			const casacore::Double delta = other.mean - mean;
+			nvariance += other.nvariance
+				+ delta * delta * sumweights * other.sumweights / w;
+			mean += delta * other.sumweights / w;
+			npts += other.npts;
+			sumweights = w;
+			sum += other.sum;
+			sumsq += other.sumsq;
+		}
+	};
+
+	// A range of keys known to hold the values of some of the requested ranks
+	struct KeyRange {
+		casacore::uInt64 lo;
+		casacore::uInt64 hi;
+		// number of values in the range, and below it
+		casacore::uInt64 count;
+		casacore::uInt64 below;
+		// indexes of the requested ranks in the range
+		std::vector<size_t> targets;
+		// collect the values in the range, or else count them in bins of
+		// 2^shift keys
+		bool collect;
+		casacore::uInt shift;
+	};
+
+	// Number of values per block in parallel loops; fixed, so that the order
+	// of merging partial results does not depend on the number of threads
+	static const casacore::Int64 blockSize = 1 << 16;
+
+	static const casacore::uInt histogramBits = 12;
+
+	DataProvider *dp;
+
+	casacore::uInt64 maxValuesInMemory;
+
+	bool haveMoments;
+
+	Moments moments;
+
+	// all valid values in the dataset, if there are no more than
+	// maxValuesInMemory of them
+	bool valuesInMemory;
+
+	std::vector<casacore::Double> values;
+
+	bool haveMedian;
+
+	casacore::Double medianValue;
+
+	// valid values, their weights and their indexes in the current sub-chunk
+	std::vector<casacore::Double> chunkValues;
+
+	std::vector<casacore::Double> chunkWeights;
+
+	std::vector<casacore::Int64> chunkIndices;
+
+	static casacore::Int
+	maxThreads() {
+#ifdef _OPENMP
+		return omp_get_max_threads();
+#else
+		return 1;
+#endif
+	}
+
+	static casacore::Int
+	threadNum() {
+#ifdef _OPENMP
+		return omp_get_thread_num();
+#else
+		return 0;
+#endif
+	}
+
+	// Order preserving map of (non-NaN) values to unsigned integers, and its
+	// inverse.
+	static casacore::uInt64
+	toKey(casacore::Double v) {
+		casacore::uInt64 u;
+		std::memcpy(&u, &v, sizeof(u));
+		const casacore::uInt64 sign = casacore::uInt64(1) << 63;
+		return (u & sign) ? ~u : (u | sign);
+	}
+
+	static casacore::Double
+	fromKey(casacore::uInt64 k) {
+		const casacore::uInt64 sign = casacore::uInt64(1) << 63;
+		const casacore::uInt64 u = (k & sign) ? (k & ~sign) : ~k;
+		casacore::Double v;
+		std::memcpy(&v, &u, sizeof(v));
+		return v;
+	}
+
+	// Ranks (0-based positions in the sorted sample) of the value(s) of which
+	// the median is the mean.
+	static std::vector<casacore::uInt64>
+	medianRanks(casacore::uInt64 n) {
+		if (n % 2 == 0)
+			return std::vector<casacore::uInt64>{n / 2 - 1, n / 2};
+		return std::vector<casacore::uInt64>{n / 2};
+	}
+
+	static casacore::uInt64
+	quantileRank(casacore::Double q, casacore::uInt64 n) {
+		casacore::Double idx = q * n;
+		const casacore::Double idxFloor = std::floor(idx);
+		if (casacore::near(idx, idxFloor))
+			idx = idxFloor;
+		const casacore::uInt64 rank = (casacore::uInt64)std::ceil(idx);
+		return rank > 0 ? rank - 1 : 0;
+	}
+
+	// Call f(subchunk) for every sub-chunk in the dataset, after loading its
+	// valid values into chunkValues, chunkWeights and chunkIndices.
+	template <class F>
+	void
+	foreachSubchunk(F f) {
+		if (dp == nullptr)
+			throw casacore::AipsError("Data provider has not been set");
+		dp->reset();
+		casacore::Int64 subchunk = 0;
+		while (true) {
+			loadSubchunk();
+			f(subchunk);
+			++(*dp);
+			++subchunk;
+			if (dp->atEnd()) {
+				dp->finalize();
+				break;
+			}
+		}
+	}
+
+	void
+	loadSubchunk() {
+		DataIterator data = dp->getData();
+		const casacore::uInt64 count = dp->getCount();
+		const bool hasMask = dp->hasMask();
+		const bool hasWeights = dp->hasWeights();
+		MaskIterator mask;
+		WeightsIterator weights;
+		if (hasMask)
+			mask = dp->getMask();
+		if (hasWeights)
+			weights = dp->getWeights();
+		chunkValues.clear();
+		chunkWeights.clear();
+		chunkIndices.clear();
+		for (casacore::uInt64 i = 0; i < count; ++i) {
+			const casacore::Double weight = hasWeights ? *weights : 1;
+			if ((!hasMask || *mask) && weight > 0) {
+				chunkValues.push_back(*data);
+				chunkWeights.push_back(weight);
+				chunkIndices.push_back(i);
+			}
+			++data;
+			if (hasMask)
+				++mask;
+			if (hasWeights)
+				++weights;
+		}
+	}
+
+	void
+	computeMoments() {
+		if (haveMoments)
+			return;
+		moments = Moments();
+		valuesInMemory = true;
+		values.clear();
+		std::vector<Moments> partial;
+		foreachSubchunk([&](casacore::Int64 subchunk) {
+				const casacore::Int64 n = chunkValues.size();
+				const casacore::Int64 nBlocks = (n + blockSize - 1) / blockSize;
+				partial.assign(nBlocks, Moments());
+#pragma omp parallel for schedule(dynamic)
+				for (casacore::Int64 b = 0; b < nBlocks; ++b) {
+					const casacore::Int64 end = std::min(n, (b + 1) * blockSize);
+					for (casacore::Int64 i = b * blockSize; i < end; ++i)
+						partial[b].add(chunkValues[i], chunkWeights[i], subchunk,
+						               chunkIndices[i]);
+				}
+				for (auto &&p : partial)
+					moments.merge(p);
+				if (valuesInMemory) {
+					if (values.size() + n <= maxValuesInMemory) {
+						values.insert(values.end(), chunkValues.begin(),
+						              chunkValues.end());
+					} else {
+						valuesInMemory = false;
+						values.clear();
+						values.shrink_to_fit();
+					}
+				}
+			});
+		haveMoments = true;
+	}
+
+	// Values of the given ranks in the sample of valid values, or, if center
+	// is not null, in the sample of absolute deviations from *center.
+	std::vector<casacore::Double>
+	valuesAtRanks(const std::vector<casacore::uInt64> &ranks,
+	              const casacore::Double *center) {
+		std::vector<casacore::Double> result(ranks.size());
+		if (valuesInMemory) {
+			std::vector<casacore::Double> deviations;
+			std::vector<casacore::Double> *sample = &values;
+			if (center) {
+				const casacore::Int64 n = values.size();
+				deviations.resize(n);
+#pragma omp parallel for schedule(static)
+				for (casacore::Int64 i = 0; i < n; ++i)
+					deviations[i] = std::abs(values[i] - *center);
+				sample = &deviations;
+			}
+			selectRanks(*sample, ranks, result);
+			return result;
+		}
+
+		std::vector<KeyRange> ranges(1);
+		if (center) {
+			ranges[0].lo = toKey(0.0);
+			ranges[0].hi = toKey(std::max(std::abs(moments.max - *center),
+			                              std::abs(moments.min - *center)));
+		} else {
+			ranges[0].lo = toKey(moments.min);
+			ranges[0].hi = toKey(moments.max);
+		}
+		ranges[0].count = moments.npts;
+		ranges[0].below = 0;
+		for (size_t t = 0; t < ranks.size(); ++t)
+			ranges[0].targets.push_back(t);
+
+		const casacore::Int nThreads = maxThreads();
+		while (!ranges.empty()) {
+			// ranges of a single key need no pass over the data
+			std::vector<KeyRange> pending;
+			for (auto &&r : ranges) {
+				if (r.lo == r.hi) {
+					for (auto &&t : r.targets)
+						result[t] = fromKey(r.lo);
+					continue;
+				}
+				r.collect = r.count <= maxValuesInMemory;
+				r.shift = 0;
+				while (((r.hi - r.lo) >> r.shift) >= (1u << histogramBits))
+					++r.shift;
+				pending.push_back(r);
+			}
+			ranges.clear();
+			if (pending.empty())
+				break;
+
+			const size_t nRanges = pending.size();
+			const size_t nBins = 1u << histogramBits;
+			std::vector<std::vector<casacore::uInt64> > histograms(
+				nThreads * nRanges);
+			std::vector<std::vector<casacore::Double> > collected(
+				nThreads * nRanges);
+			for (casacore::Int th = 0; th < nThreads; ++th) {
+				for (size_t r = 0; r < nRanges; ++r) {
+					if (!pending[r].collect)
+						histograms[th * nRanges + r].assign(nBins, 0);
+				}
+			}
+			foreachSubchunk([&](casacore::Int64) {
+					const casacore::Int64 n = chunkValues.size();
+					const casacore::Int64 nBlocks = (n + blockSize - 1) / blockSize;
+#pragma omp parallel for schedule(dynamic)
+					for (casacore::Int64 b = 0; b < nBlocks; ++b) {
+						const size_t th = threadNum();
+						const casacore::Int64 end = std::min(n, (b + 1) * blockSize);
+						for (casacore::Int64 i = b * blockSize; i < end; ++i) {
+							const casacore::Double v = center
+								? std::abs(chunkValues[i] - *center)
+								: chunkValues[i];
+							const casacore::uInt64 k = toKey(v);
+							for (size_t r = 0; r < nRanges; ++r) {
+								const KeyRange &range = pending[r];
+								if (k < range.lo || k > range.hi)
+									continue;
+								if (range.collect)
+									collected[th * nRanges + r].push_back(v);
+								else
+									++histograms[th * nRanges + r][(k - range.lo) >> range.shift];
+							}
+						}
+					}
+				});
+
+			for (size_t r = 0; r < nRanges; ++r) {
+				const KeyRange &range = pending[r];
+				if (range.collect) {
+					std::vector<casacore::Double> sample;
+					sample.reserve(range.count);
+					for (casacore::Int th = 0; th < nThreads; ++th) {
+						auto &c = collected[th * nRanges + r];
+						sample.insert(sample.end(), c.begin(), c.end());
+						std::vector<casacore::Double>().swap(c);
+					}
+					std::vector<casacore::uInt64> localRanks;
+					for (auto &&t : range.targets)
+						localRanks.push_back(ranks[t] - range.below);
+					if (sample.size() <= *std::max_element(
+						    localRanks.begin(), localRanks.end()))
+						throw casacore::AipsError(
+							"Data changed between passes over the dataset");
+					std::vector<casacore::Double> localValues(localRanks.size());
+					selectRanks(sample, localRanks, localValues);
+					for (size_t i = 0; i < range.targets.size(); ++i)
+						result[range.targets[i]] = localValues[i];
+					continue;
+				}
+				std::vector<casacore::uInt64> counts(nBins, 0);
+				for (casacore::Int th = 0; th < nThreads; ++th) {
+					const auto &h = histograms[th * nRanges + r];
+					for (size_t bin = 0; bin < nBins; ++bin)
+						counts[bin] += h[bin];
+				}
+				// narrow each target rank to its bin, one new range per bin
+				std::map<size_t, size_t> binToRange;
+				for (auto &&t : range.targets) {
+					const casacore::uInt64 local = ranks[t] - range.below;
+					casacore::uInt64 cumulative = 0;
+					size_t bin = 0;
+					while (bin < nBins - 1 && cumulative + counts[bin] <= local)
+						cumulative += counts[bin++];
+					auto it = binToRange.find(bin);
+					if (it == binToRange.end()) {
+						KeyRange child;
+						child.lo = range.lo + ((casacore::uInt64)bin << range.shift);
+						child.hi = child.lo + std::min(
+							range.hi - child.lo,
+							(casacore::uInt64(1) << range.shift) - 1);
+						child.count = counts[bin];
+						child.below = range.below + cumulative;
+						child.collect = false;
+						child.shift = 0;
+						it = binToRange.insert(
+							std::make_pair(bin, ranges.size())).first;
+						ranges.push_back(child);
+					}
+					ranges[it->second].targets.push_back(t);
+				}
+			}
+		}
+		return result;
+	}
+
+	// Select the values of the given ranks of sample, which is partially
+	// reordered.
+	static void
+	selectRanks(std::vector<casacore::Double> &sample,
+	            const std::vector<casacore::uInt64> &ranks,
+	            std::vector<casacore::Double> &result) {
+		std::vector<size_t> order(ranks.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(),
+		          [&](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+		auto first = sample.begin();
+		for (auto &&i : order) {
+			auto nth = sample.begin() + ranks[i];
+			if (nth >= first) {
+				std::nth_element(first, nth, sample.end());
+				first = nth + 1;
+			}
+			result[i] = *nth;
+		}
+	}
+};
+
+} // namespace casa
+
+#endif // MSVIS_STATISTICS_VI2_CLASSICAL_STATISTICS_H_
@@ -255,9 +255,11 @@ public:
 		}
 	}
 
-	void foreachDataset(
-		casacore::StatisticsAlgorithm<AccumType,DataIteratorType,MaskIteratorType,WeightsIteratorType>& statistics,
-		Vi2StatisticsIteratee<DataIterator,WeightsIterator,MaskIterator>& iteratee) {
+	// Statistics is normally a casacore::StatisticsAlgorithm, and Iteratee a
+	// Vi2StatisticsIteratee, but any classes providing setDataProvider() and
+	// nextDataset() respectively, such as Vi2ClassicalStatistics, may be used.
+	template <class Statistics, class Iteratee>
+	void foreachDataset(Statistics& statistics, Iteratee& iteratee) {
 
 		datasetIndex = -1;
 		followingChunkDatasetIndex = 0;
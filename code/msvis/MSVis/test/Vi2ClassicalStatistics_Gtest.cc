@@ -0,0 +1,155 @@
+//# Vi2ClassicalStatistics_Gtest.cc: Tests of Vi2ClassicalStatistics
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU General Public License as published by the Free
+//# Software Foundation; either version 2 of the License, or (at your option)
+//# any later version.
+//#
+//# This program is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//# more details.
+//#
+//# You should have received a copy of the GNU General Public License along
+//# with this program; if not, write to the Free Software Foundation, Inc.,
+//# 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+
+#include <casa/aips.h>
+#include <casacore/scimath/Mathematics/ClassicalStatistics.h>
+#include <ms/MeasurementSets/MeasurementSet.h>
+#include <msvis/MSVis/VisibilityIterator2.h>
+#include <msvis/MSVis/statistics/Vi2ClassicalStatistics.h>
+#include <msvis/MSVis/statistics/Vi2VisAmplitudeProvider.h>
+#include <msvis/MSVis/test/MsFactory.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace casa;
+using namespace casacore;
+using namespace casa::vi;
+using namespace casa::vi::test;
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+
+typedef Vi2ObservedVisAmplitudeProvider Provider;
+typedef Provider::AccumType AccumType;
+typedef Vi2ClassicalStatistics<AccumType, Provider::DataIteratorType,
+                               Provider::MaskIteratorType,
+                               Provider::WeightsIteratorType> Vi2Stats;
+typedef ClassicalStatistics<AccumType, Provider::DataIteratorType,
+                            Provider::MaskIteratorType,
+                            Provider::WeightsIteratorType> CasacoreStats;
+
+// The statistics of one dataset
+struct Result {
+  uInt64 npts;
+  Double mean, median, q1, q3, mad;
+};
+
+// Collects the statistics of every dataset
+struct Collect {
+  vector<Result> results;
+
+  template <class Statistics>
+  void nextDataset(Statistics &statistics,
+                   const std::unordered_map<int,std::string> *) {
+    StatsData<AccumType> stats = statistics.getStatistics();
+    std::set<Double> quantiles;
+    quantiles.insert(0.25);
+    quantiles.insert(0.75);
+    std::map<Double,AccumType> quantileToValue;
+    Result r;
+    r.npts = (uInt64)stats.npts;
+    r.mean = stats.mean;
+    r.median = statistics.getMedianAndQuantiles(quantileToValue, quantiles);
+    r.q1 = quantileToValue[0.25];
+    r.q3 = quantileToValue[0.75];
+    r.mad = statistics.getMedianAbsDevMed();
+    results.push_back(r);
+  }
+};
+
+// Statistics of the observed visibility amplitudes of every
+// (array, field, spectral window) dataset
+template <class Statistics>
+vector<Result> amplitudeStatistics(const MeasurementSet &ms,
+                                   Statistics &statistics) {
+  std::set<MSMainEnums::PredefinedColumns> merged;
+  merged.insert(MSMainEnums::TIME);
+  Provider provider(new VisibilityIterator2(ms), merged, false, false);
+  Collect collect;
+  provider.foreachDataset(statistics, collect);
+  return collect.results;
+}
+
+}
+
+// A memory limit far below the size of a dataset forces histogram refinement;
+// the results must be the same as with all values in memory, and the same as
+// those of casacore::ClassicalStatistics
+TEST( Vi2ClassicalStatisticsTest , RefinementTest ) {
+
+  char tmpdir[] = "/tmp/tVi2ClassicalStatisticsXXXXXX";
+  ASSERT_TRUE(mkdtemp(tmpdir) != NULL);
+
+  MsFactory msf(String(tmpdir) + "/stats.ms");
+  msf.addSpectralWindow("spw", 64, 1.0e9, 1.0e6, "RR LL");
+  std::unique_ptr<MeasurementSet> ms(msf.createMs().first);
+
+  Vi2Stats inMemory(uInt64(1) << 30);
+  vector<Result> expected = amplitudeStatistics(*ms, inMemory);
+  ASSERT_GT(expected.size(), 0u);
+
+  const uInt64 smallLimit = 16;
+  uInt64 maxNpts = 0;
+  for (uInt i = 0; i < expected.size(); ++i)
+    maxNpts = std::max(maxNpts, expected[i].npts);
+  ASSERT_GT(maxNpts, 100 * smallLimit);
+
+  Vi2Stats refined(smallLimit);
+  vector<Result> results = amplitudeStatistics(*ms, refined);
+  ASSERT_EQ(expected.size(), results.size());
+  for (uInt i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].npts, results[i].npts);
+    EXPECT_DOUBLE_EQ(expected[i].mean, results[i].mean);
+    EXPECT_EQ(expected[i].median, results[i].median);
+    EXPECT_EQ(expected[i].q1, results[i].q1);
+    EXPECT_EQ(expected[i].q3, results[i].q3);
+    EXPECT_EQ(expected[i].mad, results[i].mad);
+  }
+
+  CasacoreStats classical;
+  vector<Result> reference = amplitudeStatistics(*ms, classical);
+  ASSERT_EQ(expected.size(), reference.size());
+  for (uInt i = 0; i < expected.size(); ++i) {
+    const Double tol = 1e-6 * std::max(1.0, std::abs(reference[i].median));
+    EXPECT_EQ(reference[i].npts, results[i].npts);
+    EXPECT_NEAR(reference[i].median, results[i].median, tol);
+    EXPECT_NEAR(reference[i].q1, results[i].q1, tol);
+    EXPECT_NEAR(reference[i].q3, results[i].q3, tol);
+    EXPECT_NEAR(reference[i].mad, results[i].mad, tol);
+  }
+
+  ms.reset();
+  system((std::string("rm -rf ") + tmpdir).c_str());
+}
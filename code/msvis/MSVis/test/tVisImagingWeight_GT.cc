@@ -0,0 +1,177 @@
+//# tVisImagingWeight_GT.cc: Tests the weight density cache of VisImagingWeight
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU General Public License as published by the Free
+//# Software Foundation; either version 2 of the License, or (at your option)
+//# any later version.
+//#
+//# This program is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//# more details.
+//#
+//# You should have received a copy of the GNU General Public License along
+//# with this program; if not, write to the Free Software Foundation, Inc.,
+//# 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+#include <casa/aips.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayIO.h>
+#include <casa/IO/AipsIO.h>
+#include <casa/OS/File.h>
+#include <casa/Quanta/Quantum.h>
+#include <casacore/ms/MeasurementSets/MeasurementSet.h>
+#include <msvis/MSVis/VisibilityIterator2.h>
+#include <msvis/MSVis/VisImagingWeight.h>
+#include <msvis/MSVis/ViFrequencySelection.h>
+#include <msvis/MSVis/test/MsFactory.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <gtest/gtest.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace casa;
+using namespace casacore;
+using namespace casa::vi;
+using namespace casa::vi::test;
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+
+// Briggs weight density of the whole MS on an nPix x nPix grid of 1 arcsec
+// cells, using (and filling) the given density cache.  If nChan > 0 only
+// the first nChan channels of spectral window 0 are selected.
+Block<Matrix<Float> > density(const MeasurementSet& ms, Int nPix, const String& cache,
+                              Int nChan=0) {
+  VisibilityIterator2 vi(ms);
+  if (nChan > 0) {
+    FrequencySelectionUsingChannels selection;
+    selection.add(0, 0, nChan);
+    vi.setFrequencySelection(selection);
+  }
+  Quantity cell(1.0, "arcsec");
+  VisImagingWeight wgt(vi, "norm", Quantity(0.0, "Jy"), 0.0, nPix, nPix,
+                       cell, cell, 0, 0, false, cache);
+  Block<Matrix<Float> > grids;
+  wgt.getWeightDensity(grids);
+  return grids;
+}
+
+}
+
+TEST( VisImagingWeightTest , DensityCacheTest ) {
+
+  char tmpdir[] = "/tmp/tVisImagingWeightXXXXXX";
+  ASSERT_TRUE(mkdtemp(tmpdir) != NULL);
+
+  MsFactory msf(String(tmpdir) + "/density.ms");
+  msf.addSpectralWindow("spw", 4, 1.0e9, 1.0e6, "RR LL");
+  std::unique_ptr<MeasurementSet> ms(msf.createMs().first);
+
+  String cache = String(tmpdir) + "/density.cache";
+
+  // The first run grids the data and saves the density
+  Block<Matrix<Float> > computed = density(*ms, 256, cache);
+  ASSERT_EQ(1u, computed.nelements());
+  ASSERT_GT(sum(computed[0]), 0.0f);
+  ASSERT_TRUE(File(cache).exists());
+
+  // A second run with the same selection and grid gives the same density
+  Block<Matrix<Float> > cached = density(*ms, 256, cache);
+  ASSERT_EQ(1u, cached.nelements());
+  EXPECT_TRUE(allEQ(computed[0], cached[0]));
+
+  // Double the density stored in the cache: the next run must load it
+  // rather than grid the data again
+  {
+    AipsIO in(cache);
+    in.getstart("VisImagingWeightDensity");
+    String key;
+    uInt nGrid;
+    Array<Float> grid;
+    Vector<Double> sumwt;
+    in >> key >> nGrid >> grid >> sumwt;
+    in.getend();
+    in.close();
+    grid *= Float(2.0);
+    AipsIO out(cache, ByteIO::New);
+    out.putstart("VisImagingWeightDensity", 1);
+    out << key << nGrid << grid << sumwt;
+    out.putend();
+  }
+  Block<Matrix<Float> > loaded = density(*ms, 256, cache);
+  ASSERT_EQ(1u, loaded.nelements());
+  EXPECT_TRUE(allNear(loaded[0], Matrix<Float>(computed[0]*Float(2.0)), 1.0e-6));
+
+  // A different uv grid does not match the saved density
+  Block<Matrix<Float> > other = density(*ms, 128, cache);
+  ASSERT_EQ(1u, other.nelements());
+  EXPECT_EQ(IPosition(2, 128, 128), other[0].shape());
+  EXPECT_GT(sum(other[0]), 0.0f);
+
+  // The same rows with another channel selection do not match either
+  Block<Matrix<Float> > full = density(*ms, 256, cache);
+  Block<Matrix<Float> > fewer = density(*ms, 256, cache, 2);
+  ASSERT_EQ(1u, fewer.nelements());
+  EXPECT_LT(sum(fewer[0]), sum(full[0]));
+  EXPECT_TRUE(allEQ(fewer[0], density(*ms, 256, "", 2)[0]));
+
+  ms.reset();
+  system((std::string("rm -rf ") + tmpdir).c_str());
+}
+
+TEST( VisImagingWeightTest , ParallelDensityTest ) {
+
+  char tmpdir[] = "/tmp/tVisImagingWeightXXXXXX";
+  ASSERT_TRUE(mkdtemp(tmpdir) != NULL);
+
+  // Enough samples per buffer for addDensity() to grid in parallel
+  MsFactory msf(String(tmpdir) + "/parallel.ms");
+  msf.addAntennas(10);
+  msf.addSpectralWindow("spw", 512, 1.0e9, 1.0e6, "RR LL");
+  std::unique_ptr<MeasurementSet> ms(msf.createMs().first);
+
+#ifdef _OPENMP
+  Int nThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  Block<Matrix<Float> > serial = density(*ms, 256, "");
+#ifdef _OPENMP
+  omp_set_num_threads(4);
+#endif
+  Block<Matrix<Float> > parallel = density(*ms, 256, "");
+#ifdef _OPENMP
+  omp_set_num_threads(nThreads);
+#endif
+
+  // Every cell gets its contributions in sample order for any number of
+  // threads, so the grids are identical
+  ASSERT_EQ(1u, serial.nelements());
+  ASSERT_EQ(serial.nelements(), parallel.nelements());
+  ASSERT_GT(sum(serial[0]), 0.0f);
+  EXPECT_TRUE(allEQ(serial[0], parallel[0]));
+
+  ms.reset();
+  system((std::string("rm -rf ") + tmpdir).c_str());
+}
@@ -33,6 +33,7 @@
 #include <casa/System/Aipsrc.h>
 #include <casa/Utilities/Sort.h>
 #include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayIO.h>
 #include <tables/Tables/ScalarColumn.h>
 #include <lattices/Lattices/ArrayLattice.h>
 #include <lattices/LatticeMath/LatticeFFT.h>
@@ -66,6 +67,7 @@ MSCache::MSCache(PlotMSApp* parent):
 		  PlotMSCacheBase(parent)
 {
 	ephemerisAvailable = false;
+	hasFloatData_ = false;
 	vi_p = NULL;
 	vm_ = NULL;
 }
@@ -88,6 +90,7 @@ void MSCache::loadIt(vector<PMS::Axis>& loadAxes,
     Table::TableOption tabopt(Table::Old);
     MeasurementSet* inputMS = new MeasurementSet(filename_, TableLock(TableLock::AutoLocking), tabopt);
     getNamesFromMS(*inputMS);
+    hasFloatData_ = inputMS->isColumn(MS::FLOAT_DATA);
 
     // Apply selections to MS to create selection MS and channel/correlation selections
     Vector<Vector<Slice> > chansel;
@@ -161,6 +164,15 @@ void MSCache::loadIt(vector<PMS::Axis>& loadAxes,
 	deleteVi(); // close any open tables
 }
 
+void MSCache::putCacheState(AipsIO& os) {
+	// needed to flag the restored cache
+	os << dataColumn_ << nVBPerAve_;
+}
+
+void MSCache::getCacheState(AipsIO& is) {
+	is >> dataColumn_ >> nVBPerAve_;
+}
+
 void MSCache::loadError(String mesg) {
 	// catch load error, clear the existing cache, and rethrow
 	logLoad(mesg);
@@ -1097,6 +1109,107 @@ void MSCache::discernData(vector<PMS::Axis> loadAxes,
 
 
 
+// Visibility-derived axes are computed in a single pass over the cube(s)
+// and written straight into the cache array, rather than through a chain
+// of whole-cube temporaries.  Only cubes big enough to pay for the thread
+// start-up are split across threads; the VI2 walk itself is sequential.
+namespace {
+
+const Int minParallelVis = 1 << 16;
+
+typedef Float (*VisPart)(const Complex&);
+
+Float visAmp(const Complex& v) { return abs(v); }
+Float visPhase(const Complex& v) { return arg(v) * 180.0 / C::pi; }
+Float visReal(const Complex& v) { return real(v); }
+Float visImag(const Complex& v) { return imag(v); }
+Float visImagDeg(const Complex& v) { return imag(v) * 180.0 / C::pi; }
+
+// How the two cubes are combined before taking the part:
+//  part(a), part(a-b), part(a/b), or part(a)/part(b)
+enum VisCombine { VIS_ONE, VIS_DIFF, VIS_RATIO, VIS_PART_RATIO };
+
+void deriveVis(Array<Float>& out, VisPart part,
+		const Cube<Complex>& a, const Cube<Complex>& b = Cube<Complex>(),
+		VisCombine combine = VIS_ONE) {
+	if (combine != VIS_ONE && !a.shape().isEqual(b.shape()))
+		throw(ArrayConformanceError("PlotMS: visibility cubes do not conform"));
+	out.resize(a.shape());
+	Bool delA, delB(false), delOut;
+	const Complex* pa = a.getStorage(delA);
+	const Complex* pb = (combine == VIS_ONE) ? NULL : b.getStorage(delB);
+	Float* po = out.getStorage(delOut);
+	Int n = a.nelements();
+	switch (combine) {
+	case VIS_ONE: {
+#pragma omp parallel for if (n >= minParallelVis)
+		for (Int i = 0; i < n; ++i)
+			po[i] = part(pa[i]);
+		break;
+	}
+	case VIS_DIFF: {
+#pragma omp parallel for if (n >= minParallelVis)
+		for (Int i = 0; i < n; ++i)
+			po[i] = part(pa[i] - pb[i]);
+		break;
+	}
+	case VIS_RATIO: {
+#pragma omp parallel for if (n >= minParallelVis)
+		for (Int i = 0; i < n; ++i)
+			po[i] = part(pa[i] / pb[i]);
+		break;
+	}
+	case VIS_PART_RATIO: {
+#pragma omp parallel for if (n >= minParallelVis)
+		for (Int i = 0; i < n; ++i)
+			po[i] = part(pa[i]) / part(pb[i]);
+		break;
+	}
+	}
+	out.putStorage(po, delOut);
+	a.freeStorage(pa, delA);
+	if (pb != NULL) b.freeStorage(pb, delB);
+}
+
+// Projected baseline length of each row of a (3,nRow) uvw matrix, in one
+//  pass instead of through whole-row temporaries
+void uvDistance(Vector<Double>& out, const Matrix<Double>& uvw) {
+	Int nrow = uvw.ncolumn();
+#pragma omp parallel for if (nrow >= minParallelVis)
+	for (Int irow = 0; irow < nrow; ++irow)
+		out(irow) = sqrt(uvw(0, irow) * uvw(0, irow) + uvw(1, irow) * uvw(1, irow));
+}
+
+// Multiply a (nCorr,nChan,nRow) cube by the (nCorr,nRow) weights
+void weightCube(Array<Float>& out, const Matrix<Float>& wt) {
+	Cube<Float> wtA(out);
+	Int ncorr = wtA.shape()(0), nchan = wtA.shape()(1), nrow = wtA.shape()(2);
+#pragma omp parallel for if (Int64(ncorr) * nchan * nrow >= minParallelVis)
+	for (Int irow = 0; irow < nrow; ++irow)
+		for (Int ichan = 0; ichan < nchan; ++ichan)
+			for (Int icorr = 0; icorr < ncorr; ++icorr)
+				wtA(icorr, ichan, irow) *= wt(icorr, irow);
+}
+
+}
+
+void MSCache::loadWaveAxis(vi::VisBuffer2* vb, Matrix<Double>& out,
+		const Vector<Double>& meters) {
+	// Frequencies come from the VB one row at a time (the VB is not
+	//  thread-safe); the row length is then scaled in place, in parallel
+	//  over rows for large chunks
+	Int nrow = vb->nRows();
+	out.resize(vb->nChannels(), nrow);
+	for (Int irow = 0; irow < nrow; ++irow)
+		out.column(irow) = vb->getFrequencies(irow, freqFrame_);
+	Int nchan = out.nrow();
+#pragma omp parallel for if (Int64(nchan) * nrow >= minParallelVis)
+	for (Int irow = 0; irow < nrow; ++irow) {
+		Double scale = meters(irow) / C::c;
+		for (Int ichan = 0; ichan < nchan; ++ichan)
+			out(ichan, irow) *= scale;
+	}
+}
 
 void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 		PMS::DataColumn data) {
@@ -1194,9 +1307,8 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 		break;
 	}
 	case PMS::UVDIST: {
-		Array<Double> u(vb->uvw().row(0));
-		Array<Double> v(vb->uvw().row(1));
-		*uvdist_[vbnum] = sqrt(u*u+v*v);
+		uvdist_[vbnum]->resize(vb->nRows());
+		uvDistance(*uvdist_[vbnum], vb->uvw());
 		break;
 	}
 	case PMS::U: {
@@ -1212,67 +1324,36 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 		break;
 	}
 	case PMS::UVDIST_L: {
-		Array<Double> u(vb->uvw().row(0));
-		Array<Double> v(vb->uvw().row(1));
-		Vector<Double> uvdistM = sqrt(u*u + v*v);
-		uvdistM /=C::c;
-		uvdistL_[vbnum]->resize(vb->nChannels(), vb->nRows());
-		Vector<Double> uvrow;
-		for (Int irow = 0; irow < vb->nRows(); ++irow) {
-			uvrow.reference(uvdistL_[vbnum]->column(irow));
-			uvrow.set(uvdistM(irow));
-			uvrow *= vb->getFrequencies(irow, freqFrame_);
-		}
+		Vector<Double> uvdistM(vb->nRows());
+		uvDistance(uvdistM, vb->uvw());
+		loadWaveAxis(vb, *uvdistL_[vbnum], uvdistM);
 		break;
 	}
 
 	case PMS::UWAVE: {
-		Vector<Double> uM(vb->uvw().row(0));
-		uM/=C::c;
-		uwave_[vbnum]->resize(vb->nChannels(), vb->nRows());
-		Vector<Double> urow;
-		for (Int irow = 0; irow < vb->nRows(); ++irow) {
-			urow.reference(uwave_[vbnum]->column(irow));
-			urow.set(uM(irow));
-			urow *= vb->getFrequencies(irow, freqFrame_);
-		}
+		loadWaveAxis(vb, *uwave_[vbnum], vb->uvw().row(0));
 		break;
 	}
 	case PMS::VWAVE: {
-		Vector<Double> vM(vb->uvw().row(1));
-		vM/=C::c;
-		vwave_[vbnum]->resize(vb->nChannels(), vb->nRows());
-		Vector<Double> vrow;
-		for (Int irow = 0; irow < vb->nRows(); ++irow) {
-			vrow.reference(vwave_[vbnum]->column(irow));
-			vrow.set(vM(irow));
-			vrow *= vb->getFrequencies(irow, freqFrame_);
-		}
+		loadWaveAxis(vb, *vwave_[vbnum], vb->uvw().row(1));
 		break;
 	}
 	case PMS::WWAVE: {
-		Vector<Double> wM(vb->uvw().row(2));
-		wM/=C::c;
-		wwave_[vbnum]->resize(vb->nChannels(), vb->nRows());
-		Vector<Double> wrow;
-		for (Int irow = 0; irow < vb->nRows(); ++irow) {
-			wrow.reference(wwave_[vbnum]->column(irow));
-			wrow.set(wM(irow));
-			wrow *= vb->getFrequencies(irow, freqFrame_);
-		}
+		loadWaveAxis(vb, *wwave_[vbnum], vb->uvw().row(2));
 		break;
 	}
 	case PMS::AMP: {
+		// scalar averaging leaves the averaged amplitude in the real part
+		VisPart ampPart = averaging_.scalarAve() ? visReal : visAmp;
 		switch(data) {
 		case PMS::DATA: {
 			//CAS-5730.  For single dish data, absolute value of
 			//points should not be plotted.
-			MeasurementSet ms( filename_);
-			if ( ms.isColumn( MS::FLOAT_DATA ) || averaging_.scalarAve()){
-				*amp_[vbnum]=real(vb->visCube());
+			if (hasFloatData_ || averaging_.scalarAve()){
+				deriveVis(*amp_[vbnum], visReal, vb->visCube());
 			}
 			else {
-				*amp_[vbnum] = amplitude(vb->visCube());
+				deriveVis(*amp_[vbnum], visAmp, vb->visCube());
 			}
 			// TEST fft on freq axis to get delay
 			if (false) {
@@ -1325,53 +1406,31 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 			break;
 		}
 		case PMS::MODEL: {
-            if (averaging_.scalarAve()) 
-			    *ampModel_[vbnum] = real(vb->visCubeModel());
-            else
-			    *ampModel_[vbnum] = amplitude(vb->visCubeModel());
+			deriveVis(*ampModel_[vbnum], ampPart, vb->visCubeModel());
 			break;
 		}
 		case PMS::CORRECTED: {
-            if (averaging_.scalarAve()) 
-			    *ampCorr_[vbnum] = real(vb->visCubeCorrected());
-            else
-			    *ampCorr_[vbnum] = amplitude(vb->visCubeCorrected());
+			deriveVis(*ampCorr_[vbnum], ampPart, vb->visCubeCorrected());
 			break;
 		}
 		case PMS::CORRMODEL: {
-            if (averaging_.scalarAve()) 
-			  *ampCorrModel_[vbnum] = 
-                real(vb->visCubeCorrected() - vb->visCubeModel());
-            else
-			  *ampCorrModel_[vbnum] = 
-                amplitude(vb->visCubeCorrected() - vb->visCubeModel());
+			deriveVis(*ampCorrModel_[vbnum], ampPart,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATAMODEL: {
-            if (averaging_.scalarAve()) 
-			  *ampDataModel_[vbnum] = 
-                real(vb->visCube() - vb->visCubeModel());
-            else
-			  *ampDataModel_[vbnum] = 
-                amplitude(vb->visCube() - vb->visCubeModel());
+			deriveVis(*ampDataModel_[vbnum], ampPart,
+				vb->visCube(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATA_DIVIDE_MODEL: {
-            if (averaging_.scalarAve()) 
-			  *ampDataDivModel_[vbnum] = 
-                real( vb->visCube() / vb->visCubeModel());
-            else
-			  *ampDataDivModel_[vbnum] = 
-                amplitude( vb->visCube() / vb->visCubeModel());
+			deriveVis(*ampDataDivModel_[vbnum], ampPart,
+				vb->visCube(), vb->visCubeModel(), VIS_RATIO);
 			break;
 		}
 		case PMS::CORRECTED_DIVIDE_MODEL: {
-            if (averaging_.scalarAve()) 
-			  *ampCorrDivModel_[vbnum] = 
-                real( vb->visCubeCorrected() / vb->visCubeModel());
-            else
-			  *ampCorrDivModel_[vbnum] = 
-                amplitude( vb->visCubeCorrected() / vb->visCubeModel());
+			deriveVis(*ampCorrDivModel_[vbnum], ampPart,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_RATIO);
 			break;
 		}
 		case PMS::FLOAT_DATA: {
@@ -1382,62 +1441,39 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 		break;
 	}
 	case PMS::PHASE: {
+		// scalar averaging leaves the averaged phase in the imaginary part
+		VisPart phaPart = averaging_.scalarAve() ? visImagDeg : visPhase;
 		switch(data) {
 		case PMS::DATA: {
-            if (averaging_.scalarAve()) 
-                *pha_[vbnum]=imag(vb->visCube()) * 180.0 / C::pi;
-            else
-			    *pha_[vbnum] = phase(vb->visCube()) * 180.0 / C::pi;
+			deriveVis(*pha_[vbnum], phaPart, vb->visCube());
 			break;
 		}
 		case PMS::MODEL: {
-            if (averaging_.scalarAve()) 
-			    *phaModel_[vbnum] = imag(vb->visCubeModel()) * 180.0 / C::pi;
-            else
-			    *phaModel_[vbnum] = phase(vb->visCubeModel()) * 180.0 / C::pi;
+			deriveVis(*phaModel_[vbnum], phaPart, vb->visCubeModel());
 			break;
 		}
 		case PMS::CORRECTED: {
-            if (averaging_.scalarAve()) 
-                *phaCorr_[vbnum]=imag(vb->visCubeCorrected()) * 180.0 / C::pi;
-            else
-			    *phaCorr_[vbnum] = phase(vb->visCubeCorrected()) * 180.0 / C::pi;
+			deriveVis(*phaCorr_[vbnum], phaPart, vb->visCubeCorrected());
 			break;
 		}
 		case PMS::CORRMODEL: {
-            if (averaging_.scalarAve()) 
-			*phaCorrModel_[vbnum] = 
-                imag(vb->visCubeCorrected() - vb->visCubeModel()) * 180.0 / C::pi;
-            else
-			*phaCorrModel_[vbnum] = 
-                phase(vb->visCubeCorrected() - vb->visCubeModel()) * 180.0 / C::pi;
+			deriveVis(*phaCorrModel_[vbnum], phaPart,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATAMODEL: {
-            if (averaging_.scalarAve()) 
-			    *phaDataModel_[vbnum] = 
-                    imag(vb->visCube() - vb->visCubeModel()) * 180.0 / C::pi;
-            else
-			    *phaDataModel_[vbnum] = 
-                    phase(vb->visCube() - vb->visCubeModel()) * 180.0 / C::pi;
+			deriveVis(*phaDataModel_[vbnum], phaPart,
+				vb->visCube(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATA_DIVIDE_MODEL: {
-            if (averaging_.scalarAve()) 
-			    *phaDataDivModel_[vbnum] = 
-                    imag(vb->visCube() / vb->visCubeModel()) * 180.0 / C::pi;
-            else
-			    *phaDataDivModel_[vbnum] = 
-                    phase(vb->visCube() / vb->visCubeModel()) * 180.0 / C::pi;
+			deriveVis(*phaDataDivModel_[vbnum], phaPart,
+				vb->visCube(), vb->visCubeModel(), VIS_RATIO);
 			break;
 		}
 		case PMS::CORRECTED_DIVIDE_MODEL: {
-            if (averaging_.scalarAve()) 
-			    *phaCorrDivModel_[vbnum] = 
-                  imag(vb->visCubeCorrected() / vb->visCubeModel()) * 180.0 / C::pi;
-            else
-			    *phaCorrDivModel_[vbnum] = 
-                  phase(vb->visCubeCorrected() / vb->visCubeModel()) * 180.0 / C::pi;
+			deriveVis(*phaCorrDivModel_[vbnum], phaPart,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_RATIO);
 			break;
 		}
 		case PMS::FLOAT_DATA:  // should have caught this already
@@ -1449,35 +1485,35 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 	case PMS::REAL: {
 		switch(data) {
 		case PMS::DATA: {
-			*real_[vbnum] = real(vb->visCube());
+			deriveVis(*real_[vbnum], visReal, vb->visCube());
 			break;
 		}
 		case PMS::MODEL: {
-			*realModel_[vbnum] = real(vb->visCubeModel());
+			deriveVis(*realModel_[vbnum], visReal, vb->visCubeModel());
 			break;
 		}
 		case PMS::CORRECTED: {
-			*realCorr_[vbnum] = real(vb->visCubeCorrected());
+			deriveVis(*realCorr_[vbnum], visReal, vb->visCubeCorrected());
 			break;
 		}
 		case PMS::CORRMODEL: {
-			*realCorrModel_[vbnum] = 
-                real(vb->visCubeCorrected()) - real(vb->visCubeModel());
+			deriveVis(*realCorrModel_[vbnum], visReal,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATAMODEL: {
-			*realDataModel_[vbnum] = 
-                real(vb->visCube()) - real(vb->visCubeModel());
+			deriveVis(*realDataModel_[vbnum], visReal,
+				vb->visCube(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATA_DIVIDE_MODEL: {
-			*realDataDivModel_[vbnum] = 
-                real(vb->visCube()) / real(vb->visCubeModel());
+			deriveVis(*realDataDivModel_[vbnum], visReal,
+				vb->visCube(), vb->visCubeModel(), VIS_PART_RATIO);
 			break;
 		}
 		case PMS::CORRECTED_DIVIDE_MODEL: {
-			*realCorrDivModel_[vbnum] = 
-                real(vb->visCubeCorrected()) / real(vb->visCubeModel());
+			deriveVis(*realCorrDivModel_[vbnum], visReal,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_PART_RATIO);
 			break;
 		}
 		case PMS::FLOAT_DATA: {
@@ -1490,35 +1526,35 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 	case PMS::IMAG: {
 		switch(data) {
 		case PMS::DATA: {
-			*imag_[vbnum] = imag(vb->visCube());
+			deriveVis(*imag_[vbnum], visImag, vb->visCube());
 			break;
 		}
 		case PMS::MODEL: {
-			*imagModel_[vbnum] = imag(vb->visCubeModel());
+			deriveVis(*imagModel_[vbnum], visImag, vb->visCubeModel());
 			break;
 		}
 		case PMS::CORRECTED: {
-			*imagCorr_[vbnum] = imag(vb->visCubeCorrected());
+			deriveVis(*imagCorr_[vbnum], visImag, vb->visCubeCorrected());
 			break;
 		}
 		case PMS::CORRMODEL: {
-			*imagCorrModel_[vbnum] = 
-                imag(vb->visCubeCorrected()) - imag(vb->visCubeModel());
+			deriveVis(*imagCorrModel_[vbnum], visImag,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATAMODEL: {
-			*imagDataModel_[vbnum] = 
-                imag(vb->visCube()) - imag(vb->visCubeModel());
+			deriveVis(*imagDataModel_[vbnum], visImag,
+				vb->visCube(), vb->visCubeModel(), VIS_DIFF);
 			break;
 		}
 		case PMS::DATA_DIVIDE_MODEL: {
-			*imagDataDivModel_[vbnum] = 
-                imag(vb->visCube()) / imag(vb->visCubeModel());
+			deriveVis(*imagDataDivModel_[vbnum], visImag,
+				vb->visCube(), vb->visCubeModel(), VIS_PART_RATIO);
 			break;
 		}
 		case PMS::CORRECTED_DIVIDE_MODEL: {
-			*imagCorrDivModel_[vbnum] = 
-                imag(vb->visCubeCorrected()) / imag(vb->visCubeModel());
+			deriveVis(*imagCorrDivModel_[vbnum], visImag,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_PART_RATIO);
 			break;
 		}
 		case PMS::FLOAT_DATA:  // should have caught this already
@@ -1549,74 +1585,49 @@ void MSCache::loadAxis(vi::VisBuffer2* vb, Int vbnum, PMS::Axis axis,
 	}
 
 	case PMS::WTxAMP: {
-		uInt nchannels = vb->nChannels();
 		switch(data) {
 		case PMS::DATA: {
-			*wtxamp_[vbnum] = amplitude(vb->visCube());
-		    Cube<Float> wtA(*wtxamp_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxamp_[vbnum], visAmp, vb->visCube());
+			weightCube(*wtxamp_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::MODEL: {
-			*wtxampModel_[vbnum] = amplitude(vb->visCubeModel());
-		    Cube<Float> wtA(*wtxampModel_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxampModel_[vbnum], visAmp, vb->visCubeModel());
+			weightCube(*wtxampModel_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::CORRECTED: {
-			*wtxampCorr_[vbnum] = amplitude(vb->visCubeCorrected());
-		    Cube<Float> wtA(*wtxampCorr_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxampCorr_[vbnum], visAmp, vb->visCubeCorrected());
+			weightCube(*wtxampCorr_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::CORRMODEL: {
-			*wtxampCorrModel_[vbnum] = 
-                amplitude(vb->visCubeCorrected() - vb->visCube());
-		    Cube<Float> wtA(*wtxampCorrModel_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxampCorrModel_[vbnum], visAmp,
+				vb->visCubeCorrected(), vb->visCube(), VIS_DIFF);
+			weightCube(*wtxampCorrModel_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::DATAMODEL: {
-			*wtxampDataModel_[vbnum] = 
-                amplitude(vb->visCube() - vb->visCubeModel());
-		    Cube<Float> wtA(*wtxampDataModel_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxampDataModel_[vbnum], visAmp,
+				vb->visCube(), vb->visCubeModel(), VIS_DIFF);
+			weightCube(*wtxampDataModel_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::DATA_DIVIDE_MODEL: {
-			*wtxampDataDivModel_[vbnum] = 
-                amplitude(vb->visCube() / vb->visCubeModel());
-		    Cube<Float> wtA(*wtxampDataDivModel_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxampDataDivModel_[vbnum], visAmp,
+				vb->visCube(), vb->visCubeModel(), VIS_RATIO);
+			weightCube(*wtxampDataDivModel_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::CORRECTED_DIVIDE_MODEL: {
-			*wtxampCorrDivModel_[vbnum] = 
-                amplitude(vb->visCubeCorrected() / vb->visCubeModel());
-		    Cube<Float> wtA(*wtxampCorrDivModel_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			deriveVis(*wtxampCorrDivModel_[vbnum], visAmp,
+				vb->visCubeCorrected(), vb->visCubeModel(), VIS_RATIO);
+			weightCube(*wtxampCorrDivModel_[vbnum], vb->weight());
 			break;
 		}
 		case PMS::FLOAT_DATA: {
 			*wtxampFloat_[vbnum] = vb->visCubeFloat();
-		    Cube<Float> wtA(*wtxampFloat_[vbnum]);
-		    for(uInt c = 0; c < nchannels; ++c) {
-			    wtA.xzPlane(c) = wtA.xzPlane(c) * vb->weight();
-		    }
+			weightCube(*wtxampFloat_[vbnum], vb->weight());
 			break;
 		}
 		}
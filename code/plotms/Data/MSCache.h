@@ -85,6 +85,10 @@ protected:
   //Returns whether or not the ephemeris data has been
   //attached to a field - radial velocity and rho.
   virtual bool isEphemeris();
+
+  // casacore::MS-specific state for the persistent cache
+  virtual void putCacheState(casacore::AipsIO& os);
+  virtual void getCacheState(casacore::AipsIO& is);
 private:
     
   // Forbid copy for now
@@ -170,6 +174,10 @@ private:
 
   casacore::Vector<casacore::Double> calcVelocity(vi::VisBuffer2* vb);
 
+  // Fill a (nChan,nRow) wavelength-scaled axis from per-row lengths in m
+  void loadWaveAxis(vi::VisBuffer2* vb, casacore::Matrix<casacore::Double>& out,
+		  const casacore::Vector<casacore::Double>& meters);
+
   // For averaging done by PlotMSVBAverager;
   // Some axes need to come from VB2 attached to VI2
   bool useAveragedVisBuffer(PMS::Axis axis);
@@ -198,6 +206,9 @@ private:
   map<casacore::Int, casacore::Int> chansPerSpw_; 
 
   bool ephemerisAvailable;
+
+  // MS has a FLOAT_DATA column (single dish); set once per load
+  bool hasFloatData_;
 };
 typedef casacore::CountedPtr<MSCache> MSCachePtr;
 
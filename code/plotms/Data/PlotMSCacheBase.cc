@@ -27,11 +27,16 @@
 #include <plotms/Data/PlotMSCacheBase.h>
 #include <plotms/Data/PlotMSIndexer.h>
 #include <plotms/Threads/ThreadCommunication.h>
+#include <casa/Arrays/ArrayIO.h>
 #include <casa/OS/Timer.h>
+#include <casa/OS/Directory.h>
+#include <casa/OS/DirectoryIterator.h>
+#include <casa/OS/RegularFile.h>
 #include <casa/OS/HostInfo.h>
 #include <casa/OS/Memory.h>
 #include <casa/Quanta/MVTime.h>
 #include <casa/System/Aipsrc.h>
+#include <casa/System/AipsrcValue.h>
 #include <casa/Utilities/Sort.h>
 #include <lattices/Lattices/ArrayLattice.h>
 #include <lattices/LatticeMath/LatticeFFT.h>
@@ -46,7 +51,9 @@
 #include <tables/Tables/Table.h>
 #include <QDebug>
 
+#include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
 
 using namespace casacore;
 namespace casa {
@@ -251,6 +258,8 @@ PlotLogMessage* PlotMSCacheBase::flagRange( int plotIterIndex, casa::PlotMSFlagg
 		mesg = subMesg;
 		mesg->message( contents );
 	}
+	// Flags on disk changed, so the persistent cache is stale
+	removeDiskCache();
 	return mesg;
 }
 
@@ -531,8 +540,13 @@ void PlotMSCacheBase::load(const vector<PMS::Axis>& axes,
 	// Now Load data if the user doesn't cancel.
 	if(loadAxes.size() > 0) {
 
-		// Call method that actually does the loading (MS- or Cal-specific)
-		loadIt(loadAxes,loadData,thread);
+		// Reuse the persistent cache for this data and these parameters,
+		//  if there is one, else call method that actually does the
+		//  loading (MS- or Cal-specific)
+		diskCacheKey_ = diskCacheKey();
+		bool restored = restoreFromDisk(loadAxes, loadData);
+		if (!restored)
+			loadIt(loadAxes,loadData,thread);
 
 		// Update loaded axes if not canceled.
         if (wasCanceled()) { 
@@ -546,6 +560,8 @@ void PlotMSCacheBase::load(const vector<PMS::Axis>& axes,
                 if(PMS::axisIsData(axis)) 
                     loadedAxesData_[axis].defineRecord(datacol, averaging.toRecord());
             }
+            if (!restored)
+                saveToDisk();
         }
 
 		if (false) {
@@ -1790,6 +1806,437 @@ void PlotMSCacheBase::deletePlotMask() {
 
 
 
+// Read or write one cache member
+template<typename T>
+static void cacheIO(AipsIO& aio, Bool put, Array<T>& arr) {
+	if (put)
+		aio << arr;
+	else
+		aio >> arr;
+}
+
+// Read or write a per-chunk PtrBlock of arrays
+template<typename A>
+static void cacheIO(AipsIO& aio, Bool put, PtrBlock<A*>& blk) {
+	if (put) {
+		aio << uInt(blk.nelements());
+		for (uInt i=0; i<blk.nelements(); ++i)
+			aio << *blk[i];
+	}
+	else {
+		uInt n;
+		aio >> n;
+		for (uInt i=0; i<blk.nelements(); ++i)
+			if (blk[i]) delete blk[i];
+		blk.resize(n, true, false);
+		for (uInt i=0; i<n; ++i) {
+			blk[i] = new A();
+			aio >> *blk[i];
+		}
+	}
+}
+
+namespace {
+
+// Adds the state of the regular files below dir to files, recursing
+//  into the subtable (and SUBMSS) directories.  The state is the path,
+//  size, inode and modification time in nanoseconds, so that files
+//  rewritten within the same second, or replaced, are noticed as well
+void addFileStates(const String& dir, vector<String>& files) {
+	Directory d(dir);
+	if (!d.exists())
+		return;
+	DirectoryIterator iter(d);
+	while (!iter.pastEnd()) {
+		String path = dir + "/" + iter.name();
+		File f(path);
+		struct stat st;
+		if (f.isDirectory(false))
+			addFileStates(path, files);
+		else if (f.isRegular() && stat(path.c_str(), &st) == 0) {
+#ifdef __APPLE__
+			Int64 nsec = st.st_mtimespec.tv_nsec;
+#else
+			Int64 nsec = st.st_mtim.tv_nsec;
+#endif
+			ostringstream os;
+			os << path << ":" << Int64(st.st_size) << ":" << uInt64(st.st_ino)
+			   << ":" << Int64(st.st_mtime) << "." << nsec;
+			files.push_back(os.str());
+		}
+		iter++;
+	}
+}
+
+// Axes sharing storage (see release()) are saved as one group, named by
+//  the first axis of the group
+PMS::Axis diskCacheGroup(PMS::Axis axis) {
+	switch(axis) {
+	case PMS::GAMP: return PMS::AMP;
+	case PMS::GPHASE: return PMS::PHASE;
+	case PMS::GREAL: return PMS::REAL;
+	case PMS::GIMAG: return PMS::IMAG;
+	case PMS::FLAG_ROW: return PMS::FLAG;
+	case PMS::EL0: return PMS::AZ0;
+	case PMS::ELEVATION: return PMS::AZIMUTH;
+	case PMS::SWP:
+	case PMS::TSYS:
+	case PMS::OPAC:
+	case PMS::TEC: return PMS::DELAY;
+	default: return axis;
+	}
+}
+
+}
+
+String PlotMSCacheBase::diskCacheName() const {
+	return filename_ + ".plotmscache";
+}
+
+String PlotMSCacheBase::diskCacheKey() const {
+	// Table files change whenever the data, flags or subtables are
+	//  rewritten; a multi-MS or reference table also depends on the
+	//  tables it is made of
+	vector<String> files;
+	addFileStates(filename_, files);
+	try {
+		if (Table::isReadable(filename_)) {
+			Block<String> parts = Table(filename_).getPartNames(true);
+			for (uInt i=0; i<parts.nelements(); ++i)
+				if (parts[i] != filename_)
+					addFileStates(parts[i], files);
+		}
+	} catch (AipsError&) {
+		// the key then only reflects the table directory itself
+	}
+	// directory order is not defined
+	std::sort(files.begin(), files.end());
+	uInt64 hash = 14695981039346656037ULL;
+	for (uInt i=0; i<files.size(); ++i)
+		for (uInt k=0; k<files[i].size(); ++k)
+			hash = (hash ^ uChar(files[i][k])) * 1099511628211ULL;
+	ostringstream files_os;
+	files_os << files.size() << "#" << hash;
+
+	Record key;
+	key.define("filename", filename_);
+	key.define("files", String(files_os.str()));
+	key.defineRecord("selection", selection_.toRecord());
+	key.defineRecord("averaging", averaging_.toRecord());
+	key.defineRecord("transformations", transformations_.toRecord());
+	key.defineRecord("calibration", calibration_.toRecord());
+	ostringstream os;
+	os << key;
+	return os.str();
+}
+
+bool PlotMSCacheBase::restoreFromDisk(const vector<PMS::Axis>& loadAxes,
+		const vector<PMS::DataColumn>& loadData) {
+
+	// Only casacore::MS caches, and only into an empty cache
+	Bool persist(false);
+	AipsrcValue<Bool>::find(persist, "plotms.cache.persistent", false);
+	if (!persist || cacheType()!=PlotMSCacheBase::MS || nChunk_>0)
+		return false;
+
+	String name = diskCacheName();
+	if (!File(name).isRegular())
+		return false;
+
+	try {
+		AipsIO aio(name);
+		uInt version = aio.getstart("PlotMSCache");
+		String key;
+		aio >> key;
+		if (version != 2 || key != diskCacheKey_) {
+			aio.close();
+			logLoad("Persistent cache " + name + " is out of date, reloading.");
+			return false;
+		}
+
+		// Does it hold everything we need?
+		uInt naxes;
+		aio >> naxes;
+		map<PMS::Axis, bool> stored;
+		Vector<Int> storedAxes(naxes);
+		for (uInt i=0; i<naxes; ++i) {
+			aio >> storedAxes(i);
+			stored[PMS::Axis(storedAxes(i))] = true;
+		}
+		uInt ngroups;
+		aio >> ngroups;
+		Vector<Int> storedGroups(ngroups);
+		for (uInt i=0; i<ngroups; ++i)
+			aio >> storedGroups(i);
+		uInt ndata;
+		aio >> ndata;
+		map<PMS::Axis, Record> storedData;
+		for (uInt i=0; i<ndata; ++i) {
+			Int axis;
+			aio >> axis;
+			aio >> storedData[PMS::Axis(axis)];
+		}
+		for (uInt i=0; i<loadAxes.size(); ++i) {
+			PMS::Axis axis = loadAxes[i];
+			if (!stored[axis] ||
+			    (PMS::axisIsData(axis) &&
+			     !storedData[axis].isDefined(PMS::dataColumn(loadData[i])))) {
+				aio.close();
+				return false;
+			}
+		}
+
+		logLoad("Restoring the cache from " + name + ".");
+
+		// The fundamental meta-data
+		Int freqFrame;
+		aio >> nChunk_ >> nAnt_ >> freqFrame;
+		freqFrame_ = MFrequency::Types(freqFrame);
+		aio >> chshapes_ >> goodChunk_;
+		aio >> antnames_ >> stanames_ >> antstanames_ >> fldnames_ >> intentnames_;
+		aio >> positions_;
+		getCacheState(aio);
+
+		// The storage groups, then the axes they hold
+		for (uInt i=0; i<ngroups; ++i)
+			diskCacheIO(aio, PMS::Axis(storedGroups(i)), false);
+		for (uInt i=0; i<naxes; ++i) {
+			PMS::Axis axis = PMS::Axis(storedAxes(i));
+			loadedAxes_[axis] = true;
+			if (PMS::axisIsData(axis))
+				loadedAxesData_[axis] = storedData[axis];
+		}
+		aio.getend();
+		aio.close();
+	} catch (AipsError& err) {
+		logWarn("load_cache", "Could not restore persistent cache " + name +
+			": " + err.getMesg());
+		clear();
+		return false;
+	}
+	return true;
+}
+
+void PlotMSCacheBase::saveToDisk() {
+
+	Bool persist(false);
+	AipsrcValue<Bool>::find(persist, "plotms.cache.persistent", false);
+	if (!persist || cacheType()!=PlotMSCacheBase::MS || nChunk_==0)
+		return;
+
+	String name = diskCacheName();
+	String tmpname = name + ".tmp";
+	try {
+		vector<PMS::Axis> axes = loadedAxes();
+		// Each storage group is written once, however many of its
+		//  axes are loaded
+		vector<PMS::Axis> groups;
+		for (uInt i=0; i<axes.size(); ++i) {
+			PMS::Axis group = diskCacheGroup(axes[i]);
+			if (std::find(groups.begin(), groups.end(), group) == groups.end())
+				groups.push_back(group);
+		}
+		{
+			AipsIO aio(tmpname, ByteIO::New);
+			aio.putstart("PlotMSCache", 2);
+			aio << diskCacheKey_;
+			aio << uInt(axes.size());
+			for (uInt i=0; i<axes.size(); ++i)
+				aio << Int(axes[i]);
+			aio << uInt(groups.size());
+			for (uInt i=0; i<groups.size(); ++i)
+				aio << Int(groups[i]);
+			aio << uInt(loadedAxesData_.size());
+			for (map<PMS::Axis, Record>::iterator it=loadedAxesData_.begin();
+					it!=loadedAxesData_.end(); ++it)
+				aio << Int(it->first) << it->second;
+
+			aio << nChunk_ << nAnt_ << Int(freqFrame_);
+			aio << chshapes_ << goodChunk_;
+			aio << antnames_ << stanames_ << antstanames_ << fldnames_ << intentnames_;
+			aio << positions_;
+			putCacheState(aio);
+
+			for (uInt i=0; i<groups.size(); ++i)
+				diskCacheIO(aio, groups[i], true);
+			aio.putend();
+		}
+		RegularFile(tmpname).move(name, true);
+		logLoad("Saved the cache to " + name + ".");
+	} catch (AipsError& err) {
+		// e.g. no write permission beside the MS; not fatal
+		logWarn("load_cache", "Could not save persistent cache " + name +
+			": " + err.getMesg());
+		if (File(tmpname).exists())
+			RegularFile(tmpname).remove();
+	}
+}
+
+void PlotMSCacheBase::removeDiskCache() {
+	try {
+		String name = diskCacheName();
+		if (File(name).isRegular())
+			RegularFile(name).remove();
+	} catch (AipsError& err) {
+		logWarn("flag", "Could not remove persistent cache: " + err.getMesg());
+	}
+}
+
+void PlotMSCacheBase::diskCacheIO(AipsIO& aio, PMS::Axis axis, Bool put) {
+
+	// Same storage groups as release()
+	switch(axis) {
+	case PMS::SCAN: cacheIO(aio, put, scan_);
+		break;
+	case PMS::FIELD: cacheIO(aio, put, field_);
+		break;
+	case PMS::TIME: cacheIO(aio, put, time_);
+		break;
+	case PMS::TIME_INTERVAL: cacheIO(aio, put, timeIntr_);
+		break;
+	case PMS::SPW: cacheIO(aio, put, spw_);
+		break;
+	case PMS::CHANNEL:
+		cacheIO(aio, put, chan_);
+		cacheIO(aio, put, chansPerBin_);
+		break;
+	case PMS::FREQUENCY: cacheIO(aio, put, freq_);
+		break;
+	case PMS::VELOCITY: cacheIO(aio, put, vel_);
+		break;
+	case PMS::CORR: cacheIO(aio, put, corr_);
+		break;
+	case PMS::ANTENNA1: cacheIO(aio, put, antenna1_);
+		break;
+	case PMS::ANTENNA2: cacheIO(aio, put, antenna2_);
+		break;
+	case PMS::BASELINE: cacheIO(aio, put, baseline_);
+		break;
+	case PMS::ROW: cacheIO(aio, put, row_);
+		break;
+	case PMS::OBSERVATION: cacheIO(aio, put, obsid_);
+		break;
+	case PMS::INTENT: cacheIO(aio, put, intent_);
+		break;
+	case PMS::FEED1: cacheIO(aio, put, feed1_);
+		break;
+	case PMS::FEED2: cacheIO(aio, put, feed2_);
+		break;
+	case PMS::AMP:
+	case PMS::GAMP:
+		cacheIO(aio, put, amp_);
+		cacheIO(aio, put, ampCorr_);
+		cacheIO(aio, put, ampModel_);
+		cacheIO(aio, put, ampCorrModel_);
+		cacheIO(aio, put, ampDataModel_);
+		cacheIO(aio, put, ampDataDivModel_);
+		cacheIO(aio, put, ampCorrDivModel_);
+		cacheIO(aio, put, ampFloat_);
+		break;
+	case PMS::PHASE:
+	case PMS::GPHASE:
+		cacheIO(aio, put, pha_);
+		cacheIO(aio, put, phaCorr_);
+		cacheIO(aio, put, phaModel_);
+		cacheIO(aio, put, phaCorrModel_);
+		cacheIO(aio, put, phaDataModel_);
+		cacheIO(aio, put, phaDataDivModel_);
+		cacheIO(aio, put, phaCorrDivModel_);
+		break;
+	case PMS::REAL:
+	case PMS::GREAL:
+		cacheIO(aio, put, real_);
+		cacheIO(aio, put, realCorr_);
+		cacheIO(aio, put, realModel_);
+		cacheIO(aio, put, realCorrModel_);
+		cacheIO(aio, put, realDataModel_);
+		cacheIO(aio, put, realDataDivModel_);
+		cacheIO(aio, put, realCorrDivModel_);
+		break;
+	case PMS::IMAG:
+	case PMS::GIMAG:
+		cacheIO(aio, put, imag_);
+		cacheIO(aio, put, imagCorr_);
+		cacheIO(aio, put, imagModel_);
+		cacheIO(aio, put, imagCorrModel_);
+		cacheIO(aio, put, imagDataModel_);
+		cacheIO(aio, put, imagDataDivModel_);
+		cacheIO(aio, put, imagCorrDivModel_);
+		break;
+	case PMS::WTxAMP:
+		cacheIO(aio, put, wtxamp_);
+		cacheIO(aio, put, wtxampCorr_);
+		cacheIO(aio, put, wtxampModel_);
+		cacheIO(aio, put, wtxampCorrModel_);
+		cacheIO(aio, put, wtxampDataModel_);
+		cacheIO(aio, put, wtxampDataDivModel_);
+		cacheIO(aio, put, wtxampCorrDivModel_);
+		cacheIO(aio, put, wtxampFloat_);
+		break;
+	case PMS::WT: cacheIO(aio, put, wt_);
+		break;
+	case PMS::WTSP: cacheIO(aio, put, wtsp_);
+		break;
+	case PMS::SIGMA: cacheIO(aio, put, sigma_);
+		break;
+	case PMS::SIGMASP: cacheIO(aio, put, sigmasp_);
+		break;
+	case PMS::FLAG:
+	case PMS::FLAG_ROW:
+		cacheIO(aio, put, flag_);
+		cacheIO(aio, put, flagrow_);
+		break;
+	case PMS::UVDIST: cacheIO(aio, put, uvdist_);
+		break;
+	case PMS::UVDIST_L: cacheIO(aio, put, uvdistL_);
+		break;
+	case PMS::U: cacheIO(aio, put, u_);
+		break;
+	case PMS::V: cacheIO(aio, put, v_);
+		break;
+	case PMS::W: cacheIO(aio, put, w_);
+		break;
+	case PMS::UWAVE: cacheIO(aio, put, uwave_);
+		break;
+	case PMS::VWAVE: cacheIO(aio, put, vwave_);
+		break;
+	case PMS::WWAVE: cacheIO(aio, put, wwave_);
+		break;
+	case PMS::AZ0:
+	case PMS::EL0:
+		cacheIO(aio, put, az0_);
+		cacheIO(aio, put, el0_);
+		break;
+	case PMS::HA0: cacheIO(aio, put, ha0_);
+		break;
+	case PMS::PA0: cacheIO(aio, put, pa0_);
+		break;
+	case PMS::ANTENNA: cacheIO(aio, put, antenna_);
+		break;
+	case PMS::AZIMUTH:
+	case PMS::ELEVATION:
+		cacheIO(aio, put, az_);
+		cacheIO(aio, put, el_);
+		break;
+	case PMS::PARANG: cacheIO(aio, put, parang_);
+		break;
+	case PMS::DELAY:
+	case PMS::SWP:
+	case PMS::TSYS:
+	case PMS::OPAC:
+	case PMS::TEC: cacheIO(aio, put, par_);
+		break;
+	case PMS::SNR: cacheIO(aio, put, snr_);
+		break;
+	case PMS::RADIAL_VELOCITY: cacheIO(aio, put, radialVelocity_);
+		break;
+	case PMS::RHO: cacheIO(aio, put, rho_);
+		break;
+	case PMS::NONE:
+		break;
+	}
+}
+
 void PlotMSCacheBase::log(const String& method, const String& message,
 		int eventType) {
 	plotms_->getLogger()->postMessage(PMS::LOG_ORIGIN,method,message,eventType);
@@ -37,6 +37,7 @@
 #include <casa/Arrays.h>
 #include <casa/Containers/Block.h>
 #include <measures/Measures/MFrequency.h>
+#include <casa/IO/AipsIO.h>
 
 #include <QVector>
 
@@ -328,6 +329,26 @@ protected:
 			  casacore::Bool flag,
 			  PlotMSIndexer* indexer, int dataIndex)=0;
   
+  // Persistent copy of the loaded cache, kept beside the casacore::MS
+  //  (enabled with the plotms.cache.persistent aipsrc variable) so that an
+  //  unchanged plot can be reopened without rereading the data.
+  //  restoreFromDisk returns true only if all loadAxes were restored.
+  // <group>
+  casacore::String diskCacheName() const;
+  casacore::String diskCacheKey() const;
+  bool restoreFromDisk(const std::vector<PMS::Axis>& loadAxes,
+		       const std::vector<PMS::DataColumn>& loadData);
+  void saveToDisk();
+  void removeDiskCache();
+  void diskCacheIO(casacore::AipsIO& aio, PMS::Axis axis, casacore::Bool put);
+  // </group>
+
+  // Hooks for cache state held by derived classes (persistent cache)
+  // <group>
+  virtual void putCacheState(casacore::AipsIO& os) { (void)os; };
+  virtual void getCacheState(casacore::AipsIO& is) { (void)is; };
+  // </group>
+
   // Clean up the PtrBlocks
   void deleteCache();
   void deleteIndexer();
@@ -500,6 +521,9 @@ protected:
   bool ephemerisInitialized;
   ::QVector<double> uniqueTimes;
 
+  // Identifies the data and parameters of the persistent cache
+  casacore::String diskCacheKey_;
+
   // The calibration type (casacore::Table subType)
   casacore::String calType_;
   // polarization selection is ratio ("/")
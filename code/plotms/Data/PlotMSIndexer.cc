@@ -35,6 +35,8 @@
 //#include <QtCore/qmath.h>
 #include <QDebug>
 
+#include <unordered_map>
+
 using namespace casacore;
 namespace casa {
 
@@ -76,6 +78,9 @@ PlotMSIndexer::PlotMSIndexer():
 		  iterValue_(-999),
 		  itsColorize_(false),
 		  itsColorizeAxis_(PMS::DEFAULT_COLOR_AXIS),
+		  density_(false),
+		  dnx_(0),dny_(0),
+		  dxmin_(0.0),dxmax_(0.0),dymin_(0.0),dymax_(0.0),
 		  self(const_cast<PlotMSIndexer*>(this))
 {
 	dataIndex = 0;
@@ -123,6 +128,9 @@ PlotMSIndexer::PlotMSIndexer(PlotMSCacheBase* parent, PMS::Axis xAxis,
 		  iterValue_(-999),
 		  itsColorize_(false),
 		  itsColorizeAxis_(PMS::DEFAULT_COLOR_AXIS),
+		  density_(false),
+		  dnx_(0),dny_(0),
+		  dxmin_(0.0),dxmax_(0.0),dymin_(0.0),dymax_(0.0),
 		  self(const_cast<PlotMSIndexer*>(this))
 {
 	dataIndex = index;
@@ -172,6 +180,9 @@ PlotMSIndexer::PlotMSIndexer(PlotMSCacheBase* parent,
 		iterValue_(iterValue),
 		itsColorize_(false),
 		itsColorizeAxis_(PMS::DEFAULT_COLOR_AXIS),
+		density_(false),
+		dnx_(0),dny_(0),
+		dxmin_(0.0),dxmax_(0.0),dymin_(0.0),dymax_(0.0),
 		self(const_cast<PlotMSIndexer*>(this))
 { 
 	dataIndex = index;
@@ -181,35 +192,34 @@ PlotMSIndexer::PlotMSIndexer(PlotMSCacheBase* parent,
 PlotMSIndexer::~PlotMSIndexer() {} // anything?
 
 unsigned int PlotMSIndexer::size() const { 
+	return (density_ ? cellx_.nelements() : nRawPoints());
+}
+
+unsigned int PlotMSIndexer::nRawPoints() const { 
 	//  return (nChunk()>0 ? nCumulative_(nChunk()-1) : 0);
 	return (nSegment_>0 ? nCumulPoints_(nSegment_-1) : 0);
 }
 
 double PlotMSIndexer::xAt(unsigned int i) const {
+	if (density_) return cellx_(i);
 	setChunk(i);  // sets chunk and relative index in chunk
-
-	double x= (plotmscache_->*getXFromCache_)(currChunk_,
-			(self->*XIndexer_)(currChunk_,irel_));
-	return x;
+	return xOf(currChunk_,irel_);
 }
 double PlotMSIndexer::yAt(unsigned int i) const {
+	if (density_) return celly_(i);
 	setChunk(i);  // sets chunk and relative index in chunk
-	return (plotmscache_->*getYFromCache_)(currChunk_,
-			(self->*YIndexer_)(currChunk_,irel_));
+	return yOf(currChunk_,irel_);
 }
 void PlotMSIndexer::xAndYAt(unsigned int index, 
 		double& x, double& y) const {
-	setChunk(index);  // sets chunk and relative index in chunk
-	x=(plotmscache_->*getXFromCache_)(currChunk_,
-			(self->*XIndexer_)(currChunk_,irel_));
-	y=(plotmscache_->*getYFromCache_)(currChunk_,
-			(self->*YIndexer_)(currChunk_,irel_));
+	x=xAt(index);
+	y=yAt(index);
 }
 
 bool PlotMSIndexer::minsMaxes(double& xMin, double& xMax, 
 		double& yMin, double& yMax) {
 
-	if (this->size()<1) return false;
+	if (nRawPoints()<1) return false;
 
 	// return the collective (flagged/unflagged) min/max
 	// X:
@@ -237,24 +247,22 @@ bool PlotMSIndexer::minsMaxes(double& xMin, double& xMax,
 }
 
 bool PlotMSIndexer::maskedAt( unsigned int index) const {
+	if (density_) return cellmask_(index);
 	setChunk(index);
-	return !(*(plotmscache_->plmask_[dataIndex][currChunk_]->data()+irel_));
+	return maskOf(currChunk_,irel_);
 }
 void PlotMSIndexer::xyAndMaskAt(unsigned int index,
 		double& x, double& y,
 		bool& mask) const {
-	setChunk(index);
-	x=(plotmscache_->*getXFromCache_)(currChunk_,
-			(self->*XIndexer_)(currChunk_,irel_));
-	y=(plotmscache_->*getYFromCache_)(currChunk_,
-			(self->*YIndexer_)(currChunk_,irel_));
-	mask=!(*(plotmscache_->plmask_[dataIndex][currChunk_]->data()+irel_));
+	x=xAt(index);
+	y=yAt(index);
+	mask=maskedAt(index);
 }
 
 bool PlotMSIndexer::maskedMinsMaxes(double& xMin, double& xMax, 
 		double& yMin, double& yMax) {
 
-	if (this->size()<1) return false;
+	if (nRawPoints()<1) return false;
 
 	// return the collective (flagged) min/max
 	// X:
@@ -287,7 +295,7 @@ bool PlotMSIndexer::maskedMinsMaxes(double& xMin, double& xMax,
 bool PlotMSIndexer::maskedMinsMaxesRaw(double& xMin, double& xMax, 
 		double& yMin, double& yMax) {
 
-	if (this->size()<1) return false;
+	if (nRawPoints()<1) return false;
 
 	xMin=xflmin_;
 	xMax=xflmax_;
@@ -299,7 +307,7 @@ bool PlotMSIndexer::maskedMinsMaxesRaw(double& xMin, double& xMax,
 bool PlotMSIndexer::unmaskedMinsMaxes(double& xMin, double& xMax, 
 		double& yMin, double& yMax) {
 
-	if (this->size()<1) return false;
+	if (nRawPoints()<1) return false;
 
 	// return the collective (unflagged) min/max
 	// X:
@@ -332,7 +340,7 @@ bool PlotMSIndexer::unmaskedMinsMaxes(double& xMin, double& xMax,
 bool PlotMSIndexer::unmaskedMinsMaxesRaw(double& xMin, double& xMax, 
 		double& yMin, double& yMax) {
 
-	if (this->size()<1) return false;
+	if (nRawPoints()<1) return false;
 
 	xMin=xmin_;
 	xMax=xmax_;
@@ -349,35 +357,47 @@ unsigned int PlotMSIndexer::numBins() const {
 }
 
 unsigned int PlotMSIndexer::binAt(unsigned int i) const {
+	if(!itsColorize_) return 0;
+	if(density_) {
+		// most common colour bin of the aggregated cell
+		return cellbin_(i);
+	}
+	setChunk(i);
+	return binOf(currChunk_, irel_);
+}
+
+Double PlotMSIndexer::xOf(Int chunk, Int irel) const {
+	return (plotmscache_->*getXFromCache_)(chunk,(self->*XIndexer_)(chunk,irel));
+}
+
+Double PlotMSIndexer::yOf(Int chunk, Int irel) const {
+	return (plotmscache_->*getYFromCache_)(chunk,(self->*YIndexer_)(chunk,irel));
+}
+
+Bool PlotMSIndexer::maskOf(Int chunk, Int irel) const {
+	return !(*(plotmscache_->plmask_[dataIndex][chunk]->data()+irel));
+}
+
+unsigned int PlotMSIndexer::binOf(Int chunk, Int irel) const {
 	unsigned int binValue = 0;
-	if(itsColorize_) {
-		setChunk(i);
-		unsigned int val = (unsigned int)(plotmscache_->*getColFromCache_)(currChunk_,
-				(self->*ColIndexer_)(currChunk_,irel_));
+	unsigned int val = (unsigned int)(plotmscache_->*getColFromCache_)(chunk,
+			(self->*ColIndexer_)(chunk,irel));
 
-		if ( itsColorizeAxis_ != PMS::TIME ){
-			binValue = val % numBins();
+	if ( itsColorizeAxis_ != PMS::TIME ){
+		binValue = val % numBins();
+	}
+	else {
+		if ( plotmscache_->averaging_.time() ){
+			double timeInterval= plotmscache_->averaging_.timeValue();
+			double baseTime = plotmscache_->getTime( 0, 0 );
+			Double time = plotmscache_->getTime(chunk, 0);
+			Double timeDiff = time - baseTime;
+			int timeIndex = static_cast<int>( timeDiff / timeInterval );
+			binValue = timeIndex % numBins();
 		}
 		else {
-			if ( plotmscache_->averaging_.time() ){
-				double timeInterval= plotmscache_->averaging_.timeValue();
-				double baseTime = plotmscache_->getTime( 0, 0 );
-				Double time = plotmscache_->getTime(currChunk_, 0);
-				Double timeDiff = time - baseTime;
-				int timeIndex = static_cast<int>( timeDiff / timeInterval );
-				binValue = timeIndex % numBins();
-			}
-			else {
-				int timeIndex = 0;
-				if ( currChunk_ == 0 ){
-					timeIndex = plotmscache_->findColorIndex( currChunk_, false );
-				}
-				else {
-					timeIndex = plotmscache_->findColorIndex( currChunk_, false );
-				}
-				binValue = timeIndex % numBins();
-
-			}
+			int timeIndex = plotmscache_->findColorIndex( chunk, false );
+			binValue = timeIndex % numBins();
 		}
 	}
 	return binValue;
@@ -401,6 +421,11 @@ bool PlotMSIndexer::colorize(bool doColorize, PMS::Axis colorizeAxis) {
 		setIndexer(ColIndexer_,itsColorizeAxis_);
 	}
 
+	// Aggregated colours must be recomputed
+	if (changed && density_) {
+		aggregate();
+	}
+
 	//cout << "COLORIZE!! " << boolalpha << itsColorize_ << " " << PMS::axis(itsColorizeAxis_) << endl;
 
 	return changed;
@@ -730,6 +755,162 @@ void PlotMSIndexer::setChunk(uInt i) const {
 
 }
 
+bool PlotMSIndexer::setDensityGrid(Int nx, Int ny,
+		double xMin, double xMax, double yMin, double yMax) {
+
+	// Nothing to do if the screen grid is unchanged (e.g., a redraw
+	//  without zooming); otherwise the plotted points are re-read
+	if (density_ && nx==dnx_ && ny==dny_ &&
+	    xMin==dxmin_ && xMax==dxmax_ && yMin==dymin_ && yMax==dymax_)
+		return false;
+
+	density_=true;
+	dnx_=max(nx,1);
+	dny_=max(ny,1);
+	dxmin_=xMin;
+	dxmax_=xMax;
+	dymin_=yMin;
+	dymax_=yMax;
+	aggregate();
+	return true;
+}
+
+void PlotMSIndexer::clearDensity() {
+	density_=false;
+	dnx_=dny_=0;
+	cellx_.resize(0);
+	celly_.resize(0);
+	cellmask_.resize(0);
+	cellbin_.resize(0);
+	cellCount_.resize(0);
+	cellFlagFraction_.resize(0);
+}
+
+void PlotMSIndexer::aggregate() {
+
+	Int npts=nRawPoints();
+	Int ncell=dnx_*dny_;
+	Double dx=(dxmax_-dxmin_)/Double(dnx_);
+	Double dy=(dymax_-dymin_)/Double(dny_);
+	if (npts==0 || ncell==0 || !(dx>0.0) || !(dy>0.0)) {
+		cellx_.resize(0);
+		celly_.resize(0);
+		cellmask_.resize(0);
+		cellbin_.resize(0);
+		cellCount_.resize(0);
+		cellFlagFraction_.resize(0);
+		return;
+	}
+
+	// findColorIndex() fills its list of times on first use, so do that
+	//  before the threads read it
+	Bool doColor(itsColorize_);
+	if (doColor && itsColorizeAxis_==PMS::TIME && !plotmscache_->averaging_.time())
+		plotmscache_->findColorIndex(0, false);
+
+	// Per-cell unflagged/flagged counts and, when colourizing, the number
+	//  of points of each colour bin per cell and flag state.  Each thread
+	//  counts into private grids and a sparse bin histogram (a cell
+	//  rarely holds more than a few bins), which are merged after the loop
+	Int nbin=numBins();
+	Vector<uInt> nUnfl(ncell,0), nFl(ncell,0);
+	std::unordered_map<Int64,uInt> binCount;
+	uInt *nUnflp=nUnfl.data(), *nFlp=nFl.data();
+
+#pragma omp parallel
+	{
+		// Private count grids and bin histogram, merged below
+		std::vector<uInt> myUnfl(ncell,0), myFl(ncell,0);
+		std::unordered_map<Int64,uInt> myBins;
+
+		// Segments are independent, contiguous runs of cache points
+#pragma omp for schedule(dynamic)
+		for (Int iseg=0; iseg<nSegment_; ++iseg) {
+			Int ich=cacheChunk_(iseg);
+			Int off=cacheOffset_(iseg);
+			Int npt=nSegPoints_(iseg);
+			for (Int irel=off; irel<off+npt; ++irel) {
+				Double fx=(xOf(ich,irel)-dxmin_)/dx;
+				Double fy=(yOf(ich,irel)-dymin_)/dy;
+				// also rejects NaNs
+				if (!(fx>=0.0 && fx<=Double(dnx_) && fy>=0.0 && fy<=Double(dny_)))
+					continue;
+				Int ix=min(Int(fx),dnx_-1);
+				Int iy=min(Int(fy),dny_-1);
+				Int icell=iy*dnx_+ix;
+				Bool m=maskOf(ich,irel);
+				if (m)
+					++myFl[icell];
+				else
+					++myUnfl[icell];
+				if (doColor)
+					++myBins[(2*Int64(icell)+(m ? 1 : 0))*nbin+Int(binOf(ich,irel))];
+			}
+		}
+
+#pragma omp critical
+		{
+			for (Int icell=0; icell<ncell; ++icell) {
+				nUnflp[icell]+=myUnfl[icell];
+				nFlp[icell]+=myFl[icell];
+			}
+			for (std::unordered_map<Int64,uInt>::const_iterator it=myBins.begin();
+			     it!=myBins.end(); ++it)
+				binCount[it->first]+=it->second;
+		}
+	}
+
+	// The most common bin of each cell and flag state (the lowest one on
+	//  ties)
+	std::vector<uShort> modal(doColor ? 2*ncell : 0, 0);
+	std::vector<uInt> modalCount(doColor ? 2*ncell : 0, 0);
+	for (std::unordered_map<Int64,uInt>::const_iterator it=binCount.begin();
+	     it!=binCount.end(); ++it) {
+		Int64 icf=it->first/nbin;
+		uShort ibin=uShort(it->first%nbin);
+		if (it->second>modalCount[icf] ||
+		    (it->second==modalCount[icf] && ibin<modal[icf])) {
+			modal[icf]=ibin;
+			modalCount[icf]=it->second;
+		}
+	}
+
+	// One representative (cell-centred) point per occupied cell and
+	//  flag state, so the plotter draws at most two points per cell; each
+	//  keeps the number of points it stands for and the flagged fraction
+	//  of its cell
+	uInt nOut=0;
+	for (Int icell=0; icell<ncell; ++icell)
+		nOut+=(nUnflp[icell]>0 ? 1 : 0)+(nFlp[icell]>0 ? 1 : 0);
+
+	cellx_.resize(nOut);
+	celly_.resize(nOut);
+	cellmask_.resize(nOut);
+	cellbin_.resize(nOut);
+	cellCount_.resize(nOut);
+	cellFlagFraction_.resize(nOut);
+
+	uInt iout=0;
+	for (Int icell=0; icell<ncell; ++icell) {
+		uInt ncellpts=nUnflp[icell]+nFlp[icell];
+		if (ncellpts==0) continue;
+		Double xc=dxmin_+(Double(icell%dnx_)+0.5)*dx;
+		Double yc=dymin_+(Double(icell/dnx_)+0.5)*dy;
+		Float flfrac=Float(nFlp[icell])/Float(ncellpts);
+		for (Int ifl=0; ifl<2; ++ifl) {
+			uInt n=(ifl ? nFlp[icell] : nUnflp[icell]);
+			if (n==0) continue;
+			cellx_(iout)=xc;
+			celly_(iout)=yc;
+			cellmask_(iout)=Bool(ifl);
+			cellbin_(iout)=(doColor ? modal[2*icell+ifl] : uShort(0));
+			cellCount_(iout)=n;
+			cellFlagFraction_(iout)=flfrac;
+			++iout;
+		}
+	}
+}
+
 void PlotMSIndexer::setMethod(CacheMemPtr& getmethod,PMS::Axis axis,
         PMS::DataColumn datacol) {
 
@@ -1220,8 +1401,8 @@ void PlotMSIndexer::setCollapser(CollapseMethPtr& collmethod,PMS::Axis axis) {
  */
 
 Record PlotMSIndexer::getPointMetaData(Int i) {
-	Double thisx, thisy;
-	xAndYAt(i, thisx, thisy);
+	setChunk(i);  // sets currChunk_ and irel_ for the meta data below
+	Double thisx(xOf(currChunk_,irel_)), thisy(yOf(currChunk_,irel_));
 	// Collect meta data
 	Int ichan = getIndex0100(currChunk_, irel_);
 	Int chan = Int(plotmscache_->getChan(currChunk_,ichan));
@@ -1277,21 +1458,21 @@ Record PlotMSIndexer::getPointMetaData(Int i) {
 Record PlotMSIndexer::locateInfo(const Vector<PlotRegion>& regions,
 		Bool showUnflagged, Bool showFlagged,
 		Bool selectAll) {
-	int nFound = 0, n = size();
+	int nFound = 0, n = nRawPoints();
 	Int nFoundMasked = 0, nFoundUnmasked = 0;
 	Bool m = false;
 	Record result;
 	result.define("xaxis", PMS::axis(currentX_));
 	result.define("yaxis", PMS::axis(currentY_));
 	for(Int i = 0; i < n; ++i) {
-		m = maskedAt(i);
+		setChunk(i);
+		m = maskOf(currChunk_,irel_);
 		// Skip point if it is not displayed
 		if((!m && !showUnflagged) || (m && !showFlagged)) {
 			continue;
 		}
+		Double thisx(xOf(currChunk_,irel_)), thisy(yOf(currChunk_,irel_));
 		for(uInt j = 0; j < regions.size(); ++j) {
-			Double thisx, thisy;
-			xAndYAt(i, thisx, thisy);
 			// If a point falls inside a bounding region...
 			if(thisx > regions[j].left() && thisx < regions[j].right() &&
 					thisy > regions[j].bottom() && thisy < regions[j].top()) {
@@ -1329,18 +1510,21 @@ PlotLogMessage* PlotMSIndexer::locateRange(const Vector<PlotRegion>& regions,
 
 	Double thisx, thisy;
 	stringstream ss;
-	Int nFound = 0, n = size();
+	Int nFound = 0, n = nRawPoints();
 	Int nFoundMasked(0),nFoundUnmasked(0);
 
 	Bool m(false);
 	for(Int i = 0; i < n; i++) {
 
-		m=maskedAt(i);
+		// The following sets currChunk_ and irel_ (as needed below)
+		setChunk(i);
+		m=maskOf(currChunk_,irel_);
 
 		// Only locate if point is visible
 		if ( (!m && showUnflagged) || (m && showFlagged) ) {
 
-			xAndYAt(i, thisx, thisy);
+			thisx=xOf(currChunk_,irel_);
+			thisy=yOf(currChunk_,irel_);
 
 			for(uInt j = 0; j < regions.size(); j++) {
 				if (thisx > regions[j].left() && thisx < regions[j].right() &&
@@ -1349,6 +1533,7 @@ PlotLogMessage* PlotMSIndexer::locateRange(const Vector<PlotRegion>& regions,
 					(m ? ++nFoundMasked : ++nFoundUnmasked);
 					// only report first 1000, so logger isn't overloaded
 					if (nFound<1001) {
+						setChunk(i);
 						reportMeta(thisx, thisy, m, ss);
 						ss << '\n';
 					}
@@ -1496,15 +1681,18 @@ PlotLogMessage* PlotMSIndexer::flagRange(const PlotMSFlagging& flagging,
 
 	Double thisx, thisy;
 	stringstream ss;
-	Int nFound = 0, n = size(), flsz;
+	Int nFound = 0, n = nRawPoints(), flsz;
 
 	for(Int i = 0; i < n; i++) {
 
 		// The following sets currChunk_ and irel_ (as needed below)
-		if ((!maskedAt(i) && flag) ||    // not yet flagged and we are flagging
-				(maskedAt(i) && !flag) ) {   // already flagged and we are unflagging
+		setChunk(i);
+		Bool m=maskOf(currChunk_,irel_);
+		if ((!m && flag) ||    // not yet flagged and we are flagging
+				(m && !flag) ) {   // already flagged and we are unflagging
 
-			xAndYAt(i, thisx, thisy);
+			thisx=xOf(currChunk_,irel_);
+			thisy=yOf(currChunk_,irel_);
 
 			for(uInt j = 0; j < regions.size(); j++) {
 				if(thisx > regions[j].left() && thisx < regions[j].right() &&
@@ -1557,6 +1745,9 @@ PlotLogMessage* PlotMSIndexer::flagRange(const PlotMSFlagging& flagging,
 		// Recompute ranges
 		computeRanges();
 
+		// ...and the aggregated cells
+		if (density_) aggregate();
+
 	}
 
 
@@ -1590,7 +1781,7 @@ String PlotMSIndexer::iterValue() {
 		break;
 	}
 	case PMS::BASELINE: {
-		maskedAt(0);  // sets currChunk_ and irel_ for first point so we can get ant indices
+		setChunk(0);  // sets currChunk_ and irel_ for first point so we can get ant indices
 		Int ant1=Int(plotmscache_->getAnt1(currChunk_,getIndex0010(currChunk_,irel_)));
 		Int ant2=Int(plotmscache_->getAnt2(currChunk_,getIndex0010(currChunk_,irel_)));
 		String label;
@@ -1772,43 +1963,54 @@ void PlotMSIndexer::collapseMask0001(Int ch,Array<Bool>& collmask) {
 void PlotMSIndexer::computeRanges() {
 
 	// Initialize limits
-	xmin_=ymin_=xflmin_=yflmin_=DBL_MAX;
-	xmax_=ymax_=xflmax_=yflmax_=-DBL_MAX;
-
-	// We will count up flagged/unflagged here
-	sizeMasked_=sizeUnMasked_=0;
-
-	// Loop over all points to detected min/max
-	for (uInt i=0;i<size();++i) {
-
-		Double x,y;
-		Bool m;
-		xyAndMaskAt(i,x,y,m);
-
-		// CAS-8019 nan>ymax_ caused error in autorange
-		if ( !m ) {
-			++sizeUnMasked_;
-			if (!isNaN(x)) {
-			    xmin_ = min(xmin_,x);
-			    xmax_ = max(xmax_,x);
-			}
-			if (!isNaN(y)) {
-			    ymin_ = min(ymin_,y);
-			    ymax_ = max(ymax_,y);
-			}
-		}
-		else {
-			++sizeMasked_;
-			if (!isNaN(x)) {
-			    xflmin_ = min(xflmin_,x);
-			    xflmax_ = max(xflmax_,x);
+	Double xmin,ymin,xflmin,yflmin,xmax,ymax,xflmax,yflmax;
+	xmin=ymin=xflmin=yflmin=DBL_MAX;
+	xmax=ymax=xflmax=yflmax=-DBL_MAX;
+
+	// We will count up flagged here
+	Int nMasked(0);
+
+	// One pass over the plotted points of each segment (in parallel)
+	//  to detect min/max
+	Int npts=nRawPoints();
+#pragma omp parallel for schedule(dynamic) reduction(min:xmin,ymin,xflmin,yflmin) reduction(max:xmax,ymax,xflmax,yflmax) reduction(+:nMasked)
+	for (Int iseg=0; iseg<nSegment_; ++iseg) {
+		Int ich=cacheChunk_(iseg);
+		Int off=cacheOffset_(iseg);
+		Int npt=nSegPoints_(iseg);
+		for (Int irel=off; irel<off+npt; ++irel) {
+
+			Double x=xOf(ich,irel), y=yOf(ich,irel);
+
+			// CAS-8019 nan>ymax_ caused error in autorange
+			if ( !maskOf(ich,irel) ) {
+				if (!isNaN(x)) {
+				    xmin = min(xmin,x);
+				    xmax = max(xmax,x);
+				}
+				if (!isNaN(y)) {
+				    ymin = min(ymin,y);
+				    ymax = max(ymax,y);
+				}
 			}
-			if (!isNaN(y)) {
-			    yflmin_ = min(yflmin_,y);
-			    yflmax_ = max(yflmax_,y);
+			else {
+				++nMasked;
+				if (!isNaN(x)) {
+				    xflmin = min(xflmin,x);
+				    xflmax = max(xflmax,x);
+				}
+				if (!isNaN(y)) {
+				    yflmin = min(yflmin,y);
+				    yflmax = max(yflmax,y);
+				}
 			}
 		}
 	}
+
+	xmin_=xmin; xmax_=xmax; ymin_=ymin; ymax_=ymax;
+	xflmin_=xflmin; xflmax_=xflmax; yflmin_=yflmin; yflmax_=yflmax;
+	sizeMasked_=nMasked;
+	sizeUnMasked_=npts-nMasked;
 }
 
 void PlotMSIndexer::log(const String& method, const String& message,
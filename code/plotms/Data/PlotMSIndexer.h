@@ -76,6 +76,7 @@ public:
   // </group>
 
   // Implemented PlotPointData methods.
+  //  (in density mode these address the aggregated cells)
   // <group>
   unsigned int size() const;
   double xAt(unsigned int i) const;
@@ -108,6 +109,26 @@ public:
   // Set up indexing for the plot 
   void setUpIndexing();
 
+  // Number of cached points plotted (independent of density mode)
+  unsigned int nRawPoints() const;
+
+  // Density (screen-resolution aggregation) rendering.  Points are
+  // binned onto an nx by ny grid covering the given range, and the
+  // PlotData interface then presents one cell-centred point per occupied
+  // cell and flag state.  Rebinning reads only the flat columns, so it
+  // is cheap to redo on zoom; setDensityGrid returns false (and does
+  // nothing) if the grid is unchanged.
+  // <group>
+  bool setDensityGrid(casacore::Int nx, casacore::Int ny,
+		      double xMin, double xMax, double yMin, double yMax);
+  void clearDensity();
+  bool isDensity() const { return density_; };
+  // Number of points aggregated into presented point i, and the flagged
+  //  fraction of the points in its cell
+  casacore::uInt densityCount(unsigned int i) const { return cellCount_(i); };
+  casacore::Float densityFlagFraction(unsigned int i) const { return cellFlagFraction_(i); };
+  // </group>
+
   // Set global min/max flag
   void setGlobalMinMax(casacore::Bool globalX=false,casacore::Bool globalY=false);
   bool isGlobalXRange() const;
@@ -196,6 +217,19 @@ private:
   // Set currChunk_ according to a supplied index
   void setChunk(casacore::uInt i) const;
 
+  // Bin the plotted points onto the current density grid (in parallel
+  //  over segments, with per-thread grids and colour histograms)
+  void aggregate();
+
+  // Plotted x and y values and plot mask (true if flagged) of point
+  //  irel of a cache chunk, read straight from the cache
+  casacore::Double xOf(casacore::Int chunk, casacore::Int irel) const;
+  casacore::Double yOf(casacore::Int chunk, casacore::Int irel) const;
+  casacore::Bool maskOf(casacore::Int chunk, casacore::Int irel) const;
+
+  // Colour bin of point irel of a cache chunk
+  unsigned int binOf(casacore::Int chunk, casacore::Int irel) const;
+
   // Computes the X and Y limits for the currently set axes.  In the future we
   // may want to cache ALL ranges for all loaded values to avoid recomputation.
   void computeRanges();
@@ -276,6 +310,18 @@ private:
   PMS::Axis itsColorizeAxis_;
   // </group>
   
+  // Density rendering
+  // <group>
+  bool density_;
+  casacore::Int dnx_, dny_;
+  casacore::Double dxmin_, dxmax_, dymin_, dymax_;
+  casacore::Vector<casacore::Double> cellx_, celly_;
+  casacore::Vector<casacore::Bool> cellmask_;
+  casacore::Vector<casacore::uShort> cellbin_;
+  casacore::Vector<casacore::uInt> cellCount_;
+  casacore::Vector<casacore::Float> cellFlagFraction_;
+  // </group>
+
   // Cope with const-ness in the get methods
   PlotMSIndexer* self;
 
@@ -247,6 +247,17 @@ bool PlotMSPlotter::canvasDrawBeginning(
 ) {
 
 	(void)drawOperation,(void)drawnLayersFlag;
+
+    // Rebin density-rendered plots for the ranges about to be drawn
+    //  (not while another thread may be reading or loading the data)
+    if(itsCurrentThread_ == NULL) {
+        PlotMSPlotManager& manager = itsParent_->getPlotManager();
+        for(unsigned int i = 0; i < manager.numPlots(); i++) {
+            PlotMSPlot* plot = manager.plot(i);
+            if(plot != NULL && !plot->isCacheUpdating()) plot->updateDensity();
+        }
+    }
+
     if(!drawingIsThreaded) {
         cout << "PlotMSPlotter does not currently support threading for "
              << "plotter implementations that do not do threaded drawing "
@@ -85,6 +85,7 @@ const String PlotMSDBusApp::PARAM_EXPORT_ASYNC = "exportasync";
 
 const String PlotMSDBusApp::PARAM_COLORIZE = "colorize";
 const String PlotMSDBusApp::PARAM_COLORAXIS = "coloraxis";
+const String PlotMSDBusApp::PARAM_DENSITYTHRESHOLD = "densitythreshold";
 const String PlotMSDBusApp::PARAM_CANVASTITLE = "canvastitle";
 const String PlotMSDBusApp::PARAM_CANVASTITLEFONT = "canvastitlefont";
 const String PlotMSDBusApp::PARAM_XAXISLABEL = "xaxislabel";
@@ -405,6 +406,7 @@ void PlotMSDBusApp::dbusRunXmlMethod(
 				ret.define(PARAM_COLORIZE, disp->colorizeFlag());
 				PMS::Axis  ax = disp->colorizeAxis();
 				ret.define(PARAM_COLORAXIS, PMS::Axis(ax));
+				ret.define(PARAM_DENSITYTHRESHOLD, disp->densityThreshold());
 			}
 
 			if (can!=NULL)   {
@@ -705,6 +707,11 @@ void PlotMSDBusApp::dbusRunXmlMethod(
 				ppdisp->setColorize(false);
 		}
 
+		if(parameters.isDefined(PARAM_DENSITYTHRESHOLD) &&
+				parameters.dataType(PARAM_DENSITYTHRESHOLD) == TpInt)   {
+			ppdisp->setDensityThreshold(parameters.asInt(PARAM_DENSITYTHRESHOLD));
+		}
+
 
 		if (parameters.isDefined(PARAM_SHOWMAJORGRID)  &&
 				parameters.dataType(PARAM_SHOWMAJORGRID) == TpBool)   {
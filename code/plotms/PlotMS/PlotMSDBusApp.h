@@ -96,6 +96,7 @@ public:
     static const casacore::String PARAM_EXPORT_ASYNC;  // bool
     static const casacore::String PARAM_COLORIZE;      // bool
     static const casacore::String PARAM_COLORAXIS;     // string
+    static const casacore::String PARAM_DENSITYTHRESHOLD; // int
     static const casacore::String PARAM_CANVASTITLE;    // string
     static const casacore::String PARAM_CANVASTITLEFONT;  // int
     static const casacore::String PARAM_DATA_INDEX;    //int
@@ -31,6 +31,8 @@
 #include <plotms/Data/PlotMSCacheBase.h>
 #include <plotms/Data/MSCache.h>
 #include <plotms/Data/CalCache.h>
+#include <plotms/Data/PlotMSIndexer.h>
+#include <casa/System/AipsrcValue.h>
 #include <QDebug>
 
 
@@ -219,6 +221,10 @@ void PlotMSPlot::attachToCanvases() {
 	if ( nIter <= 0 ){
 		nIter = 1;
 	}
+	itsPlotCanvases_.resize( itsPlots_.size() );
+	for ( uInt i = 0; i < itsPlots_.size(); i++ ){
+		itsPlotCanvases_[i].assign( itsPlots_[i].size(), PlotCanvasPtr() );
+	}
 	int canvasRows = itsCanvases_.size();
 	for( int r = 0; r < canvasRows; ++r) {
 		int canvasCols = itsCanvases_[r].size();
@@ -232,6 +238,7 @@ void PlotMSPlot::attachToCanvases() {
 						int dataColCount = itsPlots_[i].size();
 						for ( int j = 0; j < dataColCount; j++ ){
 							itsCanvases_[r][c]->plotItem( itsPlots_[i][j]);
+							itsPlotCanvases_[i][j] = itsCanvases_[r][c];
 						}
 					}
 				}
@@ -249,6 +256,7 @@ void PlotMSPlot::attachToCanvases() {
 							for ( int i = 0; i < dataRowCount; i++ ){
 								if(!itsPlots_[i][iterationIndex].null()) {
 									itsCanvases_[r][c]->plotItem(itsPlots_[i][iterationIndex]);
+									itsPlotCanvases_[i][iterationIndex] = itsCanvases_[r][c];
 								}
 							}
 						}
@@ -262,6 +270,7 @@ void PlotMSPlot::attachToCanvases() {
 }
 
 void PlotMSPlot::detachFromCanvases() {
+	itsPlotCanvases_.clear();
 	for(uInt r = 0; r < itsCanvases_.size(); ++r) {
 		for(uInt c = 0; c < itsCanvases_[r].size(); ++c) {
 			if(!itsCanvases_[r][c].null()) {
@@ -770,6 +779,13 @@ void PlotMSPlot::parametersHaveChanged(const PlotMSWatchedParameters& p,
     // Make sure it's this plot's parameters.
     if(&p != &parameters()) return;
 
+    // Density rendering is off unless a threshold is given, either as a
+    // plot parameter or in aipsrc
+    const PMS_PP_Display* disp = parameters().typedGroup<PMS_PP_Display>();
+    itsDensityThreshold_ = (disp != NULL) ? disp->densityThreshold() : -1;
+    if (itsDensityThreshold_ < 0)
+        AipsrcValue<Int>::find(itsDensityThreshold_, "plotms.density.threshold", 0);
+
     //A plot not to be shown.
     bool plottable = itsParent_->getPlotManager().isPlottable( this );
     if ( ! plottable ){
@@ -845,6 +861,51 @@ void PlotMSPlot::parametersHaveChanged(const PlotMSWatchedParameters& p,
 
 }
 
+void PlotMSPlot::updateDensity() {
+	if (itsDensityThreshold_ <= 0 || itsCache_ == NULL || !itsCache_->cacheReady())
+		return;
+
+	for (uInt row = 0; row < itsPlots_.size() && row < itsPlotCanvases_.size(); ++row) {
+		Int nIter = itsCache_->nIter(row);
+		for (uInt col = 0; col < itsPlots_[row].size() && Int(col) < nIter; ++col) {
+			MaskedScatterPlotPtr plot = itsPlots_[row][col];
+			if (plot.null() || col >= itsPlotCanvases_[row].size()) continue;
+			PlotCanvasPtr canvas = itsPlotCanvases_[row][col];
+			if (canvas.null()) continue;
+			PlotMSIndexer& indexer = itsCache_->indexer(row, col);
+			if (!indexer.indexerReady()) continue;
+			uInt nShown = indexer.size();
+			if (indexer.nRawPoints() < uInt(itsDensityThreshold_)) {
+				if (indexer.isDensity()) {
+					indexer.clearDensity();
+					plot->dataChanged();
+				}
+				continue;
+			}
+
+			// One cell per pixel over the visible range (the data range
+			//  while autoscaling, since the axes follow the data)
+			pair<int, int> npix = canvas->size();
+			double xmin, xmax, ymin, ymax;
+			if (canvas->axesAutoRescale()) {
+				if (!indexer.minsMaxes(xmin, xmax, ymin, ymax)) continue;
+			} else {
+				prange_t xr = canvas->axisRange(plot->xAxis());
+				prange_t yr = canvas->axisRange(plot->yAxis());
+				xmin = xr.first;
+				xmax = xr.second;
+				ymin = yr.first;
+				ymax = yr.second;
+			}
+			// Let the plot item know its points changed (e.g., for its
+			//  bounding rectangle and legend)
+			if (indexer.setDensityGrid(npix.first, npix.second, xmin, xmax, ymin, ymax) &&
+			    indexer.size() != nShown)
+				plot->dataChanged();
+		}
+	}
+}
+
 void PlotMSPlot::plotDataChanged() {
     bool hold = allDrawingHeld();
     if(!hold) holdDrawing();
@@ -1248,6 +1309,7 @@ void PlotMSPlot::constructorSetup() {
 
     gridRow = -1;
     gridCol = -1;
+    itsDensityThreshold_ = 0;
     makeParameters(params, itsParent_);
 }
 
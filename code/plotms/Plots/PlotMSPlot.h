@@ -181,6 +181,14 @@ public:
     // Calls the dataChanged() method on the MaskedScatterPlots.  This WILL
     // cause a redraw of the affected canvases.
     void plotDataChanged();
+
+    // Switches plots with more than the density threshold (the
+    // densitythreshold plot parameter, or plotms.density.threshold in
+    // aipsrc) points to density rendering, aggregated to the pixel grid and
+    // current axes ranges of their canvases.  Meant to be called just
+    // before the canvases draw, so zooming rebins from the cache; the
+    // threshold and canvases are only looked up when the plot changes.
+    void updateDensity();
     
     //Returns true if the plot is an iteration plot.
     bool isIteration() const;
@@ -346,6 +354,14 @@ private:
     //second index is the column withen a grid.
     vector<vector<PlotCanvasPtr> > itsCanvases_;
 
+    //Canvas each plot of itsPlots_ is attached to (same indices), set by
+    //attachToCanvases().
+    vector<vector<PlotCanvasPtr> > itsPlotCanvases_;
+
+    //Density threshold from the parameters or aipsrc, read when the
+    //parameters change.
+    casacore::Int itsDensityThreshold_;
+
     vector<vector</*QPScatterPlot**/ColoredPlotPtr> > itsColoredPlots_;
     TCLParams itsTCLParams_;
     int gridRow;
@@ -1176,6 +1176,7 @@ const String PMS_PP_Display::REC_FLAGGEDS = "flaggedSymbols";
 const String PMS_PP_Display::REC_TITLES = "titles";
 const String PMS_PP_Display::REC_COLFLAGS = "colorizeFlags";
 const String PMS_PP_Display::REC_COLAXES = "colorizeAxes";
+const String PMS_PP_Display::REC_DENSITYTHRESHOLD = "densityThreshold";
 
 
 PMS_PP_Display::PMS_PP_Display(PlotFactoryPtr factory) : PlotMSPlotParameters::Group(factory)
@@ -1219,6 +1220,7 @@ Record PMS_PP_Display::toRecord() const {
 
 	rec.define(REC_COLFLAGS, Vector<bool>(itsColorizeFlags_));
 	rec.define(REC_COLAXES, PMS::toIntVector<PMS::Axis>(itsColorizeAxes_));
+	rec.define(REC_DENSITYTHRESHOLD, itsDensityThreshold_);
 
 	return rec;
 }
@@ -1300,6 +1302,15 @@ void PMS_PP_Display::fromRecord(const Record& record)
 			valuesChanged = true;
 		}
 	}
+	if (record.isDefined(REC_DENSITYTHRESHOLD) && record.dataType(REC_DENSITYTHRESHOLD) == TpInt)
+	{
+		int tmp = record.asInt(REC_DENSITYTHRESHOLD);
+		if (itsDensityThreshold_ != tmp)
+		{
+			itsDensityThreshold_ = tmp;
+			valuesChanged = true;
+		}
+	}
 
 	if (valuesChanged) updated();
 }
@@ -1326,6 +1337,7 @@ PMS_PP_Display& PMS_PP_Display::assign( const PMS_PP_Display* o ){
 		itsTitleFormats_ = o->itsTitleFormats_;
 		itsColorizeFlags_ = o->itsColorizeFlags_;
 		itsColorizeAxes_ = o->itsColorizeAxes_;
+		itsDensityThreshold_ = o->itsDensityThreshold_;
 
 		updated();
 	}
@@ -1371,6 +1383,7 @@ bool PMS_PP_Display::operator==(const Group& other) const
 			return false;
 		}
 	}
+	if (itsDensityThreshold_ != o->itsDensityThreshold_) return false;
 	return true;
 }
 
@@ -1382,6 +1395,7 @@ void PMS_PP_Display::setDefaults()
 	itsTitleFormats_ = vector<PlotMSLabelFormat>(1, PlotMSLabelFormat(PMS::DEFAULT_TITLE_FORMAT));
 	itsColorizeFlags_ = vector<bool>(1, false);
 	itsColorizeAxes_ = vector<PMS::Axis>(1, PMS::DEFAULT_COLOR_AXIS);
+	itsDensityThreshold_ = -1;
 
 }
 
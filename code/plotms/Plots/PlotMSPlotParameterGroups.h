@@ -1374,6 +1374,19 @@ public:
 		}
 	}
 
+	/* Number of plotted points above which the plot is drawn aggregated
+	 * to the canvas pixels; 0 turns this off and a negative value uses
+	 * the plotms.density.threshold aipsrc variable */
+	int densityThreshold() const {
+		return itsDensityThreshold_;
+	}
+	void setDensityThreshold (int value) {
+		if (itsDensityThreshold_ != value) {
+			itsDensityThreshold_ = value;
+			updated();
+		}
+	}
+
 
 
 
@@ -1389,6 +1402,7 @@ private:
 	vector<PlotMSLabelFormat> itsTitleFormats_;
 	vector<bool> itsColorizeFlags_;
 	vector<PMS::Axis> itsColorizeAxes_;
+	int itsDensityThreshold_;
 
 
 	/* Key strings for casacore::Record */
@@ -1397,6 +1411,7 @@ private:
 	static const casacore::String REC_TITLES;
 	static const casacore::String REC_COLFLAGS;
 	static const casacore::String REC_COLAXES;
+	static const casacore::String REC_DENSITYTHRESHOLD;
 
 	void setDefaults();
 };
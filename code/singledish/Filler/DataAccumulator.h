@@ -998,8 +998,7 @@ public:
 		return pool_[ichunk]->getNumPol();
 	}
 
-private:
-	bool isValidRecord(DataRecord const &record) {
+	static bool isValidRecord(DataRecord const &record) {
 //    std::cout << record.time << " " << record.interval << " "
 //        << record.antenna_id << " " << record.field_id << " " << record.feed_id
 //        << " " << record.spw_id << " " << record.scan << " " << record.subscan
@@ -1010,6 +1009,7 @@ private:
 				&& record.subscan >= 0 && !record.direction.empty();
 	}
 
+private:
 	std::vector<DataChunk *> pool_;
 	std::vector<casacore::Int> antenna_id_;
 	std::vector<casacore::Int> spw_id_;
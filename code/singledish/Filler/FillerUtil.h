@@ -18,6 +18,8 @@
 #define POST_END
 #endif
 
+#include <chrono>
+
 namespace casa { //# NAMESPACE CASA - BEGIN
 namespace sdfiller { //# NAMESPACE SDFILLER - BEGIN
 struct Deleter {
@@ -27,6 +29,33 @@ struct Deleter {
     }
   }
 };
+
+// accumulates wall clock time spent in a processing stage
+class StageTimer {
+public:
+  StageTimer() :
+      elapsed_(0.0), start_() {
+  }
+  void start() {
+    start_ = std::chrono::steady_clock::now();
+  }
+  void stop() {
+    elapsed_ += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_).count();
+  }
+  void add(double elapsed) {
+    elapsed_ += elapsed;
+  }
+  void reset() {
+    elapsed_ = 0.0;
+  }
+  double getElapsed() const {
+    return elapsed_;
+  }
+private:
+  double elapsed_;
+  std::chrono::steady_clock::time_point start_;
+};
 } //# NAMESPACE SDFILLER - BEGIN
 } //# NAMESPACE CASA - END
 
@@ -11,6 +11,7 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <vector>
 
 #include <singledish/Filler/DataAccumulator.h>
 #include <singledish/Filler/SysCalRecord.h>
@@ -46,13 +47,6 @@ class DataAccumulator;
 template<typename Reader>
 class SingleDishMSFiller {
 public:
-  // static methods for parallel processing
-  inline static void create_context();
-  inline static void destroy_context();
-  static void *consume(void *arg);
-  static void *produce(void *arg);
-  inline static void fillMainMT(SingleDishMSFiller<Reader> *filler);
-
   // constructor
   SingleDishMSFiller(std::string const &name, bool parallel=false);
 
@@ -68,6 +62,16 @@ public:
     return reader_->getName();
   }
 
+  // number of worker threads that merge the records in parallel
+  // execution. 0 (default) chooses the number from the available cores.
+  void setNumberOfWorkers(size_t num_workers) {
+    num_workers_ = num_workers;
+  }
+
+  size_t getNumberOfWorkers() const {
+    return num_workers_;
+  }
+
   // top level method to fill casacore::MS by reading input data
   void fill();
 
@@ -75,6 +79,71 @@ public:
   void save(std::string const &name);
 
 private:
+  // a run of records of the main loop consisting of whole timestamp
+  // groups. In parallel execution, the reader fills the records, a worker
+  // merges them into rows, and the writer writes the rows in the order
+  // of the batch id.
+  struct MainBatch {
+    MainBatch() :
+        id(0), records(), num_records(0), record_end(), chunk_keys(),
+        chunk_end(), rows(), row_keys(), num_rows(0), row_end() {
+    }
+
+    void reset(size_t batch_id) {
+      id = batch_id;
+      num_records = 0;
+      record_end.clear();
+      chunk_keys.clear();
+      chunk_end.clear();
+      row_keys.clear();
+      num_rows = 0;
+      row_end.clear();
+    }
+
+    // records are copied into recycled storage
+    void addRecord(sdfiller::DataRecord const &record) {
+      if (num_records < records.size()) {
+        *records[num_records] = record;
+      } else {
+        records.emplace_back(new sdfiller::DataRecord(record));
+      }
+      ++num_records;
+    }
+
+    void closeGroup() {
+      record_end.push_back(num_records);
+      chunk_end.push_back(chunk_keys.size());
+    }
+
+    sdfiller::MSDataRecord &nextRow() {
+      if (num_rows == rows.size()) {
+        rows.emplace_back(new sdfiller::MSDataRecord());
+      }
+      return *rows[num_rows];
+    }
+
+    void commitRow(size_t key) {
+      row_keys.push_back(key);
+      ++num_rows;
+    }
+
+    size_t id;
+    // records and the end offset of each timestamp group
+    std::vector<std::unique_ptr<sdfiller::DataRecord>> records;
+    size_t num_records;
+    std::vector<size_t> record_end;
+    // global index of the key of each chunk a group is merged into,
+    // in the order of chunks, and the end offset of each group
+    std::vector<size_t> chunk_keys;
+    std::vector<size_t> chunk_end;
+    // merged rows, global index of their keys, and the end offset
+    // of each group
+    std::vector<std::unique_ptr<sdfiller::MSDataRecord>> rows;
+    std::vector<size_t> row_keys;
+    size_t num_rows;
+    std::vector<size_t> row_end;
+  };
+
   // initialization
   void initialize();
 
@@ -94,9 +163,22 @@ private:
   // fill MAIN table
   void fillMain();
 
+  // fill MAIN table by a pipeline of a reader thread, worker threads
+  // merging the records, and the writer on the calling thread
+  void fillMainMT();
+
   // flush accumulated data
   inline void flush(sdfiller::DataAccumulator &accumulator);
 
+  // merge timestamp groups of the batch into rows
+  inline void mergeBatch(MainBatch &batch);
+
+  // update subtables and MAIN table with the rows of the batch
+  inline void writeBatch(MainBatch const &batch);
+
+  // post time spent in each stage of the main loop
+  inline void postTiming(size_t num_workers, casacore::Double elapsed);
+
   void sortPointing();
 
   // Fill subtables
@@ -183,6 +265,24 @@ private:
       casacore::Int dataDescriptionId, casacore::Int stateId, casacore::Int const &scan_number,
       casacore::Double const &time, sdfiller::MSDataRecord const &dataRecord);
 
+  // update MAIN table with consecutive rows at once
+  // @param[in] records main table row specifications
+  // @param[in] data_desc_ids data description id of each row
+  // @param[in] state_ids state id of each row
+  inline void updateMain(std::vector<sdfiller::MSDataRecord const *> const &records,
+      std::vector<casacore::Int> const &data_desc_ids,
+      std::vector<casacore::Int> const &state_ids);
+
+  // put array cells of MAIN table row
+  inline void updateMainArrays(casacore::uInt irow, sdfiller::MSDataRecord const &dataRecord);
+
+  // update subtables that the row refers to
+  // @param[in] record main table row specification
+  // @param[out] data_desc_id data description id
+  // @param[out] state_id state id
+  inline void updateSubtables(sdfiller::MSDataRecord const &record,
+      casacore::Int &data_desc_id, casacore::Int &state_id);
+
   std::unique_ptr<casacore::MeasurementSet> ms_;
   std::unique_ptr<casacore::MSMainColumns> ms_columns_;
   std::unique_ptr<casacore::MSDataDescColumns> data_description_columns_;
@@ -220,6 +320,14 @@ private:
 
   // for parallel processing
   casacore::Bool const parallel_;
+
+  size_t num_workers_;
+
+  // time spent in each stage of the main loop
+  sdfiller::StageTimer read_timer_;
+  sdfiller::StageTimer merge_timer_;
+  sdfiller::StageTimer subtable_timer_;
+  sdfiller::StageTimer main_timer_;
 }
 ;
 
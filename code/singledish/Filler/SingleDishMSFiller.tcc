@@ -19,9 +19,16 @@
 #include <singledish/Filler/SysCalRecord.h>
 #include <singledish/Filler/WeatherRecord.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
 
 #include <casacore/casa/Arrays/Cube.h>
 #include <casacore/casa/OS/File.h>
@@ -39,6 +46,7 @@
 #include <casacore/ms/MeasurementSets/MSSourceColumns.h>
 
 #include <casacore/tables/Tables/Table.h>
+#include <casacore/tables/Tables/RefRows.h>
 #include <casacore/tables/Tables/ScalarColumn.h>
 #include <casacore/tables/Tables/SetupNewTab.h>
 
@@ -145,198 +153,8 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 
 using namespace sdfiller;
 
-static constexpr ssize_t CONTEXT_BUFFER_SIZE = 10;
-static constexpr ssize_t FILLER_STORAGE_SIZE = CONTEXT_BUFFER_SIZE + 2;
-typedef sdfiller::ProducerConsumerModelContext<ssize_t, CONTEXT_BUFFER_SIZE> PCMContext;
-
-extern PCMContext *g_context_p;
-extern casa::sdfiller::DataRecord *g_storage_p;
-
-template<class T>
-void SingleDishMSFiller<T>::create_context() {
-  static_assert(0 < FILLER_STORAGE_SIZE && FILLER_STORAGE_SIZE < SSIZE_MAX,
-      "FILLER_STORAGE_SIZE is wrong value");
-  static_assert(CONTEXT_BUFFER_SIZE + 2 <= FILLER_STORAGE_SIZE,
-      "FILLER_STORAGE_SIZE < CONTEXT_BUFFER_SIZE + 2");
-
-  constexpr ssize_t END_OF_PRODUCTION = -1;
-  if (!g_context_p) {
-    g_context_p = new PCMContext(END_OF_PRODUCTION);
-  }
-  if (!g_storage_p) {
-    g_storage_p = new DataRecord[FILLER_STORAGE_SIZE];
-  }
-}
-
-template<class T>
-void SingleDishMSFiller<T>::destroy_context() {
-  if (g_context_p) {
-    delete g_context_p;
-    g_context_p = nullptr;
-  }
-  if (g_storage_p) {
-    delete[] g_storage_p;
-    g_storage_p = nullptr;
-  }
-}
-
-template<class T>
-void *SingleDishMSFiller<T>::consume(void *arg) {
-  POST_START;
-
-  try {
-    auto filler = reinterpret_cast<SingleDishMSFiller<T> *>(arg);
-    auto reader = filler->reader_.get();
-
-//      std::ostringstream oss;
-
-    size_t nrow = reader->getNumberOfRows();
-    assert(nrow < SIZE_MAX);
-    DataAccumulator accumulator;
-
-//      oss << "consume: nrow = " << nrow;
-//      PCMContext::locked_print(oss.str(), g_context_p);
-
-    ssize_t storage_index;
-    for (size_t irow = 0; irow < nrow + 1; ++irow) {
-//        oss.str("");
-//        oss << "consume: start row " << irow;
-//        PCMContext::locked_print(oss.str(), g_context_p);
-      bool more_products = PCMContext::consume(g_context_p, &storage_index);
-      assert(storage_index < FILLER_STORAGE_SIZE);
-
-//        oss.str("");
-//        oss << "consume index " << storage_index << " more_products = "
-//            << more_products;
-//        PCMContext::locked_print(oss.str(), g_context_p);
-
-      if (more_products) {
-        DataRecord *record = &g_storage_p[storage_index];
-
-//          oss.str("");
-//          oss << "Accumulate record: time = " << record->time << " interval = "
-//              << record->interval;
-//          PCMContext::locked_print(oss.str(), g_context_p);
-
-        casacore::Bool is_ready = accumulator.queryForGet(record->time);
-        if (is_ready) {
-          filler->flush(accumulator);
-        }
-        casacore::Bool astatus = accumulator.accumulate(*record);
-        (void) astatus;
-
-//          oss.str("");
-//          oss << "astatus = " << astatus;
-//          PCMContext::locked_print(oss.str(), g_context_p);
-      } else {
-        break;
-      }
-    }
-
-//      PCMContext::locked_print("Final flush", g_context_p);
-    filler->flush(accumulator);
-  } catch (std::runtime_error &e) {
-    std::ostringstream oss;
-    oss << "Exception: " << e.what();
-    PCMContext::locked_print(oss.str(), g_context_p);
-  } catch (...) {
-    PCMContext::locked_print("Unknown exception", g_context_p);
-  }
-
-  POST_END;
-  pthread_exit(0);
-}
-
-template<class T>
-void *SingleDishMSFiller<T>::produce(void *arg) {
-  POST_START;
-
-  try {
-    auto filler = reinterpret_cast<SingleDishMSFiller<T> *>(arg);
-    auto reader = filler->reader_.get();
-
-//      std::ostringstream oss;
-
-    size_t nrow = reader->getNumberOfRows();
-
-//      oss << "produce: nrow = " << nrow;
-//      PCMContext::locked_print(oss.str(), g_context_p);
-
-    ssize_t storage_index = 0;
-
-    for (size_t irow = 0; irow < nrow; ++irow) {
-
-      DataRecord *record = &g_storage_p[storage_index];
-      casacore::Bool status = reader->getData(irow, *record);
-
-//        oss.str("");
-//        oss << "irow " << irow << " status " << status << std::endl;
-//        oss << "   TIME=" << record->time << " INTERVAL=" << record->interval
-//            << std::endl;
-//        oss << "status = " << status;
-//        PCMContext::locked_print(oss.str(), g_context_p);
-
-      if (status) {
-//          oss.str("");
-//          oss << "produce index " << storage_index;
-//          PCMContext::locked_print(oss.str(), g_context_p);
-
-        PCMContext::produce(g_context_p, storage_index);
-      } else {
-        break;
-      }
-
-      storage_index++;
-      storage_index %= FILLER_STORAGE_SIZE;
-    }
-
-//      PCMContext::locked_print("Done production", g_context_p);
-
-    PCMContext::complete_production(g_context_p);
-
-  } catch (std::runtime_error &e) {
-    std::ostringstream oss;
-    oss << "Exception: " << e.what();
-    PCMContext::locked_print(oss.str(), g_context_p);
-
-    PCMContext::complete_production(g_context_p);
-  } catch (...) {
-    PCMContext::locked_print("Unknown exception", g_context_p);
-
-    PCMContext::complete_production(g_context_p);
-  }
-
-  POST_END;
-  pthread_exit(0);
-}
-
-template<class T>
-void SingleDishMSFiller<T>::fillMainMT(SingleDishMSFiller<T> *filler) {
-  POST_START;
-
-  pthread_t consumer_id;
-  pthread_t producer_id;
-
-  // create context
-  SingleDishMSFiller<T>::create_context();
-
-  try {
-    sdfiller::create_thread(&consumer_id, NULL, SingleDishMSFiller<T>::consume,
-        filler);
-    sdfiller::create_thread(&producer_id, NULL, SingleDishMSFiller<T>::produce,
-        filler);
-
-    sdfiller::join_thread(&consumer_id, NULL);
-    sdfiller::join_thread(&producer_id, NULL);
-  } catch (...) {
-    SingleDishMSFiller<T>::destroy_context();
-    throw;
-  }
-
-  SingleDishMSFiller<T>::destroy_context();
-
-  POST_END;
-}
+// number of records that parallel execution passes between threads at once
+static constexpr size_t FILLER_BATCH_SIZE = 256;
 
 template<class T>
 SingleDishMSFiller<T>::SingleDishMSFiller(std::string const &name,
@@ -347,7 +165,8 @@ SingleDishMSFiller<T>::SingleDishMSFiller(std::string const &name,
     is_float_(false), data_key_(), reference_feed_(-1), pointing_time_(),
     pointing_time_max_(), pointing_time_min_(), num_pointing_time_(),
     syscal_list_(), subscan_list_(), polarization_type_pool_(), weather_list_(),
-    parallel_(parallel) {
+    parallel_(parallel), num_workers_(0), read_timer_(), merge_timer_(),
+    subtable_timer_(), main_timer_() {
 }
 
 template<class T>
@@ -368,7 +187,7 @@ void SingleDishMSFiller<T>::fill() {
   casacore::LogIO os(casacore::LogOrigin("SingleDishMSFiller", "fill", WHERE));
   if (parallel_) {
     os << "Parallel execution of fillMain" << casacore::LogIO::POST;
-    SingleDishMSFiller<T>::fillMainMT(this);
+    fillMainMT();
   } else {
     os << "Serial execution of fillMain" << casacore::LogIO::POST;
     fillMain();
@@ -688,12 +507,21 @@ template<class T>
 void SingleDishMSFiller<T>::fillMain() {
   POST_START;
 
+  StageTimer total_timer;
+  total_timer.start();
+  read_timer_.reset();
+  merge_timer_.reset();
+  subtable_timer_.reset();
+  main_timer_.reset();
+
   size_t nrow = reader_->getNumberOfRows();
   DataAccumulator accumulator;
   DataRecord record;
 //    std::cout << "nrow = " << nrow << std::endl;
   for (size_t irow = 0; irow < nrow; ++irow) {
+    read_timer_.start();
     casacore::Bool status = reader_->getData(irow, record);
+    read_timer_.stop();
 //      std::cout << "irow " << irow << " status " << status << std::endl;
 //      std::cout << "   TIME=" << record.time << " INTERVAL=" << record.interval
 //          << std::endl;
@@ -703,7 +531,9 @@ void SingleDishMSFiller<T>::fillMain() {
       if (is_ready) {
         flush(accumulator);
       }
+      merge_timer_.start();
       casacore::Bool astatus = accumulator.accumulate(record);
+      merge_timer_.stop();
       (void) astatus;
 //        std::cout << "astatus = " << astatus << std::endl;
     }
@@ -711,9 +541,301 @@ void SingleDishMSFiller<T>::fillMain() {
 
   flush(accumulator);
 
+  total_timer.stop();
+  postTiming(0, total_timer.getElapsed());
+
   POST_END;
 }
 
+template<class T>
+void SingleDishMSFiller<T>::fillMainMT() {
+  POST_START;
+
+  StageTimer total_timer;
+  total_timer.start();
+  read_timer_.reset();
+  merge_timer_.reset();
+  subtable_timer_.reset();
+  main_timer_.reset();
+
+  size_t num_workers = num_workers_;
+  if (num_workers == 0) {
+    // leave one core each to the reader and the writer
+    size_t const num_cores = std::thread::hardware_concurrency();
+    num_workers = (num_cores > 3) ? num_cores - 2 : 1;
+  }
+
+  // Batches go round from the reader through a worker to the writer and
+  // back to the reader, so that their number bounds the memory in use.
+  std::vector<std::unique_ptr<MainBatch>> batch_storage;
+  std::deque<MainBatch *> free_batches;
+  for (size_t i = 0; i < 2 * num_workers + 2; ++i) {
+    batch_storage.emplace_back(new MainBatch());
+    free_batches.push_back(batch_storage.back().get());
+  }
+  std::deque<MainBatch *> read_batches;
+  std::map<size_t, MainBatch *> merged_batches;
+  size_t num_batches = 0;
+  bool end_of_read = false;
+  bool abort = false;
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable cond;
+
+  // must be called in a catch block
+  auto fail = [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) {
+      error = std::current_exception();
+    }
+    abort = true;
+    cond.notify_all();
+  };
+
+  // Readers access a single file or table so that getData runs on one
+  // thread only. Records are grouped by timestamp exactly as queryForGet
+  // groups them in fillMain, and each key gets a global index in order
+  // of its first appearance, which is the order of chunks in fillMain.
+  auto read = [&]() {
+    try {
+      typedef std::tuple<casacore::Int, casacore::Int, casacore::Int,
+          casacore::Int, casacore::String, casacore::String> Key;
+      std::map<Key, size_t> key_index;
+      // the last group each key appeared in
+      std::vector<size_t> key_group;
+      size_t igroup = 0;
+      casacore::Double group_time = -1.0;
+      MainBatch *batch = nullptr;
+      auto submit = [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        read_batches.push_back(batch);
+        batch = nullptr;
+        cond.notify_all();
+      };
+
+      size_t const nrow = reader_->getNumberOfRows();
+      DataRecord record;
+      for (size_t irow = 0; irow < nrow; ++irow) {
+        read_timer_.start();
+        casacore::Bool status = reader_->getData(irow, record);
+        read_timer_.stop();
+        if (!status) {
+          continue;
+        }
+        if (0.0 <= group_time && group_time != record.time) {
+          batch->closeGroup();
+          ++igroup;
+          group_time = -1.0;
+          if (batch->num_records >= FILLER_BATCH_SIZE) {
+            submit();
+          }
+        }
+        if (!DataAccumulator::isValidRecord(record)) {
+          continue;
+        }
+        if (!batch) {
+          std::unique_lock<std::mutex> lock(mutex);
+          cond.wait(lock, [&]() {return abort || !free_batches.empty();});
+          if (abort) {
+            return;
+          }
+          batch = free_batches.front();
+          free_batches.pop_front();
+          batch->reset(num_batches++);
+        }
+        group_time = record.time;
+        Key const key(record.antenna_id, record.field_id, record.feed_id,
+            record.spw_id, record.pol_type, record.intent);
+        auto iter = key_index.find(key);
+        if (iter == key_index.end()) {
+          size_t const index = key_index.size();
+          key_index[key] = index;
+          key_group.push_back(igroup);
+          batch->chunk_keys.push_back(index);
+        } else if (key_group[iter->second] != igroup) {
+          key_group[iter->second] = igroup;
+          batch->chunk_keys.push_back(iter->second);
+        }
+        batch->addRecord(record);
+      }
+      if (batch) {
+        batch->closeGroup();
+        submit();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      end_of_read = true;
+      cond.notify_all();
+    } catch (...) {
+      fail();
+    }
+  };
+
+  auto merge = [&]() {
+    try {
+      StageTimer timer;
+      for (;;) {
+        MainBatch *batch = nullptr;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cond.wait(lock,
+              [&]() {return abort || end_of_read || !read_batches.empty();});
+          if (abort || read_batches.empty()) {
+            break;
+          }
+          batch = read_batches.front();
+          read_batches.pop_front();
+        }
+        timer.start();
+        mergeBatch(*batch);
+        timer.stop();
+        std::lock_guard<std::mutex> lock(mutex);
+        merged_batches[batch->id] = batch;
+        cond.notify_all();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      merge_timer_.add(timer.getElapsed());
+    } catch (...) {
+      fail();
+    }
+  };
+
+  casacore::LogIO os(casacore::LogOrigin("SingleDishMSFiller", "fillMainMT", WHERE));
+  os << "Merging records with " << num_workers << " worker threads"
+      << casacore::LogIO::POST;
+  std::vector<std::thread> threads;
+  try {
+    threads.emplace_back(read);
+    for (size_t i = 0; i < num_workers; ++i) {
+      threads.emplace_back(merge);
+    }
+  } catch (...) {
+    fail();
+  }
+
+  // write batches in order on this thread
+  for (size_t id = 0;; ++id) {
+    MainBatch *batch = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&]() {
+        return abort || merged_batches.count(id) > 0
+            || (end_of_read && id == num_batches);
+      });
+      auto iter = merged_batches.find(id);
+      if (abort || iter == merged_batches.end()) {
+        break;
+      }
+      batch = iter->second;
+      merged_batches.erase(iter);
+    }
+    try {
+      writeBatch(*batch);
+    } catch (...) {
+      fail();
+      break;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    free_batches.push_back(batch);
+    cond.notify_all();
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  total_timer.stop();
+  postTiming(num_workers, total_timer.getElapsed());
+
+  POST_END;
+}
+
+template<class T>
+void SingleDishMSFiller<T>::mergeBatch(MainBatch &batch) {
+  POST_START;
+
+  size_t irecord = 0;
+  size_t ichunk_start = 0;
+  for (size_t igroup = 0; igroup < batch.record_end.size(); ++igroup) {
+    // a new accumulator orders chunks by first appearance in the group
+    DataAccumulator accumulator;
+    for (; irecord < batch.record_end[igroup]; ++irecord) {
+      casacore::Bool astatus = accumulator.accumulate(*batch.records[irecord]);
+      (void) astatus;
+    }
+    size_t const nchunk = accumulator.getNumberOfChunks();
+    assert(ichunk_start + nchunk == batch.chunk_end[igroup]);
+    for (size_t ichunk = 0; ichunk < nchunk; ++ichunk) {
+      if (accumulator.get(ichunk, batch.nextRow())) {
+        batch.commitRow(batch.chunk_keys[ichunk_start + ichunk]);
+      }
+    }
+    ichunk_start = batch.chunk_end[igroup];
+    batch.row_end.push_back(batch.num_rows);
+  }
+
+  POST_END;
+}
+
+template<class T>
+void SingleDishMSFiller<T>::writeBatch(MainBatch const &batch) {
+  POST_START;
+
+  std::vector<MSDataRecord const *> records;
+  std::vector<casacore::Int> data_desc_ids;
+  std::vector<casacore::Int> state_ids;
+  records.reserve(batch.num_rows);
+  data_desc_ids.reserve(batch.num_rows);
+  state_ids.reserve(batch.num_rows);
+
+  subtable_timer_.start();
+  std::vector<size_t> order;
+  size_t irow = 0;
+  for (size_t igroup = 0; igroup < batch.row_end.size(); ++igroup) {
+    // same order of rows as fillMain
+    order.clear();
+    for (; irow < batch.row_end[igroup]; ++irow) {
+      order.push_back(irow);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return batch.row_keys[a] < batch.row_keys[b];
+    });
+    for (auto i : order) {
+      MSDataRecord const &record = *batch.rows[i];
+      casacore::Int data_desc_id = -1;
+      casacore::Int state_id = -1;
+      updateSubtables(record, data_desc_id, state_id);
+      records.push_back(&record);
+      data_desc_ids.push_back(data_desc_id);
+      state_ids.push_back(state_id);
+    }
+  }
+  subtable_timer_.stop();
+
+  main_timer_.start();
+  updateMain(records, data_desc_ids, state_ids);
+  main_timer_.stop();
+
+  POST_END;
+}
+
+template<class T>
+void SingleDishMSFiller<T>::postTiming(size_t num_workers,
+    casacore::Double elapsed) {
+  casacore::LogIO os(casacore::LogOrigin("SingleDishMSFiller", "fillMain", WHERE));
+  os << "Time spent in main loop (sec): read " << read_timer_.getElapsed()
+      << ", merge " << merge_timer_.getElapsed();
+  if (num_workers > 0) {
+    os << " (sum over " << num_workers << " workers)";
+  }
+  os << ", subtables " << subtable_timer_.getElapsed() << ", main table "
+      << main_timer_.getElapsed() << ", total " << elapsed
+      << casacore::LogIO::POST;
+}
+
 template<class T>
 void SingleDishMSFiller<T>::fillAntenna() {
   POST_START;
@@ -1177,6 +1299,83 @@ void SingleDishMSFiller<T>::updateMain(casacore::Int const &antenna_id, casacore
   ms_columns_->interval().put(irow, interval);
   ms_columns_->exposure().put(irow, interval);
 
+  updateMainArrays(irow, dataRecord);
+  ms_columns_->flagRow().put(irow, dataRecord.flag_row);
+
+  POST_END;
+}
+
+template<class T>
+void SingleDishMSFiller<T>::updateMain(
+    std::vector<MSDataRecord const *> const &records,
+    std::vector<casacore::Int> const &data_desc_ids,
+    std::vector<casacore::Int> const &state_ids) {
+  POST_START;
+
+  size_t const nrow = records.size();
+  if (nrow == 0) {
+    return;
+  }
+
+  // constant stuff
+  static casacore::Array<casacore::Bool> const flagCategory(casacore::IPosition(3, 0, 0, 0));
+
+  // target rows
+  casacore::uInt const first_row = ms_->nrow();
+  casacore::RefRows const rows(first_row, first_row + nrow - 1);
+
+  // add new rows
+  ms_->addRow(nrow, false);
+
+  // scalar columns at once
+  casacore::Vector<casacore::Int> antenna_id(nrow);
+  casacore::Vector<casacore::Int> field_id(nrow);
+  casacore::Vector<casacore::Int> feed_id(nrow);
+  casacore::Vector<casacore::Int> scan_number(nrow);
+  casacore::Vector<casacore::Double> time(nrow);
+  casacore::Vector<casacore::Double> interval(nrow);
+  casacore::Vector<casacore::Bool> flag_row(nrow);
+  for (size_t i = 0; i < nrow; ++i) {
+    MSDataRecord const &dataRecord = *records[i];
+    antenna_id[i] = dataRecord.antenna_id;
+    field_id[i] = dataRecord.field_id;
+    feed_id[i] = dataRecord.feed_id;
+    scan_number[i] = dataRecord.scan;
+    time[i] = dataRecord.time;
+    interval[i] = dataRecord.interval;
+    flag_row[i] = dataRecord.flag_row;
+  }
+  ms_columns_->uvw().putColumnCells(rows,
+      casacore::Matrix<casacore::Double>(3, nrow, 0.0));
+  ms_columns_->antenna1().putColumnCells(rows, antenna_id);
+  ms_columns_->antenna2().putColumnCells(rows, antenna_id);
+  ms_columns_->fieldId().putColumnCells(rows, field_id);
+  ms_columns_->feed1().putColumnCells(rows, feed_id);
+  ms_columns_->feed2().putColumnCells(rows, feed_id);
+  ms_columns_->dataDescId().putColumnCells(rows,
+      casacore::Vector<casacore::Int>(data_desc_ids));
+  ms_columns_->stateId().putColumnCells(rows,
+      casacore::Vector<casacore::Int>(state_ids));
+  ms_columns_->scanNumber().putColumnCells(rows, scan_number);
+  ms_columns_->time().putColumnCells(rows, time);
+  ms_columns_->timeCentroid().putColumnCells(rows, time);
+  ms_columns_->interval().putColumnCells(rows, interval);
+  ms_columns_->exposure().putColumnCells(rows, interval);
+  ms_columns_->flagRow().putColumnCells(rows, flag_row);
+
+  // array columns whose shape may vary row by row
+  for (size_t i = 0; i < nrow; ++i) {
+    casacore::uInt const irow = first_row + i;
+    ms_columns_->flagCategory().put(irow, flagCategory);
+    updateMainArrays(irow, *records[i]);
+  }
+
+  POST_END;
+}
+
+template<class T>
+void SingleDishMSFiller<T>::updateMainArrays(casacore::uInt irow,
+    MSDataRecord const &dataRecord) {
   if (is_float_) {
     casacore::Matrix<casacore::Float> floatData;
     if (dataRecord.isFloat()) {
@@ -1198,11 +1397,8 @@ void SingleDishMSFiller<T>::updateMain(casacore::Int const &antenna_id, casacore
   }
 
   ms_columns_->flag().put(irow, dataRecord.flag);
-  ms_columns_->flagRow().put(irow, dataRecord.flag_row);
   ms_columns_->sigma().put(irow, dataRecord.sigma);
   ms_columns_->weight().put(irow, dataRecord.weight);
-
-  POST_END;
 }
 
 template<class T>
@@ -1217,36 +1413,21 @@ void SingleDishMSFiller<T>::flush(DataAccumulator &accumulator) {
   }
 
   for (size_t ichunk = 0; ichunk < nchunk; ++ichunk) {
+    merge_timer_.start();
     casacore::Bool status = accumulator.get(ichunk, record_);
+    merge_timer_.stop();
 //      std::cout << "accumulator status = " << std::endl;
     if (status) {
-      casacore::Double time = record_.time;
-      casacore::Int antenna_id = record_.antenna_id;
-      casacore::Int spw_id = record_.spw_id;
-      casacore::Int feed_id = record_.feed_id;
-      casacore::Int field_id = record_.field_id;
-      casacore::Int scan = record_.scan;
-      casacore::Int subscan = record_.subscan;
-      casacore::String pol_type = record_.pol_type;
-      casacore::String obs_mode = record_.intent;
-      casacore::Int num_pol = record_.num_pol;
-      casacore::Vector<casacore::Int> &corr_type = record_.corr_type;
-      casacore::Int polarization_id = updatePolarization(corr_type, num_pol);
-      updateFeed(feed_id, spw_id, pol_type);
-      casacore::Int data_desc_id = updateDataDescription(polarization_id, spw_id);
-      casacore::Int state_id = updateState(subscan, obs_mode);
-      casacore::Matrix<casacore::Double> &direction = record_.direction;
-      casacore::Double interval = record_.interval;
-
-      // updatePointing must be called after updateFeed
-      updatePointing(antenna_id, feed_id, time, interval, direction);
-
-      updateSysCal(antenna_id, feed_id, spw_id, time, interval, record_);
-
-      updateWeather(antenna_id, time, interval, record_);
-
-      updateMain(antenna_id, field_id, feed_id, data_desc_id, state_id, scan,
-          time, record_);
+      subtable_timer_.start();
+      casacore::Int data_desc_id = -1;
+      casacore::Int state_id = -1;
+      updateSubtables(record_, data_desc_id, state_id);
+      subtable_timer_.stop();
+
+      main_timer_.start();
+      updateMain(record_.antenna_id, record_.field_id, record_.feed_id,
+          data_desc_id, state_id, record_.scan, record_.time, record_);
+      main_timer_.stop();
     }
   }
 //    std::cout << "clear accumulator" << std::endl;
@@ -1255,6 +1436,37 @@ void SingleDishMSFiller<T>::flush(DataAccumulator &accumulator) {
   POST_END;
 }
 
+template<class T>
+void SingleDishMSFiller<T>::updateSubtables(MSDataRecord const &record,
+    casacore::Int &data_desc_id, casacore::Int &state_id) {
+  POST_START;
+
+  casacore::Double time = record.time;
+  casacore::Int antenna_id = record.antenna_id;
+  casacore::Int spw_id = record.spw_id;
+  casacore::Int feed_id = record.feed_id;
+  casacore::Int subscan = record.subscan;
+  casacore::String pol_type = record.pol_type;
+  casacore::String obs_mode = record.intent;
+  casacore::Int num_pol = record.num_pol;
+  casacore::Vector<casacore::Int> const &corr_type = record.corr_type;
+  casacore::Int polarization_id = updatePolarization(corr_type, num_pol);
+  updateFeed(feed_id, spw_id, pol_type);
+  data_desc_id = updateDataDescription(polarization_id, spw_id);
+  state_id = updateState(subscan, obs_mode);
+  casacore::Matrix<casacore::Double> const &direction = record.direction;
+  casacore::Double interval = record.interval;
+
+  // updatePointing must be called after updateFeed
+  updatePointing(antenna_id, feed_id, time, interval, direction);
+
+  updateSysCal(antenna_id, feed_id, spw_id, time, interval, record);
+
+  updateWeather(antenna_id, time, interval, record);
+
+  POST_END;
+}
+
 template<class T>
 void SingleDishMSFiller<T>::sortPointing() {
   POST_START;
@@ -860,6 +860,21 @@ TEST_F(SingleDishMSFillerTestFloat, ParallelFillerTest) {
   Verify();
 }
 
+TEST_F(SingleDishMSFillerTestFloat, ParallelFillerMultiWorkerTest) {
+  // Create filler
+  std::cout << "create parallel filler with 4 workers" << std::endl;
+  SingleDishMSFiller<Scantable2MSReader> filler(my_data_name_, true);
+  filler.setNumberOfWorkers(4);
+  ASSERT_EQ(4u, filler.getNumberOfWorkers());
+
+  // Run filler
+  std::cout << "run filler" << std::endl;
+  ExecuteFiller(filler);
+
+  // verify table contents
+  Verify();
+}
+
 TEST_F(SingleDishMSFillerTestComplex, FillerTest) {
   // Create filler
   SingleDishMSFiller<Scantable2MSReader> filler(my_data_name_);
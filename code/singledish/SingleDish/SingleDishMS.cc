@@ -3325,11 +3325,13 @@ void SingleDishMS::smooth(string const &kernelType, float const kernelWidth,
   finalize_process();
 }
 
-bool SingleDishMS::importAsap(string const &infile, string const &outfile, bool const parallel)
+bool SingleDishMS::importAsap(string const &infile, string const &outfile, bool const parallel,
+                              int const nworkers)
 {
   bool status = true;
   try {
     SingleDishMSFiller<Scantable2MSReader> filler(infile, parallel);
+    filler.setNumberOfWorkers(nworkers > 0 ? nworkers : 0);
     filler.fill();
     filler.save(outfile);
   } catch (AipsError &e) {
@@ -3346,11 +3348,13 @@ bool SingleDishMS::importAsap(string const &infile, string const &outfile, bool
   return status;
 }
 
-bool SingleDishMS::importNRO(string const &infile, string const &outfile, bool const parallel)
+bool SingleDishMS::importNRO(string const &infile, string const &outfile, bool const parallel,
+                             int const nworkers)
 {
   bool status = true;
   try {
     SingleDishMSFiller<NRO2MSReader> filler(infile, parallel);
+    filler.setNumberOfWorkers(nworkers > 0 ? nworkers : 0);
     filler.fill();
     filler.save(outfile);
   } catch (AipsError &e) {
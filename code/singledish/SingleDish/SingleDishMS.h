@@ -432,8 +432,12 @@ private:
   constexpr static casacore::Int kNRowBlocking = 1000;
 
 public:
-  static bool importAsap(string const &infile, string const &outfile, bool const parallel=false);
-  static bool importNRO(string const &infile, string const &outfile, bool const parallel=false);
+  // nworkers is the number of threads merging records in parallel
+  // execution, 0 to choose it from the available cores
+  static bool importAsap(string const &infile, string const &outfile, bool const parallel=false,
+                         int const nworkers=0);
+  static bool importNRO(string const &infile, string const &outfile, bool const parallel=false,
+                        int const nworkers=0);
 };
 // class SingleDishMS -END
 
@@ -27,6 +27,7 @@
 //#
 
 #include <spectrallines/Splatalogue/ListConverter.h>
+#include <spectrallines/Splatalogue/SplatalogueIndex.h>
 
 #include <casa/Quanta/Quantum.h>
 #include <casa/Quanta/Unit.h>
@@ -74,6 +75,8 @@ SplatalogueTable* ListConverter::load() {
 	SplatalogueTable *newTable = _defineTable(_species.size());
 	_addData(newTable);
 	newTable->flush();
+	// a previous table of the same name may have been indexed
+	SplatalogueIndex::clearCache();
 	return newTable;
 }
 
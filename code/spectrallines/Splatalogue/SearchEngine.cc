@@ -33,8 +33,6 @@
 
 #include <casa/OS/File.h>
 #include <imageanalysis/ImageAnalysis/ImageInputProcessor.h>
-#include <tables/Tables/ScalarColumn.h>
-#include <tables/TaQL/TableParse.h>
 #include <fcntl.h>
 #include <memory>
 
@@ -46,9 +44,11 @@ namespace casa {
 
 SearchEngine::SearchEngine(
 	const SplatalogueTable* const table, const Bool list,
-	const String& logfile, const Bool append
+	const String& logfile, const Bool append,
+	const std::shared_ptr<const SplatalogueIndex>& index
 ) : _log(new LogIO), _table(table), _logfile(logfile),
-	_list(list), _append(append){
+	_list(list), _append(append),
+	_index(index ? index : SplatalogueIndex::get(*table)) {
 	if (!logfile.empty()) {
         OutputDestinationChecker::OutputStruct logfile;
         logfile.label = "logfile";
@@ -84,95 +84,26 @@ SplatalogueTable* SearchEngine::search(
 			*_log << "Cannot create table " << resultsTableName << LogIO::EXCEPTION;
 		}
 	}
-	ostringstream query;
-	query << "SELECT FROM "  << _table->tableName();
-	query << " WHERE ";
-
-	query << "(" << _getBetweenClause(SplatalogueTable::FREQUENCY, freqLow, freqHigh) << ")";
-	if (species.size() > 0) {
-		query << " AND (" << SplatalogueTable::SPECIES << " IN (";
-		for (uInt i=0; i<species.size(); i++) {
-			query << "'" << species[i] << "'";
-			if (i != species.size() - 1) {
-				query << ", ";
-			}
-		}
-		query << "))";
-	}
-
-	if (recommendedOnly) {
-		query << " AND (" << SplatalogueTable::RECOMMENDED << ")";
-	}
-
-	if (chemNames.size() > 0) {
-		query << " AND (" << SplatalogueTable::CHEMICAL_NAME << " IN (";
-		for (uInt i=0; i<chemNames.size(); i++) {
-			query << "'" << chemNames[i] << "'";
-			if (i != chemNames.size() - 1) {
-				query << ", ";
-			}
-		}
-		query << "))";
-	}
-	if (qns.size() > 0) {
-		query << " AND (" << SplatalogueTable::QUANTUM_NUMBERS << " IN (";
-		for (uInt i=0; i<qns.size(); i++) {
-			query << "'" << qns[i] << "'";
-			if (i != qns.size() - 1) {
-				query << ", ";
-			}
-		}
-		query << "))";
-	}
-	String rrlPortion = (includeRRLs || onlyRRLs)
-		? "LINELIST = 'Recomb'"
-		: "";
-	ostringstream nonRRLPortion;
-	if (! onlyRRLs) {
-		nonRRLPortion << "(LINELIST != 'Recomb')";
-		if (intensityLow < intensityHigh) {
-			nonRRLPortion << " AND " << _getBetweenClause(
-				SplatalogueTable::INTENSITY, intensityLow, intensityHigh
-			);
-		}
-		if (smu2Low < smu2High) {
-			nonRRLPortion << " AND " << _getBetweenClause(
-				SplatalogueTable::SMU2, smu2Low, smu2High
-			);
-		}
-		if (logaLow < logaHigh) {
-			nonRRLPortion << " AND " << _getBetweenClause(
-				SplatalogueTable::LOGA, logaLow, logaHigh
-			);
-		}
-		if (elLow < elHigh) {
-			nonRRLPortion << " AND " << _getBetweenClause(
-				SplatalogueTable::EL, elLow, elHigh
-			);
-		}
-		if (euLow < euHigh) {
-			nonRRLPortion << " AND " << _getBetweenClause(
-				SplatalogueTable::EU, euLow, euHigh
-			);
-		}
-	}
-	if (onlyRRLs) {
-		query << " AND " << rrlPortion;
-	}
-	else if (includeRRLs) {
-		query << " AND ((" << rrlPortion << ") OR (" << nonRRLPortion.str() << "))";
-	}
-	else {
-		query << " AND " << nonRRLPortion.str();
-	}
-	query << " ORDER BY " << SplatalogueTable::FREQUENCY;
-
-	Table resTable = _runQuery(query.str());
-	std::auto_ptr<SplatalogueTable> resSplatTable(new SplatalogueTable(resTable));
-	if (!resultsTableName.empty()) {
+	Vector<uInt> rows = _index->search(
+		freqLow, freqHigh, species, recommendedOnly, chemNames, qns,
+		intensityLow, intensityHigh, smu2Low, smu2High, logaLow, logaHigh,
+		elLow, elHigh, euLow, euHigh, includeRRLs, onlyRRLs
+	);
+	Table resTable = (*_table)(rows);
+	std::auto_ptr<SplatalogueTable> resSplatTable;
+	if (resultsTableName.empty()) {
+		resSplatTable.reset(new SplatalogueTable(resTable));
+	}
+	else if (File(_table->tableName()).exists()) {
+		resSplatTable.reset(new SplatalogueTable(resTable));
 		resSplatTable->rename(resultsTableName, Table::NewNoReplace);
 		resSplatTable->flush(true, true);
 	}
+	else {
+		// a reference table cannot refer to a table which is not on disk
+		resTable.deepCopy(resultsTableName, Table::NewNoReplace);
+		resSplatTable.reset(new SplatalogueTable(resultsTableName));
+	}
 	if (_list) {
 		_logIt(resSplatTable->list());
 	}
@@ -180,78 +111,25 @@ SplatalogueTable* SearchEngine::search(
 }
 
 Vector<String> SearchEngine::uniqueSpecies() const {
-	String query = "SELECT UNIQUE(" + SplatalogueTable::SPECIES
-		+ ") FROM " + _table->tableName() + " ORDER BY " + SplatalogueTable::SPECIES;
-	// Table resTable = tableCommand(query).table();
-	Table resTable = _runQuery(query);
-
+	Vector<String> vSpecies = _index->uniqueSpecies();
 	String logString;
-	ROScalarColumn<String> species(resTable, SplatalogueTable::SPECIES);
-	Vector<String> vSpecies(species.nrow());
-	for (uInt i=0; i<species.nrow(); i++) {
-		vSpecies[i] = species(i);
-		logString += species(i) + "\n";
+	for (uInt i=0; i<vSpecies.size(); i++) {
+		logString += vSpecies[i] + "\n";
 	}
 	_logIt(logString);
 	return vSpecies;
 }
 
 Vector<String> SearchEngine::uniqueChemicalNames() const {
-	String query = "SELECT UNIQUE(" + SplatalogueTable::CHEMICAL_NAME
-		+ ") FROM " + _table->tableName() + " ORDER BY " + SplatalogueTable::CHEMICAL_NAME;
-	// Table resTable = tableCommand(query).table();
-	Table resTable = _runQuery(query);
-
-	ROScalarColumn<String> chemNames(resTable, SplatalogueTable::CHEMICAL_NAME);
-	Vector<String> vChemNames(chemNames.nrow());
+	Vector<String> vChemNames = _index->uniqueChemicalNames();
 	String logString;
-	for (uInt i=0; i<chemNames.nrow(); i++) {
-		vChemNames[i] = chemNames(i);
-		logString += chemNames(i) + "\n";
+	for (uInt i=0; i<vChemNames.size(); i++) {
+		logString += vChemNames[i] + "\n";
 	}
 	_logIt(logString);
 	return vChemNames;
 }
 
-String SearchEngine::_getBetweenClause(
-	const String& col, const Double low, const Double high
-) const {
-	ostringstream os;
-	os << col << " BETWEEN " << low << " AND " << high;
-	return os.str();
-}
-
-Table SearchEngine::_runQuery(const String& query) const {
-	String tablename = _table->tableName();
-	File file(tablename);
-	Bool dump = false;
-	String queryCopy = query;
-	if (! file.exists()) {
-		*_log << LogIO::NORMAL << "Flushing a copy of " << tablename << " to disk so it can be queried" << LogIO::POST;
-		Path newName = File::newUniqueName(".");
-		uInt pos = query.find(tablename);
-		uInt length = tablename.length();
-		tablename = newName.absoluteName();
-		_table->deepCopy(tablename, Table::Scratch, true, Table::AipsrcEndian, false);
-		dump = true;
-		cout << "query " << query << endl;
-		cout << "new table " << tablename << endl;
-		String begin = query.substr(0, pos);
-		String end = query.substr(pos+length, query.length());
-		queryCopy = begin + tablename + end;
-		cout << "new query " << queryCopy << endl;
-
-	}
-	Table resTable = tableCommand(queryCopy).table();
-	if (dump) {
-		Table t(tablename);
-		t.markForDelete();
-		//*_log << LogIO::NORMAL << "Removing temporary disk copy " << tablename << LogIO::POST;
-		//Table::deleteTable(tablename, true);
-	}
-	return resTable;
-}
-
 void SearchEngine::_logIt(const String& logString) const {
 	LogOrigin origin("SearchEngine", __FUNCTION__);
 	*_log << origin << logString << LogIO::POST;
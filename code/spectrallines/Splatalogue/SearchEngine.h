@@ -33,8 +33,11 @@
 #include <casa/Arrays/Vector.h>
 #include <casa/BasicSL/String.h>
 #include <casa/Logging/LogIO.h>
+#include <spectrallines/Splatalogue/SplatalogueIndex.h>
 #include <spectrallines/Splatalogue/SplatalogueTable.h>
 
+#include <memory>
+
 namespace casa {
 
 // <summary>Performs a query on a splatalogue spectral line table</summary>
@@ -51,6 +54,11 @@ namespace casa {
 // <synopsis>
 // It is a requirement that users be able to perform searches on spectral
 // line tables they import from Splatalogue.
+//
+// Searches are answered from the SplatalogueIndex of the table. The
+// constructor gets it from SplatalogueIndex::get(), which reuses the index
+// of an unmodified table on disk but builds a new one for any other table,
+// unless the caller passes an index it keeps for the table itself.
 // </synopsis>
 //
 // <example>
@@ -75,9 +83,12 @@ public:
 	// <src>list</src> casacore::List result set of search to logger (and optional logfile)?
 	// <src>logfile</src> Logfile to list results to. Only used if list=true. If empty, no logfile is created.
 	// <src>append</src> Append results to logfile (true) or overwrite logfile (false) if it exists? Only used if list=true and logfile not empty.
+	// <src>index</src> Index of <src>table</src> to search. If null, it is got from SplatalogueIndex::get().
 	SearchEngine(
 		const SplatalogueTable* const table, const casacore::Bool list,
-		const casacore::String& logfile, const casacore::Bool append
+		const casacore::String& logfile, const casacore::Bool append,
+		const std::shared_ptr<const SplatalogueIndex>& index
+			= std::shared_ptr<const SplatalogueIndex>()
 	);
 
 	//destuctor
@@ -107,17 +118,9 @@ private:
 	const SplatalogueTable *_table;
 	casacore::String _logfile;
 	const casacore::Bool _list, _append;
+	std::shared_ptr<const SplatalogueIndex> _index;
 	SearchEngine();
 
-	casacore::String _getBetweenClause(
-		const casacore::String& col, const casacore::Double low, const casacore::Double high
-	) const;
-
-	// If the query table is currently not on disk, this method will temporarily
-	// write a copy of it to disk and query it, and then remove the copy from disk.
-	// The method returns the query results table.
-	casacore::Table _runQuery(const casacore::String& query) const;
-
 	void _logIt(const casacore::String& logString) const;
 };
 
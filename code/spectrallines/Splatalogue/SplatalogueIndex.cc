@@ -0,0 +1,357 @@
+//# SplatalogueIndex.cc: In-memory search index of a splatalogue table
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This library is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU Library General Public License as published by
+//# the Free Software Foundation; either version 2 of the License, or (at your
+//# option) any later version.
+//#
+//# This library is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+//# License for more details.
+//#
+//# You should have received a copy of the GNU Library General Public License
+//# along with this library; if not, write to the Free Software Foundation,
+//# Inc., 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+//#
+
+#include <spectrallines/Splatalogue/SplatalogueIndex.h>
+
+#include <casa/BasicMath/Math.h>
+#include <casa/OS/Directory.h>
+#include <casa/OS/DirectoryIterator.h>
+#include <casa/OS/RegularFile.h>
+#include <tables/Tables/ScalarColumn.h>
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+
+using namespace casacore;
+namespace casa {
+
+namespace {
+
+const String RECOMB = "Recomb";
+
+// A shared index and the state of the table it was built from
+struct CacheEntry {
+	std::shared_ptr<const SplatalogueIndex> index;
+	uInt nrow;
+	Int64 mtime, size;
+};
+
+std::mutex cacheMutex;
+std::map<String, CacheEntry> cache;
+
+// Newest modification time and total size of the files of a table on disk,
+// which change whenever the table is rewritten
+void tableState(Int64& mtime, Int64& size, const String& dir) {
+	DirectoryIterator iter((Directory(dir)));
+	while (! iter.pastEnd()) {
+		String path = dir + "/" + iter.name();
+		File f(path);
+		if (f.isDirectory(false)) {
+			tableState(mtime, size, path);
+		}
+		else if (f.isRegular(false)) {
+			mtime = std::max(mtime, Int64(f.modifyTime()));
+			size += RegularFile(path).size();
+		}
+		iter++;
+	}
+}
+
+inline Bool between(const Double value, const Double low, const Double high) {
+	return value >= low && value <= high;
+}
+
+template <typename T>
+std::vector<T> permute(const Vector<T>& values, const std::vector<uInt>& order) {
+	std::vector<T> permuted(order.size());
+	for (uInt i=0; i<order.size(); i++) {
+		permuted[i] = values[order[i]];
+	}
+	return permuted;
+}
+
+}
+
+SplatalogueIndex::SplatalogueIndex(const SplatalogueTable& table)
+	: _nrow(table.nrow()), _nValidFreq(0) {
+	Vector<Double> freq = ROScalarColumn<Double>(table, SplatalogueTable::FREQUENCY).getColumn();
+	_rows.resize(_nrow);
+	std::iota(_rows.begin(), _rows.end(), 0);
+	// NaN frequencies, which no range selects, go to the end
+	std::stable_sort(
+		_rows.begin(), _rows.end(),
+		[&freq](uInt a, uInt b) {
+			return ! isNaN(freq[a]) && (isNaN(freq[b]) || freq[a] < freq[b]);
+		}
+	);
+	_freq = permute(freq, _rows);
+	while (_nValidFreq < _nrow && ! isNaN(_freq[_nValidFreq])) {
+		_nValidFreq++;
+	}
+	_intensity = permute(ROScalarColumn<Float>(table, SplatalogueTable::INTENSITY).getColumn(), _rows);
+	_smu2 = permute(ROScalarColumn<Float>(table, SplatalogueTable::SMU2).getColumn(), _rows);
+	_loga = permute(ROScalarColumn<Float>(table, SplatalogueTable::LOGA).getColumn(), _rows);
+	_el = permute(ROScalarColumn<Float>(table, SplatalogueTable::EL).getColumn(), _rows);
+	_eu = permute(ROScalarColumn<Float>(table, SplatalogueTable::EU).getColumn(), _rows);
+	Vector<Bool> recommended = ROScalarColumn<Bool>(table, SplatalogueTable::RECOMMENDED).getColumn();
+	Vector<String> linelist = ROScalarColumn<String>(table, SplatalogueTable::LINELIST).getColumn();
+	_recommended.resize(_nrow);
+	_isRRL.resize(_nrow);
+	for (uInt i=0; i<_nrow; i++) {
+		_recommended[i] = recommended[_rows[i]];
+		_isRRL[i] = linelist[_rows[i]] == RECOMB;
+	}
+	_buildDictionary(
+		_species, ROScalarColumn<String>(table, SplatalogueTable::SPECIES).getColumn(), _rows
+	);
+	_buildDictionary(
+		_chemNames, ROScalarColumn<String>(table, SplatalogueTable::CHEMICAL_NAME).getColumn(), _rows
+	);
+	_buildDictionary(
+		_qns, ROScalarColumn<String>(table, SplatalogueTable::QUANTUM_NUMBERS).getColumn(), _rows
+	);
+	_speciesPositions = _positions(_species);
+	_chemNamePositions = _positions(_chemNames);
+}
+
+SplatalogueIndex::~SplatalogueIndex() {}
+
+std::shared_ptr<const SplatalogueIndex> SplatalogueIndex::get(const SplatalogueTable& table) {
+	String name = table.tableName();
+	// Only persistent tables on disk can be recognized when opened again;
+	// the index of any other table belongs to the caller alone, so it goes
+	// away with it
+	if (
+		table.tableType() != Table::Plain || table.isMarkedForDelete()
+		|| ! File(name).isDirectory()
+	) {
+		return std::shared_ptr<const SplatalogueIndex>(new SplatalogueIndex(table));
+	}
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	// Forget the indexes of tables which no longer exist
+	for (auto iter=cache.begin(); iter!=cache.end(); ) {
+		if (File(iter->first).isDirectory()) {
+			++iter;
+		}
+		else {
+			iter = cache.erase(iter);
+		}
+	}
+	Int64 mtime = 0;
+	Int64 size = 0;
+	tableState(mtime, size, name);
+	CacheEntry& entry = cache[name];
+	if (
+		! entry.index || entry.nrow != table.nrow()
+		|| entry.mtime != mtime || entry.size != size
+	) {
+		entry.index.reset(new SplatalogueIndex(table));
+		entry.nrow = table.nrow();
+		entry.mtime = mtime;
+		entry.size = size;
+	}
+	return entry.index;
+}
+
+void SplatalogueIndex::clearCache() {
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
+
+Vector<uInt> SplatalogueIndex::search(
+	const Double freqLow, const Double freqHigh,
+	const Vector<String>& species, const Bool recommendedOnly,
+	const Vector<String>& chemNames, const Vector<String>& qns,
+	const Double intensityLow, const Double intensityHigh,
+	const Double smu2Low, const Double smu2High,
+	const Double logaLow, const Double logaHigh,
+	const Double elLow, const Double elHigh,
+	const Double euLow, const Double euHigh,
+	const Bool includeRRLs, const Bool onlyRRLs
+) const {
+	const std::vector<Double>::const_iterator validEnd = _freq.begin() + _nValidFreq;
+	const uInt begin = std::lower_bound(_freq.begin(), validEnd, freqLow) - _freq.begin();
+	const uInt end = std::max(
+		begin, uInt(std::upper_bound(_freq.begin(), validEnd, freqHigh) - _freq.begin())
+	);
+	std::vector<bool> selSpecies, selChemNames, selQNs;
+	if (
+		(species.size() > 0 && ! _select(selSpecies, _species, species))
+		|| (chemNames.size() > 0 && ! _select(selChemNames, _chemNames, chemNames))
+		|| (qns.size() > 0 && ! _select(selQNs, _qns, qns))
+	) {
+		return Vector<uInt>(0);
+	}
+
+	// Take the candidates from the smallest of the frequency range and the
+	// positions lists of the selected species or chemical names.
+	std::vector<uInt> candidates;
+	uInt nCandidates = end - begin;
+	const std::vector<std::vector<uInt> >* positions = 0;
+	const std::vector<bool>* selected = 0;
+	if (! selSpecies.empty()) {
+		uInt n = _count(_speciesPositions, selSpecies, begin, end);
+		if (n < nCandidates) {
+			nCandidates = n;
+			positions = &_speciesPositions;
+			selected = &selSpecies;
+		}
+	}
+	if (! selChemNames.empty()) {
+		uInt n = _count(_chemNamePositions, selChemNames, begin, end);
+		if (n < nCandidates) {
+			nCandidates = n;
+			positions = &_chemNamePositions;
+			selected = &selChemNames;
+		}
+	}
+	candidates.reserve(nCandidates);
+	if (positions) {
+		_collect(candidates, *positions, *selected, begin, end);
+		std::sort(candidates.begin(), candidates.end());
+	}
+	else {
+		for (uInt pos=begin; pos<end; pos++) {
+			candidates.push_back(pos);
+		}
+	}
+
+	const Bool cutIntensity = intensityLow < intensityHigh;
+	const Bool cutSmu2 = smu2Low < smu2High;
+	const Bool cutLoga = logaLow < logaHigh;
+	const Bool cutEl = elLow < elHigh;
+	const Bool cutEu = euLow < euHigh;
+	std::vector<uInt> rows;
+	rows.reserve(candidates.size());
+	for (uInt pos : candidates) {
+		if (
+			(! selSpecies.empty() && ! selSpecies[_species.lineIds[pos]])
+			|| (recommendedOnly && ! _recommended[pos])
+			|| (! selChemNames.empty() && ! selChemNames[_chemNames.lineIds[pos]])
+			|| (! selQNs.empty() && ! selQNs[_qns.lineIds[pos]])
+		) {
+			continue;
+		}
+		Bool match = false;
+		if (_isRRL[pos]) {
+			match = includeRRLs || onlyRRLs;
+		}
+		else if (! onlyRRLs) {
+			match = (! cutIntensity || between(_intensity[pos], intensityLow, intensityHigh))
+				&& (! cutSmu2 || between(_smu2[pos], smu2Low, smu2High))
+				&& (! cutLoga || between(_loga[pos], logaLow, logaHigh))
+				&& (! cutEl || between(_el[pos], elLow, elHigh))
+				&& (! cutEu || between(_eu[pos], euLow, euHigh));
+		}
+		if (match) {
+			rows.push_back(_rows[pos]);
+		}
+	}
+	return Vector<uInt>(rows);
+}
+
+Vector<String> SplatalogueIndex::uniqueSpecies() const {
+	return Vector<String>(_species.names);
+}
+
+Vector<String> SplatalogueIndex::uniqueChemicalNames() const {
+	return Vector<String>(_chemNames.names);
+}
+
+uInt SplatalogueIndex::nrow() const {
+	return _nrow;
+}
+
+void SplatalogueIndex::_buildDictionary(
+	_Dictionary& dict, const Vector<String>& values,
+	const std::vector<uInt>& order
+) {
+	for (uInt i=0; i<values.size(); i++) {
+		dict.ids[values[i]] = 0;
+	}
+	dict.names.reserve(dict.ids.size());
+	for (
+		std::map<String, uInt>::iterator iter=dict.ids.begin();
+			iter!=dict.ids.end(); iter++
+	) {
+		iter->second = dict.names.size();
+		dict.names.push_back(iter->first);
+	}
+	dict.lineIds.resize(order.size());
+	for (uInt i=0; i<order.size(); i++) {
+		dict.lineIds[i] = dict.ids[values[order[i]]];
+	}
+}
+
+std::vector<std::vector<uInt> > SplatalogueIndex::_positions(const _Dictionary& dict) {
+	std::vector<std::vector<uInt> > positions(dict.names.size());
+	for (uInt pos=0; pos<dict.lineIds.size(); pos++) {
+		positions[dict.lineIds[pos]].push_back(pos);
+	}
+	return positions;
+}
+
+Bool SplatalogueIndex::_select(
+	std::vector<bool>& selected, const _Dictionary& dict,
+	const Vector<String>& names
+) {
+	selected.assign(dict.names.size(), false);
+	Bool any = false;
+	for (uInt i=0; i<names.size(); i++) {
+		std::map<String, uInt>::const_iterator iter = dict.ids.find(names[i]);
+		if (iter != dict.ids.end()) {
+			selected[iter->second] = true;
+			any = true;
+		}
+	}
+	return any;
+}
+
+uInt SplatalogueIndex::_count(
+	const std::vector<std::vector<uInt> >& positions,
+	const std::vector<bool>& selected, uInt begin, uInt end
+) {
+	uInt n = 0;
+	for (uInt id=0; id<positions.size(); id++) {
+		if (selected[id]) {
+			const std::vector<uInt>& p = positions[id];
+			n += std::lower_bound(p.begin(), p.end(), end)
+				- std::lower_bound(p.begin(), p.end(), begin);
+		}
+	}
+	return n;
+}
+
+void SplatalogueIndex::_collect(
+	std::vector<uInt>& candidates,
+	const std::vector<std::vector<uInt> >& positions,
+	const std::vector<bool>& selected, uInt begin, uInt end
+) {
+	for (uInt id=0; id<positions.size(); id++) {
+		if (selected[id]) {
+			const std::vector<uInt>& p = positions[id];
+			candidates.insert(
+				candidates.end(), std::lower_bound(p.begin(), p.end(), begin),
+				std::lower_bound(p.begin(), p.end(), end)
+			);
+		}
+	}
+}
+
+} //# NAMESPACE CASA - END
@@ -0,0 +1,176 @@
+//# SplatalogueIndex.h: In-memory search index of a splatalogue table
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This library is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU Library General Public License as published by
+//# the Free Software Foundation; either version 2 of the License, or (at your
+//# option) any later version.
+//#
+//# This library is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+//# License for more details.
+//#
+//# You should have received a copy of the GNU Library General Public License
+//# along with this library; if not, write to the Free Software Foundation,
+//# Inc., 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+//#
+#ifndef SPLAT_SPLATALOGUEINDEX_H
+#define SPLAT_SPLATALOGUEINDEX_H
+
+#include <casa/aips.h>
+
+#include <casa/Arrays/Vector.h>
+#include <casa/BasicSL/String.h>
+#include <spectrallines/Splatalogue/SplatalogueTable.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace casa {
+
+// <summary>In-memory search index of a splatalogue spectral line table</summary>
+// <use visibility=local>
+//
+// <reviewed reviewer="" date="yyyy/mm/dd" tests="" demos="">
+// </reviewed>
+//
+
+// <etymology>
+// Index of a splatalogue table.
+// </etymology>
+//
+// <synopsis>
+// Holds the searchable columns of a splatalogue table sorted by frequency,
+// together with dictionaries of the species, chemical names and quantum
+// numbers and, per species and per chemical name, the frequency-sorted
+// positions of their lines. A frequency range is found by binary search, a
+// species or chemical name selection by the positions lists, and the
+// remaining criteria are evaluated on the selected candidates only, so a
+// search costs a small fraction of a table scan.
+//
+// Building an index reads the whole table, so indexes of persistent tables
+// are shared through get(), which keeps one per table name and rebuilds it
+// if the table files were modified since. Indexes of tables which were
+// removed are dropped. Any other table (e.g. in memory or a scratch table)
+// gets an index of its own, which is freed with its last user.
+// </synopsis>
+//
+// <example>
+// <srcBlock>
+// std::shared_ptr<const SplatalogueIndex> index = SplatalogueIndex::get(table);
+// casacore::Vector<casacore::uInt> rows = index->search(...);
+// casacore::Table lines = table(rows);
+// </srcBlock>
+// </example>
+//
+// <motivation>
+// Interactive line identification needs answers in milliseconds, which
+// TaQL queries scanning (and sometimes first copying) the table cannot give.
+// </motivation>
+//
+// <todo asof="">
+// </todo>
+
+class SplatalogueIndex {
+public:
+
+	SplatalogueIndex(const SplatalogueTable& table);
+
+	~SplatalogueIndex();
+
+	// Get the index of <src>table</src>, building it if necessary.
+	static std::shared_ptr<const SplatalogueIndex> get(const SplatalogueTable& table);
+
+	// Forget all shared indexes.
+	static void clearCache();
+
+	// Row numbers of the lines matching the criteria, ordered by frequency.
+	// The criteria have the meaning of the SearchEngine::search() parameters.
+	casacore::Vector<casacore::uInt> search(
+		const casacore::Double freqLow, const casacore::Double freqHigh,
+		const casacore::Vector<casacore::String>& species, const casacore::Bool recommendedOnly,
+		const casacore::Vector<casacore::String>& chemNames, const casacore::Vector<casacore::String>& qns,
+		const casacore::Double intensityLow, const casacore::Double intensityHigh,
+		const casacore::Double smu2Low, const casacore::Double smu2High,
+		const casacore::Double logaLow, const casacore::Double logaHigh,
+		const casacore::Double elLow, const casacore::Double elHigh,
+		const casacore::Double euLow, const casacore::Double euHigh,
+		const casacore::Bool includeRRLs, const casacore::Bool onlyRRLs
+	) const;
+
+	// The unique species in the table, sorted.
+	casacore::Vector<casacore::String> uniqueSpecies() const;
+
+	// The unique chemical names in the table, sorted.
+	casacore::Vector<casacore::String> uniqueChemicalNames() const;
+
+	casacore::uInt nrow() const;
+
+private:
+
+	// A sorted list of unique values and the id (index in that list) of the
+	// value of every line
+	struct _Dictionary {
+		std::vector<casacore::String> names;
+		std::map<casacore::String, casacore::uInt> ids;
+		std::vector<casacore::uInt> lineIds;
+	};
+
+	casacore::uInt _nrow;
+	// Number of lines with a valid (not NaN) frequency; these come first
+	casacore::uInt _nValidFreq;
+	// Table row numbers in frequency order. All other per-line vectors are
+	// indexed by the position in this order.
+	std::vector<casacore::uInt> _rows;
+	std::vector<casacore::Double> _freq;
+	std::vector<casacore::Float> _intensity, _smu2, _loga, _el, _eu;
+	std::vector<bool> _recommended, _isRRL;
+	_Dictionary _species, _chemNames, _qns;
+	// Frequency-ordered positions of the lines of each species and chemical name
+	std::vector<std::vector<casacore::uInt> > _speciesPositions, _chemNamePositions;
+
+	SplatalogueIndex();
+
+	static void _buildDictionary(
+		_Dictionary& dict, const casacore::Vector<casacore::String>& values,
+		const std::vector<casacore::uInt>& order
+	);
+
+	static std::vector<std::vector<casacore::uInt> > _positions(const _Dictionary& dict);
+
+	// Flags the dictionary ids of <src>names</src>. Returns false if none of
+	// the names is in the dictionary.
+	static casacore::Bool _select(
+		std::vector<bool>& selected, const _Dictionary& dict,
+		const casacore::Vector<casacore::String>& names
+	);
+
+	// Number of positions in [begin, end) of the selected positions lists
+	static casacore::uInt _count(
+		const std::vector<std::vector<casacore::uInt> >& positions,
+		const std::vector<bool>& selected, casacore::uInt begin, casacore::uInt end
+	);
+
+	// Append the positions in [begin, end) of the selected positions lists
+	static void _collect(
+		std::vector<casacore::uInt>& candidates,
+		const std::vector<std::vector<casacore::uInt> >& positions,
+		const std::vector<bool>& selected, casacore::uInt begin, casacore::uInt end
+	);
+};
+
+} //# NAMESPACE CASA - END
+
+#endif
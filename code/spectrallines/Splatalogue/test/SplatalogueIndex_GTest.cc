@@ -0,0 +1,321 @@
+//# SplatalogueIndex_GTest.cc: Tests of SplatalogueIndex
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This library is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU Library General Public License as published by
+//# the Free Software Foundation; either version 2 of the License, or (at your
+//# option) any later version.
+//#
+//# This library is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Library General Public
+//# License for more details.
+//#
+//# You should have received a copy of the GNU Library General Public License
+//# along with this library; if not, write to the Free Software Foundation,
+//# Inc., 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+#include <spectrallines/Splatalogue/SplatalogueIndex.h>
+
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/BasicMath/Math.h>
+#include <tables/TaQL/TableParse.h>
+#include <tables/DataMan/StandardStMan.h>
+#include <tables/Tables/ScaColDesc.h>
+#include <tables/Tables/ScalarColumn.h>
+#include <tables/Tables/SetupNewTab.h>
+#include <tables/Tables/TableDesc.h>
+
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+using namespace casacore;
+using namespace casa;
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace {
+
+const uInt NROW = 500;
+
+// Deterministic pseudo-random numbers in [0, 1)
+Double uniform(uInt& seed) {
+	seed = seed * 1103515245u + 12345u;
+	return Double((seed >> 8) & 0xffff) / 65536.0;
+}
+
+// Write a splatalogue table with NROW lines on disk. Every frequency is
+// distinct (and a few are NaN), so the frequency order is unique.
+void createTable(const String& name, uInt seed) {
+	TableDesc td(name + "_desc", TableDesc::Scratch);
+	td.addColumn(ScalarColumnDesc<String>(SplatalogueTable::SPECIES));
+	td.addColumn(ScalarColumnDesc<Bool>(SplatalogueTable::RECOMMENDED));
+	td.addColumn(ScalarColumnDesc<String>(SplatalogueTable::CHEMICAL_NAME));
+	td.addColumn(ScalarColumnDesc<Double>(SplatalogueTable::FREQUENCY));
+	td.addColumn(ScalarColumnDesc<String>(SplatalogueTable::QUANTUM_NUMBERS));
+	td.addColumn(ScalarColumnDesc<Float>(SplatalogueTable::INTENSITY));
+	td.addColumn(ScalarColumnDesc<Float>(SplatalogueTable::SMU2));
+	td.addColumn(ScalarColumnDesc<Float>(SplatalogueTable::LOGA));
+	td.addColumn(ScalarColumnDesc<Float>(SplatalogueTable::EL));
+	td.addColumn(ScalarColumnDesc<Float>(SplatalogueTable::EU));
+	td.addColumn(ScalarColumnDesc<String>(SplatalogueTable::LINELIST));
+	SetupNewTable setup(name, td, Table::New);
+	StandardStMan stm;
+	setup.bindAll(stm);
+	SplatalogueTable table(setup, NROW, "GHz", "D2", "K", "K");
+	ScalarColumn<String> species(table, SplatalogueTable::SPECIES);
+	ScalarColumn<Bool> recommended(table, SplatalogueTable::RECOMMENDED);
+	ScalarColumn<String> chemName(table, SplatalogueTable::CHEMICAL_NAME);
+	ScalarColumn<Double> freq(table, SplatalogueTable::FREQUENCY);
+	ScalarColumn<String> qns(table, SplatalogueTable::QUANTUM_NUMBERS);
+	ScalarColumn<Float> intensity(table, SplatalogueTable::INTENSITY);
+	ScalarColumn<Float> smu2(table, SplatalogueTable::SMU2);
+	ScalarColumn<Float> loga(table, SplatalogueTable::LOGA);
+	ScalarColumn<Float> el(table, SplatalogueTable::EL);
+	ScalarColumn<Float> eu(table, SplatalogueTable::EU);
+	ScalarColumn<String> linelist(table, SplatalogueTable::LINELIST);
+	const char *speciesNames[] = {"CO", "HCN", "H2O", "CH3OH", "SiO", "H"};
+	const char *chemNames[] = {"Carbon Monoxide", "Hydrogen Cyanide", "Water", "Methanol", "Silicon Monoxide", "Hydrogen"};
+	const char *qnsNames[] = {"1-0", "2-1", "3-2", "J=1-0, F=2-1"};
+	for (uInt i=0; i<NROW; i++) {
+		uInt s = uInt(uniform(seed) * 6);
+		species.put(i, speciesNames[s]);
+		chemName.put(i, chemNames[s]);
+		linelist.put(i, s == 5 ? "Recomb" : "JPL");
+		recommended.put(i, uniform(seed) < 0.7);
+		freq.put(i, i % 97 == 13 ? doubleNaN() : 100.0 + ((i * 7919) % NROW) * 0.1 + uniform(seed) * 0.01);
+		qns.put(i, qnsNames[uInt(uniform(seed) * 4)]);
+		intensity.put(i, -10 + 10 * uniform(seed));
+		smu2.put(i, 100 * uniform(seed));
+		loga.put(i, -8 + 6 * uniform(seed));
+		el.put(i, 500 * uniform(seed));
+		eu.put(i, 500 * uniform(seed));
+	}
+	table.flush();
+}
+
+String inList(const String& col, const Vector<String>& values) {
+	std::ostringstream os;
+	os << " AND (" << col << " IN (";
+	for (uInt i=0; i<values.size(); i++) {
+		os << (i ? ", " : "") << "'" << values[i] << "'";
+	}
+	os << "))";
+	return os.str();
+}
+
+String between(const String& col, Double low, Double high) {
+	std::ostringstream os;
+	os.precision(17);
+	os << col << " BETWEEN " << low << " AND " << high;
+	return os.str();
+}
+
+// The search criteria, as for SplatalogueIndex::search()
+struct Criteria {
+	Double freqLow, freqHigh;
+	Vector<String> species;
+	Bool recommendedOnly;
+	Vector<String> chemNames, qns;
+	Double intensityLow, intensityHigh, smu2Low, smu2High, logaLow, logaHigh;
+	Double elLow, elHigh, euLow, euHigh;
+	Bool includeRRLs, onlyRRLs;
+
+	Criteria(Double low, Double high)
+		: freqLow(low), freqHigh(high), recommendedOnly(false),
+		  intensityLow(0), intensityHigh(-1), smu2Low(0), smu2High(-1),
+		  logaLow(0), logaHigh(-1), elLow(0), elHigh(-1), euLow(0), euHigh(-1),
+		  includeRRLs(false), onlyRRLs(false) {}
+
+	Vector<uInt> search(const SplatalogueIndex& index) const {
+		return index.search(
+			freqLow, freqHigh, species, recommendedOnly, chemNames, qns,
+			intensityLow, intensityHigh, smu2Low, smu2High, logaLow, logaHigh,
+			elLow, elHigh, euLow, euHigh, includeRRLs, onlyRRLs
+		);
+	}
+
+	// Rows found by the TaQL query SearchEngine used before the index
+	Vector<uInt> query(const String& tableName) const {
+		std::ostringstream q;
+		q << "SELECT FROM " << tableName << " WHERE ("
+			<< between(SplatalogueTable::FREQUENCY, freqLow, freqHigh) << ")";
+		if (species.size() > 0) {
+			q << inList(SplatalogueTable::SPECIES, species);
+		}
+		if (recommendedOnly) {
+			q << " AND (" << SplatalogueTable::RECOMMENDED << ")";
+		}
+		if (chemNames.size() > 0) {
+			q << inList(SplatalogueTable::CHEMICAL_NAME, chemNames);
+		}
+		if (qns.size() > 0) {
+			q << inList(SplatalogueTable::QUANTUM_NUMBERS, qns);
+		}
+		std::ostringstream nonRRL;
+		nonRRL << "(LINELIST != 'Recomb')";
+		if (intensityLow < intensityHigh) {
+			nonRRL << " AND " << between(SplatalogueTable::INTENSITY, intensityLow, intensityHigh);
+		}
+		if (smu2Low < smu2High) {
+			nonRRL << " AND " << between(SplatalogueTable::SMU2, smu2Low, smu2High);
+		}
+		if (logaLow < logaHigh) {
+			nonRRL << " AND " << between(SplatalogueTable::LOGA, logaLow, logaHigh);
+		}
+		if (elLow < elHigh) {
+			nonRRL << " AND " << between(SplatalogueTable::EL, elLow, elHigh);
+		}
+		if (euLow < euHigh) {
+			nonRRL << " AND " << between(SplatalogueTable::EU, euLow, euHigh);
+		}
+		if (onlyRRLs) {
+			q << " AND LINELIST = 'Recomb'";
+		}
+		else if (includeRRLs) {
+			q << " AND ((LINELIST = 'Recomb') OR (" << nonRRL.str() << "))";
+		}
+		else {
+			q << " AND " << nonRRL.str();
+		}
+		q << " ORDER BY " << SplatalogueTable::FREQUENCY;
+		return tableCommand(q.str()).table().rowNumbers();
+	}
+};
+
+std::vector<Criteria> allCriteria() {
+	std::vector<Criteria> all;
+	all.push_back(Criteria(0, 1e10));
+	all.push_back(Criteria(110, 130));
+	all.push_back(Criteria(140, 100));
+	Criteria c(100, 140);
+	c.species = Vector<String>(2);
+	c.species[0] = "CO";
+	c.species[1] = "SiO";
+	all.push_back(c);
+	c.recommendedOnly = true;
+	c.qns = Vector<String>(1, "2-1");
+	all.push_back(c);
+	c = Criteria(105, 145);
+	c.chemNames = Vector<String>(1, "Methanol");
+	c.intensityLow = -5;
+	c.intensityHigh = -1;
+	c.elLow = 10;
+	c.elHigh = 300;
+	all.push_back(c);
+	c = Criteria(100, 150);
+	c.smu2Low = 20;
+	c.smu2High = 80;
+	c.logaLow = -6;
+	c.logaHigh = -3;
+	c.euLow = 0;
+	c.euHigh = 250;
+	c.includeRRLs = true;
+	all.push_back(c);
+	c.onlyRRLs = true;
+	all.push_back(c);
+	c = Criteria(100, 150);
+	c.species = Vector<String>(1, "NotThere");
+	all.push_back(c);
+	return all;
+}
+
+void expectSameAsQuery(const SplatalogueIndex& index, const String& tableName) {
+	std::vector<Criteria> all = allCriteria();
+	for (uInt i=0; i<all.size(); i++) {
+		Vector<uInt> indexed = all[i].search(index);
+		Vector<uInt> queried = all[i].query(tableName);
+		ASSERT_EQ(queried.size(), indexed.size()) << "criteria " << i;
+		EXPECT_TRUE(allEQ(indexed, queried)) << "criteria " << i;
+	}
+}
+
+class SplatalogueIndexTest : public ::testing::Test {
+protected:
+	String _dir, _name;
+
+	void SetUp() {
+		char tmpdir[] = "/tmp/tSplatalogueIndexXXXXXX";
+		ASSERT_TRUE(mkdtemp(tmpdir) != NULL);
+		_dir = tmpdir;
+		_name = _dir + "/lines.tbl";
+		SplatalogueIndex::clearCache();
+	}
+
+	void TearDown() {
+		SplatalogueIndex::clearCache();
+		system(("rm -rf " + _dir).c_str());
+	}
+};
+
+}
+
+TEST_F(SplatalogueIndexTest, SameAsQuery) {
+	createTable(_name, 1);
+	SplatalogueTable table(_name);
+	expectSameAsQuery(*SplatalogueIndex::get(table), _name);
+}
+
+TEST_F(SplatalogueIndexTest, SharedUntilModified) {
+	createTable(_name, 1);
+	std::shared_ptr<const SplatalogueIndex> first, second;
+	{
+		SplatalogueTable table(_name);
+		first = SplatalogueIndex::get(table);
+		second = SplatalogueIndex::get(table);
+		EXPECT_EQ(first.get(), second.get());
+	}
+	// Rewrite the table with the same number of rows but other lines; file
+	// times have a resolution of a second
+	sleep(1);
+	Table::deleteTable(_name);
+	createTable(_name, 2);
+	SplatalogueTable table(_name);
+	std::shared_ptr<const SplatalogueIndex> third = SplatalogueIndex::get(table);
+	EXPECT_NE(first.get(), third.get());
+	expectSameAsQuery(*third, _name);
+}
+
+TEST_F(SplatalogueIndexTest, TransientTableNotShared) {
+	createTable(_name, 1);
+	SplatalogueTable table(_name);
+	SplatalogueTable memTable(table.copyToMemoryTable("lines"));
+	std::shared_ptr<const SplatalogueIndex> first = SplatalogueIndex::get(memTable);
+	std::weak_ptr<const SplatalogueIndex> weak(first);
+	EXPECT_NE(first.get(), SplatalogueIndex::get(memTable).get());
+	expectSameAsQuery(*first, _name);
+	// Not kept by the cache
+	first.reset();
+	EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(SplatalogueIndexTest, RemovedTableEvicted) {
+	String other = _dir + "/other.tbl";
+	createTable(_name, 1);
+	createTable(other, 2);
+	std::weak_ptr<const SplatalogueIndex> weak;
+	{
+		SplatalogueTable table(_name);
+		weak = SplatalogueIndex::get(table);
+	}
+	EXPECT_FALSE(weak.expired());
+	Table::deleteTable(_name);
+	SplatalogueTable otherTable(other);
+	SplatalogueIndex::get(otherTable);
+	EXPECT_TRUE(weak.expired());
+}
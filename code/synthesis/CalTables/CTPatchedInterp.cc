@@ -26,12 +26,16 @@
 //#
 
 #include <synthesis/CalTables/CTPatchedInterp.h>
-#include <synthesis/CalTables/CTIter.h>
+#include <synthesis/CalTables/CTMainColumns.h>
 #include <scimath/Mathematics/InterpolateArray1D.h>
 #include <casa/OS/Path.h>
 #include <casa/Utilities/GenSort.h>
 #include <casa/aips.h>
 
+#ifdef _OPENMP
+ #include <omp.h>
+#endif
+
 #define CTPATCHEDINTERPVERB false
 
 //#include <casa/BasicSL/Constants.h>
@@ -82,8 +86,13 @@ CTPatchedInterp::CTPatchedInterp(NewCalTable& ct,
   resFlag_(),
   tI_(),
   tIdel_(),
+  tIaxis_(),
   lastFld_(ct.spectralWindow().nrow(),-1),
-  lastObs_(ct.spectralWindow().nrow(),-1)
+  lastObs_(ct.spectralWindow().nrow(),-1),
+  freqRegSpw_(ct.spectralWindow().nrow(),-1),
+  freqRegOut_(ct.spectralWindow().nrow()),
+  freqRegIn_(ct.spectralWindow().nrow()),
+  freqReg_(ct.spectralWindow().nrow())
 {
   if (CTPATCHEDINTERPVERB) cout << "CTPatchedInterp::CTPatchedInterp(<no MS>)" << endl;
 
@@ -249,8 +258,13 @@ CTPatchedInterp::CTPatchedInterp(NewCalTable& ct,
   resFlag_(),
   tI_(),
   tIdel_(),
+  tIaxis_(),
   lastFld_(ms.spectralWindow().nrow(),-1),
-  lastObs_(ms.spectralWindow().nrow(),-1)
+  lastObs_(ms.spectralWindow().nrow(),-1),
+  freqRegSpw_(ms.spectralWindow().nrow(),-1),
+  freqRegOut_(ms.spectralWindow().nrow()),
+  freqRegIn_(ms.spectralWindow().nrow()),
+  freqReg_(ms.spectralWindow().nrow())
 {
 
   if (CTPATCHEDINTERPVERB) cout << "CTPatchedInterp::CTPatchedInterp(CT,MS)" << endl;
@@ -410,8 +424,13 @@ CTPatchedInterp::CTPatchedInterp(NewCalTable& ct,
   resFlag_(),
   tI_(),
   tIdel_(),
+  tIaxis_(),
   lastFld_(mscol.spectralWindow().nrow(),-1),
-  lastObs_(mscol.spectralWindow().nrow(),-1)
+  lastObs_(mscol.spectralWindow().nrow(),-1),
+  freqRegSpw_(mscol.spectralWindow().nrow(),-1),
+  freqRegOut_(mscol.spectralWindow().nrow()),
+  freqRegIn_(mscol.spectralWindow().nrow()),
+  freqReg_(mscol.spectralWindow().nrow())
 {
   if (CTPATCHEDINTERPVERB) cout << "CTPatchedInterp::CTPatchedInterp(mscol)" << endl;
 
@@ -525,26 +544,11 @@ Bool CTPatchedInterp::interpolate(Int msobs, Int msfld, Int msspw, Double time,
 
   if (CTPATCHEDINTERPVERB) cout << "CTPatchedInterp::interpolate(...)" << endl;
 
-  Bool newcal(false);
-  IPosition ip(4,0,msspw,msfld,thisobs(msobs));
-
-  // Loop over _output_ elements
-  for (Int iMSElem=0;iMSElem<nMSElem_;++iMSElem) {
-    // Call fully _patched_ time-interpolator, keeping track of 'newness'
-    //  fills timeResult_/timeResFlag_ implicitly
-    ip(0)=iMSElem;
-    
-    if (!tI_(ip)) {
-      //cout << "Flagging: " << ip << endl;
-      newcal=true;
-    }
-    else {
-      if (freq>0.0)
-	newcal|=tI_(ip)->interpolate(time,freq);
-      else
-	newcal|=tI_(ip)->interpolate(time);
-    }
-  }
+  // Call fully _patched_ time-interpolators, keeping track of 'newness'
+  //  fills timeResult_/timeResFlag_ implicitly
+  Vector<Int> newElem;
+  Int nNew(0);
+  Bool newcal=interpolateInTime(msobs,msfld,msspw,time,freq,newElem,nNew);
 
   // Whole result referred to time result:
   result_(msspw,msfld,thisobs(msobs)).reference(timeResult_(msspw,msfld,thisobs(msobs)));
@@ -585,31 +589,32 @@ Bool CTPatchedInterp::interpolate(Int msobs, Int msfld, Int msspw, Double time,
      }
   }
 
-  Bool newcal(false);
-  IPosition ip(4,0,msspw,msfld,thisobs(msobs));
-  // Loop over _output_ antennas
-  for (Int iMSElem=0;iMSElem<nMSElem_;++iMSElem) {
-    // Call time interpolation calculation; resample in freq if new
-    //   (fills timeResult_/timeResFlag_ implicitly)
-    ip(0)=iMSElem;
-    if (!tI_(ip)) {
-      //      if (iMSElem==0) cout << "Flagging: " << ip << endl;
-      newcal=true;
-    }
-    else {
-
-      if (tI_(ip)->interpolate(time)) { 
-	// Resample in frequency
-	Matrix<Float> fR(freqResult_(msspw,msfld,thisobs(msobs)).xyPlane(iMSElem));
-	Matrix<Bool> fRflg(freqResFlag_(msspw,msfld,thisobs(msobs)).xyPlane(iMSElem));
-	Matrix<Float> tR(timeResult_(msspw,msfld,thisobs(msobs)).xyPlane(iMSElem));
-	Matrix<Bool> tRflg(timeResFlag_(msspw,msfld,thisobs(msobs)).xyPlane(iMSElem));
-	resampleInFreq(fR,fRflg,freq,tR,tRflg,freqIn_(spwMap_(msspw)));
-	
-	// Calibration is new
-	newcal=true;
-      }
-    }
+  // Frequency registration for this spw and channel set (cached)
+  calcFreqReg(msspw,freq);
+
+  // Call time interpolation calculation for all _output_ antennas; those
+  //   with a new result are resampled in freq below
+  //   (fills timeResult_/timeResFlag_ implicitly)
+  Vector<Int> newElem;
+  Int nNew(0);
+  Bool newcal=interpolateInTime(msobs,msfld,msspw,time,-1.0,newElem,nNew);
+
+  // Resample the new elements in frequency; each writes only its own
+  //  plane of the result, and the registration is shared
+  Cube<Float>& fRes(freqResult_(msspw,msfld,thisobs(msobs)));
+  Cube<Bool>& fResFlg(freqResFlag_(msspw,msfld,thisobs(msobs)));
+  Cube<Float>& tRes(timeResult_(msspw,msfld,thisobs(msobs)));
+  Cube<Bool>& tResFlg(timeResFlag_(msspw,msfld,thisobs(msobs)));
+  const Vector<Double>& finGHz(freqRegIn_(msspw));
+  const Vector<uInt>& freg(freqReg_(msspw));
+#pragma omp parallel for default(shared) schedule(dynamic) if (nNew>1)
+  for (Int inew=0;inew<nNew;++inew) {
+    Int iMSElem=newElem(inew);
+    Matrix<Float> fR(fRes.xyPlane(iMSElem));
+    Matrix<Bool> fRflg(fResFlg.xyPlane(iMSElem));
+    Matrix<Float> tR(tRes.xyPlane(iMSElem));
+    Matrix<Bool> tRflg(tResFlg.xyPlane(iMSElem));
+    resampleInFreq(fR,fRflg,freq,tR,tRflg,finGHz,freg);
   }
 
   // Whole result referred to freq result:
@@ -716,74 +721,61 @@ void CTPatchedInterp::sliceTable() {
   spwInOK_.resize(nCTSpw_);
   spwInOK_.set(false);
 
-  // Set up iterator
-  //  TBD: handle baseline-based case!
-  Block<String> sortcol;
-  Int addobs( (byObs_ ? 1 : 0) ); // slicing by obs?
-  Int addfld( (byField_ ? 1 : 0) ); // slicing by field?
-
-  switch(mtype_) {
-  case VisCalEnum::GLOBAL: {
-
+  if (mtype_==VisCalEnum::GLOBAL)
     throw(AipsError("CTPatchedInterp::sliceTable: No non-Mueller/Jones yet."));
 
-    sortcol.resize(1+addobs+addfld);
-    if (byObs_) sortcol[0]="OBSERVATION_ID";  // slicing by obs
-    if (byField_) sortcol[0+addobs]="FIELD_ID";  // slicing by field
-    sortcol[0+addobs+addfld]="SPECTRAL_WINDOW_ID";
-    ROCTIter ctiter(ct_,sortcol);
-    while (!ctiter.pastEnd()) {
-      Int ispw=ctiter.thisSpw();
-      Int ifld = (byField_ ? ctiter.thisField() : 0); // use 0 if not slicing by field
-      Int iobs = (byObs_ ? ctiter.thisObs() : 0); // use 0 if not slicing by obs
-      IPosition ip(4,0,ispw,ifld,iobs);
-      ctSlices_(ip)= new NewCalTable(ctiter.table());
-      spwInOK_(ispw)=(spwInOK_(ispw) || ctSlices_(ip)->nrow()>0);
-      ctiter.next();
-    }
-    break;
-  }
-  case VisCalEnum::MUELLER: {
-    sortcol.resize(3+addobs+addfld);
-    if (byObs_) sortcol[0]="OBSERVATION_ID";  // slicing by obs
-    if (byField_) sortcol[0+addobs]="FIELD_ID";  // slicing by field
-    sortcol[0+addobs+addfld]="SPECTRAL_WINDOW_ID";
-    sortcol[1+addobs+addfld]="ANTENNA1";
-    sortcol[2+addobs+addfld]="ANTENNA2";
-    ROCTIter ctiter(ct_,sortcol);
-    while (!ctiter.pastEnd()) {
-      Int ispw=ctiter.thisSpw();
-      Int iant1=ctiter.thisAntenna1();
-      Int iant2=ctiter.thisAntenna2();
-      Int ibln=blnidx(iant1,iant2,nCTAnt_);
-      Int ifld = (byField_ ? ctiter.thisField() : 0); // use 0 if not slicing by field
-      Int iobs = (byObs_ ? ctiter.thisObs() : 0); // use 0 if not slicing by obs
-      IPosition ip(4,ibln,ispw,ifld,iobs);
-      ctSlices_(ip)=new NewCalTable(ctiter.table());
-      spwInOK_(ispw)=(spwInOK_(ispw) || ctSlices_(ip)->nrow()>0);
-      ctiter.next();
-    }    
-    break;
-  }
-  case VisCalEnum::JONES: {
-    sortcol.resize(2+addobs+addfld);
-    if (byObs_) sortcol[0]="OBSERVATION_ID";  // slicing by obs
-    if (byField_) sortcol[0+addobs]="FIELD_ID";  // slicing by field
-    sortcol[0+addobs+addfld]="SPECTRAL_WINDOW_ID";
-    sortcol[1+addobs+addfld]="ANTENNA1";
-    ROCTIter ctiter(ct_,sortcol);
-    while (!ctiter.pastEnd()) {
-      Int ispw=ctiter.thisSpw();
-      Int iant=ctiter.thisAntenna1();
-      Int ifld = (byField_ ? ctiter.thisField() : 0); // use 0 if not slicing by field
-      Int iobs = (byObs_ ? ctiter.thisObs() : 0); // use 0 if not slicing by obs
-      IPosition ip(4,iant,ispw,ifld,iobs);
-      ctSlices_(ip)= new NewCalTable(ctiter.table());
-      spwInOK_(ispw)=(spwInOK_(ispw) || ctSlices_(ip)->nrow()>0);
-      ctiter.next();
-    }    
-    break;
+  // Read the indexing columns in bulk, and bucket the rows by slice.
+  //  (A sorting CTIter over obs/fld/spw/ant re-attaches column accessors
+  //   for every small iteration, which dominates setup for large tables.)
+  ROCTMainColumns ctmc(ct_);
+  Vector<Int> spwcol,ant1col,ant2col,fldcol,obscol;
+  ctmc.spwId().getColumn(spwcol);
+  ctmc.antenna1().getColumn(ant1col);
+  if (mtype_==VisCalEnum::MUELLER) ctmc.antenna2().getColumn(ant2col);
+  if (byField_) ctmc.fieldId().getColumn(fldcol);
+  if (byObs_) ctmc.obsId().getColumn(obscol);
+
+  // The flat (column-major) slice index of each row, or -1 if the row
+  //  lies outside the cal table's indexing range
+  uInt nrow=ct_.nrow();
+  uInt nSlice=ctSlices_.nelements();
+  Vector<Int> rowSlice(nrow,-1);
+  Vector<uInt> nSliceRow(nSlice,0);
+  for (uInt irow=0;irow<nrow;++irow) {
+    Int ispw=spwcol(irow);
+    Int iel=(mtype_==VisCalEnum::MUELLER ?
+	     blnidx(ant1col(irow),ant2col(irow),nCTAnt_) : ant1col(irow));
+    Int ifld = (byField_ ? fldcol(irow) : 0); // use 0 if not slicing by field
+    Int iobs = (byObs_ ? obscol(irow) : 0); // use 0 if not slicing by obs
+    if (iel<0 || iel>=nCTElem_ || ispw<0 || ispw>=nCTSpw_ ||
+	ifld<0 || ifld>=nCTFld_ || iobs<0 || iobs>=nCTObs_)
+      continue;
+    Int islice=iel+nCTElem_*(ispw+nCTSpw_*(ifld+nCTFld_*iobs));
+    rowSlice(irow)=islice;
+    ++nSliceRow(islice);
   }
+
+  // Gather the row numbers of each slice contiguously (in table order)
+  Vector<uInt> sliceStart(nSlice+1,0);
+  for (uInt i=0;i<nSlice;++i)
+    sliceStart(i+1)=sliceStart(i)+nSliceRow(i);
+  Vector<uInt> sliceRows(sliceStart(nSlice));
+  Vector<uInt> sliceFill(sliceStart(Slice(0,nSlice)).copy());
+  for (uInt irow=0;irow<nrow;++irow)
+    if (rowSlice(irow)>-1)
+      sliceRows(sliceFill(rowSlice(irow))++)=irow;
+
+  // Make a reference table for each non-empty slice
+  for (uInt i=0;i<nSlice;++i) {
+    if (nSliceRow(i)==0) continue;
+    Int iel=i%nCTElem_;
+    Int ispw=(i/nCTElem_)%nCTSpw_;
+    Int ifld=(i/(nCTElem_*nCTSpw_))%nCTFld_;
+    Int iobs=i/(nCTElem_*nCTSpw_*nCTFld_);
+    Vector<uInt> rows(sliceRows(Slice(sliceStart(i),nSliceRow(i))).copy());
+    IPosition ip(4,iel,ispw,ifld,iobs);
+    ctSlices_(ip)=new NewCalTable(ct_(rows));
+    spwInOK_(ispw)=true;
   }
 
 }
@@ -803,6 +795,8 @@ void CTPatchedInterp::makeInterpolators() {
   tI_.set(NULL);
   tIdel_.resize(tIsize);
   tIdel_.set(false);
+  tIaxis_.resize(tIsize);
+  tIaxis_.set(-1);
 
   Bool reportBadSpw(false);
   for (Int iMSObs=0;iMSObs<nMSObs_;++iMSObs) {
@@ -851,6 +845,25 @@ void CTPatchedInterp::makeInterpolators() {
 		   << " as mapped, and will be flagged in this process." << endl;
 	    }
 	  } // iMSElem
+
+	  // Elements whose interpolators have the same times will share
+	  //  the registration of each timestamp (see interpolateInTime)
+	  Vector<Int> axes(nMSElem_);
+	  Int nAxes(0);
+	  for (Int iMSElem=0;iMSElem<nMSElem_;++iMSElem) {
+	    IPosition tIip(4,iMSElem,iMSSpw,iMSFld,iMSObs);
+	    if (!tI_(tIip)) continue;
+	    tIaxis_(tIip)=iMSElem;
+	    for (Int iax=0;iax<nAxes;++iax) {
+	      IPosition axip(4,axes(iax),iMSSpw,iMSFld,iMSObs);
+	      if (tI_(axip)->sameTimes(*tI_(tIip))) {
+		tIaxis_(tIip)=axes(iax);
+		break;
+	      }
+	    }
+	    if (tIaxis_(tIip)==iMSElem)
+	      axes(nAxes++)=iMSElem;
+	  }
 	} // spwOK
 	else
 	  reportBadSpw=true;
@@ -869,6 +882,7 @@ void CTPatchedInterp::makeInterpolators() {
 	for (Int iMSElem=0;iMSElem<nMSElem_;++iMSElem) {
 	  IPosition tIip0(4,iMSElem,iMSSpw,iMSFld,iMSObs),tIip1(4,iMSElem,iMSSpw,thisAltFld,iMSObs);
 	  tI_(tIip0)=tI_(tIip1);
+	  tIaxis_(tIip0)=tIaxis_(tIip1);
 	}
       }
     }
@@ -1078,9 +1092,125 @@ void CTPatchedInterp::setSpwMap(Vector<Int>& spwmap) {
 }
 
 
+// Time-interpolate all elements, registering the time once per CT time list
+Bool CTPatchedInterp::interpolateInTime(Int msobs, Int msfld, Int msspw, Double time, Double freq,
+					Vector<Int>& newElem, Int& nNew) {
+
+  Bool newcal(false);
+  newElem.resize(nMSElem_);
+  nNew=0;
+  Vector<Int> regIdx(nMSElem_,-1);
+  Vector<Bool> regExact(nMSElem_,false);
+  IPosition ip(4,0,msspw,msfld,thisobs(msobs));
+
+  // Loop over _output_ elements
+  for (Int iMSElem=0;iMSElem<nMSElem_;++iMSElem) {
+    ip(0)=iMSElem;
+    if (!tI_(ip)) {
+      // Flagged (no calibration available)
+      newcal=true;
+      continue;
+    }
+
+    // Register the time, or borrow the registration of an earlier
+    //  element with the same CT times
+    Int iaxis=tIaxis_(ip);
+    if (iaxis==iMSElem)
+      tI_(ip)->registerTime(regIdx(iMSElem),regExact(iMSElem),time);
+    else {
+      regIdx(iMSElem)=regIdx(iaxis);
+      regExact(iMSElem)=regExact(iaxis);
+    }
+
+    Bool newElemCal(false);
+    if (freq>0.0)
+      newElemCal=tI_(ip)->interpolate(time,freq,regIdx(iMSElem),regExact(iMSElem));
+    else
+      newElemCal=tI_(ip)->interpolate(time,regIdx(iMSElem),regExact(iMSElem));
+
+    if (newElemCal) {
+      newElem(nNew++)=iMSElem;
+      newcal=true;
+    }
+  }
+  return newcal;
+}
+
+// Calculate (or reuse) the frequency registration for an MS spw
+void CTPatchedInterp::calcFreqReg(Int msspw,const Vector<Double>& fout) {
+
+  Int ctspw=spwMap_(msspw);
+
+  // Same CT spw and same output channels as last time?
+  if (ctspw==freqRegSpw_(msspw) &&
+      fout.nelements()==freqRegOut_(msspw).nelements() &&
+      allEQ(fout,freqRegOut_(msspw)))
+    return;
+
+  freqRegSpw_(msspw)=ctspw;
+  freqRegOut_(msspw).resize(fout.nelements());
+  freqRegOut_(msspw)=fout;
+
+  Vector<Double>& finGHz(freqRegIn_(msspw));
+  Vector<uInt>& freg(freqReg_(msspw));
+  finGHz.resize(0);
+  freg.resize(0);
+
+  // Nothing to register on if spw not mapped to the CalTable
+  if (ctspw<0 || ctspw>=nCTSpw_ || freqIn_(ctspw).nelements()==0)
+    return;
+
+  finGHz.resize(freqIn_(ctspw).nelements());
+  finGHz=freqIn_(ctspw)/1e9;
+
+  // Registration only needed for chan-dep flags
+  if (!freqType_.contains("flag"))
+    return;
+
+  // For each requested chan, the index of the registration sample
+  uInt nflg=finGHz.nelements();
+  uInt nflgout=fout.nelements();
+  freg.resize(nflgout);
+  for (uInt iflgout=0;iflgout<nflgout;++iflgout) {
+      
+    // Find nominal registration (the _index_ just left)
+    Bool exact(false);
+    uInt ireg=binarySearch(exact,finGHz,fout(iflgout),nflg,0);
+    if (ireg>0)
+      ireg-=1;
+    ireg=min(ireg,nflg-1);
+
+    // refine registration by interp type
+    switch (ia1dmethod_) {
+    case InterpolateArray1D<Double,Float>::nearestNeighbour: {
+      // nearest might be forward sample
+      if ( ireg<(nflg-1) &&
+	   abs(fout[iflgout]-finGHz[ireg])>abs(finGHz[ireg+1]-fout[iflgout]) )
+	ireg+=1;
+      break;
+    }
+    case InterpolateArray1D<Double,Float>::linear: {
+      if (ireg==(nflg-1)) // need one more sample to the right
+	ireg-=1;
+      break;
+    }
+    case InterpolateArray1D<Double,Float>::cubic:
+    case InterpolateArray1D<Double,Float>::spline: {
+      if (ireg==0) ireg+=1;  // need one more sample to the left
+      if (ireg>(nflg-3)) ireg=nflg-3;  // need two more samples to the right
+      break;
+    }
+    default:
+      break;
+    }
+    freg[iflgout]=ireg;
+  }
+}
+
 // Resample in frequency
 void CTPatchedInterp::resampleInFreq(Matrix<Float>& fres,Matrix<Bool>& fflg,const Vector<Double>& fout,
-				     Matrix<Float>& tres,Matrix<Bool>& tflg,const Vector<Double>& fin) {
+				     Matrix<Float>& tres,Matrix<Bool>& tflg,const Vector<Double>& finGHz,
+				     const Vector<uInt>& freg) {
 
   if (CTPATCHEDINTERPVERB) cout << "  CTPatchedInterp::resampleInFreq(...)" << endl;
 
@@ -1106,7 +1236,12 @@ void CTPatchedInterp::resampleInFreq(Matrix<Float>& fres,Matrix<Bool>& fflg,cons
     Vector<Bool> fflgi(fflg.row(ifpar/flparmod)), tflgi(tflg.row(ifpar/flparmod));
 
     // Mask time result by flags
-    Vector<Double> mfin=fin(!tflgi).getCompressedArray();
+    Bool anyFlg=anyTrue(tflgi);
+    Vector<Double> mfin;
+    if (anyFlg)
+      mfin=finGHz(!tflgi).getCompressedArray();
+    else
+      mfin.reference(finGHz);
 
     if (mfin.nelements()==0) {
       //   cout << ifpar << " All chans flagged!" << endl;
@@ -1117,8 +1252,11 @@ void CTPatchedInterp::resampleInFreq(Matrix<Float>& fres,Matrix<Bool>& fflg,cons
       continue;
     }
 
-    mfin/=1.0e9; // in GHz
-    Vector<Float> mtresi=tresi(!tflgi).getCompressedArray();
+    Vector<Float> mtresi;
+    if (anyFlg)
+      mtresi=tresi(!tflgi).getCompressedArray();
+    else
+      mtresi=tresi.copy();  // unwrapped below
 
     // Trap case of same in/out frequencies
     if (fout.nelements()==mfin.nelements() && allNear(fout,mfin,1.e-10)) {
@@ -1136,7 +1274,7 @@ void CTPatchedInterp::resampleInFreq(Matrix<Float>& fres,Matrix<Bool>& fflg,cons
     }
 
     // Set flags carefully
-    resampleFlagsInFreq(fflgi,fout,tflgi,fin);
+    resampleFlagsInFreq(fflgi,tflgi,freg);
 
 
     // Always use nearest on edges
@@ -1190,8 +1328,8 @@ void CTPatchedInterp::resampleInFreq(Matrix<Float>& fres,Matrix<Bool>& fflg,cons
   }
 }
 
-void CTPatchedInterp::resampleFlagsInFreq(Vector<Bool>& flgout,const Vector<Double>& fout,
-					  Vector<Bool>& flgin,const Vector<Double>& fin) {
+void CTPatchedInterp::resampleFlagsInFreq(Vector<Bool>& flgout,Vector<Bool>& flgin,
+					  const Vector<uInt>& freg) {
 
   //  cout << "resampleFlagsInFreq" << endl;
 
@@ -1200,8 +1338,6 @@ void CTPatchedInterp::resampleFlagsInFreq(Vector<Bool>& flgout,const Vector<Doub
 #define CUBIC InterpolateArray1D<Double,Float>::cubic
 #define SPLINE InterpolateArray1D<Double,Float>::spline
 
-  Vector<Double> finGHz=fin/1e9;
-
   // Handle chan-dep flags
   if (freqType_.contains("flag")) {
     
@@ -1231,56 +1367,11 @@ void CTPatchedInterp::resampleFlagsInFreq(Vector<Bool>& flgout,const Vector<Doub
     }
     }
     
-    // Now step through requested chans, setting flags
-    uInt ireg=0;
+    // Now step through requested chans, setting flags from the
+    //  registration worked out in calcFreqReg
     uInt nflgout=flgout.nelements();
-    for (uInt iflgout=0;iflgout<nflgout;++iflgout) {
-      
-      // Find nominal registration (the _index_ just left)
-      Bool exact(false);
-      ireg=binarySearch(exact,finGHz,fout(iflgout),nflg,0);
-      if (ireg>0)
-	ireg-=1;
-      ireg=min(ireg,nflg-1);
-
-      //while (finGHz(ireg)<=fout(iflgout) && ireg<nflg-1) {
-      //  ireg+=1;  // USB specific!
-      //}
-      //if (ireg>0 && finGHz(ireg)!=fout(iflgout)) --ireg;  // registration is one sample prior
-
-      // refine registration by interp type
-      switch (ia1dmethod_) {
-      case NEAREST: {
-	// nearest might be forward sample
-	if ( ireg<(nflg-1) &&
-	     abs(fout[iflgout]-finGHz[ireg])>abs(finGHz[ireg+1]-fout[iflgout]) )
-	  ireg+=1;
-	break;
-      }
-      case LINEAR: {
-	if (ireg==(nflg-1)) // need one more sample to the right
-	  ireg-=1;
-	break;
-      }
-      case CUBIC:
-      case SPLINE: {
-	if (ireg==0) ireg+=1;  // need one more sample to the left
-	if (ireg>(nflg-3)) ireg=nflg-3;  // need two more samples to the right
-	break;
-      }
-      }
-	
-      // Assign effective flag
-      flgout[iflgout]=flreg[ireg];
-
-      /*
-      cout << iflgout << " "
-	   << ireg << " "
-	   << flreg[ireg] 
-	   << endl;
-      */
-
-    }
+    for (uInt iflgout=0;iflgout<nflgout;++iflgout)
+      flgout[iflgout]=flreg[freg[iflgout]];
 
   }
   else 
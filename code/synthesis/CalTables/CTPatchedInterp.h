@@ -153,11 +153,23 @@ private:
   // Set generic antenna/baseline map
   void setElemMap();
 
-  // Resample in frequency
+  // Time-interpolate all elements for an MS obs/fld/spw, registering the
+  //  time once per distinct CT time list; newElem[0:nNew] receives the
+  //  elements with a new result (PD correction applied if freq>0)
+  casacore::Bool interpolateInTime(casacore::Int msobs, casacore::Int msfld, casacore::Int msspw,
+				   casacore::Double time, casacore::Double freq,
+				   casacore::Vector<casacore::Int>& newElem, casacore::Int& nNew);
+
+  // Frequency registration of output chans on the CT chans for an MS spw,
+  //  recalculated only when the spw mapping or chan freqs change
+  void calcFreqReg(casacore::Int msspw,const casacore::Vector<casacore::Double>& fout);
+
+  // Resample in frequency (finGHz and freg from calcFreqReg)
   void resampleInFreq(casacore::Matrix<casacore::Float>& fres,casacore::Matrix<casacore::Bool>& fflg,const casacore::Vector<casacore::Double>& fout,
-		      casacore::Matrix<casacore::Float>& tres,casacore::Matrix<casacore::Bool>& tflg,const casacore::Vector<casacore::Double>& fin);
-  void resampleFlagsInFreq(casacore::Vector<casacore::Bool>& flgout,const casacore::Vector<casacore::Double>& fout,
-			   casacore::Vector<casacore::Bool>& flgin,const casacore::Vector<casacore::Double>& fin);
+		      casacore::Matrix<casacore::Float>& tres,casacore::Matrix<casacore::Bool>& tflg,const casacore::Vector<casacore::Double>& finGHz,
+		      const casacore::Vector<casacore::uInt>& freg);
+  void resampleFlagsInFreq(casacore::Vector<casacore::Bool>& flgout,casacore::Vector<casacore::Bool>& flgin,
+			   const casacore::Vector<casacore::uInt>& freg);
 
   // Baseline index from antenna indices: (assumes a1<=a2 !!)
   inline casacore::Int blnidx(const casacore::Int& a1, const casacore::Int& a2, const casacore::Int& nAnt) { return  a1*nAnt-a1*(a1+1)/2+a2; };
@@ -231,9 +243,19 @@ private:
   //   These are populated by the available caltables slices
   casacore::Array<CTTimeInterp1*> tI_;  // [nMSElem_,nMSSpw_,nMSFld_,nMSObs_]
   casacore::Array<casacore::Bool> tIdel_;         // [nMSElem_,nMSSpw_,nMSFld_,mMSObs_]
+  // The element whose interpolator registers timestamps for each one
+  //  (the first with the same CT times)
+  casacore::Array<casacore::Int> tIaxis_;         // [nMSElem_,nMSSpw_,nMSFld_,mMSObs_]
 
   casacore::Vector<casacore::Int> lastFld_,lastObs_;
 
+  // Cached frequency registration, per MS spw: the CT spw and output
+  //  chan freqs it was made for, the CT chan freqs (GHz), and the CT
+  //  chan registering each output chan (only if chan-dep flags)
+  casacore::Vector<casacore::Int> freqRegSpw_;
+  casacore::Vector<casacore::Vector<casacore::Double> > freqRegOut_,freqRegIn_;
+  casacore::Vector<casacore::Vector<casacore::uInt> > freqReg_;
+
 
 };
 
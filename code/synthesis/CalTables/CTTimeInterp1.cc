@@ -32,6 +32,7 @@
 #include <casa/BasicSL/Constants.h>
 #include <casa/Arrays/Array.h>
 #include <casa/Arrays/ArrayIO.h>
+#include <casa/Arrays/ArrayLogical.h>
 #include <casa/Arrays/ArrayMath.h>
 #include <casa/Logging/LogMessage.h>
 #include <casa/Logging/LogSink.h>
@@ -140,13 +141,25 @@ Bool CTTimeInterp1::interpolate(Double newtime) {
 
   // A new time is specified, so some work may be required
 
-  // Convert supplied time value to Float (referenced to timeRef_)
-  Float fnewtime(newtime-timeRef_);
-
   // Establish registration in time
   Bool exact(false);
   Int newIdx(currIdx_);
-  Bool newReg=findTimeRegistration(newIdx,exact,fnewtime);
+  registerTime(newIdx,exact,newtime);
+
+  return this->interpolate(newtime,newIdx,exact);
+
+}
+
+Bool CTTimeInterp1::interpolate(Double newtime, Int newIdx, Bool exact) {
+
+  // Don't work unnecessarily
+  if (newtime==currTime_)
+    return false;  // no change
+
+  // Convert supplied time value to Float (referenced to timeRef_)
+  Float fnewtime(newtime-timeRef_);
+
+  Bool newReg=(newIdx!=currIdx_);
 
   if (CTTIMEINTERPVERB1) 
     cout <<boolalpha<< " newReg="<<newReg<< " newIdx="<<newIdx<< " exact="<<exact
@@ -202,6 +215,28 @@ Bool CTTimeInterp1::interpolate(Double newtime, Double freq) {
 
 }
 
+Bool CTTimeInterp1::interpolate(Double newtime, Double freq, Int idx, Bool exact) {
+
+  Bool newcal=this->interpolate(newtime,idx,exact);
+
+  if (newcal && timeType().contains("PD"))
+    applyPhaseDelay(freq);
+
+  return newcal;
+
+}
+
+void CTTimeInterp1::registerTime(Int& idx,Bool& exact,Double newtime) {
+  findTimeRegistration(idx,exact,Float(newtime-timeRef_));
+}
+
+Bool CTTimeInterp1::sameTimes(const CTTimeInterp1& other) const {
+  return (timeType_==other.timeType_ &&
+	  timeRef_==other.timeRef_ &&
+	  timelist_.nelements()==other.timelist_.nelements() &&
+	  allEQ(timelist_,other.timelist_));
+}
+
 void CTTimeInterp1::state(Bool verbose) {
 
   cout << endl << "-state---------" << endl;
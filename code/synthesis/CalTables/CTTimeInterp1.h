@@ -70,6 +70,21 @@ public:
   // Interpolate, given timestamp and fiducial freq; returns T if new result
   casacore::Bool interpolate(casacore::Double newtime, casacore::Double freq);
 
+  // Registration of a timestamp in the time list: the index of the slot to
+  //  use (or of the first of the two to interpolate between), and whether
+  //  that slot is to be used as is
+  void registerTime(casacore::Int& idx,casacore::Bool& exact,casacore::Double newtime);
+
+  // True if other has the same time list and type, and so registers any
+  //  timestamp exactly as this one does
+  casacore::Bool sameTimes(const CTTimeInterp1& other) const;
+
+  // Interpolate, given timestamp and its registration by registerTime (of
+  //  this or an interpolator with the same times); returns T if new result
+  casacore::Bool interpolate(casacore::Double newtime, casacore::Int idx, casacore::Bool exact);
+  casacore::Bool interpolate(casacore::Double newtime, casacore::Double freq,
+			     casacore::Int idx, casacore::Bool exact);
+
   void state(casacore::Bool verbose=false);
 
 private:
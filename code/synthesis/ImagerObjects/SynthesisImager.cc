@@ -1010,7 +1010,8 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 			       const Quantity& fieldofview,
 			       const Int npixels, const Bool multiField,
 			       const String& filtertype, const Quantity& filterbmaj,
-			       const Quantity& filterbmin, const Quantity& filterbpa   )
+			       const Quantity& filterbmin, const Quantity& filterbpa,
+			       const String& densityCache )
   {
     LogIO os(LogOrigin("SynthesisImager", "weight()", WHERE));
 
@@ -1049,7 +1050,7 @@ namespace casa { //# NAMESPACE CASA - BEGIN
     				  << ", " << actualNpix << "] in the uv plane" << LogIO::POST;
     		  imwgt_p=VisImagingWeight(*rvi_p, rmode, noise, robust, nx,
     				  ny, cellx, celly, actualNpix,
-    				  actualNpix, multiField);
+    				  actualNpix, multiField, densityCache);
     	  }
     	  else if ((type=="robust")||(type=="uniform")||(type=="briggs")) {
     		  if(!imageDefined_p) throw(AipsError("Please define image first"));
@@ -1111,7 +1112,7 @@ namespace casa { //# NAMESPACE CASA - BEGIN
 
 		  imwgt_p=VisImagingWeight(*rvi_p, wtype=="Uniform" ? "none" : rmode, noise, robust,
                                  actualNPixels_x, actualNPixels_y, actualCellSize_x,
-                                 actualCellSize_y, 0, 0, multiField);
+                                 actualCellSize_y, 0, 0, multiField, densityCache);
 
 		  /*
 		  if(rvi_p !=NULL){
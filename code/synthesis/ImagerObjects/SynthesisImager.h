@@ -161,7 +161,8 @@ class SynthesisImager
 	      const casacore::String& filtertype=casacore::String("Gaussian"),
 	      const casacore::Quantity& filterbmaj=casacore::Quantity(0.0,"deg"),
 	      const casacore::Quantity& filterbmin=casacore::Quantity(0.0,"deg"),
-	      const casacore::Quantity& filterbpa=casacore::Quantity(0.0,"deg")  );
+	      const casacore::Quantity& filterbpa=casacore::Quantity(0.0,"deg"),
+	      const casacore::String& densityCache=casacore::String("")  );
 
   casacore::Bool getWeightDensity();
   virtual casacore::Bool setWeightDensity();
@@ -534,7 +534,8 @@ Bool SynthesisImagerVi2::defineImage(SynthesisParamsImage& impars,
 			       const Quantity& fieldofview,
 			       const Int npixels, const Bool multiField,
 			       const String& filtertype, const Quantity& filterbmaj,
-			       const Quantity& filterbmin, const Quantity& filterbpa   )
+			       const Quantity& filterbmin, const Quantity& filterbpa,
+			       const String& densityCache )
   {
     LogIO os(LogOrigin("SynthesisImagerVi2", "weight()", WHERE));
 
@@ -573,7 +574,7 @@ Bool SynthesisImagerVi2::defineImage(SynthesisParamsImage& impars,
     				  << ", " << actualNpix << "] in the uv plane" << LogIO::POST;
     		  imwgt_p=VisImagingWeight(*vi_p, rmode, noise, robust, nx,
     				  ny, cellx, celly, actualNpix,
-    				  actualNpix, multiField);
+    				  actualNpix, multiField, densityCache);
     	  }
     	  else if ((type=="robust")||(type=="uniform")||(type=="briggs")) {
    		  if(!imageDefined_p) throw(AipsError("Please define image first"));
@@ -636,7 +637,7 @@ Bool SynthesisImagerVi2::defineImage(SynthesisParamsImage& impars,
 
 		  imwgt_p=VisImagingWeight(*vi_p, wtype=="Uniform" ? "none" : rmode, noise, robust,
                                  actualNPixels_x, actualNPixels_y, actualCellSize_x,
-                                 actualCellSize_y, 0, 0, multiField);
+                                 actualCellSize_y, 0, 0, multiField, densityCache);
 
 		  /*
 		  if(rvi_p !=NULL){
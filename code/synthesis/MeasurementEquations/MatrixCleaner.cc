@@ -99,7 +99,8 @@ MatrixCleaner::MatrixCleaner():
   itsDidStopPointMode(false),
   itsJustStarting(true),
   psfShape_p(0),
-  noClean_p(false)
+  noClean_p(false),
+  itsPsfConvValid(false)
 {
   itsMemoryMB=Double(HostInfo::memoryTotal()/1024)/16.0;
   itsScales.resize(0);
@@ -164,13 +165,20 @@ MatrixCleaner::MatrixCleaner(const Matrix<Float> & psf,
 
 
 void MatrixCleaner::setPsf(const Matrix<Float>& psf){
-  itsXfr=new Matrix<Complex>();
   AlwaysAssert(validatePsf(psf), AipsError);
+  // Same PSF as last time (next major cycle, or a plane sharing the PSF):
+  // its transform and the PSF convolutions made from it are still good
+  if(!itsXfr.null() && itsPsf.shape().isEqual(psf.shape()) && allEQ(itsPsf, psf))
+    return;
+  itsXfr=new Matrix<Complex>();
   psfShape_p.resize(0, false);
   psfShape_p=psf.shape();
   FFTServer<Float,Complex> fft(psf.shape()); 
   fft.fft0(*itsXfr, psf);
   //cout << "shapes " << itsXfr->shape() << " psf " << psf.shape() << endl;
+  itsPsf.resize(psf.shape());
+  itsPsf=psf;
+  itsPsfConvValid=false;
 }
 
 MatrixCleaner::MatrixCleaner(const MatrixCleaner & other)
@@ -204,6 +212,13 @@ MatrixCleaner & MatrixCleaner::operator=(const MatrixCleaner & other) {
     psfShape_p.resize(0, false);
     psfShape_p=other.psfShape_p;
     noClean_p=other.noClean_p;
+    itsPsf.resize(other.itsPsf.shape());
+    itsPsf=other.itsPsf;
+    itsXfrScaleSizes.resize(other.itsXfrScaleSizes.nelements());
+    itsXfrScaleSizes=other.itsXfrScaleSizes;
+    itsXfrShape.resize(0, false);
+    itsXfrShape=other.itsXfrShape;
+    itsPsfConvValid=other.itsPsfConvValid;
   }
   return *this;
 }
@@ -232,26 +247,110 @@ void MatrixCleaner::makeDirtyScales(){
   Matrix<Complex> dirtyFT;
   FFTServer<Float,Complex> fft(itsDirty->shape());
   fft.fft0(dirtyFT, *itsDirty);
+  makeDirtyConvScales(dirtyFT);
+  
+} 
+
+// The FFTServer keeps its plan and work buffers, so sharing one between
+// threads (or firstprivate copies of it) does not work; each thread
+// makes its own for the loops below.
+
+Int MatrixCleaner::nScaleThreads(const Int nTransforms) const {
+  Int nth=1;
+#ifdef _OPENMP
+  nth=max(1, min(nTransforms, omp_get_max_threads()));
+#else
+  (void)nTransforms;
+#endif
+  return nth;
+}
+
+void MatrixCleaner::makeScaleXfrs(const IPosition& shape){
+  itsScales.resize(itsNscales, true);
+  itsScaleXfrs.resize(itsNscales, true);
+  Int nth=nScaleThreads(itsNscales);
+#pragma omp parallel default(shared) num_threads(nth)
+  {
+    FFTServer<Float,Complex> fft(shape);
+#pragma omp for schedule(dynamic)
+    for (Int scale=0; scale<itsNscales; scale++) {
+      itsScales[scale] = Matrix<Float>(shape);
+      makeScale(itsScales[scale], itsScaleSizes(scale));
+      itsScaleXfrs[scale] = Matrix<Complex> ();
+      fft.fft0(itsScaleXfrs[scale], itsScales[scale]);
+    }
+  }
+  itsXfrScaleSizes.resize(itsScaleSizes.nelements());
+  itsXfrScaleSizes=itsScaleSizes;
+  itsXfrShape.resize(0, false);
+  itsXfrShape=shape;
+  itsPsfConvValid=false;
+}
+
+void MatrixCleaner::makePsfConvScales(){
+  itsPsfConvScales.resize((itsNscales+1)*(itsNscales+1), true);
+  // PSF * scale for every scale, then PSF * scale * otherscale for every
+  // pair, all as one list of independent transforms
+  Int nPairs=itsNscales*(itsNscales+1)/2;
+  Vector<Int> pairScale(nPairs), pairOther(nPairs);
+  Int k=0;
+  for (Int scale=0; scale<itsNscales; scale++) {
+    for (Int otherscale=scale; otherscale<itsNscales; otherscale++) {
+      AlwaysAssert(index(scale, otherscale)<Int(itsPsfConvScales.nelements()),
+		   AipsError);
+      pairScale(k)=scale;
+      pairOther(k)=otherscale;
+      ++k;
+    }
+  }
+  Int nTransforms=itsNscales+nPairs;
+  Int nth=nScaleThreads(nTransforms);
+#pragma omp parallel default(shared) num_threads(nth)
+  {
+    FFTServer<Float,Complex> fft(psfShape_p);
+    Matrix<Complex> cWork;
+#pragma omp for schedule(dynamic)
+    for (Int n=0; n<nTransforms; n++) {
+      if(n < itsNscales) {
+	//PSF * scale
+	itsPsfConvScales[n] = Matrix<Float>(psfShape_p);
+	cWork=((*itsXfr)*(itsScaleXfrs[n]));
+	fft.fft0((itsPsfConvScales[n]), cWork, false);
+	fft.flip(itsPsfConvScales[n], false, false);
+      }
+      else {
+	// PSF *  scale * otherscale
+	Int scale=pairScale(n-itsNscales);
+	Int otherscale=pairOther(n-itsNscales);
+	Int ind=index(scale, otherscale);
+	itsPsfConvScales[ind] =Matrix<Float>(psfShape_p);
+	cWork=((*itsXfr)*conj(itsScaleXfrs[scale])*(itsScaleXfrs[otherscale]));
+	fft.fft0(itsPsfConvScales[ind], cWork, false);
+	//For some reason this complex->real fft  does not need a flip ...may be because conj(a)*a is real
+      }
+    }
+  }
+  itsPsfConvValid=true;
+}
+
+void MatrixCleaner::makeDirtyConvScales(const Matrix<Complex>& dirtyFT){
   itsDirtyConvScales.resize(itsNscales, true);
-  Int scale=0;
-  //Having problem with fftw and omp
-  // #pragma omp parallel default(shared) private(scale) firstprivate(fft)
+  IPosition shape=itsDirty->shape();
+  Int nth=nScaleThreads(itsNscales);
+#pragma omp parallel default(shared) num_threads(nth)
   {
-    //#pragma omp  for 
-    // Dirty*scale
-    for (scale=0; scale<itsNscales; scale++) {
-      Matrix<Complex> cWork;
+    FFTServer<Float,Complex> fft(shape);
+    Matrix<Complex> cWork;
+#pragma omp for schedule(dynamic)
+    for (Int scale=0; scale<itsNscales; scale++) {
       // Dirty * scale
-      //      cout << "scale " << scale << " itsScaleptr " << &(itsScaleXfrs[scale]) << "\n"<< endl;
-      
-      itsDirtyConvScales[scale]=Matrix<Float>(itsDirty->shape());
+      itsDirtyConvScales[scale]=Matrix<Float>(shape);
       cWork=((dirtyFT)*(itsScaleXfrs[scale]));
       fft.fft0((itsDirtyConvScales[scale]), cWork, false);
       fft.flip((itsDirtyConvScales[scale]), false, false);
     }
   }
-  
-} 
+}
 void MatrixCleaner::update(const Matrix<Float> &dirty)
 {
   itsDirty->assign(dirty);
@@ -814,15 +913,20 @@ void MatrixCleaner::setDirty(const Matrix<Float>& dirty){
 // user will call make makePsfScales and makeDirtyScales like an adult in the know
 
 void MatrixCleaner::defineScales(const Vector<Float>& scaleSizes){
-  if(itsScales.nelements()>0) {
+  Vector<Float> sortedSizes(scaleSizes.copy());
+  GenSort<Float>::sort(sortedSizes);
+  // The same scales again (e.g. next major cycle): keep the scale
+  // transforms and PSF convolutions for makePsfScales to reuse
+  Bool sameScales=(sortedSizes.nelements()==itsScaleSizes.nelements()) &&
+    allEQ(sortedSizes, itsScaleSizes);
+  if(itsScales.nelements()>0 && !sameScales) {
     destroyScales();
   }
 
   destroyMasks();
   itsNscales=scaleSizes.nelements();
   itsScaleSizes.resize(itsNscales);
-  itsScaleSizes=scaleSizes;  // make a copy that we can call our own
-  GenSort<Float>::sort(itsScaleSizes);
+  itsScaleSizes=sortedSizes;  // make a copy that we can call our own
   itsScalesValid=false;
 }
 
@@ -832,44 +936,30 @@ void MatrixCleaner::makePsfScales(){
     throw(AipsError("Scales have to be set"));
   if(itsXfr.null())
     throw(AipsError("Psf is not defined"));
-  destroyScales();
-  itsScales.resize(itsNscales, true);
-  itsScaleXfrs.resize(itsNscales, true);
-  itsPsfConvScales.resize((itsNscales+1)*(itsNscales+1), true);
-  FFTServer<Float,Complex> fft(psfShape_p);
-  Int scale=0;
-  for(scale=0; scale<itsNscales;scale++) {
-    itsScales[scale] = Matrix<Float>(psfShape_p);
-    makeScale(itsScales[scale], itsScaleSizes(scale));
-    itsScaleXfrs[scale] = Matrix<Complex> ();
-    fft.fft0(itsScaleXfrs[scale], itsScales[scale]);
-  }
-  Matrix<Complex> cWork;
-  
-  for (scale=0; scale<itsNscales;scale++) {
-    os << "Calculating convolutions for scale " << scale << LogIO::POST;
-    //PSF * scale
-    itsPsfConvScales[scale] = Matrix<Float>(psfShape_p);
-    cWork=((*itsXfr)*(itsScaleXfrs[scale]));
-    //cout << "shape "  << cWork.shape() << "   " << itsPsfConvScales[scale].shape() << endl;
-
-    fft.fft0((itsPsfConvScales[scale]), cWork, false);
-    fft.flip(itsPsfConvScales[scale], false, false);
-    
-    //cout << "psf scale " << scale << " " << max(itsPsfConvScales[scale]) << " " << min(itsPsfConvScales[scale]) << endl;
-
-    for (Int otherscale=scale;otherscale<itsNscales;otherscale++) {
-      
-      AlwaysAssert(index(scale, otherscale)<Int(itsPsfConvScales.nelements()),
-		   AipsError);
-      
-      // PSF *  scale * otherscale
-      itsPsfConvScales[index(scale,otherscale)] =Matrix<Float>(psfShape_p);
-      cWork=((*itsXfr)*conj(itsScaleXfrs[scale])*(itsScaleXfrs[otherscale]));
-      fft.fft0(itsPsfConvScales[index(scale,otherscale)], cWork, false);
-      //For some reason this complex->real fft  does not need a flip ...may be because conj(a)*a is real
-      //fft.flip(*itsPsfConvScales[index(scale,otherscale)], false, false);
+  // The scale transforms only depend on the scale sizes and the shape,
+  // the PSF convolutions also on the PSF; redo only what has changed
+  Bool xfrsValid=(itsScales.nelements()==uInt(itsNscales)) &&
+    (itsScaleXfrs.nelements()==uInt(itsNscales)) &&
+    itsXfrShape.isEqual(psfShape_p) &&
+    (itsXfrScaleSizes.nelements()==itsScaleSizes.nelements()) &&
+    allEQ(itsXfrScaleSizes, itsScaleSizes);
+  Bool psfConvValid=xfrsValid && itsPsfConvValid &&
+    (itsPsfConvScales.nelements()==uInt((itsNscales+1)*(itsNscales+1)));
+  if(xfrsValid) {
+    // As destroyScales would, but keeping the scales
+    for(uInt scale=0; scale<itsDirtyConvScales.nelements();scale++) {
+      itsDirtyConvScales[scale].resize();
     }
+    itsDirtyConvScales.resize(0,true);
+    destroyMasks();
+  }
+  else {
+    destroyScales();
+    makeScaleXfrs(psfShape_p);
+  }
+  if(!psfConvValid) {
+    os << "Calculating convolutions for " << itsNscales << " scales" << LogIO::POST;
+    makePsfConvScales();
   }
   
   itsScalesValid=true;
@@ -916,70 +1006,13 @@ Bool MatrixCleaner::setscales(const Vector<Float>& scaleSizes)
   Matrix<Complex> dirtyFT;
   fft.fft0(dirtyFT, *itsDirty);
 
-  ///Having problem with fftw with openmp
-  //#pragma parallel default(shared) private(scale) firstprivate(fft)
-  {
-    //#pragma omp for 
-    for (scale=0; scale<itsNscales;scale++) {
-      os << "Calculating scale image and Fourier transform for scale " << scale << LogIO::POST;
-      //cout << "Calculating scale image and Fourier transform for scale " << scale << endl;
-      itsScales[scale] = Matrix<Float>(itsDirty->shape());
-      //AlwaysAssert(itsScales[scale], AipsError);
-      // First make the scale
-      makeScale(itsScales[scale], scaleSizes(scale));
-      itsScaleXfrs[scale] = Matrix<Complex> ();
-       fft.fft0(itsScaleXfrs[scale], itsScales[scale]);
-    }
-  }
+  os << "Calculating scale images and Fourier transforms for " << itsNscales << " scales" << LogIO::POST;
+  makeScaleXfrs(itsDirty->shape());
   
   // Now we can do all the convolutions
-  Matrix<Complex> cWork;
-  for (scale=0; scale<itsNscales;scale++) {
-    os << "Calculating convolutions for scale " << scale << LogIO::POST;
-    
-    // PSF * scale
-     itsPsfConvScales[scale] = Matrix<Float>(itsDirty->shape());
-
-    cWork=((*itsXfr)*(itsScaleXfrs[scale]));
-
-    fft.fft0((itsPsfConvScales[scale]), cWork, false);
-    fft.flip(itsPsfConvScales[scale], false, false);
-    
-    itsDirtyConvScales[scale] = Matrix<Float>(itsDirty->shape());
-    cWork=((dirtyFT)*(itsScaleXfrs[scale]));
-    fft.fft0(itsDirtyConvScales[scale], cWork, false);
-    fft.flip(itsDirtyConvScales[scale], false, false);
-    ///////////
-    /*
-    {
-      String axisName = "TabularDoggies1";
-      String axisUnit = "km";
-      Double crval = 10.12;
-      Double crpix = -128.32;
-      Double cdelt = 3.145;
-      TabularCoordinate tab1(crval, cdelt, crpix, axisUnit, axisName);
-      TabularCoordinate tab2(crval, cdelt, crpix, axisUnit, "Dogma");
-      CoordinateSystem csys;
-      csys.addCoordinate(tab1);
-      csys.addCoordinate(tab2);
-      PagedImage<Float> limage(itsPsfConvScales[scale].shape(), csys, "psfconvscale_"+String::toString(scale));
-      limage.put(itsPsfConvScales[scale]);
-    }
-    */
-      ///////////
-
-    for (Int otherscale=scale;otherscale<itsNscales;otherscale++) {
-      
-      AlwaysAssert(index(scale, otherscale)<Int(itsPsfConvScales.nelements()),
-		   AipsError);
-      
-      // PSF *  scale * otherscale
-       itsPsfConvScales[index(scale,otherscale)] =Matrix<Float>(itsDirty->shape());
-      cWork=((*itsXfr)*conj(itsScaleXfrs[scale])*(itsScaleXfrs[otherscale]));
-      fft.fft0(itsPsfConvScales[index(scale,otherscale)], cWork, false);
-      //fft.flip(*itsPsfConvScales[index(scale,otherscale)], false, false);
-    }
-  }
+  os << "Calculating convolutions for " << itsNscales << " scales" << LogIO::POST;
+  makePsfConvScales();
+  makeDirtyConvScales(dirtyFT);
 
   itsScalesValid=true;
 
@@ -350,6 +350,17 @@ private:
   casacore::Bool destroyScales();
   casacore::Bool destroyMasks();
 
+  // Make the scale images and their transforms for the given image
+  // shape, one FFT per scale in parallel
+  void makeScaleXfrs(const casacore::IPosition& shape);
+  // Make the PSF*scale and PSF*scale*otherscale convolutions from
+  // itsXfr and itsScaleXfrs
+  void makePsfConvScales();
+  // Make the Dirty*scale convolutions from the transform of the dirty image
+  void makeDirtyConvScales(const casacore::Matrix<casacore::Complex>& dirtyFT);
+  // Number of threads to use for the per-scale FFTs
+  casacore::Int nScaleThreads(const casacore::Int nTransforms) const;
+
 
   
   casacore::Bool itsIgnoreCenterBox;
@@ -364,6 +375,13 @@ private:
   casacore::IPosition psfShape_p;
   casacore::Bool noClean_p;
 
+  // What the cached scale transforms and PSF convolutions were made
+  // from, so that they survive major cycles and planes with the same PSF
+  casacore::Matrix<casacore::Float> itsPsf;
+  casacore::Vector<casacore::Float> itsXfrScaleSizes;
+  casacore::IPosition itsXfrShape;
+  casacore::Bool itsPsfConvValid;
+
 };
 
 } //# NAMESPACE CASA - END
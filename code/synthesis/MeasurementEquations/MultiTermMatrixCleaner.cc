@@ -65,17 +65,25 @@
 
 #include<synthesis/MeasurementEquations/MultiTermMatrixCleaner.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace casacore;
 namespace casa { //# NAMESPACE CASA - BEGIN
 
 #define MIN(a,b) ((a)<=(b) ? (a) : (b))
 #define MAX(a,b) ((a)>=(b) ? (a) : (b))
+
+// Side of the tiles over which peaks are cached between minor-cycle iterations
+#define PEAKTILE 64
 	
   MultiTermMatrixCleaner::MultiTermMatrixCleaner():
     MatrixCleaner(),
     ntaylor_p(0),psfntaylor_p(0),nscales_p(0),nx_p(0),ny_p(0),totalIters_p(0),
     maxscaleindex_p(0), globalmaxpos_p(IPosition(0)),
-    donePSF_p(false),donePSP_p(false),doneCONV_p(false),memoryMB_p(0),
+    donePSF_p(false),donePSP_p(false),doneCONV_p(false),
+    ntilex_p(0),ntiley_p(0),fullScan_p(true),memoryMB_p(0),allocatedMB_p(0),
     adbg(false)
   { }
 
@@ -377,22 +385,16 @@ Int MultiTermMatrixCleaner::mtclean(Int maxniter, Float stopfraction, Float inpu
 	  trc_p = IPosition(2,nx_p-1,ny_p-1);
 	}
 
-      Int scale=0;
       Int ntaylor=ntaylor_p;
       IPosition blc(blc_p), trc(trc_p);
-      //OMP//      #pragma omp parallel default(shared) private(scale) firstprivate(ntaylor,criterion,blc,trc)
-       { 
-	 //OMP//	 #pragma omp for 
-          for(scale=0;scale<nscales_p;scale++)
+#pragma omp parallel for default(shared) schedule(dynamic)
+          for(Int scale=0;scale<nscales_p;scale++)
           {
-            /* Solve the matrix eqn for all pixels */
-            solveMatrixEqn(ntaylor,scale,blc,trc);
-            /* Choose a component from the list of solutions. Record the location for each scale.*/
-	    // Calculate penalty function
+            /* Choose a component from the solutions of the matrix eqn. Record the location for each scale.*/
+	    // Calculate penalty function (solving for the coefficients on the fly)
 	    // Find max across all pixels.
             chooseComponent(ntaylor, scale,criterion,blc,trc);
 	  }
-       }//end pragma omp
 
        /* Find the best component over all scales */
        for(Int scale=0;scale<nscales_p;scale++)
@@ -493,6 +495,22 @@ Int MultiTermMatrixCleaner::IND4(Int taylor1, Int taylor2, Int scale1, Int scale
 	return ((taylor1*(taylor1+1)/2)+taylor2)*totscale + ((scale1*(scale1+1)/2)+scale2);
 }
 
+/* Number of threads for a set of independent FFTs. Each thread holds an
+   FFTServer and full-size real and complex work images, so stay within the
+   memory not already taken by allocateMemory() */
+Int MultiTermMatrixCleaner::nFFTThreads(Int ntransforms)
+{
+  Int nth=1;
+#ifdef _OPENMP
+  Double perThreadMB = Double(nx_p)*Double(ny_p)*4.0*5.0/(1024.0*1024.0);
+  Int nmem = (perThreadMB>0.0) ? (Int)((0.75*memoryMB_p - allocatedMB_p)/perThreadMB) : 1;
+  nth = MAX(1, MIN(MIN(ntransforms, omp_get_max_threads()), nmem));
+#else
+  (void)ntransforms;
+#endif
+  return nth;
+}
+
 
  /* Check if scale sizes are appropriate to the image size 
      If some scales are too big, ignore them.
@@ -546,18 +564,22 @@ Int MultiTermMatrixCleaner::allocateMemory()
 	
 	Int ntotal4d = (nscales_p*(nscales_p+1)/2) * (ntaylor_p*(ntaylor_p+1)/2);
 
-        Int nHess = ntotal4d;                    // cubeA
+        // The Hessian terms and the scales are only kept as PSF-support patches,
+        // the solution vectors and the penalty images are not kept at all.
+        Int nHess = ntotal4d                     // cubeA
+	                  + nscales_p;           // vecScales
         Int ntempfull =  1                          // scratch
-	                       + nscales_p * 3      // vecScales, vecScaleMasks, vecWork_p, ////vecScaleModel_p
+	                       + nscales_p      // vecScaleMasks, ////vecScaleModel_p
                                + ntaylor_p   // vecModel (vecDirty is a ref)
-                               + 2 * nscales_p * ntaylor_p; // matR and matCoeff
+                               + nscales_p * ntaylor_p; // matR
 
         Int ntemphalf = 2  // scratch
 	                        + nscales_p  // vecSCalesFT
                                 + psfntaylor_p; // vecPsfFT
 
-	Int numMB = static_cast<Int>(( nx_p*ny_p*4*(ntempfull + ntemphalf/2.0)  + psfsupport_p[0]*psfsupport_p[1]*nHess  )/(1024*1024));
+	Int numMB = static_cast<Int>(( Double(nx_p)*Double(ny_p)*4*(ntempfull + ntemphalf/2.0)  + Double(psfsupport_p[0]*psfsupport_p[1])*4*nHess  )/(1024*1024));
         memoryMB_p = Double(HostInfo::memoryTotal()/1024);
+        allocatedMB_p = numMB;
 
         if(adbg) os << "This algorithm needs to allocate " << numMB << " MBytes." << LogIO::POST;
         if (numMB > 0.75*memoryMB_p) 
@@ -579,18 +601,10 @@ Int MultiTermMatrixCleaner::allocateMemory()
 	  invMatA_p[i].resize(tgip);
 	}
 	
-	// I_D 
-        dirtyFT_p.resize(); 
-	
-	// Temporary work-holder
-        cWork_p.resize(); 
-	//tWork_p.resize(gip);
-	
 	// Scales 
 	vecScales_p.resize(nscales_p);
 	vecScalesFT_p.resize(nscales_p);
         vecScaleMasks_p.resize(nscales_p);
-	vecWork_p.resize(nscales_p);
 	//        vecScaleModel_p.resize(nscales_p);
 	for(Int i=0;i<nscales_p;i++) 
 	{
@@ -599,7 +613,6 @@ Int MultiTermMatrixCleaner::allocateMemory()
 ;
 	  vecScalesFT_p[i].resize();
           vecScaleMasks_p[i].resize(gip);
-	  vecWork_p[i].resize(gip);
 	  //          vecScaleModel_p[i].resize(gip);
 	  //          vecScaleModel_p[i] = 0.0;
 	}
@@ -631,15 +644,27 @@ Int MultiTermMatrixCleaner::allocateMemory()
 	
 	// I_D * (Psf * Scales)
 	matR_p.resize(ntaylor_p*nscales_p);
-	// Coefficients to be solved for.
-	matCoeffs_p.resize(ntaylor_p*nscales_p);
 	
 	for(Int i=0;i<ntaylor_p*nscales_p;i++) 
 	{
 		  matR_p[i].resize(gip); 
-		  matCoeffs_p[i].resize(gip);
-                  matCoeffs_p[i] = 0.0;
 	}
+
+	// Coefficients of the chosen component
+	compCoeffs_p.resize(ntaylor_p);
+	compCoeffs_p = 0.0;
+
+	// Tiled peaks of the penalty functions and the principal residual
+	ntilex_p = (nx_p + PEAKTILE - 1)/PEAKTILE;
+	ntiley_p = (ny_p + PEAKTILE - 1)/PEAKTILE;
+	tileMin_p.resize(nscales_p+1); tileMax_p.resize(nscales_p+1);
+	tileMinPos_p.resize(nscales_p+1); tileMaxPos_p.resize(nscales_p+1);
+	for(Int i=0;i<=nscales_p;i++)
+	{
+	  tileMin_p[i].resize(ntilex_p*ntiley_p); tileMax_p[i].resize(ntilex_p*ntiley_p);
+	  tileMinPos_p[i].resize(ntilex_p*ntiley_p); tileMaxPos_p[i].resize(ntilex_p*ntiley_p);
+	}
+	fullScan_p = true;
   
 	return 0;
 }
@@ -662,13 +687,20 @@ Int MultiTermMatrixCleaner::setupUserMask()
       if(adbg) os << "Convolving user mask with scales, and using 0.1 as a threshold." << LogIO::POST;
       Matrix<Complex> maskft;
       fftcomplex.fft0(maskft , *itsMask , false);
+      for(Int scale=0;scale<nscales_p;scale++)
+        AlwaysAssert(maskft.shape() == vecScalesFT_p[scale].shape(),AipsError);
 
+      Int nth=nFFTThreads(nscales_p);
+#pragma omp parallel default(shared) num_threads(nth)
+      {
+      FFTServer<Float,Complex> fft(gip);
+      Matrix<Complex> cWork;
+#pragma omp for schedule(dynamic)
       for(Int scale=0;scale<nscales_p;scale++)
       {
-        AlwaysAssert(maskft.shape() == vecScalesFT_p[scale].shape(),AipsError);
-        cWork_p.assign(maskft * vecScalesFT_p[scale]);
-       	fftcomplex.fft0( vecScaleMasks_p[scale] , cWork_p , false  );
-        fftcomplex.flip( vecScaleMasks_p[scale] , false , false);
+        cWork.assign(maskft * vecScalesFT_p[scale]);
+       	fft.fft0( vecScaleMasks_p[scale] , cWork , false  );
+        fft.flip( vecScaleMasks_p[scale] , false , false);
 	
         for (Int j=0 ; j < (itsMask->shape())(1); ++j)
         for (Int k =0 ; k < (itsMask->shape())(0); ++k)
@@ -681,6 +713,7 @@ Int MultiTermMatrixCleaner::setupUserMask()
 	
 	//	       writeMatrixToDisk("scalemask."+String::toString(scale), vecScaleMasks_p[scale]);
       }// end of for scale
+      }// end pragma parallel
 
           /* TO DO... maybe :
              Map some local variables to those in the parant MatrixCleaner class 
@@ -794,25 +827,25 @@ Int MultiTermMatrixCleaner::setupScaleFunctions()
 		// NSCALES = 1;
 		if(adbg) os << "Calculating scales and their FTs " << LogIO::POST;
 			
+		IPosition immid(2,nx_p/2, ny_p/2);
+		Int nth=nFFTThreads(nscales_p);
+#pragma omp parallel default(shared) num_threads(nth)
+		{
+		FFTServer<Float,Complex> fft(gip);
+		Matrix<Float> scaleWork(gip);
+#pragma omp for schedule(dynamic)
 		for (Int scale=0; scale<nscales_p;scale++) 
 		{
-		  /*
 			// First make the scale
-			makeScale(vecScales_p[scale], scaleSizes_p(scale));
+			makeScale(scaleWork, scaleSizes_p(scale));
 			// Now store the XFR (shape of FT is set automatically)
-                        fftcomplex.fft0(vecScalesFT_p[scale] , vecScales_p[scale] , false);
-                        //fftcomplex.flip(vecScalesFT_p[scale] , false , false);
-		  */
-			// First make the scale
-			makeScale(vecWork_p[0], scaleSizes_p(scale));
-			// Now store the XFR (shape of FT is set automatically)
-                        fftcomplex.fft0(vecScalesFT_p[scale] , vecWork_p[0] , false);
+                        fft.fft0(vecScalesFT_p[scale] , scaleWork , false);
 			// Copy the scale onto the smaller vecScales image.
-			IPosition immid(2,nx_p/2, ny_p/2);
-			Matrix<Float> psfpatch = ( vecWork_p[0] ) (immid-psfsupport_p/2,immid+psfsupport_p/2-IPosition(2,1,1));  
+			Matrix<Float> psfpatch = ( scaleWork ) (immid-psfsupport_p/2,immid+psfsupport_p/2-IPosition(2,1,1));  
 			vecScales_p[scale] = psfpatch; 
 
 		}
+		}// end pragma parallel
 		donePSP_p=true;
 	}
 	
@@ -843,32 +876,42 @@ Int MultiTermMatrixCleaner::computeHessianPeak()
       //... depending on the number of scales chosen
 
       // (PSF * scale) * (PSF * scale) -> cubeA_p [nx_p,ny_p,ntaylor,ntaylor,nscales]
+      // The Hessian is symmetric in the Taylor terms and in the scales (see IND4),
+      // so only the unique terms are made, in parallel, each as a PSF-support patch.
       os << "Calculating PSF and Scale convolutions " << LogIO::POST;
+      Block<IPosition> terms(cubeA_p.nelements());
+      Int nterms=0;
       for (Int taylor1=0; taylor1<ntaylor_p;taylor1++) 
       for (Int taylor2=0; taylor2<=taylor1;taylor2++) 
       for (Int scale1=0; scale1<nscales_p;scale1++) 
       for (Int scale2=0; scale2<=scale1;scale2++) 
+	terms[nterms++] = IPosition(4,taylor1,taylor2,scale1,scale2);
+      AlwaysAssert(nterms==Int(cubeA_p.nelements()), AipsError);
+
+      Int nth=nFFTThreads(nterms);
+#pragma omp parallel default(shared) num_threads(nth)
       {
+      FFTServer<Float,Complex> fft(gip);
+      Matrix<Float> hessWork(gip);
+      Matrix<Complex> cWork;
+#pragma omp for schedule(dynamic)
+      for (Int term=0; term<nterms; term++)
+      {
+	Int taylor1=terms[term](0), taylor2=terms[term](1);
+	Int scale1=terms[term](2), scale2=terms[term](3);
 	Int ttay1 = taylor1+taylor2;
         
         // CALC Hess : Calculate  PSF_(t1+t2)  * scale_1 * scale 2
 
-        cWork_p.assign( (vecPsfFT_p[ttay1]) *(vecScalesFT_p[scale1])*(vecScalesFT_p[scale2]) );
+        cWork.assign( (vecPsfFT_p[ttay1]) *(vecScalesFT_p[scale1])*(vecScalesFT_p[scale2]) );
 
-	Bool usepatch=true;
-	if(usepatch)
-	  {
-	    fftcomplex.fft0( vecWork_p[0]  , cWork_p , false  );
-	    Matrix<Float> psfpatch = ( vecWork_p[0] ) (itsPositionPeakPsf-psfsupport_p/2,itsPositionPeakPsf+psfsupport_p/2-IPosition(2,1,1));  
-	    cubeA_p[IND4(taylor1,taylor2,scale1,scale2)] = psfpatch; 
-	  }
-	else
-	  {
-	    fftcomplex.fft0( cubeA_p[IND4(taylor1,taylor2,scale1,scale2)]  , cWork_p , false  );
-	  }
+	fft.fft0( hessWork  , cWork , false  );
+	Matrix<Float> psfpatch = ( hessWork ) (itsPositionPeakPsf-psfsupport_p/2,itsPositionPeakPsf+psfsupport_p/2-IPosition(2,1,1));  
+	cubeA_p[IND4(taylor1,taylor2,scale1,scale2)] = psfpatch; 
 	
 	//writeMatrixToDisk("psfconv_t_"+String::toString(taylor1)+"-"+String::toString(taylor2)+"_s_"+String::toString(scale1)+"-"+String::toString(scale2)+".im", cubeA_p[IND4(taylor1,taylor2,scale1,scale2)] );
       }	  
+      }// end pragma parallel
 
       // Construct A, invA for each scale.
       if(itsPositionPeakPsf != IPosition(2,(nx_p/2),(ny_p/2)))
@@ -976,24 +1019,34 @@ Int MultiTermMatrixCleaner::computeRHS()
 	 */
 
 	/* I_D * (PSF * scale) -> matR_p [nx_p,ny_p,ntaylor,nscales] */
+	Matrix<Complex> dirtyFT;
+	Int nth=nFFTThreads(nscales_p);
 	for (Int taylor=0; taylor<ntaylor_p;taylor++) 
 	{
 	   /* Compute FT of dirty image */
-	  fftcomplex.fft0( dirtyFT_p , vecDirty_p[taylor] , false );
+	  fftcomplex.fft0( dirtyFT , vecDirty_p[taylor] , false );
 	   
+#pragma omp parallel default(shared) num_threads(nth)
+	  {
+	   FFTServer<Float,Complex> fft(gip);
+	   Matrix<Complex> cWork;
+#pragma omp for schedule(dynamic)
 	   for (Int scale=0; scale<nscales_p;scale++) 
 	   {
 
 	     // CALC RHS :  Calculate   Dirty_t  * scale_s
 
                 // Let cWork get resized if needed. Force matR to have the right shape
-		////                cWork_p.assign( (dirtyFT_p)*(vecPsfFT_p[0])*(vecScalesFT_p[scale]) );
-                cWork_p.assign( (dirtyFT_p)*(vecScalesFT_p[scale]) );
-                fftcomplex.fft0( matR_p[IND2(taylor,scale)] , cWork_p , false );
-                fftcomplex.flip(  matR_p[IND2(taylor,scale)] , false , false );
+                cWork.assign( (dirtyFT)*(vecScalesFT_p[scale]) );
+                fft.fft0( matR_p[IND2(taylor,scale)] , cWork , false );
+                fft.flip(  matR_p[IND2(taylor,scale)] , false , false );
 	   }
+	  }// end pragma parallel
 	   //	   writeMatrixToDisk("resid_"+String::toString(taylor)+".im", matR_p[IND2(taylor,0)] );
 	}
+
+	/* All residuals have changed : the next peak search covers the whole image */
+	fullScan_p = true;
 	
 	return 0;
 }/* end of computeRHS() */
@@ -1019,34 +1072,21 @@ Int MultiTermMatrixCleaner::computeFluxLimit(Float &fluxlimit, Float threshold)
 
 
 /***************************************
- *  Solve the matrix eqn for each point in the lattice.
-Note : This function is called within the 'scale' omp/pragma loop. Needs to be thread-safe
+ *  Solve the matrix eqn at one point in the lattice.
+ *  The solutions are not stored for all pixels : the penalty function
+ *  (scanTiles) solves for them on the fly in exactly the same way.
  ****************************************/
-Int MultiTermMatrixCleaner::solveMatrixEqn(Int ntaylor, Int scale, IPosition blc, IPosition trc)
+Int MultiTermMatrixCleaner::solveMatrixEqn(Int scale, const IPosition& pos, Vector<Float>& coeffs)
 {
-  
-	for(Int taylor1=0;taylor1<ntaylor;taylor1++)
-	{
-	     Matrix<Float> coeffs = (matCoeffs_p[IND2(taylor1,scale)])(blc,trc);  
-	     coeffs = 0.0;
-             for(Int taylor2=0;taylor2<ntaylor;taylor2++)
-	     {
-	       Matrix<Float> rhs = (matR_p[IND2(taylor2,scale)])(blc,trc);
-	       coeffs = coeffs +  ((Float)(invMatA_p[scale])(taylor1,taylor2))* rhs;
-	     }
-	}
-  
-  /* Solve for the coefficients, one scale at at time*/
-	/*	
-	for(Int taylor1=0;taylor1<ntaylor;taylor1++)
+	coeffs.resize(ntaylor_p);
+	for(Int taylor1=0;taylor1<ntaylor_p;taylor1++)
 	{
-	     (matCoeffs_p[IND2(taylor1,scale)]) = 0.0; 
-             for(Int taylor2=0;taylor2<ntaylor;taylor2++)
+	     coeffs[taylor1] = 0.0;
+             for(Int taylor2=0;taylor2<ntaylor_p;taylor2++)
 	     {
-		  matCoeffs_p[IND2(taylor1,scale)] = matCoeffs_p[IND2(taylor1,scale)] + ((Float)(invMatA_p[scale])(taylor1,taylor2))*(matR_p[IND2(taylor2,scale)]);
+	       coeffs[taylor1] = coeffs[taylor1] + ((Float)(invMatA_p[scale])(taylor1,taylor2))*(matR_p[IND2(taylor2,scale)])(pos);
 	     }
 	}
-	*/
 	return 0;
 }/* end of solveMatrixEqn() */
 	
@@ -1062,161 +1102,131 @@ Int MultiTermMatrixCleaner::solveMatrixEqn(Int ntaylor, Int scale, IPosition blc
 Note : This function is called within the 'scale' omp/pragma loop. Needs to be thread-safe
  ****************************************/
 
-  Int MultiTermMatrixCleaner::chooseComponent(Int ntaylor, Int scale, Int /*criterion*/, IPosition blc, IPosition trc)
+  Int MultiTermMatrixCleaner::chooseComponent(Int /*ntaylor*/, Int scale, Int /*criterion*/, IPosition blc, IPosition trc)
 {
+  /* Penalty function (option 1) over the updated region, then the peak over all tiles */
+  scanTiles(scale, blc, trc);
+  findTilePeak(scale, maxScaleVal_p[scale], maxScalePos_p[scale]);
+
+  return 0;
+}/* end of chooseComponent() */
 
+/***************************************
+ *  Masked min and max (as in findMaxAbsMask) of the penalty function for 'scale',
+ *  or of the principal residual for scale==nscales_p, for all tiles that overlap
+ *  [blc,trc]. Only those tiles can have changed since the last call.
+ *  Called within the 'scale' omp loop : thread-safe for different scales.
+ ****************************************/
+void MultiTermMatrixCleaner::scanTiles(Int scale, const IPosition& blc, const IPosition& trc)
+{
+  const Bool resid = (scale==nscales_p);
+  const Int nt = resid ? 1 : ntaylor_p;
+  const Int mscale = resid ? 0 : scale;
+
+  Block<const Float*> rp(nt);
+  for(Int taylor=0;taylor<nt;taylor++) rp[taylor] = matR_p[IND2(taylor,mscale)].data();
+  const Float *mp = vecScaleMasks_p[mscale].data();
+  Block<Float> invA(nt*nt), A(nt*nt), coeffs(nt);
+  for(Int taylor1=0;taylor1<nt;taylor1++)
+    for(Int taylor2=0;taylor2<nt;taylor2++)
+      {
+	invA[taylor1*nt+taylor2] = (Float)(invMatA_p[mscale])(taylor1,taylor2);
+	A[taylor1*nt+taylor2] = (Float)(matA_p[mscale])(taylor1,taylor2);
+      }
 
-  Matrix<Float> work = ( vecWork_p[scale] )(blc,trc);  
+  Vector<Float> &tmin = tileMin_p[scale], &tmax = tileMax_p[scale];
+  Vector<Int64> &tminpos = tileMinPos_p[scale], &tmaxpos = tileMaxPos_p[scale];
 
-  work = 0.0;
-  for(Int taylor1=0;taylor1<ntaylor;taylor1++)
+  for(Int ty=blc(1)/PEAKTILE; ty<=trc(1)/PEAKTILE; ty++)
+  for(Int tx=blc(0)/PEAKTILE; tx<=trc(0)/PEAKTILE; tx++)
+  {
+    Float vmin=0.0, vmax=0.0;
+    Int64 pmin=-1, pmax=-1;
+    Int iend = MIN(nx_p, (tx+1)*PEAKTILE), jend = MIN(ny_p, (ty+1)*PEAKTILE);
+    for(Int j=ty*PEAKTILE; j<jend; j++)
+    for(Int i=tx*PEAKTILE; i<iend; i++)
     {
-      Matrix<Float> coeffs1 = (matCoeffs_p[IND2(taylor1,scale)])(blc,trc);
-      Matrix<Float> resid = (matR_p[IND2(taylor1,scale)])(blc,trc);
-      work = work + (Float)2.0 * coeffs1 * resid;
-      for(Int taylor2=0;taylor2<ntaylor;taylor2++)
+      Int64 p = Int64(j)*nx_p + i;
+      Float val;
+      if(resid)
+	val = rp[0][p];
+      else
+      {
+	// Same operations, in the same order, as the array expressions used before
+	for(Int taylor1=0;taylor1<nt;taylor1++)
 	{
-	  Matrix<Float> coeffs2 = (matCoeffs_p[IND2(taylor2,scale)])(blc,trc);
-	  work = work - (Float)((matA_p[scale])(taylor1,taylor2)) * coeffs1 * coeffs2;
+	  coeffs[taylor1] = 0.0;
+	  for(Int taylor2=0;taylor2<nt;taylor2++)
+	    coeffs[taylor1] = coeffs[taylor1] + invA[taylor1*nt+taylor2]*rp[taylor2][p];
 	}
+	val = 0.0;
+	for(Int taylor1=0;taylor1<nt;taylor1++)
+	{
+	  val = val + (Float)2.0 * coeffs[taylor1] * rp[taylor1][p];
+	  for(Int taylor2=0;taylor2<nt;taylor2++)
+	    val = val - A[taylor1*nt+taylor2] * coeffs[taylor1] * coeffs[taylor2];
+	}
+      }
+      val = val * mp[p];
+      if(pmin<0 || val<vmin) { vmin=val; pmin=p; }
+      if(pmax<0 || val>vmax) { vmax=val; pmax=p; }
     }
-  findMaxAbsMask(vecWork_p[scale],vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-  
-  /*
-    
-  vecWork_p[scale] = 0.0;
-  for(Int taylor1=0;taylor1<ntaylor;taylor1++)
-    {
-      vecWork_p[scale] = vecWork_p[scale] + (Float)2.0  * (  (matCoeffs_p[IND2(taylor1,scale)])  *  (matR_p[IND2(taylor1,scale)])  );
-      for(Int taylor2=0;taylor2<ntaylor;taylor2++)
-	vecWork_p[scale] = vecWork_p[scale] - (Float)((matA_p[scale])(taylor1,taylor2)) * matCoeffs_p[IND2(taylor1,scale)] * matCoeffs_p[IND2(taylor2,scale)] ;
-    }
-  findMaxAbsMask(vecWork_p[scale],vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-  */
-
-
-  //    switch(criterion)
-  //    {
-       //     case 1 : /* For each scale, find the maximum chi-square derivative (maybe) */
-	 //       {
-	 /*
-               /// Code block using a private matrix
-	       Matrix<Float> ttWork_p((matR_p[IND2(0,0)]).shape());
-               ttWork_p = 0.0;
-                for(Int taylor1=0;taylor1<ntaylor_p;taylor1++)
-                {
-                      ttWork_p = ttWork_p + (Float)2.0  * (  (matCoeffs_p[IND2(taylor1,scale)])  *  (matR_p[IND2(taylor1,scale)])  );
-	              for(Int taylor2=0;taylor2<ntaylor_p;taylor2++)
-	                     ttWork_p = ttWork_p -  matCoeffs_p[IND2(taylor1,scale)] * matCoeffs_p[IND2(taylor2,scale)] * cubeA_p[IND4(taylor1,taylor2,scale,scale)];
-                }
-                findMaxAbsMask(ttWork_p,vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-	 */
-	 /*
-	       /// Code block using pre-allocated matrices
-               vecWork_p[scale] = 0.0;
-                for(Int taylor1=0;taylor1<ntaylor_p;taylor1++)
-                {
-                      vecWork_p[scale] = vecWork_p[scale] + (Float)2.0  * (  (matCoeffs_p[IND2(taylor1,scale)])  *  (matR_p[IND2(taylor1,scale)])  );
-	              for(Int taylor2=0;taylor2<ntaylor_p;taylor2++)
-	                     vecWork_p[scale] = vecWork_p[scale] -  matCoeffs_p[IND2(taylor1,scale)] * matCoeffs_p[IND2(taylor2,scale)] * cubeA_p[IND4(taylor1,taylor2,scale,scale)];
-                }
-                findMaxAbsMask(vecWork_p[scale],vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-	 */
-       //       }
-       //       break;
-       /*
-     case 2 : // For each scale, find the peak residual 
-       {
-               Float norm = sqrt((1.0/(matA_p[scale])(0,0)));
-               findMaxAbsMask( norm*matR_p[IND2(0,scale)] , vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-       }
-       break;
-     case 3: // For each scale, find the peak t_0 coefficnent 
-       {
-               findMaxAbsMask( matCoeffs_p[IND2(0,scale)] , vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-       }
-       break;
-     case 4: // For each scale find the max chisq derivative (diag approx for all hessians) - BAD
-       {
- 	       Matrix<Float> ttWork_p((matR_p[IND2(0,0)]).shape());
-                ttWork_p = 0.0;
-                for(Int taylor1=0;taylor1<ntaylor_p;taylor1++)
-                {
-		    ttWork_p = ttWork_p + (Float)(2.0  * (matA_p[scale])(taylor1,taylor1) ) *  (matR_p[IND2(taylor1,scale)])  ;
-	            for(Int taylor2=0;taylor2<ntaylor_p;taylor2++)
-			ttWork_p = ttWork_p - (Float)(2.0*( (matA_p[scale])(taylor1,taylor1) * (matA_p[scale])(taylor1,taylor2))) * matCoeffs_p[IND2(taylor2,scale)] ; 
-                }
-                findMaxAbsMask(ttWork_p,vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-       }
-       break;
-       */
-  //     case 5 : /* For each scale, same as 1, but use only psf peaks */
-  //      {
-	 /*    
-               /// Code block using a private matrix
-	       Matrix<Float> ttWork_p((matR_p[IND2(0,0)]).shape());
-               ttWork_p = 0.0;
-                for(Int taylor1=0;taylor1<ntaylor_p;taylor1++)
-                {
-                      ttWork_p = ttWork_p + (Float)2.0  * (  (matCoeffs_p[IND2(taylor1,scale)])  *  (matR_p[IND2(taylor1,scale)])  );
-	              for(Int taylor2=0;taylor2<ntaylor_p;taylor2++)
-			ttWork_p = ttWork_p - (Float)((matA_p[scale])(taylor1,taylor2)) * matCoeffs_p[IND2(taylor1,scale)] * matCoeffs_p[IND2(taylor2,scale)] ;
-                }
-                findMaxAbsMask(ttWork_p,vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-	 */
-  /*		
-	 /// Code block using pre-allocated matrices
-	        vecWork_p[scale] = 0.0;
-                for(Int taylor1=0;taylor1<ntaylor;taylor1++)
-                {
-		  vecWork_p[scale] = vecWork_p[scale] + (Float)2.0  * (  (matCoeffs_p[IND2(taylor1,scale)])  *  (matR_p[IND2(taylor1,scale)])  );
-	          for(Int taylor2=0;taylor2<ntaylor;taylor2++)
-			vecWork_p[scale] = vecWork_p[scale] - (Float)((matA_p[scale])(taylor1,taylor2)) * matCoeffs_p[IND2(taylor1,scale)] * matCoeffs_p[IND2(taylor2,scale)] ;
-                }
-                findMaxAbsMask(vecWork_p[scale],vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-		
-
-       }
-       break;
-  */
-       /*
-     case 6 : // chi-square for this scale = sum of abs of residual images for taylor terms 
-       {
-
-	 /// Code block using pre-allocated matrices
-	        vecWork_p[scale] = 0.0;
-                for(Int taylor1=0;taylor1<ntaylor;taylor1++)
-                {
-		  vecWork_p[scale] = vecWork_p[scale] + (  abs(matR_p[IND2(taylor1,scale)])  );
-                }
-                findMaxAbsMask(vecWork_p[scale],vecScaleMasks_p[scale],maxScaleVal_p[scale],maxScalePos_p[scale]);
-		
-
-       }
-       break;
-       */
-       //     default:
-       //       os << LogIO::SEVERE << "Internal error : Unknown option for type of update direction" << LogIO::POST;
-       //     }
- 
+    Int tile = ty*ntilex_p + tx;
+    tmin[tile]=vmin; tminpos[tile]=pmin;
+    tmax[tile]=vmax; tmaxpos[tile]=pmax;
+  }
+}/* end of scanTiles() */
 
-	return 0;
-}/* end of chooseComponent() */
+/* Peak over all tiles. Ties go to the first pixel in storage order, as in findMaxAbsMask */
+void MultiTermMatrixCleaner::findTilePeak(Int scale, Float& maxAbs, IPosition& posMaxAbs)
+{
+  const Vector<Float> &tmin = tileMin_p[scale], &tmax = tileMax_p[scale];
+  const Vector<Int64> &tminpos = tileMinPos_p[scale], &tmaxpos = tileMaxPos_p[scale];
+  Float vmin=0.0, vmax=0.0;
+  Int64 pmin=-1, pmax=-1;
+  for(uInt tile=0; tile<tmin.nelements(); tile++)
+  {
+    if(pmin<0 || tmin[tile]<vmin || (tmin[tile]==vmin && tminpos[tile]<pmin)) { vmin=tmin[tile]; pmin=tminpos[tile]; }
+    if(pmax<0 || tmax[tile]>vmax || (tmax[tile]==vmax && tmaxpos[tile]<pmax)) { vmax=tmax[tile]; pmax=tmaxpos[tile]; }
+  }
+  maxAbs = vmax;
+  Int64 p = pmax;
+  if(abs(vmin) > abs(vmax))
+  {
+    maxAbs = vmin;
+    p = pmin;
+  }
+  posMaxAbs = IPosition(2, p % nx_p, p / nx_p);
+}/* end of findTilePeak() */
 
 /* Update the RHS vector - Called from 'updateModelandRHS'.
 Note : This function is called within the 'scale' omp/pragma loop. Needs to be thread-safe for scales.
  */
-Int MultiTermMatrixCleaner::updateRHS(Int ntaylor, Int scale, Float loopgain, Vector<Float> coeffs, IPosition blc, IPosition trc, IPosition blcPsf, IPosition trcPsf)
+Int MultiTermMatrixCleaner::updateRHS(Int ntaylor, Int scale, Float loopgain, const Vector<Float>& coeffs, IPosition blc, IPosition trc, IPosition blcPsf, IPosition trcPsf)
 {
+    // In place, one pass over the box (column by column) per Taylor term,
+    // with all the Hessian terms applied while the residual is in cache.
+    const Int nrow = trc(0)-blc(0)+1;
+    const Int ncol = trc(1)-blc(1)+1;
+    const Int npsf = psfsupport_p(0);
+    Block<const Float*> smooth(ntaylor);
     for(Int taylor1=0;taylor1<ntaylor;taylor1++)
     {
-      Matrix<Float> residSub = (matR_p[IND2(taylor1,scale)])(blc,trc);  
-	   for(Int taylor2=0;taylor2<ntaylor;taylor2++)
-	   {
-	     Matrix<Float> smoothSub = (cubeA_p[IND4(taylor1,taylor2,scale,maxscaleindex_p)])(blcPsf,trcPsf);
-             residSub -= smoothSub * loopgain * coeffs[taylor2];
-	     //	     residSub = residSub - smoothSub * loopgain * (matCoeffs_p[IND2(taylor2,maxscaleindex_p)])(globalmaxpos_p);
-	   }
+      Float *resid = matR_p[IND2(taylor1,scale)].data();
+      for(Int taylor2=0;taylor2<ntaylor;taylor2++)
+	smooth[taylor2] = cubeA_p[IND4(taylor1,taylor2,scale,maxscaleindex_p)].data();
+      for(Int j=0;j<ncol;j++)
+      {
+	Float *residCol = resid + Int64(blc(1)+j)*nx_p + blc(0);
+	Int64 psfCol = Int64(blcPsf(1)+j)*npsf + blcPsf(0);
+	for(Int i=0;i<nrow;i++)
+	{
+	  Float val = residCol[i];
+	  for(Int taylor2=0;taylor2<ntaylor;taylor2++)
+	    val -= smooth[taylor2][psfCol+i] * loopgain * coeffs[taylor2];
+	  residCol[i] = val;
+	}
+      }
     }
     //
     return 0;
@@ -1280,36 +1290,31 @@ Int MultiTermMatrixCleaner::updateModelAndRHS(Float loopgain)
    /* Update the model images */
    ///   Matrix<Float> scaleSub = (vecScales_p[maxscaleindex_p])(blcPsf,trcPsf);  // OLD
    /// Matrix<Float> scaleSub = (vecScales_p[maxscaleindex_p])(blcScale, trcScale);  // NEW
+   /* Coefficients of the chosen component */
+   solveMatrixEqn(maxscaleindex_p, globalmaxpos_p, compCoeffs_p);
+
    Matrix<Float> scaleSub = (vecScales_p[maxscaleindex_p])(blcPsf_p, trcPsf_p);  // NEWER (same size as psf)
    for(Int taylor=0;taylor<ntaylor_p;taylor++)
    {
      Matrix<Float> modelSub = (vecModel_p[taylor])(blc_p,trc_p); 
-     modelSub += scaleSub * loopgain * (matCoeffs_p[IND2(taylor,maxscaleindex_p)])(globalmaxpos_p);
+     modelSub += scaleSub * loopgain * compCoeffs_p[taylor];
    }
 
    /* Update the convolved residuals */
-   Vector<Float> coeffs(ntaylor_p);
-   for(Int taylor=0;taylor<ntaylor_p;taylor++) 
-          coeffs[taylor] = (matCoeffs_p[IND2(taylor,maxscaleindex_p)])(globalmaxpos_p);
-   
-   Int scale;
    Int ntaylor=ntaylor_p;
    IPosition blc(blc_p), trc(trc_p), blcPsf(blcPsf_p), trcPsf(trcPsf_p);
-   //OMP// #pragma omp parallel default(shared) private(scale) firstprivate(ntaylor,loopgain,coeffs,blc,trc,blcPsf,trcPsf)
-  { 
-    //OMP// #pragma omp for 
-    for(scale=0;scale<nscales_p;scale++)
+#pragma omp parallel for default(shared) schedule(dynamic)
+    for(Int scale=0;scale<nscales_p;scale++)
    {
-     updateRHS(ntaylor,scale, loopgain, coeffs, blc, trc, blcPsf, trcPsf);
+     updateRHS(ntaylor,scale, loopgain, compCoeffs_p, blc, trc, blcPsf, trcPsf);
    }
-  }//End pragma parallel  
 
    /* Update flux counters */
    for(Int taylor=0;taylor<ntaylor_p;taylor++)
    {
-	   totalTaylorFlux_p[taylor] += loopgain*(matCoeffs_p[IND2(taylor,maxscaleindex_p)])(globalmaxpos_p);
+	   totalTaylorFlux_p[taylor] += loopgain*compCoeffs_p[taylor];
    }
-   totalScaleFlux_p[maxscaleindex_p] += loopgain*(matCoeffs_p[IND2(0,maxscaleindex_p)])(globalmaxpos_p);
+   totalScaleFlux_p[maxscaleindex_p] += loopgain*compCoeffs_p[0];
    
    return 0;
 }/* end of updateModelAndRHS() */
@@ -1323,7 +1328,16 @@ Int MultiTermMatrixCleaner::checkConvergence(Int /*criterion*/, Float &fluxlimit
     Float maxres=0.0;
     IPosition maxrespos;
 
-    findMaxAbsMask((matR_p[IND2(0,0)]),vecScaleMasks_p[0],maxres,maxrespos);
+    // Same as findMaxAbsMask((matR_p[IND2(0,0)]),vecScaleMasks_p[0],maxres,maxrespos),
+    // searching again only where the last update changed the residual
+    if(fullScan_p)
+      {
+	scanTiles(nscales_p, IPosition(2,0,0), IPosition(2,nx_p-1,ny_p-1));
+	fullScan_p = false;
+      }
+    else
+      scanTiles(nscales_p, blc_p, trc_p);
+    findTilePeak(nscales_p, maxres, maxrespos);
     Float norma = (1.0/(matA_p[0])(0,0));
     rmaxval = abs(maxres*norma);
     rmaxval_p = fabs(rmaxval);
@@ -1438,7 +1452,7 @@ Int MultiTermMatrixCleaner::checkConvergence(Int /*criterion*/, Float &fluxlimit
             os << " Pos: " <<  globalmaxpos_p << " Scale: " << scaleSizes_p[maxscaleindex_p];
             os << " Coeffs: ";
             for(Int taylor=0;taylor<ntaylor_p;taylor++)
-               os << (matCoeffs_p[IND2(taylor,maxscaleindex_p)])(globalmaxpos_p) << "  ";
+               os << compCoeffs_p[taylor] << "  ";
             if(adbg)
 	      {
               os << " OrigRes: ";
@@ -1495,21 +1509,41 @@ Bool MultiTermMatrixCleaner::computeprincipalsolution()
 
     AlwaysAssert((vecDirty_p.nelements()>0), AipsError);
 
-    /* Solve for the coefficients at the delta-function scale*/
-    for(Int taylor1=0;taylor1<ntaylor_p;taylor1++)
+    /* Solve for the coefficients at the delta-function scale, pixel by pixel,
+       and put them into the residual vector */
+    Int ntaylor=ntaylor_p;
+    Block<Float*> dirty(ntaylor);
+    Block<Bool> del(ntaylor);
+    for(Int taylor=0; taylor<ntaylor;taylor++)
     {
-	(matCoeffs_p[IND2(taylor1,0)]) = 0.0; 
-	for(Int taylor2=0;taylor2<ntaylor_p;taylor2++)
-	{
-	    matCoeffs_p[IND2(taylor1,0)] = matCoeffs_p[IND2(taylor1,0)] + ((Float)(invMatA_p[0])(taylor1,taylor2))*(vecDirty_p[taylor2]);
-	}
+	AlwaysAssert(vecDirty_p[taylor].shape()==vecDirty_p[0].shape(), AipsError);
+	dirty[taylor] = vecDirty_p[taylor].getStorage(del[taylor]);
     }
-	
-    /* Copy this into the residual vector */
-    for(Int taylor=0; taylor<ntaylor_p;taylor++)
+    Block<Float> invA(ntaylor*ntaylor);
+    for(Int taylor1=0;taylor1<ntaylor;taylor1++)
+	for(Int taylor2=0;taylor2<ntaylor;taylor2++)
+	    invA[taylor1*ntaylor+taylor2] = (Float)(invMatA_p[0])(taylor1,taylor2);
+    Int64 npix = vecDirty_p[0].nelements();
+
+#pragma omp parallel default(shared)
     {
-	vecDirty_p[taylor].assign(matCoeffs_p[IND2(taylor,0)]);
+    Block<Float> coeffs(ntaylor);
+#pragma omp for
+    for(Int64 p=0; p<npix; p++)
+    {
+	for(Int taylor1=0;taylor1<ntaylor;taylor1++)
+	{
+	    coeffs[taylor1] = 0.0;
+	    for(Int taylor2=0;taylor2<ntaylor;taylor2++)
+		coeffs[taylor1] = coeffs[taylor1] + invA[taylor1*ntaylor+taylor2]*dirty[taylor2][p];
+	}
+	for(Int taylor=0; taylor<ntaylor;taylor++)
+	    dirty[taylor][p] = coeffs[taylor];
     }
+    }// end pragma parallel
+
+    for(Int taylor=0; taylor<ntaylor;taylor++)
+	vecDirty_p[taylor].putStorage(dirty[taylor], del[taylor]);
 
     return true;
 }
@@ -149,12 +149,8 @@ private:
   casacore::Int nx,ny;
   casacore::Bool donePSF_p,donePSP_p,doneCONV_p;
  
-  casacore::Matrix<casacore::Complex> dirtyFT_p;
   casacore::Block<casacore::Matrix<casacore::Float> > vecScaleMasks_p;
   
-  casacore::Matrix<casacore::Complex> cWork_p;
-  casacore::Block<casacore::Matrix<casacore::Float> > vecWork_p;
-  
   // h(s) [nx,ny,nscales]
   casacore::Block<casacore::Matrix<casacore::Float> > vecScales_p; 
   casacore::Block<casacore::Matrix<casacore::Complex> > vecScalesFT_p; 
@@ -177,11 +173,22 @@ private:
   // R_{sk} = I_D * B_{sk} [nx,ny,ntaylor,nscales]
   casacore::Block<casacore::Matrix<casacore::Float> > matR_p; 
   
-  // a_{sk} = Solution vectors. [nx,ny,ntaylor,nscales]
-  casacore::Block<casacore::Matrix<casacore::Float> > matCoeffs_p; 
+  // a_{sk} = Solution vectors are not stored : they are solved for pixel by
+  // pixel from matR_p when needed. These are the ones of the last component.
+  casacore::Vector<casacore::Float> compCoeffs_p;
+
+  // Masked min/max (with positions) of the penalty function of each scale,
+  // and of the principal residual (index nscales_p), per tile of the image.
+  // Only the tiles that an update touches are searched again.
+  casacore::Int ntilex_p, ntiley_p;
+  casacore::Block<casacore::Vector<casacore::Float> > tileMin_p, tileMax_p;
+  casacore::Block<casacore::Vector<casacore::Int64> > tileMinPos_p, tileMaxPos_p;
+  casacore::Bool fullScan_p;
 
   // casacore::Memory to be allocated per Matrix
   casacore::Double memoryMB_p;
+  // casacore::Memory allocated by allocateMemory()
+  casacore::Double allocatedMB_p;
   
   // Solve [A][Coeffs] = [I_D * B]
   // Shape of A : [ntaylor,ntaylor]
@@ -202,10 +209,12 @@ private:
   casacore::Int computeRHS();
 
   // Solver functions : minor-cycle iterations. Need to be efficient.
-  casacore::Int solveMatrixEqn(casacore::Int ntaylor,casacore::Int scale, casacore::IPosition blc, casacore::IPosition trc);
+  casacore::Int solveMatrixEqn(casacore::Int scale, const casacore::IPosition& pos, casacore::Vector<casacore::Float>& coeffs);
   casacore::Int chooseComponent(casacore::Int ntaylor,casacore::Int scale, casacore::Int criterion, casacore::IPosition blc, casacore::IPosition trc);
   casacore::Int updateModelAndRHS(casacore::Float loopgain);
-  casacore::Int updateRHS(casacore::Int ntaylor, casacore::Int scale, casacore::Float loopgain,casacore::Vector<casacore::Float> coeffs, casacore::IPosition blc, casacore::IPosition trc, casacore::IPosition blcPsf, casacore::IPosition trcPsf);
+  casacore::Int updateRHS(casacore::Int ntaylor, casacore::Int scale, casacore::Float loopgain, const casacore::Vector<casacore::Float>& coeffs, casacore::IPosition blc, casacore::IPosition trc, casacore::IPosition blcPsf, casacore::IPosition trcPsf);
+  void scanTiles(casacore::Int scale, const casacore::IPosition& blc, const casacore::IPosition& trc);
+  void findTilePeak(casacore::Int scale, casacore::Float& maxAbs, casacore::IPosition& posMaxAbs);
   casacore::Int checkConvergence(casacore::Int updatetype, casacore::Float &fluxlimit, casacore::Float &loopgain); 
   casacore::Bool buildImagePatches();
 
@@ -213,6 +222,7 @@ private:
   casacore::Int writeMatrixToDisk(casacore::String imagename, casacore::Matrix<casacore::Float> &themat);
   casacore::Int IND2(casacore::Int taylor,casacore::Int scale);
   casacore::Int IND4(casacore::Int taylor1, casacore::Int taylor2, casacore::Int scale1, casacore::Int scale2);
+  casacore::Int nFFTThreads(casacore::Int ntransforms);
   
   casacore::Bool adbg;
 };
@@ -0,0 +1,391 @@
+//# Vi2Benchmark.cc: Synthetic performance benchmark of VI2 layers and FTMachines
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU General Public License as published by the Free
+//# Software Foundation; either version 2 of the License, or (at your option)
+//# any later version.
+//#
+//# This program is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//# more details.
+//#
+//# You should have received a copy of the GNU General Public License along
+//# with this program; if not, write to the Free Software Foundation, Inc.,
+//# 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+#include <synthesis/apps/vi2benchmark/Vi2Benchmark.h>
+
+#include <casa/Exceptions/Error.h>
+#include <casa/OS/File.h>
+#include <coordinates/Coordinates/CoordinateSystem.h>
+#include <coordinates/Coordinates/DirectionCoordinate.h>
+#include <coordinates/Coordinates/Projection.h>
+#include <coordinates/Coordinates/SpectralCoordinate.h>
+#include <coordinates/Coordinates/StokesCoordinate.h>
+#include <images/Images/TempImage.h>
+#include <measures/Measures/MeasTable.h>
+#include <measures/Measures/Stokes.h>
+#include <ms/MeasurementSets/MSColumns.h>
+#include <msvis/MSVis/AveragingVi2Factory.h>
+#include <msvis/MSVis/IteratingParameters.h>
+#include <msvis/MSVis/LayeredVi2Factory.h>
+#include <msvis/MSVis/SimpleSimVi2.h>
+#include <msvis/MSVis/VisBuffer2.h>
+#include <msvis/MSVis/VisImagingWeight.h>
+#include <msvis/MSVis/VisibilityIterator2.h>
+#include <mstransform/TVI/ChannelAverageTVI.h>
+#include <mstransform/TVI/PhaseShiftingTVI.h>
+#include <mstransform/TVI/StatWtTVILayerFactory.h>
+#include <mstransform/TVI/UVContSubTVI.h>
+#include <synthesis/MeasurementComponents/CalibratingVi2.h>
+#include <synthesis/TransformMachines2/GridFT.h>
+#include <synthesis/TransformMachines2/WProjectFT.h>
+#include <synthesis/TransformMachines2/test/MakeMS.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <sys/resource.h>
+
+using namespace casacore;
+using namespace casa::vi;
+
+namespace casa {
+
+namespace test {
+
+namespace {
+
+// PhaseShiftingTVI has no layer factory of its own
+class PhaseShiftingTVILayerFactory : public ViiLayerFactory {
+
+public:
+
+  PhaseShiftingTVILayerFactory(const Record& configuration)
+    : configuration_p(configuration) {}
+
+protected:
+
+  ViImplementation2 * createInstance(ViImplementation2* vii0) const {
+    return new PhaseShiftingTVI(vii0, configuration_p);
+  }
+
+  const Record configuration_p;
+};
+
+// Phase center of the synthetic MS, and reference direction of the
+// FTMachine images
+MDirection phaseCenter() {
+  return MDirection(Quantity(20.0, "deg"), Quantity(20.0, "deg"));
+}
+
+// Reset the peak resident set size of the process, where supported
+void resetPeakRss() {
+#ifdef __linux__
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs) {
+    clearRefs << "5";
+  }
+#endif
+}
+
+Double peakRssMB() {
+#ifdef __linux__
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return atof(line.c_str() + 6) / 1024.0;
+    }
+  }
+#endif
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+class StageTimer {
+
+public:
+
+  StageTimer() : start_p(std::chrono::steady_clock::now()) {}
+
+  Double seconds() const {
+    return std::chrono::duration<Double>(
+      std::chrono::steady_clock::now() - start_p).count();
+  }
+
+private:
+
+  std::chrono::steady_clock::time_point start_p;
+};
+
+} // namespace
+
+Double Vi2BenchmarkResult::rowsPerSecond() const {
+  return seconds > 0 ? rows / seconds : 0;
+}
+
+Double Vi2BenchmarkResult::visibilitiesPerSecond() const {
+  return seconds > 0 ? visibilities / seconds : 0;
+}
+
+Vi2Benchmark::Vi2Benchmark(const Vi2BenchmarkParameters& pars)
+  : pars_p(pars) {}
+
+Vi2Benchmark::~Vi2Benchmark() {
+  if (ms_p) {
+    ms_p->markForDelete();
+  }
+}
+
+std::vector<String> Vi2Benchmark::stages() {
+  return {"sim", "calibrate", "timeaverage", "chanaverage", "uvcontsub",
+      "phaseshift", "chain", "statwt", "gridft-put", "gridft-get",
+      "wprojectft-put", "wprojectft-get"};
+}
+
+std::vector<Vi2BenchmarkResult> Vi2Benchmark::run(const std::vector<String>& stages) {
+  std::vector<Vi2BenchmarkResult> results;
+  for (auto& stage : stages) {
+    results.push_back(run(stage));
+  }
+  return results;
+}
+
+Vi2BenchmarkResult Vi2Benchmark::run(const String& stage) {
+  // Data-generating layer
+  SimpleSimVi2Parameters simpars(pars_p.nField, pars_p.nScan, pars_p.nSpw,
+                                 pars_p.nAnt, pars_p.nCorr,
+                                 Vector<Int>(pars_p.nField, pars_p.nTime),
+                                 Vector<Int>(pars_p.nSpw, pars_p.nChan));
+  SimpleSimVi2LayerFactory sim(simpars);
+
+  CalibratingParameters calpars(2.0f);
+  CalVi2LayerFactory cal(calpars);
+
+  AveragingOptions aveopt(AveragingOptions::AverageCorrected |
+                          AveragingOptions::CorrectedFlagWeightAvgFromWEIGHT);
+  AveragingParameters avepars(pars_p.timeBin, 0.0, SortColumns(), aveopt);
+  AveragingVi2LayerFactory timeave(avepars);
+
+  Record chanaveConfig;
+  chanaveConfig.define("chanbin", pars_p.chanBin);
+  ChannelAverageTVILayerFactory chanave(chanaveConfig);
+
+  Record uvcontsubConfig;
+  uvcontsubConfig.define("fitorder", 1);
+  uvcontsubConfig.define("want_cont", False);
+  UVContSubTVILayerFactory uvcontsub(uvcontsubConfig);
+
+  Record phaseshiftConfig;
+  phaseshiftConfig.define("XpcOffset", 1.0);
+  phaseshiftConfig.define("YpcOffset", 1.0);
+  PhaseShiftingTVILayerFactory phaseshift(phaseshiftConfig);
+
+  std::vector<ViiLayerFactory*> layers;
+  if (stage == "sim") {
+    layers = {&sim};
+  } else if (stage == "calibrate") {
+    layers = {&sim, &cal};
+  } else if (stage == "timeaverage") {
+    layers = {&sim, &timeave};
+  } else if (stage == "chanaverage") {
+    layers = {&sim, &chanave};
+  } else if (stage == "uvcontsub") {
+    layers = {&sim, &uvcontsub};
+  } else if (stage == "phaseshift") {
+    layers = {&sim, &phaseshift};
+  } else if (stage == "chain") {
+    layers = {&sim, &cal, &chanave, &timeave};
+  } else if (stage == "statwt") {
+    return runStatWt(stage);
+  } else if (stage == "gridft-put") {
+    return runFTMachine(stage, "GridFT", True);
+  } else if (stage == "gridft-get") {
+    return runFTMachine(stage, "GridFT", False);
+  } else if (stage == "wprojectft-put") {
+    return runFTMachine(stage, "WProjectFT", True);
+  } else if (stage == "wprojectft-get") {
+    return runFTMachine(stage, "WProjectFT", False);
+  } else {
+    ThrowCc("Unknown benchmark stage " + stage);
+  }
+  Vector<ViiLayerFactory*> factories(layers.size());
+  for (uInt i = 0; i < layers.size(); ++i) {
+    factories[i] = layers[i];
+  }
+  return runLayers(stage, factories);
+}
+
+void Vi2Benchmark::iterate(VisibilityIterator2& vi, Vi2BenchmarkResult& result,
+                           Bool readWeights) {
+  VisBuffer2 *vb = vi.getVisBuffer();
+  for (vi.originChunks(); vi.moreChunks(); vi.nextChunk()) {
+    for (vi.origin(); vi.more(); vi.next()) {
+      const Cube<Complex>& vis = vb->visCubeCorrected();
+      vb->flagCube();
+      if (readWeights) {
+        vb->weight();
+      }
+      result.rows += vb->nRows();
+      result.visibilities += vis.nelements();
+    }
+  }
+}
+
+Vi2BenchmarkResult Vi2Benchmark::runLayers(const String& stage,
+                                           const Vector<ViiLayerFactory*>& factories) {
+  Vi2BenchmarkResult result;
+  result.stage = stage;
+  resetPeakRss();
+  StageTimer timer;
+  VisibilityIterator2 vi(factories);
+  iterate(vi, result, False);
+  result.seconds = timer.seconds();
+  result.peakRssMB = peakRssMB();
+  return result;
+}
+
+Vi2BenchmarkResult Vi2Benchmark::runStatWt(const String& stage) {
+  Vi2BenchmarkResult result;
+  result.stage = stage;
+  MeasurementSet& ms = syntheticMS();
+  resetPeakRss();
+  StageTimer timer;
+  IteratingParameters itpars;
+  VisIterImpl2LayerFactory data(&ms, itpars, False);
+  Record statwtConfig;
+  StatWtTVILayerFactory statwt(statwtConfig);
+  Vector<ViiLayerFactory*> factories(2);
+  factories[0] = &data;
+  factories[1] = &statwt;
+  VisibilityIterator2 vi(factories);
+  iterate(vi, result, True);
+  result.seconds = timer.seconds();
+  result.peakRssMB = peakRssMB();
+  return result;
+}
+
+Vi2BenchmarkResult Vi2Benchmark::runFTMachine(const String& stage,
+                                              const String& ftmachine,
+                                              Bool toSky) {
+  Vi2BenchmarkResult result;
+  result.stage = stage;
+  MeasurementSet& ms = syntheticMS();
+  resetPeakRss();
+
+  VisibilityIterator2 vi(ms, SortColumns(), True);
+  VisBuffer2 *vb = vi.getVisBuffer();
+  VisImagingWeight imwgt("natural");
+  vi.useImagingWeight(imwgt);
+
+  MPosition loc;
+  MeasTable::Observatory(loc, ROMSColumns(ms).observation().telescopeName()(0));
+  std::unique_ptr<refim::FTMachine> ftm;
+  if (ftmachine == "WProjectFT") {
+    ftm.reset(new refim::WProjectFT(50, loc, 1000000, 16));
+  } else {
+    ftm.reset(new refim::GridFT(1000000, 16, "SF", loc, 1.0, false, false));
+  }
+
+  Matrix<Double> xform(2, 2);
+  xform = 0.0;
+  xform.diagonal() = 1.0;
+  const Double refPix = pars_p.imageSize / 2;
+  DirectionCoordinate dc(MDirection::J2000, Projection::SIN,
+                         Quantity(20.0, "deg"), Quantity(20.0, "deg"),
+                         Quantity(0.5, "arcsec"), Quantity(0.5, "arcsec"),
+                         xform, refPix, refPix, 999.0, 999.0);
+  StokesCoordinate stc(Vector<Int>(1, Stokes::I));
+  SpectralCoordinate spc(MFrequency::LSRK, 1.5e9, 1e6, 0.0, 1.420405752e9);
+  CoordinateSystem cs;
+  cs.addCoordinate(dc);
+  cs.addCoordinate(stc);
+  cs.addCoordinate(spc);
+  TempImage<Complex> im(IPosition(4, pars_p.imageSize, pars_p.imageSize, 1, 1), cs);
+
+  StageTimer timer;
+  if (toSky) {
+    im.set(Complex(0.0));
+    Matrix<Float> weight;
+    vi.originChunks();
+    vi.origin();
+    ftm->initializeToSky(im, weight, *vb);
+    for (vi.originChunks(); vi.moreChunks(); vi.nextChunk()) {
+      for (vi.origin(); vi.more(); vi.next()) {
+        ftm->put(*vb);
+        result.rows += vb->nRows();
+        result.visibilities += vb->visCube().nelements();
+      }
+    }
+    ftm->finalizeToSky();
+    ftm->getImage(weight, true);
+  } else {
+    im.set(Complex(0.0));
+    im.putAt(Complex(1.0, 0.0), IPosition(4, Int(refPix), Int(refPix), 0, 0));
+    vi.originChunks();
+    vi.origin();
+    ftm->initializeToVis(im, *vb);
+    for (vi.originChunks(); vi.moreChunks(); vi.nextChunk()) {
+      for (vi.origin(); vi.more(); vi.next()) {
+        ftm->get(*vb);
+        result.rows += vb->nRows();
+        result.visibilities += vb->visCubeModel().nelements();
+      }
+    }
+    ftm->finalizeToVis();
+  }
+  result.seconds = timer.seconds();
+  result.peakRssMB = peakRssMB();
+  return result;
+}
+
+MeasurementSet& Vi2Benchmark::syntheticMS() {
+  if (!ms_p) {
+    const String msname = File::newUniqueName(".", "vi2benchmark").absoluteName() + ".ms";
+    MakeMS::makems(msname, phaseCenter(), 1.5e9, 1e6, pars_p.msNChan, pars_p.msNInt);
+    ms_p.reset(new MeasurementSet(msname, Table::Update));
+  }
+  return *ms_p;
+}
+
+void Vi2Benchmark::report(std::ostream& os, const std::vector<Vi2BenchmarkResult>& results) {
+  os << std::left << std::setw(16) << "stage"
+     << std::right << std::setw(12) << "rows"
+     << std::setw(14) << "visibilities"
+     << std::setw(10) << "time (s)"
+     << std::setw(14) << "rows/s"
+     << std::setw(14) << "vis/s"
+     << std::setw(16) << "peak RSS (MB)" << std::endl;
+  for (auto& r : results) {
+    os << std::left << std::setw(16) << r.stage
+       << std::right << std::setw(12) << r.rows
+       << std::setw(14) << r.visibilities
+       << std::setw(10) << std::fixed << std::setprecision(3) << r.seconds
+       << std::setw(14) << std::setprecision(0) << r.rowsPerSecond()
+       << std::setw(14) << r.visibilitiesPerSecond()
+       << std::setw(16) << std::setprecision(1) << r.peakRssMB << std::endl;
+  }
+}
+
+} // namespace test
+} // namespace casa
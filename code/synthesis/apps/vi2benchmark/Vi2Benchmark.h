@@ -0,0 +1,150 @@
+//# Vi2Benchmark.h: Synthetic performance benchmark of VI2 layers and FTMachines
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU General Public License as published by the Free
+//# Software Foundation; either version 2 of the License, or (at your option)
+//# any later version.
+//#
+//# This program is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//# more details.
+//#
+//# You should have received a copy of the GNU General Public License along
+//# with this program; if not, write to the Free Software Foundation, Inc.,
+//# 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+#ifndef SYNTHESIS_VI2BENCHMARK_H
+#define SYNTHESIS_VI2BENCHMARK_H
+
+#include <casa/aips.h>
+#include <casa/BasicSL/String.h>
+#include <casa/Arrays/Vector.h>
+#include <ms/MeasurementSets/MeasurementSet.h>
+#include <msvis/MSVis/ViiLayerFactory.h>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace casa {
+
+namespace vi {
+class VisibilityIterator2;
+}
+
+namespace test {
+
+// Shape of the synthetic data. The VI2 layer stages run on a SimpleSimVi2
+// of nField x nScan x nSpw x nTime integrations of nAnt antennas, nChan
+// channels and nCorr correlations; the stages which need MS columns
+// (StatWtTVI and the FTMachines) run on a synthetic MS made by MakeMS with
+// msNChan channels and msNInt integrations.
+struct Vi2BenchmarkParameters {
+  casacore::Int nField = 1;
+  casacore::Int nScan = 1;
+  casacore::Int nSpw = 1;
+  casacore::Int nAnt = 27;
+  casacore::Int nCorr = 4;
+  casacore::Int nTime = 60;
+  casacore::Int nChan = 256;
+  // ChannelAverageTVI bin (channels) and AveragingTvi2 interval (s)
+  casacore::Int chanBin = 8;
+  casacore::Double timeBin = 10.0;
+  // image size (pixels) of the FTMachine stages
+  casacore::Int imageSize = 512;
+  casacore::Int msNChan = 64;
+  casacore::Int msNInt = 100;
+};
+
+struct Vi2BenchmarkResult {
+  casacore::String stage;
+  casacore::uInt64 rows = 0;
+  casacore::uInt64 visibilities = 0;
+  casacore::Double seconds = 0;
+  // peak resident set size during the stage where the platform allows
+  // resetting it (Linux), else of the process so far
+  casacore::Double peakRssMB = 0;
+
+  casacore::Double rowsPerSecond() const;
+  casacore::Double visibilitiesPerSecond() const;
+};
+
+// <summary>
+// Synthetic end-to-end performance benchmark of the VI2 ecosystem.
+// </summary>
+//
+// <synopsis>
+// Each stage iterates over a representative VI2 layer stack, or drives an
+// FTMachine, on synthetic data (no production data needed), reading the
+// corrected visibilities and flags of every sub-chunk, and reports the rows
+// and visibilities per second and the peak RSS.
+//
+// Stages:
+// <ul>
+//  <li> sim: SimpleSimVi2 alone
+//  <li> calibrate: SimpleSimVi2 + CalibratingVi2
+//  <li> timeaverage: SimpleSimVi2 + AveragingTvi2
+//  <li> chanaverage: SimpleSimVi2 + ChannelAverageTVI
+//  <li> uvcontsub: SimpleSimVi2 + UVContSubTVI
+//  <li> phaseshift: SimpleSimVi2 + PhaseShiftingTVI
+//  <li> chain: SimpleSimVi2 + CalibratingVi2 + ChannelAverageTVI + AveragingTvi2
+//  <li> statwt: MS + StatWtTVI
+//  <li> gridft-put, gridft-get, wprojectft-put, wprojectft-get: gridding
+//       and degridding of the MS with GridFT and WProjectFT
+// </ul>
+// </synopsis>
+class Vi2Benchmark {
+
+public:
+
+  explicit Vi2Benchmark(const Vi2BenchmarkParameters& pars);
+
+  ~Vi2Benchmark();
+
+  // Names of all stages, in the order in which they are usually run
+  static std::vector<casacore::String> stages();
+
+  Vi2BenchmarkResult run(const casacore::String& stage);
+
+  std::vector<Vi2BenchmarkResult> run(const std::vector<casacore::String>& stages);
+
+  static void report(std::ostream& os, const std::vector<Vi2BenchmarkResult>& results);
+
+private:
+
+  Vi2BenchmarkResult runLayers(const casacore::String& stage,
+                               const casacore::Vector<vi::ViiLayerFactory*>& factories);
+
+  Vi2BenchmarkResult runStatWt(const casacore::String& stage);
+
+  Vi2BenchmarkResult runFTMachine(const casacore::String& stage,
+                                  const casacore::String& ftmachine,
+                                  casacore::Bool toSky);
+
+  // Iterate over all sub-chunks, reading the corrected visibilities, flags
+  // and, if readWeights, weights
+  void iterate(vi::VisibilityIterator2& vi, Vi2BenchmarkResult& result,
+               casacore::Bool readWeights);
+
+  // The synthetic MS, made on first use and deleted with this object
+  casacore::MeasurementSet& syntheticMS();
+
+  Vi2BenchmarkParameters pars_p;
+  std::unique_ptr<casacore::MeasurementSet> ms_p;
+};
+
+} // namespace test
+} // namespace casa
+
+#endif
@@ -0,0 +1,81 @@
+//# tVi2Benchmark_GT.cc: Run the VI2 benchmark stages on small synthetic data
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU General Public License as published by the Free
+//# Software Foundation; either version 2 of the License, or (at your option)
+//# any later version.
+//#
+//# This program is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//# more details.
+//#
+//# You should have received a copy of the GNU General Public License along
+//# with this program; if not, write to the Free Software Foundation, Inc.,
+//# 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+#include <synthesis/apps/vi2benchmark/Vi2Benchmark.h>
+#include <casa/iostream.h>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace casa;
+using namespace casacore;
+using namespace casa::test;
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+TEST( Vi2Benchmark , AllStages ) {
+
+  Vi2BenchmarkParameters pars;
+  pars.nAnt = 4;
+  pars.nTime = 20;
+  pars.nChan = 32;
+  pars.chanBin = 4;
+  pars.timeBin = 5.0;
+  pars.imageSize = 64;
+  pars.msNChan = 8;
+  pars.msNInt = 10;
+
+  Vi2Benchmark benchmark(pars);
+  const std::vector<String> stages = Vi2Benchmark::stages();
+  const std::vector<Vi2BenchmarkResult> results = benchmark.run(stages);
+  Vi2Benchmark::report(cout, results);
+
+  ASSERT_EQ(stages.size(), results.size());
+  for (uInt i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(stages[i], results[i].stage);
+    ASSERT_GT(results[i].rows, 0u);
+    ASSERT_GT(results[i].visibilities, 0u);
+    ASSERT_GE(results[i].seconds, 0.0);
+    ASSERT_GT(results[i].peakRssMB, 0.0);
+  }
+
+  // the simulated data has nAnt*(nAnt-1)/2 rows per integration
+  ASSERT_EQ(uInt64(pars.nTime * pars.nAnt * (pars.nAnt - 1) / 2), results[0].rows);
+  ASSERT_EQ(results[0].rows * pars.nChan * pars.nCorr, results[0].visibilities);
+
+  // channel averaging reduces the visibilities, not the rows
+  ASSERT_EQ(results[0].rows, results[3].rows);
+  ASSERT_EQ(results[0].visibilities / pars.chanBin, results[3].visibilities);
+}
+
+TEST( Vi2Benchmark , UnknownStage ) {
+  Vi2Benchmark benchmark(Vi2BenchmarkParameters());
+  ASSERT_THROW(benchmark.run(String("nosuchstage")), AipsError);
+}
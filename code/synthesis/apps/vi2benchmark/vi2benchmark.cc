@@ -0,0 +1,110 @@
+//# vi2benchmark.cc: Synthetic performance benchmark of VI2 layers and FTMachines
+//# Copyright (C) 2017
+//# Associated Universities, Inc. Washington DC, USA.
+//#
+//# This program is free software; you can redistribute it and/or modify it
+//# under the terms of the GNU General Public License as published by the Free
+//# Software Foundation; either version 2 of the License, or (at your option)
+//# any later version.
+//#
+//# This program is distributed in the hope that it will be useful, but WITHOUT
+//# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+//# more details.
+//#
+//# You should have received a copy of the GNU General Public License along
+//# with this program; if not, write to the Free Software Foundation, Inc.,
+//# 675 Massachusetts Ave, Cambridge, MA 02139, USA.
+//#
+//# Correspondence concerning AIPS++ should be addressed as follows:
+//#        Internet email: aips2-request@nrao.edu.
+//#        Postal address: AIPS++ Project Office
+//#                        National Radio Astronomy Observatory
+//#                        520 Edgemont Road
+//#                        Charlottesville, VA 22903-2475 USA
+//#
+//# $Id$
+
+#include <synthesis/apps/vi2benchmark/Vi2Benchmark.h>
+
+#include <casa/Exceptions/Error.h>
+#include <casa/iostream.h>
+#include <cstdlib>
+
+using namespace casacore;
+using namespace casa;
+using namespace casa::test;
+
+static void usage() {
+  cout << "usage: vi2benchmark [-nfield N] [-nscan N] [-nspw N] [-nant N] [-ncorr N]" << endl
+       << "                    [-ntime N] [-nchan N] [-chanbin N] [-timebin SECONDS]" << endl
+       << "                    [-imsize N] [-msnchan N] [-msnint N] [-stages STAGE,STAGE,...]" << endl
+       << "stages:";
+  for (auto& stage : Vi2Benchmark::stages()) {
+    cout << " " << stage;
+  }
+  cout << endl;
+}
+
+int main(int argc, char **argv) {
+  Vi2BenchmarkParameters pars;
+  std::vector<String> stages = Vi2Benchmark::stages();
+  for (int i = 1; i < argc; ++i) {
+    const String parameter(argv[i]);
+    if (parameter == "-h" || parameter == "--help" || i + 1 == argc) {
+      usage();
+      return parameter == "-h" || parameter == "--help" ? 0 : 1;
+    }
+    const String value(argv[++i]);
+    if (parameter == "-nfield") {
+      pars.nField = atoi(value.c_str());
+    } else if (parameter == "-nscan") {
+      pars.nScan = atoi(value.c_str());
+    } else if (parameter == "-nspw") {
+      pars.nSpw = atoi(value.c_str());
+    } else if (parameter == "-nant") {
+      pars.nAnt = atoi(value.c_str());
+    } else if (parameter == "-ncorr") {
+      pars.nCorr = atoi(value.c_str());
+    } else if (parameter == "-ntime") {
+      pars.nTime = atoi(value.c_str());
+    } else if (parameter == "-nchan") {
+      pars.nChan = atoi(value.c_str());
+    } else if (parameter == "-chanbin") {
+      pars.chanBin = atoi(value.c_str());
+    } else if (parameter == "-timebin") {
+      pars.timeBin = atof(value.c_str());
+    } else if (parameter == "-imsize") {
+      pars.imageSize = atoi(value.c_str());
+    } else if (parameter == "-msnchan") {
+      pars.msNChan = atoi(value.c_str());
+    } else if (parameter == "-msnint") {
+      pars.msNInt = atoi(value.c_str());
+    } else if (parameter == "-stages") {
+      stages.clear();
+      String rest = value;
+      while (!rest.empty()) {
+        const String::size_type comma = rest.find(',');
+        stages.push_back(rest.substr(0, comma));
+        rest = comma == String::npos ? String() : String(rest.substr(comma + 1));
+      }
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  try {
+    Vi2Benchmark benchmark(pars);
+    std::vector<Vi2BenchmarkResult> results;
+    for (auto& stage : stages) {
+      results.push_back(benchmark.run(stage));
+      cerr << "Finished stage " << stage << endl;
+    }
+    Vi2Benchmark::report(cout, results);
+  } catch (const AipsError& x) {
+    cerr << "Exception: " << x.getMesg() << endl;
+    return 1;
+  }
+  return 0;
+}
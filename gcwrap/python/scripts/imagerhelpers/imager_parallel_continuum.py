@@ -392,8 +392,11 @@ class PyParallelContSynthesisImager(PySynthesisImager):
         ## Set weight parameters and accumulate weight density (natural)
         joblist=[];
         for node in self.listOfNodes:
-            ## Set weighting pars
-            joblist.append( self.PH.runcmd("toolsi.setweighting( **" + str(self.weightpars) + ")", node ) )
+            ## Set weighting pars. Each node selects different data, so it gets its own density cache.
+            nodeweightpars = self.weightpars.copy()
+            if nodeweightpars.get('densitycache','') != '':
+                nodeweightpars['densitycache'] = nodeweightpars['densitycache'] + '.' + str(node)
+            joblist.append( self.PH.runcmd("toolsi.setweighting( **" + str(nodeweightpars) + ")", node ) )
         self.PH.checkJobs( joblist )
 
         ## If only one field, do the get/gather/set of the weight density.
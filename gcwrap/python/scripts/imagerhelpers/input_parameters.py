@@ -89,6 +89,7 @@ class ImagerParameters():
                  robust=0.5,
                  npixels=0,
                  uvtaper=[],
+                 densitycache='',
 
                  niter=0, 
                  cycleniter=0, 
@@ -164,7 +165,7 @@ class ImagerParameters():
                                    'interpolation':interpolation, 'wprojplanes':wprojplanes,
                                    'deconvolver':deconvolver, 'vptable':vptable }     }
         ######### weighting
-        self.weightpars = {'type':weighting,'robust':robust, 'npixels':npixels,'uvtaper':uvtaper}
+        self.weightpars = {'type':weighting,'robust':robust, 'npixels':npixels,'uvtaper':uvtaper,'densitycache':densitycache}
 
         ######### Normalizers ( this is where flat noise, flat sky rules will go... )
         self.allnormpars = { self.defaultKey : {#'mtype': mtype,
@@ -5,7 +5,7 @@ from casac import casac
 
 mysdms, mycb = gentools(['sdms', 'cb'])
 
-def importasap(infile=None, outputvis=None, flagbackup=None, overwrite=None, parallel=None):
+def importasap(infile=None, outputvis=None, flagbackup=None, overwrite=None, parallel=None, nworkers=None):
     """
     """
     casalog.origin('importasap')
@@ -21,6 +21,9 @@ def importasap(infile=None, outputvis=None, flagbackup=None, overwrite=None, par
         if overwrite is None:
             overwrite = False
 
+        if nworkers is None:
+            nworkers = 0
+
         # basic check
         if os.path.exists(outputvis) and not overwrite:
             raise RuntimeError('%s exists.'%(outputvis))
@@ -29,7 +32,7 @@ def importasap(infile=None, outputvis=None, flagbackup=None, overwrite=None, par
             raise RuntimeError('%s is not a valid Scantable.'%(infile))
 
         # import
-        status = mysdms.importasap(infile, outputvis, parallel)
+        status = mysdms.importasap(infile, outputvis, parallel, nworkers)
 
         if status == True:
             # flagversions file must be deleted 
@@ -6,13 +6,16 @@ from taskinit import *
 import sdutil
 mysdms, mycb = gentools(['sdms', 'cb'])
 
-def importnro(infile=None, outputvis=None, overwrite=None, parallel=None):
+def importnro(infile=None, outputvis=None, overwrite=None, parallel=None, nworkers=None):
     """
     """
     casalog.origin('importnro')
     status = True
 
     try:
+        if nworkers is None:
+            nworkers = 0
+
         outputvis_temp = outputvis + '-backup-' + datetime.datetime.now().strftime('%Y%m%d-%H%M%S')
         
         if os.path.exists(outputvis):
@@ -24,7 +27,7 @@ def importnro(infile=None, outputvis=None, overwrite=None, parallel=None):
         if not is_nostar(infile):
             raise RuntimeError('%s is not a valid NOSTAR data.'%(infile))
 
-        status = mysdms.importnro(infile, outputvis, parallel)
+        status = mysdms.importnro(infile, outputvis, parallel, nworkers)
 
         if status:
             # initialize weights using cb tool
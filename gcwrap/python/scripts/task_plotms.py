@@ -24,7 +24,7 @@ def plotms(vis=None,
            xsharedaxis=None, ysharedaxis=None,
            customsymbol=None, symbolshape=None, symbolsize=None,
            symbolcolor=None, symbolfill=None, symboloutline=None,
-           coloraxis=None,
+           coloraxis=None, densitythreshold=None,
            customflaggedsymbol=None, flaggedsymbolshape=None,
            flaggedsymbolsize=None, flaggedsymbolcolor=None,
            flaggedsymbolfill=None, flaggedsymboloutline=None,
@@ -171,6 +171,10 @@ def plotms(vis=None,
 
     coloraxis -- which axis to use for colorizing
                      default: ''  (ignored - same as colorizing off)              
+    densitythreshold -- number of plotted points above which the plot
+                     is aggregated to the canvas pixels
+                     default: -1  (use the plotms.density.threshold aipsrc
+                     variable; 0 turns aggregation off)
     
     title  -- title along top of plot (called "canvas" in some places)
     titlefont -- plot title font size
@@ -518,6 +522,11 @@ def plotms(vis=None,
         if coloraxis:
             pm.setColorAxis(coloraxis,False,plotindex)
 
+        # (Density rendering)
+        if densitythreshold is None:
+            densitythreshold = -1
+        pm.setDensityThreshold(densitythreshold,False,plotindex)
+
         # Set custom symbol
         # Make the custom symbol into a list if it is not already.
         if type(customsymbol) is bool and customsymbol:
@@ -1,6 +1,8 @@
 # unit test for the exportasdm task
 
+import filecmp
 import os
+import re
 import shutil
 
 from __main__ import default
@@ -301,6 +303,44 @@ class exportasdm_test(unittest.TestCase):
         omsname = "test"+str(12)+self.out
         os.system('rm -rf '+omsname+'; mv  asdm '+omsname)
 
+    def test13(self):
+        '''Test 13: v3, the output does not depend on the number of parallel BDF writers'''
+        myvis = self.vis_c
+        os.system('rm -rf myinput.ms bdfwriters1.asdm bdfwriters4.asdm')
+        ms.open(myvis)
+        ms.timesort('myinput.ms')
+        ms.close()
+
+        # short subscans, so that several are written at the same time
+        for nwriters in [1, 4]:
+            rval = os.system('MS2asdm --subscanduration 30 --apuncorrected --bdfwriters '
+                             + str(nwriters) + ' myinput.ms bdfwriters' + str(nwriters) + '.asdm')
+            self.assertEqual(rval, 0)
+
+        def tablerows(asdmname, table):
+            f = open(asdmname + '/' + table + '.xml')
+            rows = re.findall('<row>.*?</row>', f.read(), re.DOTALL)
+            f.close()
+            return rows
+
+        # the Main, Subscan and Scan rows, in order
+        for table in ['Main', 'Subscan', 'Scan']:
+            rows1 = tablerows('bdfwriters1.asdm', table)
+            rows4 = tablerows('bdfwriters4.asdm', table)
+            self.assertEqual(rows1, rows4, table + ' table rows differ')
+        self.assertTrue(len(tablerows('bdfwriters1.asdm', 'Main')) > 4)
+
+        # the BDF payloads
+        bdfs1 = sorted(os.listdir('bdfwriters1.asdm/ASDMBinary'))
+        bdfs4 = sorted(os.listdir('bdfwriters4.asdm/ASDMBinary'))
+        self.assertEqual(bdfs1, bdfs4)
+        for bdf in bdfs1:
+            self.assertTrue(filecmp.cmp('bdfwriters1.asdm/ASDMBinary/' + bdf,
+                                        'bdfwriters4.asdm/ASDMBinary/' + bdf, shallow=False),
+                            'BDF ' + bdf + ' differs')
+
+        os.system('rm -rf myinput.ms bdfwriters1.asdm bdfwriters4.asdm')
+
 
 
 class exportasdm_test2(unittest.TestCase):
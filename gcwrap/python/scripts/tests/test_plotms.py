@@ -1688,6 +1688,62 @@ class plotms_test_transform(plotms_test_base):
         print
 
 # ------------------------------------------------------------------------------
+
+class plotms_test_persistent_cache(plotms_test_base):
+    ''' Test the persistent (on-disk) cache '''
+
+    def setUp(self):
+        self.checkDisplay()
+        self.setUpdata()
+        # The plotms application reads the rc file when it starts
+        self.rcfile = os.path.join(self.outputDir, "casarc")
+        f = open(self.rcfile, "w")
+        f.write("plotms.cache.persistent: true\n")
+        f.close()
+        self.casarcfiles = os.environ.get('CASARCFILES')
+        os.environ['CASARCFILES'] = self.rcfile
+        pm.killApp()
+
+    def tearDown(self):
+        pm.killApp()
+        if self.casarcfiles is None:
+            del os.environ['CASARCFILES']
+        else:
+            os.environ['CASARCFILES'] = self.casarcfiles
+        self.tearDowndata()
+
+    def test_persistent_cache_roundtrip(self):
+        '''test_persistent_cache_roundtrip: Restored cache gives the same plot'''
+        cachefile = self.ms + ".plotmscache"
+        txtfile1 = os.path.join(self.outputDir, "testCache01_1.txt")
+        txtfile2 = os.path.join(self.outputDir, "testCache01_2.txt")
+
+        # First run loads the MS and saves the cache beside it
+        res = plotms(vis=self.ms, xaxis='time', yaxis='amp', showgui=False,
+                     plotfile=txtfile1, expformat='txt')
+        self.assertTrue(res)
+        self.assertTrue(os.path.isfile(txtfile1))
+        self.assertTrue(os.path.isfile(cachefile), "Cache was not saved")
+        mtime = os.path.getmtime(cachefile)
+
+        # Second run, in a fresh application, restores the cache
+        pm.killApp()
+        time.sleep(2)
+        res = plotms(vis=self.ms, xaxis='time', yaxis='amp', showgui=False,
+                     plotfile=txtfile2, expformat='txt')
+        self.assertTrue(res)
+        self.assertTrue(os.path.isfile(txtfile2))
+        # not rewritten, so the data came from the cache
+        self.assertEqual(os.path.getmtime(cachefile), mtime)
+
+        f1 = open(txtfile1)
+        f2 = open(txtfile2)
+        self.assertEqual(f1.read(), f2.read())
+        f1.close()
+        f2.close()
+        print
+
+# ------------------------------------------------------------------------------
  
 def suite():
     print 'Tests may fail due to DBUS timeout if the version of Qt is not at least 4.8.5'
@@ -1702,6 +1758,7 @@ def suite():
             plotms_test_iteration,
             plotms_test_multi,
             plotms_test_selection,
-            plotms_test_transform
+            plotms_test_transform,
+            plotms_test_persistent_cache
            ]
  
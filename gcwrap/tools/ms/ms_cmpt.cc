@@ -67,6 +67,7 @@
 #include <msvis/MSVis/ViFrequencySelection.h>
 
 #include <msvis/MSVis/statistics/Vi2StatisticsIteratee.h>
+#include <msvis/MSVis/statistics/Vi2ClassicalStatistics.h>
 #include <msvis/MSVis/statistics/Vi2DataProvider.h>
 #include <msvis/MSVis/statistics/Vi2VisAmplitudeProvider.h>
 #include <msvis/MSVis/statistics/Vi2VisPhaseProvider.h>
@@ -1428,6 +1429,19 @@ public:
 
 	void nextDataset(StatisticsAlgorithm<A,D,M,W> &statistics,
 	                 const std::unordered_map<int,std::string> *columnValues) {
+		recordStatistics(statistics, columnValues);
+	}
+
+	void nextDataset(Vi2ClassicalStatistics<A,D,M,W> &statistics,
+	                 const std::unordered_map<int,std::string> *columnValues) {
+		recordStatistics(statistics, columnValues);
+	}
+
+private:
+
+	template <class S>
+	void recordStatistics(S &statistics,
+	                      const std::unordered_map<int,std::string> *columnValues) {
 		string keyvals;
 		string delim;
 		for (auto const & id : sortColumnIds) {
@@ -1456,8 +1470,8 @@ public:
 
 // Compute statistics using a given DataProvider, using iteration over vi2
 // chunks to implement reporting axes. The Statistics template parameter may be
-// any StatisticsAlgorithm class, although statistics2 always uses
-// ClassicalStatistics.
+// any StatisticsAlgorithm class, or Vi2ClassicalStatistics, which statistics2
+// always uses.
 //
 // Note that the format of the returned record has not been finalized, and may
 // change.
@@ -1490,7 +1504,8 @@ doStatistics(
 }
 
 // Thin wrapper over doStatistics, provided because statistics2 requires
-// ClassicalStatistics.
+// classical statistics. Vi2ClassicalStatistics computes the same statistics as
+// ClassicalStatistics, with fewer passes over the MS and in parallel.
 template <class DataProvider>
 static ::casac::record *
 doClassicalStatistics(
@@ -1499,7 +1514,7 @@ doClassicalStatistics(
 	bool hideTimeAxis,
 	DataProvider *dataProvider)
 {
-	return doStatistics<DataProvider,ClassicalStatistics>(
+	return doStatistics<DataProvider,Vi2ClassicalStatistics>(
 		sortColumnIds, mergedColumns, hideTimeAxis, dataProvider);
 }
 
@@ -460,6 +460,23 @@ string plotms::getColorAxis(const int plotIndex)
     GETSINGLEPLOTSTR(COLORAXIS) 
 }
 
+void plotms::setDensityThreshold(const int threshold, const bool updateImmediately, const int plotIndex) 
+{
+    launchApp();
+    Record params;
+    params.define(PlotMSDBusApp::PARAM_DENSITYTHRESHOLD, threshold);
+    params.define(PlotMSDBusApp::PARAM_UPDATEIMMEDIATELY, updateImmediately);
+    params.define(PlotMSDBusApp::PARAM_PLOTINDEX, plotIndex);
+    QtDBusXmlApp::dbusXmlCallNoRet(dbus::FROM_NAME, app.dbusName( ),
+            PlotMSDBusApp::METHOD_SETPLOTPARAMS, params, /*true*/asyncCall);
+}
+
+int plotms::getDensityThreshold(const int plotIndex) 
+{
+    launchApp();
+    GETSINGLEPLOTINT(DENSITYTHRESHOLD) 
+}
+
 
 
 void plotms::setTitle(const string& text,  const bool updateImmediately, const int plotIndex) 
@@ -464,12 +464,13 @@ singledishms::smooth(string const &type, float const width,
 }
 
 bool
-singledishms::importasap(string const &infile, string const &outfile, bool const parallel)
+singledishms::importasap(string const &infile, string const &outfile, bool const parallel,
+                         int const nworkers)
 {
     bool rstat(false);
     *itsLog << _ORIGIN;
     try {
-      rstat = SingleDishMS::importAsap(infile, outfile, parallel);
+      rstat = SingleDishMS::importAsap(infile, outfile, parallel, nworkers);
     } catch  (AipsError x) {
       *itsLog << LogIO::SEVERE << "Exception Reported: " << x.getMesg()
           << LogIO::POST;
@@ -479,12 +480,13 @@ singledishms::importasap(string const &infile, string const &outfile, bool const
 }
 
 bool
-singledishms::importnro(string const &infile, string const &outfile, bool const parallel)
+singledishms::importnro(string const &infile, string const &outfile, bool const parallel,
+                        int const nworkers)
 {
     bool rstat(false);
     *itsLog << _ORIGIN;
     try {
-      rstat = SingleDishMS::importNRO(infile, outfile, parallel);
+      rstat = SingleDishMS::importNRO(infile, outfile, parallel, nworkers);
     } catch  (AipsError x) {
       *itsLog << LogIO::SEVERE << "Exception Reported: " << x.getMesg()
           << LogIO::POST;
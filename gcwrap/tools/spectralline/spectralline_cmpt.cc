@@ -96,6 +96,7 @@ bool spectralline::close() {
 			delete _table;
 			_table = 0;
 		}
+		_index.reset();
 		return true;
 	} catch (AipsError x) {
 		*_log << LogIO::SEVERE << "Exception Reported: " << x.getMesg() << LogIO::POST;
@@ -181,7 +182,7 @@ spectralline* spectralline::search(
 			}
 		}
 
-		SearchEngine engine(_table, verbose, logfile, append);
+		SearchEngine engine(_table, verbose, logfile, append, _getIndex());
 		table.reset(
 			engine.search(
 				outfile, freqRange[0], freqRange[1], mySpecies,
@@ -249,7 +250,7 @@ record* spectralline::species(const bool verbose, const string& logfile, const b
 		if (_detached()) {
 			return 0;
 		}
-		SearchEngine engine(_table, verbose, logfile, append);
+		SearchEngine engine(_table, verbose, logfile, append, _getIndex());
 		Vector<String> species = engine.uniqueSpecies();
 		*_log << LogIO::NORMAL << species << LogIO::POST;
 		Record ret;
@@ -267,7 +268,7 @@ record* spectralline::chemnames(const bool verbose, const string& logfile, const
 		if (_detached()) {
 			return 0;
 		}
-		SearchEngine engine(_table, verbose, logfile, append);
+		SearchEngine engine(_table, verbose, logfile, append, _getIndex());
 		Vector<String> chemNames = engine.uniqueChemicalNames();
 		*_log << LogIO::NORMAL << chemNames << LogIO::POST;
 		Record ret;
@@ -287,6 +288,13 @@ int spectralline::nrows() {
 	return _table->nrow();
 }
 
+std::shared_ptr<const SplatalogueIndex> spectralline::_getIndex() {
+	if (! _index) {
+		_index = SplatalogueIndex::get(*_table);
+	}
+	return _index;
+}
+
 bool spectralline::_detached() const {
 	bool detached = false;
 	if (_table == 0) {
@@ -2,6 +2,7 @@
 #include <memory>
 
 #include <stdcasa/StdCasa/CasacSupport.h>
+#include <spectrallines/Splatalogue/SplatalogueIndex.h>
 #include <spectrallines/Splatalogue/SplatalogueTable.h>
 
 
@@ -2,11 +2,16 @@
 
 casacore::LogIO *_log;
 casa::SplatalogueTable *_table;
+// The index of _table, kept with it so that a table which is not on disk
+// is not indexed again for every search
+std::shared_ptr<const casa::SplatalogueIndex> _index;
 
 spectralline(casa::SplatalogueTable* table);
 
 bool _detached() const;
 
+std::shared_ptr<const casa::SplatalogueIndex> _getIndex();
+
 void _checkLowHigh(
 	double& low, double& high, const vector<double> pair, const string label
 ) const ;
@@ -371,7 +371,8 @@ bool synthesisimager::setweighting(const std::string& type,
 				   const ::casac::variant& fieldofview,
 				   const int npixels,
 				   const bool multifield,
-				   const std::vector<std::string>& uvtaper
+				   const std::vector<std::string>& uvtaper,
+				   const std::string& densitycache
 				   /*				   const std::string& filtertype,
 				   const ::casac::variant& filterbmaj,
 				   const ::casac::variant& filterbmin,
@@ -399,7 +400,7 @@ bool synthesisimager::setweighting(const std::string& type,
 
       if(uvtaperpars.nelements()>0 && uvtaperpars[0].length()>0) filtertype=String("gaussian");
 
-      itsImager->weight( type, rmode, cnoise, robust, cfov, npixels, multifield, filtertype, bmaj, bmin, bpa  );
+      itsImager->weight( type, rmode, cnoise, robust, cfov, npixels, multifield, filtertype, bmaj, bmin, bpa, densitycache );
 
     } 
   catch  (AipsError x) 